@@ -0,0 +1,111 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "arena.h"
+#include "profile.h"
+#include "mem.h"
+
+#define ARENA_ALIGN(n)  (((n) + sizeof (void *) - 1) & ~(sizeof (void *) - 1))
+
+static struct arena_block *
+arena_block_new(struct mem_acct *mem, size_t size)
+{
+    struct arena_block *b = mem_malloc(mem, MEM_BUF, sizeof (*b) + size);
+
+    assert(b != NULL);
+    prof_count(PROF_ALLOCS, 1);
+    b->next = NULL;
+    b->size = size;
+    b->used = 0;
+    return b;
+}
+
+struct arena *
+arena_new(size_t bsize, struct mem_acct *mem)
+{
+    struct arena *a = mem_malloc(mem, MEM_OTHER, sizeof (*a));
+
+    a->mem = mem;
+    a->bsize = (bsize) ? bsize : BUFSIZ * 8;
+    a->head = a->cur = arena_block_new(mem, a->bsize);
+    return a;
+}
+
+void *
+arena_alloc(struct arena *a, size_t size)
+{
+    struct arena_block *b = a->cur;
+    void *p;
+
+    size = ARENA_ALIGN(size);
+
+    while (b->used + size > b->size) {
+        if (b->next == NULL) {
+            b->next = arena_block_new(a->mem, 
+                                      (size > a->bsize) ? size : a->bsize);
+        } 
+        b = b->next;
+        b->used = 0;  // blocks after cur are stale after a reset
+    }
+    a->cur = b;
+
+    p = b->data + b->used;
+    b->used += size;
+    return p;
+}
+
+char *
+arena_strndup(struct arena *a, const char *s, size_t n)
+{
+    char *p = arena_alloc(a, n + 1);
+
+    memcpy(p, s, n);
+    p[n] = '\0';
+    return p;
+}
+
+/* arena_reset() - `free' everything allocated from the arena
+ *
+ * only the first block is marked empty here, the others are 
+ * cleared as arena_alloc() reaches them.
+ */
+void
+arena_reset(struct arena *a)
+{
+    a->cur = a->head;
+    a->head->used = 0;
+}
+
+void
+arena_free(struct arena *a)
+{
+    struct arena_block *b = a->head;
+
+    while (b) {
+        struct arena_block *tmp = b->next;
+        mem_free(a->mem, MEM_BUF, b);
+        b = tmp;
+    }
+    mem_free(a->mem, MEM_OTHER, a);
+}
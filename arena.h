@@ -0,0 +1,56 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _ARENA_H
+#define _ARENA_H       1
+
+#include <stddef.h>
+
+struct mem_acct;
+
+/*
+ * A simple bump allocator. Memory is allocated in blocks, and
+ * individual allocations are never freed. arena_reset() makes all
+ * the memory available again without returning the blocks to the
+ * system, so that the same arena can be used over and over for 
+ * short-lived data (e.g., a chart for each utterance).
+ */
+
+struct arena_block {
+    struct arena_block  *next;
+    size_t              size;
+    size_t              used;
+    char                data[];
+};
+
+struct arena {
+    struct arena_block  *head;
+    struct arena_block  *cur;
+    size_t              bsize;  // default block size
+    struct mem_acct     *mem;   // blocks are counted here, or NULL
+};
+
+struct arena    *arena_new(size_t bsize, struct mem_acct *mem);
+void            *arena_alloc(struct arena *a, size_t size);
+char            *arena_strndup(struct arena *a, const char *s, size_t n);
+void            arena_reset(struct arena *a);
+void            arena_free(struct arena *a);
+
+#endif /* _ARENA_H */
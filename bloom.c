@@ -0,0 +1,276 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+#include "bloom.h"
+
+#define BLOOM_MINKEYS   1024
+#define BLOOM_MAXK      16
+#define BLOOM_MAXSTATS  8
+#define BLOOM_SAMPLE    64  // time one in this many rejected lookups
+
+/* 
+ * the counters are shared by all filters with the same name, e.g. all
+ * n-gram tables of the combine cues. they are only updated if
+ * bloom_stats_on is set, atomically, as the tables of different models
+ * may be used from different threads (see libseg.h).
+ */
+struct bloom_stats {
+    const char  *name;
+    size_t      probes;     // lookups through the filter
+    size_t      rejected;   // answered by the filter alone
+    size_t      fpos;       // passed the filter, not in the table
+    size_t      nsample;    // rejected lookups sent to the table anyway
+    double      sample_ns;  //   and the time they took
+    size_t      nfill;      // times a filter was (re)built 
+};
+
+double bloom_fpr = 0.0;
+int bloom_stats_on = 0;
+
+static struct bloom_stats stats[BLOOM_MAXSTATS];
+static int nstats = 0;
+static double bpk;          // bits per key
+static int nhash;           // bits set per key
+static double clock_ns;     // overhead of a clock_gettime() pair
+
+static inline double
+elapsed_ns(struct timespec *t0, struct timespec *t1)
+{
+    return (t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec);
+}
+
+/* bloom_init() - enable the filters with the false positive rate `fpr'
+ *
+ * a zero `fpr' disables the filters. the rate is kept by each filter
+ * created after the call, and does not change the lookup counters, 
+ * see bloom_stats_enable().
+ */
+void
+bloom_init(double fpr)
+{
+    assert(fpr >= 0.0 && fpr < 1.0);
+    bloom_fpr = fpr;
+    if (fpr == 0.0) return;
+
+    bpk = -log(fpr) / (M_LN2 * M_LN2);
+    nhash = (int) lround(bpk * M_LN2);
+    if (nhash < 1) nhash = 1;
+    if (nhash > BLOOM_MAXK) nhash = BLOOM_MAXK;
+}
+
+/* bloom_stats_enable() - count the lookups of all filters, for 
+ *                        bloom_report(). only seg(1) turns them on.
+ */
+void
+bloom_stats_enable()
+{
+    struct timespec t0, t1;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < 1000; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+    }
+    clock_ns = elapsed_ns(&t0, &t1) / 1000;
+    bloom_stats_on = 1;
+}
+
+static struct bloom_stats *
+stats_get(const char *name)
+{
+    int i;
+
+    for (i = 0; i < nstats; i++) {
+        if (!strcmp(stats[i].name, name)) return &stats[i];
+    }
+    assert(nstats < BLOOM_MAXSTATS);
+    stats[nstats].name = name;
+    return &stats[nstats++];
+}
+
+/* bloom_report() - print the lookup counters of all filters */
+void
+bloom_report()
+{
+    int i;
+
+    if (!bloom_stats_on || bloom_fpr == 0.0) return;
+
+    for (i = 0; i < nstats; i++) {
+        struct bloom_stats *st = &stats[i];
+        size_t neg = st->rejected + st->fpos;
+        double miss_ns = st->nsample ? st->sample_ns / st->nsample : 0.0;
+
+        fprintf(stderr, "bloom %s: %zu lookups, %zu rejected (%.1f%%), "
+                "%zu false positives (%.4f), %zu builds, "
+                "%.0f ns per table miss, ~%.1f ms saved\n",
+                st->name, st->probes, st->rejected, 
+                st->probes ? 100.0 * st->rejected / st->probes : 0.0,
+                st->fpos, neg ? (double) st->fpos / neg : 0.0,
+                st->nfill, miss_ns, st->rejected * miss_ns / 1e6);
+    }
+}
+
+static void
+bloom_alloc(struct bloom *b, size_t cap)
+{
+    size_t nblocks = 1,
+           need = (size_t) ceil(cap * b->bpk / BLOOM_BLOCKBITS);
+    void *bits;
+
+    while (nblocks < need) nblocks <<= 1;
+    free(b->bits);
+    if (posix_memalign(&bits, 64, nblocks * BLOOM_BLOCKWORDS * 8)) {
+        assert(0);
+    }
+    memset(bits, 0, nblocks * BLOOM_BLOCKWORDS * 8);
+    b->bits = bits;
+    b->nblocks = nblocks;
+    b->cap = cap;
+    b->n = 0;
+}
+
+/* bloom_new() - a filter for a new, empty table
+ *
+ * returns NULL if the filters are disabled. filters with the same 
+ * `name' share their counters. the filter keeps the rate set by 
+ * bloom_init() at the time it was created.
+ */
+struct bloom *
+bloom_new(const char *name)
+{
+    struct bloom *b;
+
+    if (bloom_fpr == 0.0) return NULL;
+
+    b = calloc(1, sizeof (*b));
+    b->k = nhash;
+    b->bpk = bpk;
+    b->st = stats_get(name);
+    bloom_alloc(b, BLOOM_MINKEYS);
+    return b;
+}
+
+void
+bloom_free(struct bloom *b)
+{
+    if (b == NULL) return;
+    free(b->bits);
+    free(b);
+}
+
+/* bloom_bytes() - the memory held by `b', for --mem-report */
+size_t
+bloom_bytes(struct bloom *b)
+{
+    if (b == NULL) return 0;
+    return sizeof (*b) + b->nblocks * BLOOM_BLOCKWORDS * 8;
+}
+
+static inline void
+bloom_set(struct bloom *b, strhash_t hv)
+{
+    uint64_t x = bloom_mix(hv);
+    uint64_t *blk = b->bits + 
+                    ((x >> 32) & (b->nblocks - 1)) * BLOOM_BLOCKWORDS;
+    unsigned pos = x, step = (x >> 9) | 1;
+    int i;
+
+    for (i = 0; i < b->k; i++, pos += step) {
+        unsigned bit = pos & (BLOOM_BLOCKBITS - 1);
+        blk[bit >> 6] |= 1ull << (bit & 63);
+    }
+    ++b->n;
+}
+
+/* bloom_fill() - rebuild `b' from the keys of `h'
+ *
+ * the filter is sized for twice the current number of keys, so that
+ * the table can grow for a while before the next rebuild.
+ */
+void
+bloom_fill(struct bloom *b, GHashTable *h)
+{
+    GHashTableIter it;
+    gpointer key;
+    size_t cap = 2 * g_hash_table_size(h);
+
+    bloom_alloc(b, cap < BLOOM_MINKEYS ? BLOOM_MINKEYS : cap);
+    g_hash_table_iter_init(&it, h);
+    while (g_hash_table_iter_next(&it, &key, NULL)) {
+        bloom_set(b, str_hash_n(key, strlen(key)));
+    }
+    if (bloom_stats_on) ++b->st->nfill;
+}
+
+/* bloom_add() - add the key with hash `hv', just inserted into `h' */
+void
+bloom_add(struct bloom *b, GHashTable *h, strhash_t hv)
+{
+    if (b->n < b->cap) {
+        bloom_set(b, hv);
+    } else {
+        bloom_fill(b, h);
+    }
+}
+
+/* bloom_lookup_stats() - bloom_lookup() with counters
+ *
+ * one in BLOOM_SAMPLE rejected lookups is also sent to the table to
+ * measure what the filter saves (and to check that it was right).
+ */
+gpointer
+bloom_lookup_stats(struct bloom *b, GHashTable *h, strhash_t hv,
+                   const char *s, size_t len)
+{
+    static __thread unsigned nrej = 0;
+    struct bloom_stats *st = b->st;
+    gpointer val;
+
+    __atomic_add_fetch(&st->probes, 1, __ATOMIC_RELAXED);
+    if (!bloom_test(b, hv)) {
+        __atomic_add_fetch(&st->rejected, 1, __ATOMIC_RELAXED);
+        if (++nrej % BLOOM_SAMPLE == 0) {
+            struct timespec t0, t1;
+            double ns;
+
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            val = str_hash_lookup(h, hv, s, len);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            assert(val == NULL);
+            ns = elapsed_ns(&t0, &t1) - clock_ns;
+            __atomic_add_fetch(&st->nsample, 1, __ATOMIC_RELAXED);
+            // a racy add is good enough for an estimate
+            st->sample_ns += (ns > 0) ? ns : 0;
+        }
+        return NULL;
+    }
+    val = str_hash_lookup(h, hv, s, len);
+    if (val == NULL) {
+        __atomic_add_fetch(&st->fpos, 1, __ATOMIC_RELAXED);
+    }
+    return val;
+}
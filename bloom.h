@@ -0,0 +1,121 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _BLOOM_H
+#define _BLOOM_H       1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <glib.h>
+#include "strhash.h"
+
+/*
+ * Blocked Bloom filters that answer `definitely not in the table' for
+ * the spans looked up in a hash table created with str_hash() and
+ * str_equal(). All probes of a key fall into a single 64-byte block,
+ * so a negative answer costs at most one cache miss, instead of a
+ * string hash and a bucket walk in the table.
+ *
+ * The filters are off unless bloom_init() is called with a positive
+ * false positive rate. The filter of an empty or disabled table is
+ * NULL, and bloom_lookup() then falls back to str_hash_lookup().
+ *
+ * The filters are sized from the false positive rate and the number
+ * of keys. The owner adds every key it inserts into the table with
+ * bloom_add(), and rebuilds the filter from the table with 
+ * bloom_fill() after removing keys.
+ */
+
+#define BLOOM_BLOCKBITS 512
+#define BLOOM_BLOCKWORDS (BLOOM_BLOCKBITS / 64)
+
+struct bloom_stats;
+
+struct bloom {
+    uint64_t    *bits;      // nblocks * BLOOM_BLOCKWORDS words
+    size_t      nblocks;    // a power of two
+    int         k;          // bits set per key
+    double      bpk;        // bits per key
+    size_t      n;          // keys added
+    size_t      cap;        // keys the filter was sized for
+    struct bloom_stats *st;
+};
+
+extern double bloom_fpr;
+extern int bloom_stats_on;
+
+void bloom_init(double fpr);
+void bloom_stats_enable();
+void bloom_report();
+
+struct bloom *bloom_new(const char *name);
+void bloom_free(struct bloom *b);
+void bloom_add(struct bloom *b, GHashTable *h, strhash_t hv);
+void bloom_fill(struct bloom *b, GHashTable *h);
+size_t bloom_bytes(struct bloom *b);
+
+gpointer bloom_lookup_stats(struct bloom *b, GHashTable *h, strhash_t hv,
+                            const char *s, size_t len);
+
+static inline uint64_t
+bloom_mix(strhash_t hv)
+{
+    uint64_t x = hv;
+
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+/* bloom_test() - 0 if the key with hash `hv' is not in the filter */
+static inline int
+bloom_test(const struct bloom *b, strhash_t hv)
+{
+    uint64_t x = bloom_mix(hv);
+    const uint64_t *blk = b->bits + 
+                          ((x >> 32) & (b->nblocks - 1)) * BLOOM_BLOCKWORDS;
+    unsigned pos = x, step = (x >> 9) | 1;
+    int i;
+
+    for (i = 0; i < b->k; i++, pos += step) {
+        unsigned bit = pos & (BLOOM_BLOCKBITS - 1);
+        if (!(blk[bit >> 6] & (1ull << (bit & 63)))) return 0;
+    }
+    return 1;
+}
+
+/* bloom_lookup() - str_hash_lookup() behind the filter `b' */
+static inline gpointer
+bloom_lookup(struct bloom *b, GHashTable *h, strhash_t hv, 
+             const char *s, size_t len)
+{
+    if (b == NULL) {
+        return str_hash_lookup(h, hv, s, len);
+    }
+    if (bloom_stats_on) {
+        return bloom_lookup_stats(b, h, hv, s, len);
+    }
+    return bloom_test(b, hv) ? str_hash_lookup(h, hv, s, len) : NULL;
+}
+
+#endif // _BLOOM_H
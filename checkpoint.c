@@ -0,0 +1,268 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "checkpoint.h"
+#include "cclib_debug.h"
+
+#define CKPT_MAGIC      "SEGCKPT"
+#define CKPT_VERSION    1
+#define CKPT_ALIGN(n)   (((n) + 7) & ~(uint64_t) 7)
+
+struct ckpt_hdr {
+    char        magic[8];
+    uint64_t    version;
+};
+
+struct ckpt_rechdr {
+    char        tag[CKPT_TAGLEN];
+    uint64_t    len;
+};
+
+struct ckpt *ckpt_in = NULL;
+
+static char *
+tmpname(const char *fname)
+{
+    char *tmp = malloc(strlen(fname) + 5);
+
+    strcpy(tmp, fname);
+    strcat(tmp, ".tmp");
+    return tmp;
+}
+
+/* ckpt_create() - start writing a checkpoint to `fname' */
+struct ckpt *
+ckpt_create(const char *fname)
+{
+    struct ckpt *ck = calloc(1, sizeof (*ck));
+    struct ckpt_hdr hdr;
+    char *tmp = tmpname(fname);
+
+    ck->fname = strdup(fname);
+    ck->recpos = -1;
+    ck->fp = fopen(tmp, "w");
+    if (ck->fp == NULL) {
+        PERROR("cannot open `%s' for writing\n", tmp);
+        free(tmp);
+        free(ck->fname);
+        free(ck);
+        return NULL;
+    }
+    free(tmp);
+    memset(&hdr, 0, sizeof (hdr));
+    memcpy(hdr.magic, CKPT_MAGIC, sizeof (hdr.magic));
+    hdr.version = CKPT_VERSION;
+    ckpt_put(ck->fp, &hdr, sizeof (hdr));
+    return ck;
+}
+
+/* ckpt_begin() - start the record `tag', the data is written to the 
+ *                returned stream until ckpt_end()
+ */
+FILE *
+ckpt_begin(struct ckpt *ck, const char *tag)
+{
+    struct ckpt_rechdr rh;
+
+    assert(ck->recpos < 0 && strlen(tag) < CKPT_TAGLEN);
+    memset(&rh, 0, sizeof (rh));
+    strcpy(rh.tag, tag);
+    ck->recpos = ftell(ck->fp);
+    ckpt_put(ck->fp, &rh, sizeof (rh));
+    return ck->fp;
+}
+
+void
+ckpt_end(struct ckpt *ck)
+{
+    static const char zero[8];
+    long end = ftell(ck->fp);
+    uint64_t len = end - ck->recpos - sizeof (struct ckpt_rechdr);
+
+    assert(ck->recpos >= 0);
+    ckpt_put(ck->fp, zero, CKPT_ALIGN(len) - len);
+    fseek(ck->fp, ck->recpos + offsetof(struct ckpt_rechdr, len), SEEK_SET);
+    ckpt_put_u64(ck->fp, len);
+    fseek(ck->fp, 0, SEEK_END);
+    ck->recpos = -1;
+}
+
+/* ckpt_commit() - finish the checkpoint, and replace the previous one
+ *
+ * `ck' is freed in any case. on errors the previous checkpoint is left
+ * in place, and -1 is returned.
+ */
+int
+ckpt_commit(struct ckpt *ck)
+{
+    char *tmp = tmpname(ck->fname);
+    int ret = 0;
+
+    assert(ck->recpos < 0);
+    if (ferror(ck->fp) | fclose(ck->fp)) {
+        PERROR("error writing the checkpoint `%s'\n", tmp);
+        unlink(tmp);
+        ret = -1;
+    } else if (rename(tmp, ck->fname)) {
+        PERROR("cannot rename `%s' to `%s'\n", tmp, ck->fname);
+        unlink(tmp);
+        ret = -1;
+    }
+    free(tmp);
+    free(ck->fname);
+    free(ck);
+    return ret;
+}
+
+/* ckpt_open() - read the record index of the checkpoint `fname' */
+struct ckpt *
+ckpt_open(const char *fname)
+{
+    struct ckpt *ck = calloc(1, sizeof (*ck));
+    struct ckpt_hdr hdr;
+    struct ckpt_rechdr rh;
+    size_t nalloc = 0;
+
+    ck->fname = strdup(fname);
+    ck->recpos = -1;
+    ck->fp = fopen(fname, "r");
+    if (ck->fp == NULL) {
+        PERROR("cannot open `%s' for reading\n", fname);
+        ckpt_close(ck);
+        return NULL;
+    }
+    if (fread(&hdr, sizeof (hdr), 1, ck->fp) != 1
+        || memcmp(hdr.magic, CKPT_MAGIC, sizeof (hdr.magic))
+        || hdr.version != CKPT_VERSION) {
+        PERROR("`%s' is not a valid checkpoint\n", fname);
+        ckpt_close(ck);
+        return NULL;
+    }
+    while (fread(&rh, sizeof (rh), 1, ck->fp) == 1) {
+        struct ckpt_rec *r;
+
+        if (ck->nrec == nalloc) {
+            nalloc = (nalloc) ? 2 * nalloc : 16;
+            ck->rec = realloc(ck->rec, nalloc * sizeof (*ck->rec));
+        }
+        r = &ck->rec[ck->nrec++];
+        memcpy(r->tag, rh.tag, CKPT_TAGLEN);
+        r->tag[CKPT_TAGLEN - 1] = '\0';
+        r->off = ftell(ck->fp);
+        r->len = rh.len;
+        if (fseek(ck->fp, CKPT_ALIGN(rh.len), SEEK_CUR)) {
+            PERROR("`%s' is not a valid checkpoint\n", fname);
+            ckpt_close(ck);
+            return NULL;
+        }
+    }
+    return ck;
+}
+
+const struct ckpt_rec *
+ckpt_find(struct ckpt *ck, const char *tag)
+{
+    size_t i;
+
+    for (i = 0; i < ck->nrec; i++) {
+        if (!strcmp(ck->rec[i].tag, tag)) return &ck->rec[i];
+    }
+    return NULL;
+}
+
+/* ckpt_read() - read the data of the record `tag', and set up `b' to
+ *               parse it. the returned buffer should be freed by the
+ *               caller. returns NULL if the record is missing or 
+ *               cannot be read.
+ */
+char *
+ckpt_read(struct ckpt *ck, const char *tag, struct ckpt_buf *b)
+{
+    const struct ckpt_rec *r = ckpt_find(ck, tag);
+    char *data;
+
+    if (r == NULL) {
+        PERROR("checkpoint `%s' has no `%s', the options should be the "
+               "same as the run that wrote it\n", ck->fname, tag);
+        return NULL;
+    }
+    data = malloc(r->len + 1);
+    if (data == NULL || fseek(ck->fp, r->off, SEEK_SET) 
+        || (r->len && fread(data, r->len, 1, ck->fp) != 1)) {
+        PERROR("error reading `%s' from the checkpoint `%s'\n", 
+               tag, ck->fname);
+        free(data);
+        return NULL;
+    }
+    b->p = data;
+    b->end = data + r->len;
+    b->tag = r->tag;
+    b->err = 0;
+    return data;
+}
+
+void
+ckpt_close(struct ckpt *ck)
+{
+    if (ck == NULL) return;
+    if (ck->fp) fclose(ck->fp);
+    free(ck->rec);
+    free(ck->fname);
+    free(ck);
+}
+
+/* ckpt_get() - copy the next `n' bytes of the record to `dst' */
+void
+ckpt_get(struct ckpt_buf *b, void *dst, size_t n)
+{
+    if (n > b->end - b->p) {
+        if (!b->err) PERROR("`%s' of the checkpoint is truncated\n", b->tag);
+        b->err = 1;
+        b->p = b->end;
+        memset(dst, 0, n);
+        return;
+    }
+    memcpy(dst, b->p, n);
+    b->p += n;
+}
+
+/* ckpt_get_str() - the next NUL terminated string of the record, "" 
+ *                  if it is truncated
+ */
+const char *
+ckpt_get_str(struct ckpt_buf *b)
+{
+    const char *s = b->p;
+    const char *nul = memchr(b->p, '\0', b->end - b->p);
+
+    if (nul == NULL) {
+        if (!b->err) PERROR("`%s' of the checkpoint is truncated\n", b->tag);
+        b->err = 1;
+        b->p = b->end;
+        return "";
+    }
+    b->p = nul + 1;
+    return s;
+}
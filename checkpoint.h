@@ -0,0 +1,119 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H       1
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Checkpoints of an incremental run, see --checkpoint-every and
+ * --resume.
+ *
+ * A checkpoint file is a header followed by a sequence of records,
+ * each a tag, the length of the data and the data padded to 8 bytes.
+ * Each structure writes and reads its own record (e.g., 
+ * phonstats_write_bin() and phonstats_read_bin()), the records are
+ * found by their tags when reading. Everything is in host byte order,
+ * a checkpoint is only meant to be resumed on the same machine with 
+ * the same options and input.
+ *
+ * The file is written under a temporary name and renamed at the end,
+ * so an interrupted write leaves the previous checkpoint in place.
+ *
+ * Errors are reported on stderr and returned: ckpt_create(), 
+ * ckpt_open() and ckpt_read() return NULL, ckpt_commit() -1. A read
+ * past the end of a record sets the `err' of its ckpt_buf, and reads 
+ * zeros, the reader checks it once it is done.
+ */
+
+#define CKPT_TAGLEN     16
+
+struct ckpt_rec {
+    char        tag[CKPT_TAGLEN];
+    uint64_t    off;        // of the data, from the start of the file
+    uint64_t    len;
+};
+
+struct ckpt {
+    char            *fname;
+    FILE            *fp;
+    long            recpos;     // the record being written, or -1
+    struct ckpt_rec *rec;       // the records of a checkpoint read
+    size_t          nrec;
+};
+
+/* a read-only view of a record, see ckpt_get() */
+struct ckpt_buf {
+    const char  *p;
+    const char  *end;
+    const char  *tag;
+    int         err;    // a read ran past the end
+};
+
+extern struct ckpt *ckpt_in;    // the checkpoint being resumed, or NULL
+
+struct ckpt *ckpt_create(const char *fname);
+FILE *ckpt_begin(struct ckpt *ck, const char *tag);
+void ckpt_end(struct ckpt *ck);
+int ckpt_commit(struct ckpt *ck);
+
+struct ckpt *ckpt_open(const char *fname);
+const struct ckpt_rec *ckpt_find(struct ckpt *ck, const char *tag);
+char *ckpt_read(struct ckpt *ck, const char *tag, struct ckpt_buf *b);
+void ckpt_close(struct ckpt *ck);
+
+void ckpt_get(struct ckpt_buf *b, void *dst, size_t n);
+const char *ckpt_get_str(struct ckpt_buf *b);
+
+/* ckpt_put() - write `n' bytes of record data, errors are caught
+ *              by ckpt_commit()
+ */
+static inline void
+ckpt_put(FILE *fp, const void *p, size_t n)
+{
+    if (n) fwrite(p, n, 1, fp);
+}
+
+static inline void
+ckpt_put_u64(FILE *fp, uint64_t v)
+{
+    fwrite(&v, sizeof (v), 1, fp);
+}
+
+static inline void
+ckpt_put_str(FILE *fp, const char *s)
+{
+    fwrite(s, strlen(s) + 1, 1, fp);
+}
+
+static inline uint64_t
+ckpt_get_u64(struct ckpt_buf *b)
+{
+    uint64_t v;
+
+    ckpt_get(b, &v, sizeof (v));
+    return v;
+}
+
+#endif // _CHECKPOINT_H
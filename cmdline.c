@@ -42,11 +42,24 @@ const char *gengetopt_args_info_help[] = {
   "      --progress[=INT]          print progress  (default=`100')",
   "  -i, --input=filename          input file name  (default=`br-phono.txt')",
   "      --stress-file=filename     filename to read stress patterns from",
+  "      --symbols=ENUM            what a phoneme is in the input and in the -I\n                                  and -O lexicons: bytes: a byte, utf8: a UTF-8\n                                  character with its combining diacritics,\n                                  tokens: a space separated token. the stress\n                                  file has one byte per phoneme (possible\n                                  values=\"bytes\", \"utf8\", \"tokens\"\n                                  default=`bytes')",
+  "      --word-sep=TOKEN          the token between the words with\n                                  --symbols=tokens  (default=`#')",
   "  -f, --input-format=ENUM       input file format:\n                                   seg: one segmented utterance/word per line\n                                   unseg: one unsegmented utterance/word per\n                                  line\n                                   mc: MorphoChallenge format, <freq,unseg>\n                                  pairs  (possible values=\"seg\", \"unseg\",\n                                  \"mc\" default=`seg')",
   "  -o, --output=filename         output file name  (default=`-')",
   "  -I, --inlex=filename          input lexicon file",
   "  -O, --outlex=filename         output lexicon file  (default=`-')",
   "      --shuffle[=SEED]          randomize the input utternaces. if SEED is not\n                                  given, current time is used as seed\n                                  (default=`-1')",
+  "      --outlex-format=ENUM      format of the output lexicon. binary lexicons\n                                  are loaded much faster, -I recognizes them\n                                  automatically  (possible values=\"text\",\n                                  \"binary\" default=`text')",
+  "      --bloom-fpr=RATE          false positive rate of the Bloom filters in\n                                  front of the lexicon and n-gram lookups, 0\n                                  disables the filters  (default=`0')",
+  "      --bloom-stats             print Bloom filter lookup statistics at exit\n                                  (default=off)",
+  "      --profile=FILE            write per-stage timings and counters to FILE\n                                  at exit, as CSV if FILE ends with .csv, JSON\n                                  otherwise",
+  "      --mem-report[=N]          print the memory held by the model structures\n                                  to stderr at exit, and after every N\n                                  utterances  (default=`1000')",
+  "      --checkpoint-every=N      write a checkpoint after every N utterances\n                                  (only with -m combine)",
+  "      --checkpoint-file=FILE    file name for --checkpoint-every, it is\n                                  replaced atomically  (default=`seg.ckpt')",
+  "      --resume=FILE             continue the run saved in the checkpoint FILE,\n                                  the input and the options should be the same",
+  "      --serve[=SOCKET]          after segmenting the input, segment the\n                                  utterances read line by line from stdin, or\n                                  from the connections to the Unix socket\n                                  SOCKET, and print the stats at exit (only with\n                                  -m combine)  (default=`-')",
+  "      --serve-learn             keep learning from the utterances segmented\n                                  with --serve  (default=off)",
+  "      --serve-batch=N           answer up to N requests that arrive together\n                                  with one write  (default=`1')",
   "\nOptions for printing varios segmentation measures:",
   "  -p, --print                   print predictability measures given in --pred\n                                  and exit  (default=off)",
   "      --print-lb                print word boundary information for each\n                                  measure  (default=off)",
@@ -64,6 +77,18 @@ const char *gengetopt_args_info_help[] = {
   "      --score-edges             include utterance edges in BP/BR calculation\n                                  (default=off)",
   "\nOptions for `lm1' method:",
   "      --alpha=rate              parameter for lm1 segmentation  (default=`0.5')",
+  "      --lm-maxwlen=INT          maximum word length for lm1 segmentation, 0\n                                  for no limit  (default=`0')",
+  "\nOptions for `gibbs' method:",
+  "      --gibbs-model=ENUM        language model for gibbs sampling  (possible\n                                  values=\"unigram\", \"bigram\"\n                                  default=`unigram')",
+  "      --gibbs-iter=INT          number of iterations  (default=`1000')",
+  "      --gibbs-alpha0=DOUBLE     concentration parameter of the unigram DP\n                                  (default=`20.0')",
+  "      --gibbs-alpha1=DOUBLE     concentration parameter of the bigram DPs\n                                  (default=`100.0')",
+  "      --gibbs-pb=DOUBLE         probability of a word boundary in the base\n                                  distribution  (default=`0.5')",
+  "      --gibbs-rho=DOUBLE        prior on utterance boundaries (unigram model)\n                                  (default=`2.0')",
+  "      --gibbs-anneal=INT        number of initial iterations with annealing\n                                  (default=`0')",
+  "      --gibbs-temp=DOUBLE       starting temperature for annealing\n                                  (default=`10.0')",
+  "      --gibbs-threads=INT       number of utterance blocks to sample in\n                                  parallel  (default=`1')",
+  "      --gibbs-seed=INT          seed for the sampler  (default=`1')",
   "\nOptions for predictability based segmentation:",
   "      --pred-m=ENUM             measure(s) to use for predictability based\n                                  segmentation  (possible values=\"jp\",\n                                  \"tp\", \"mi\", \"sv\", \"h\", \"rtp\",\n                                  \"rsv\", \"rh\" default=`tp')",
   "      --pred-norm               normalize the predictability scores\n                                  (default=off)",
@@ -81,6 +106,9 @@ const char *gengetopt_args_info_help[] = {
   "      --random-rate=DOUBLE      rate of boundaries, should be a number between\n                                  0 (no boundaries) an 1 (all boundaries)\n                                  (default=`0.5')",
   "\nOptions for lexicon based segmentation:",
   "      --lexicon-partial[=ENUM]  do partial segmentation  (possible\n                                  values=\"all\", \"one\", \"begin\", \"end\",\n                                  \"beginend\", \"none\" default=`none')",
+  "      --parse-threads=INT       number of threads to use for parsing long\n                                  inputs  (default=`1')",
+  "      --parse-minlen=INT        minimum input length for parsing with multiple\n                                  threads  (default=`64')",
+  "      --max-parses=INT          maximum number of parses to print for an\n                                  input, 0 for no limit  (default=`0')",
   "      --lex-nglen=INT           ngram size for keeping statistics about the\n                                  phonemes in the lexicon  (default=`5')",
   "      --lex-useprior            use utterances in --prior-data as initial\n                                  lexicon statistics  (default=on)",
   "      --lex-minfreq=DOUBLE      frequencey of an ngram to qualify as a word\n                                  (default=`0.0')",
@@ -104,7 +132,7 @@ const char *gengetopt_args_info_help[] = {
   "      --sub-ngmin=INT           minimum ngram length for stress (otherwise\n                                  inherited from ub-ngmin)  (default=`2')",
   "      --sub-ngmax=INT           maximum ngram length for stress (otherwise\n                                  inherited from ub-ngmax)  (default=`2')",
   "\nGeneral options for segmentation:",
-  "  -m, --method=ENUM             segmentation method(s), some can be combined\n                                  (possible values=\"lexicon\", \"lm\",\n                                  \"random\", \"pred\", \"ub\", \"lexc\",\n                                  \"nv\", \"combine\" default=`combine')",
+  "  -m, --method=ENUM             segmentation method(s), some can be combined\n                                  (possible values=\"lexicon\", \"lm\",\n                                  \"random\", \"pred\", \"ub\", \"lexc\",\n                                  \"nv\", \"combine\", \"mbdp\", \"gibbs\"\n                                  default=`combine')",
   "  -c, --cues=ENUM               list of cues to combine  (possible\n                                  values=\"pred\", \"phon\", \"stress\",\n                                  \"lex\" default=`pred')",
   "      --cue-source=ENUM         default source for all cues  (possible\n                                  values=\"utterances\", \"segments\",\n                                  \"lexicon\" default=`utterances')",
   "      --psb-cheat               update statistics for source=segm first from\n                                  the utterances, and later when boundaries are\n                                  decided  (default=off)",
@@ -119,6 +147,7 @@ const char *gengetopt_args_info_help[] = {
   "      --threshold=th            threshold to use for deciding boundaries\n                                  (default=`0.0')",
   "      --norm=method             normalize the measures with given method before\n                                  using  (possible values=\"none\", \"zscore\",\n                                  \"mdiff\", \"mdivide\" default=`none')",
   "      --vote=ENUM               what to return as vote  (possible\n                                  values=\"binary\", \"diff\", \"lgdiff\"\n                                  default=`binary')",
+  "      --vote-kernel=ENUM        vectorized kernels for peaks and votes, all\n                                  give the same results  (possible\n                                  values=\"auto\", \"avx2\", \"sse2\",\n                                  \"scalar\" default=`auto')",
   "      --prior-data[=filename]   filename to build prior statistics from, if\n                                  filename is not specified, the statistics are\n                                  calculated on the first pass on the input\n                                  file.  (default=`input')",
   "For filename arguments `-' means stdin or stdout",
     0
@@ -156,7 +185,7 @@ const char *cmdline_parser_lex_values[] = {"lc", "lf", "lp", 0}; /*< Possible va
 const char *cmdline_parser_lex_dir_values[] = {"lr", "rl", "both", 0}; /*< Possible values for lex-dir. */
 const char *cmdline_parser_stress_values[] = {"ub", "transition", "cheat", "sylcheat", 0}; /*< Possible values for stress. */
 const char *cmdline_parser_ub_type_values[] = {"ubegin", "uend", "both", 0}; /*< Possible values for ub-type. */
-const char *cmdline_parser_method_values[] = {"lexicon", "lm", "random", "pred", "ub", "lexc", "nv", "combine", 0}; /*< Possible values for method. */
+const char *cmdline_parser_method_values[] = {"lexicon", "lm", "random", "pred", "ub", "lexc", "nv", "combine", "mbdp", "gibbs", 0}; /*< Possible values for method. */
 const char *cmdline_parser_cues_values[] = {"pred", "phon", "stress", "lex", 0}; /*< Possible values for cues. */
 const char *cmdline_parser_cue_source_values[] = {"utterances", "segments", "lexicon", 0}; /*< Possible values for cue-source. */
 const char *cmdline_parser_pred_source_values[] = {"utterances", "segments", "lexicon", 0}; /*< Possible values for pred-source. */
@@ -168,6 +197,10 @@ const char *cmdline_parser_boundary_method_values[] = {"peak", "threshold", "non
 const char *cmdline_parser_peak_values[] = {"strict", "relaxed", "dual", "right", "left", "lr", "strict2", 0}; /*< Possible values for peak. */
 const char *cmdline_parser_norm_values[] = {"none", "zscore", "mdiff", "mdivide", 0}; /*< Possible values for norm. */
 const char *cmdline_parser_vote_values[] = {"binary", "diff", "lgdiff", 0}; /*< Possible values for vote. */
+const char *cmdline_parser_gibbs_model_values[] = {"unigram", "bigram", 0}; /*< Possible values for gibbs-model. */
+const char *cmdline_parser_outlex_format_values[] = {"text", "binary", 0}; /*< Possible values for outlex-format. */
+const char *cmdline_parser_vote_kernel_values[] = {"auto", "avx2", "sse2", "scalar", 0}; /*< Possible values for vote-kernel. */
+const char *cmdline_parser_symbols_values[] = {"bytes", "utf8", "tokens", 0}; /*< Possible values for symbols. */
 
 static char *
 gengetopt_strdup (const char *s);
@@ -183,11 +216,24 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->progress_given = 0 ;
   args_info->input_given = 0 ;
   args_info->stress_file_given = 0 ;
+  args_info->symbols_given = 0 ;
+  args_info->word_sep_given = 0 ;
   args_info->input_format_given = 0 ;
   args_info->output_given = 0 ;
   args_info->inlex_given = 0 ;
   args_info->outlex_given = 0 ;
   args_info->shuffle_given = 0 ;
+  args_info->outlex_format_given = 0 ;
+  args_info->bloom_fpr_given = 0 ;
+  args_info->bloom_stats_given = 0 ;
+  args_info->profile_given = 0 ;
+  args_info->mem_report_given = 0 ;
+  args_info->checkpoint_every_given = 0 ;
+  args_info->checkpoint_file_given = 0 ;
+  args_info->resume_given = 0 ;
+  args_info->serve_given = 0 ;
+  args_info->serve_learn_given = 0 ;
+  args_info->serve_batch_given = 0 ;
   args_info->print_given = 0 ;
   args_info->print_lb_given = 0 ;
   args_info->print_ub_given = 0 ;
@@ -203,6 +249,17 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->score_given = 0 ;
   args_info->score_edges_given = 0 ;
   args_info->alpha_given = 0 ;
+  args_info->lm_maxwlen_given = 0 ;
+  args_info->gibbs_model_given = 0 ;
+  args_info->gibbs_iter_given = 0 ;
+  args_info->gibbs_alpha0_given = 0 ;
+  args_info->gibbs_alpha1_given = 0 ;
+  args_info->gibbs_pb_given = 0 ;
+  args_info->gibbs_rho_given = 0 ;
+  args_info->gibbs_anneal_given = 0 ;
+  args_info->gibbs_temp_given = 0 ;
+  args_info->gibbs_threads_given = 0 ;
+  args_info->gibbs_seed_given = 0 ;
   args_info->pred_m_given = 0 ;
   args_info->pred_norm_given = 0 ;
   args_info->pred_xlen_given = 0 ;
@@ -217,6 +274,9 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->random_seed_given = 0 ;
   args_info->random_rate_given = 0 ;
   args_info->lexicon_partial_given = 0 ;
+  args_info->parse_threads_given = 0 ;
+  args_info->parse_minlen_given = 0 ;
+  args_info->max_parses_given = 0 ;
   args_info->lex_nglen_given = 0 ;
   args_info->lex_useprior_given = 0 ;
   args_info->lex_minfreq_given = 0 ;
@@ -252,6 +312,7 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->threshold_given = 0 ;
   args_info->norm_given = 0 ;
   args_info->vote_given = 0 ;
+  args_info->vote_kernel_given = 0 ;
   args_info->prior_data_given = 0 ;
 }
 
@@ -269,6 +330,10 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->input_orig = NULL;
   args_info->stress_file_arg = NULL;
   args_info->stress_file_orig = NULL;
+  args_info->symbols_arg = symbols_arg_bytes;
+  args_info->symbols_orig = NULL;
+  args_info->word_sep_arg = gengetopt_strdup ("#");
+  args_info->word_sep_orig = NULL;
   args_info->input_format_arg = input_format_arg_seg;
   args_info->input_format_orig = NULL;
   args_info->output_arg = gengetopt_strdup ("-");
@@ -279,6 +344,25 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->outlex_orig = NULL;
   args_info->shuffle_arg = -1;
   args_info->shuffle_orig = NULL;
+  args_info->outlex_format_arg = outlex_format_arg_text;
+  args_info->outlex_format_orig = NULL;
+  args_info->bloom_fpr_arg = 0;
+  args_info->bloom_fpr_orig = NULL;
+  args_info->bloom_stats_flag = 0;
+  args_info->profile_arg = NULL;
+  args_info->profile_orig = NULL;
+  args_info->mem_report_arg = 1000;
+  args_info->mem_report_orig = NULL;
+  args_info->checkpoint_every_orig = NULL;
+  args_info->checkpoint_file_arg = gengetopt_strdup ("seg.ckpt");
+  args_info->checkpoint_file_orig = NULL;
+  args_info->resume_arg = NULL;
+  args_info->resume_orig = NULL;
+  args_info->serve_arg = gengetopt_strdup ("-");
+  args_info->serve_orig = NULL;
+  args_info->serve_learn_flag = 0;
+  args_info->serve_batch_arg = 1;
+  args_info->serve_batch_orig = NULL;
   args_info->print_flag = 0;
   args_info->print_lb_flag = 0;
   args_info->print_ub_flag = 0;
@@ -299,6 +383,28 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->score_edges_flag = 0;
   args_info->alpha_arg = 0.5;
   args_info->alpha_orig = NULL;
+  args_info->lm_maxwlen_arg = 0;
+  args_info->lm_maxwlen_orig = NULL;
+  args_info->gibbs_model_arg = gibbs_model_arg_unigram;
+  args_info->gibbs_model_orig = NULL;
+  args_info->gibbs_iter_arg = 1000;
+  args_info->gibbs_iter_orig = NULL;
+  args_info->gibbs_alpha0_arg = 20.0;
+  args_info->gibbs_alpha0_orig = NULL;
+  args_info->gibbs_alpha1_arg = 100.0;
+  args_info->gibbs_alpha1_orig = NULL;
+  args_info->gibbs_pb_arg = 0.5;
+  args_info->gibbs_pb_orig = NULL;
+  args_info->gibbs_rho_arg = 2.0;
+  args_info->gibbs_rho_orig = NULL;
+  args_info->gibbs_anneal_arg = 0;
+  args_info->gibbs_anneal_orig = NULL;
+  args_info->gibbs_temp_arg = 10.0;
+  args_info->gibbs_temp_orig = NULL;
+  args_info->gibbs_threads_arg = 1;
+  args_info->gibbs_threads_orig = NULL;
+  args_info->gibbs_seed_arg = 1;
+  args_info->gibbs_seed_orig = NULL;
   args_info->pred_m_arg = NULL;
   args_info->pred_m_orig = NULL;
   args_info->pred_norm_flag = 0;
@@ -322,6 +428,12 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->random_rate_orig = NULL;
   args_info->lexicon_partial_arg = lexicon_partial_arg_none;
   args_info->lexicon_partial_orig = NULL;
+  args_info->parse_threads_arg = 1;
+  args_info->parse_threads_orig = NULL;
+  args_info->parse_minlen_arg = 64;
+  args_info->parse_minlen_orig = NULL;
+  args_info->max_parses_arg = 0;
+  args_info->max_parses_orig = NULL;
   args_info->lex_nglen_arg = 5;
   args_info->lex_nglen_orig = NULL;
   args_info->lex_useprior_flag = 1;
@@ -390,6 +502,8 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->norm_orig = NULL;
   args_info->vote_arg = vote_arg_binary;
   args_info->vote_orig = NULL;
+  args_info->vote_kernel_arg = vote_kernel_arg_auto;
+  args_info->vote_kernel_orig = NULL;
   args_info->prior_data_arg = gengetopt_strdup ("input");
   args_info->prior_data_orig = NULL;
   
@@ -408,84 +522,112 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->progress_help = gengetopt_args_info_help[5] ;
   args_info->input_help = gengetopt_args_info_help[6] ;
   args_info->stress_file_help = gengetopt_args_info_help[7] ;
-  args_info->input_format_help = gengetopt_args_info_help[8] ;
-  args_info->output_help = gengetopt_args_info_help[9] ;
-  args_info->inlex_help = gengetopt_args_info_help[10] ;
-  args_info->outlex_help = gengetopt_args_info_help[11] ;
-  args_info->shuffle_help = gengetopt_args_info_help[12] ;
-  args_info->print_help = gengetopt_args_info_help[14] ;
-  args_info->print_lb_help = gengetopt_args_info_help[15] ;
-  args_info->print_ub_help = gengetopt_args_info_help[16] ;
-  args_info->print_header_help = gengetopt_args_info_help[17] ;
-  args_info->print_ph_help = gengetopt_args_info_help[18] ;
-  args_info->print_unum_help = gengetopt_args_info_help[19] ;
-  args_info->print_phng_help = gengetopt_args_info_help[20] ;
-  args_info->print_ptp_help = gengetopt_args_info_help[21] ;
+  args_info->symbols_help = gengetopt_args_info_help[8] ;
+  args_info->word_sep_help = gengetopt_args_info_help[9] ;
+  args_info->input_format_help = gengetopt_args_info_help[10] ;
+  args_info->output_help = gengetopt_args_info_help[11] ;
+  args_info->inlex_help = gengetopt_args_info_help[12] ;
+  args_info->outlex_help = gengetopt_args_info_help[13] ;
+  args_info->shuffle_help = gengetopt_args_info_help[14] ;
+  args_info->outlex_format_help = gengetopt_args_info_help[15] ;
+  args_info->bloom_fpr_help = gengetopt_args_info_help[16] ;
+  args_info->bloom_stats_help = gengetopt_args_info_help[17] ;
+  args_info->profile_help = gengetopt_args_info_help[18] ;
+  args_info->mem_report_help = gengetopt_args_info_help[19] ;
+  args_info->checkpoint_every_help = gengetopt_args_info_help[20] ;
+  args_info->checkpoint_file_help = gengetopt_args_info_help[21] ;
+  args_info->resume_help = gengetopt_args_info_help[22] ;
+  args_info->serve_help = gengetopt_args_info_help[23] ;
+  args_info->serve_learn_help = gengetopt_args_info_help[24] ;
+  args_info->serve_batch_help = gengetopt_args_info_help[25] ;
+  args_info->print_help = gengetopt_args_info_help[27] ;
+  args_info->print_lb_help = gengetopt_args_info_help[28] ;
+  args_info->print_ub_help = gengetopt_args_info_help[29] ;
+  args_info->print_header_help = gengetopt_args_info_help[30] ;
+  args_info->print_ph_help = gengetopt_args_info_help[31] ;
+  args_info->print_unum_help = gengetopt_args_info_help[32] ;
+  args_info->print_phng_help = gengetopt_args_info_help[33] ;
+  args_info->print_ptp_help = gengetopt_args_info_help[34] ;
   args_info->print_ptp_min = 0;
   args_info->print_ptp_max = 0;
-  args_info->print_wfreq_help = gengetopt_args_info_help[22] ;
-  args_info->print_wfreq_sum_help = gengetopt_args_info_help[23] ;
-  args_info->print_latex_help = gengetopt_args_info_help[24] ;
-  args_info->print_prf_help = gengetopt_args_info_help[25] ;
-  args_info->score_help = gengetopt_args_info_help[26] ;
-  args_info->score_edges_help = gengetopt_args_info_help[27] ;
-  args_info->alpha_help = gengetopt_args_info_help[29] ;
-  args_info->pred_m_help = gengetopt_args_info_help[31] ;
+  args_info->print_wfreq_help = gengetopt_args_info_help[35] ;
+  args_info->print_wfreq_sum_help = gengetopt_args_info_help[36] ;
+  args_info->print_latex_help = gengetopt_args_info_help[37] ;
+  args_info->print_prf_help = gengetopt_args_info_help[38] ;
+  args_info->score_help = gengetopt_args_info_help[39] ;
+  args_info->score_edges_help = gengetopt_args_info_help[40] ;
+  args_info->alpha_help = gengetopt_args_info_help[42] ;
+  args_info->lm_maxwlen_help = gengetopt_args_info_help[43] ;
+  args_info->gibbs_model_help = gengetopt_args_info_help[45] ;
+  args_info->gibbs_iter_help = gengetopt_args_info_help[46] ;
+  args_info->gibbs_alpha0_help = gengetopt_args_info_help[47] ;
+  args_info->gibbs_alpha1_help = gengetopt_args_info_help[48] ;
+  args_info->gibbs_pb_help = gengetopt_args_info_help[49] ;
+  args_info->gibbs_rho_help = gengetopt_args_info_help[50] ;
+  args_info->gibbs_anneal_help = gengetopt_args_info_help[51] ;
+  args_info->gibbs_temp_help = gengetopt_args_info_help[52] ;
+  args_info->gibbs_threads_help = gengetopt_args_info_help[53] ;
+  args_info->gibbs_seed_help = gengetopt_args_info_help[54] ;
+  args_info->pred_m_help = gengetopt_args_info_help[56] ;
   args_info->pred_m_min = 0;
   args_info->pred_m_max = 0;
-  args_info->pred_norm_help = gengetopt_args_info_help[32] ;
-  args_info->pred_xlen_help = gengetopt_args_info_help[33] ;
-  args_info->pred_ylen_help = gengetopt_args_info_help[34] ;
-  args_info->pred_xmax_help = gengetopt_args_info_help[35] ;
-  args_info->pred_ymax_help = gengetopt_args_info_help[36] ;
-  args_info->pred_xmin_help = gengetopt_args_info_help[37] ;
-  args_info->pred_ymin_help = gengetopt_args_info_help[38] ;
-  args_info->pred_printw_help = gengetopt_args_info_help[39] ;
-  args_info->pred_printoptions_help = gengetopt_args_info_help[40] ;
-  args_info->pred_swaplr_help = gengetopt_args_info_help[41] ;
-  args_info->random_seed_help = gengetopt_args_info_help[43] ;
-  args_info->random_rate_help = gengetopt_args_info_help[44] ;
-  args_info->lexicon_partial_help = gengetopt_args_info_help[46] ;
-  args_info->lex_nglen_help = gengetopt_args_info_help[47] ;
-  args_info->lex_useprior_help = gengetopt_args_info_help[48] ;
-  args_info->lex_minfreq_help = gengetopt_args_info_help[49] ;
-  args_info->lex_minent_help = gengetopt_args_info_help[50] ;
-  args_info->lex_mult_help = gengetopt_args_info_help[51] ;
-  args_info->lex_wcombine_help = gengetopt_args_info_help[52] ;
-  args_info->lex_norm_help = gengetopt_args_info_help[53] ;
-  args_info->lex_help = gengetopt_args_info_help[54] ;
+  args_info->pred_norm_help = gengetopt_args_info_help[57] ;
+  args_info->pred_xlen_help = gengetopt_args_info_help[58] ;
+  args_info->pred_ylen_help = gengetopt_args_info_help[59] ;
+  args_info->pred_xmax_help = gengetopt_args_info_help[60] ;
+  args_info->pred_ymax_help = gengetopt_args_info_help[61] ;
+  args_info->pred_xmin_help = gengetopt_args_info_help[62] ;
+  args_info->pred_ymin_help = gengetopt_args_info_help[63] ;
+  args_info->pred_printw_help = gengetopt_args_info_help[64] ;
+  args_info->pred_printoptions_help = gengetopt_args_info_help[65] ;
+  args_info->pred_swaplr_help = gengetopt_args_info_help[66] ;
+  args_info->random_seed_help = gengetopt_args_info_help[68] ;
+  args_info->random_rate_help = gengetopt_args_info_help[69] ;
+  args_info->lexicon_partial_help = gengetopt_args_info_help[71] ;
+  args_info->parse_threads_help = gengetopt_args_info_help[72] ;
+  args_info->parse_minlen_help = gengetopt_args_info_help[73] ;
+  args_info->max_parses_help = gengetopt_args_info_help[74] ;
+  args_info->lex_nglen_help = gengetopt_args_info_help[75] ;
+  args_info->lex_useprior_help = gengetopt_args_info_help[76] ;
+  args_info->lex_minfreq_help = gengetopt_args_info_help[77] ;
+  args_info->lex_minent_help = gengetopt_args_info_help[78] ;
+  args_info->lex_mult_help = gengetopt_args_info_help[79] ;
+  args_info->lex_wcombine_help = gengetopt_args_info_help[80] ;
+  args_info->lex_norm_help = gengetopt_args_info_help[81] ;
+  args_info->lex_help = gengetopt_args_info_help[82] ;
   args_info->lex_min = 0;
   args_info->lex_max = 0;
-  args_info->lex_dir_help = gengetopt_args_info_help[55] ;
-  args_info->stress_help = gengetopt_args_info_help[57] ;
-  args_info->ub_nglen_help = gengetopt_args_info_help[59] ;
-  args_info->ub_ngmin_help = gengetopt_args_info_help[60] ;
-  args_info->ub_ngmax_help = gengetopt_args_info_help[61] ;
-  args_info->ub_lmin_help = gengetopt_args_info_help[62] ;
-  args_info->ub_lmax_help = gengetopt_args_info_help[63] ;
-  args_info->ub_rmin_help = gengetopt_args_info_help[64] ;
-  args_info->ub_rmax_help = gengetopt_args_info_help[65] ;
-  args_info->ub_type_help = gengetopt_args_info_help[66] ;
-  args_info->sub_ngmin_help = gengetopt_args_info_help[67] ;
-  args_info->sub_ngmax_help = gengetopt_args_info_help[68] ;
-  args_info->method_help = gengetopt_args_info_help[70] ;
-  args_info->cues_help = gengetopt_args_info_help[71] ;
+  args_info->lex_dir_help = gengetopt_args_info_help[83] ;
+  args_info->stress_help = gengetopt_args_info_help[85] ;
+  args_info->ub_nglen_help = gengetopt_args_info_help[87] ;
+  args_info->ub_ngmin_help = gengetopt_args_info_help[88] ;
+  args_info->ub_ngmax_help = gengetopt_args_info_help[89] ;
+  args_info->ub_lmin_help = gengetopt_args_info_help[90] ;
+  args_info->ub_lmax_help = gengetopt_args_info_help[91] ;
+  args_info->ub_rmin_help = gengetopt_args_info_help[92] ;
+  args_info->ub_rmax_help = gengetopt_args_info_help[93] ;
+  args_info->ub_type_help = gengetopt_args_info_help[94] ;
+  args_info->sub_ngmin_help = gengetopt_args_info_help[95] ;
+  args_info->sub_ngmax_help = gengetopt_args_info_help[96] ;
+  args_info->method_help = gengetopt_args_info_help[98] ;
+  args_info->cues_help = gengetopt_args_info_help[99] ;
   args_info->cues_min = 0;
   args_info->cues_max = 0;
-  args_info->cue_source_help = gengetopt_args_info_help[72] ;
-  args_info->psb_cheat_help = gengetopt_args_info_help[73] ;
-  args_info->pred_source_help = gengetopt_args_info_help[74] ;
-  args_info->phon_source_help = gengetopt_args_info_help[75] ;
-  args_info->stress_source_help = gengetopt_args_info_help[76] ;
-  args_info->lex_source_help = gengetopt_args_info_help[77] ;
-  args_info->combine_help = gengetopt_args_info_help[78] ;
-  args_info->combine_rate_help = gengetopt_args_info_help[79] ;
-  args_info->boundary_method_help = gengetopt_args_info_help[80] ;
-  args_info->peak_help = gengetopt_args_info_help[81] ;
-  args_info->threshold_help = gengetopt_args_info_help[82] ;
-  args_info->norm_help = gengetopt_args_info_help[83] ;
-  args_info->vote_help = gengetopt_args_info_help[84] ;
-  args_info->prior_data_help = gengetopt_args_info_help[85] ;
+  args_info->cue_source_help = gengetopt_args_info_help[100] ;
+  args_info->psb_cheat_help = gengetopt_args_info_help[101] ;
+  args_info->pred_source_help = gengetopt_args_info_help[102] ;
+  args_info->phon_source_help = gengetopt_args_info_help[103] ;
+  args_info->stress_source_help = gengetopt_args_info_help[104] ;
+  args_info->lex_source_help = gengetopt_args_info_help[105] ;
+  args_info->combine_help = gengetopt_args_info_help[106] ;
+  args_info->combine_rate_help = gengetopt_args_info_help[107] ;
+  args_info->boundary_method_help = gengetopt_args_info_help[108] ;
+  args_info->peak_help = gengetopt_args_info_help[109] ;
+  args_info->threshold_help = gengetopt_args_info_help[110] ;
+  args_info->norm_help = gengetopt_args_info_help[111] ;
+  args_info->vote_help = gengetopt_args_info_help[112] ;
+  args_info->vote_kernel_help = gengetopt_args_info_help[113] ;
+  args_info->prior_data_help = gengetopt_args_info_help[114] ;
   
 }
 
@@ -622,6 +764,9 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->input_orig));
   free_string_field (&(args_info->stress_file_arg));
   free_string_field (&(args_info->stress_file_orig));
+  free_string_field (&(args_info->symbols_orig));
+  free_string_field (&(args_info->word_sep_arg));
+  free_string_field (&(args_info->word_sep_orig));
   free_string_field (&(args_info->input_format_orig));
   free_string_field (&(args_info->output_arg));
   free_string_field (&(args_info->output_orig));
@@ -630,12 +775,36 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->outlex_arg));
   free_string_field (&(args_info->outlex_orig));
   free_string_field (&(args_info->shuffle_orig));
+  free_string_field (&(args_info->outlex_format_orig));
+  free_string_field (&(args_info->bloom_fpr_orig));
   free_multiple_field (args_info->print_ptp_given, (void *)(args_info->print_ptp_arg), &(args_info->print_ptp_orig));
   args_info->print_ptp_arg = 0;
+  free_string_field (&(args_info->profile_arg));
+  free_string_field (&(args_info->profile_orig));
+  free_string_field (&(args_info->mem_report_orig));
+  free_string_field (&(args_info->checkpoint_every_orig));
+  free_string_field (&(args_info->checkpoint_file_arg));
+  free_string_field (&(args_info->checkpoint_file_orig));
+  free_string_field (&(args_info->resume_arg));
+  free_string_field (&(args_info->resume_orig));
+  free_string_field (&(args_info->serve_arg));
+  free_string_field (&(args_info->serve_orig));
+  free_string_field (&(args_info->serve_batch_orig));
   free_string_field (&(args_info->print_wfreq_orig));
   free_string_field (&(args_info->print_prf_orig));
   free_string_field (&(args_info->score_orig));
   free_string_field (&(args_info->alpha_orig));
+  free_string_field (&(args_info->lm_maxwlen_orig));
+  free_string_field (&(args_info->gibbs_model_orig));
+  free_string_field (&(args_info->gibbs_iter_orig));
+  free_string_field (&(args_info->gibbs_alpha0_orig));
+  free_string_field (&(args_info->gibbs_alpha1_orig));
+  free_string_field (&(args_info->gibbs_pb_orig));
+  free_string_field (&(args_info->gibbs_rho_orig));
+  free_string_field (&(args_info->gibbs_anneal_orig));
+  free_string_field (&(args_info->gibbs_temp_orig));
+  free_string_field (&(args_info->gibbs_threads_orig));
+  free_string_field (&(args_info->gibbs_seed_orig));
   free_multiple_field (args_info->pred_m_given, (void *)(args_info->pred_m_arg), &(args_info->pred_m_orig));
   args_info->pred_m_arg = 0;
   free_string_field (&(args_info->pred_xlen_orig));
@@ -647,6 +816,9 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->random_seed_orig));
   free_string_field (&(args_info->random_rate_orig));
   free_string_field (&(args_info->lexicon_partial_orig));
+  free_string_field (&(args_info->parse_threads_orig));
+  free_string_field (&(args_info->parse_minlen_orig));
+  free_string_field (&(args_info->max_parses_orig));
   free_string_field (&(args_info->lex_nglen_orig));
   free_string_field (&(args_info->lex_minfreq_orig));
   free_string_field (&(args_info->lex_minent_orig));
@@ -682,6 +854,7 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
   free_string_field (&(args_info->threshold_orig));
   free_string_field (&(args_info->norm_orig));
   free_string_field (&(args_info->vote_orig));
+  free_string_field (&(args_info->vote_kernel_orig));
   free_string_field (&(args_info->prior_data_arg));
   free_string_field (&(args_info->prior_data_orig));
   
@@ -779,6 +952,10 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "input", args_info->input_orig, 0);
   if (args_info->stress_file_given)
     write_into_file(outfile, "stress-file", args_info->stress_file_orig, 0);
+  if (args_info->symbols_given)
+    write_into_file(outfile, "symbols", args_info->symbols_orig, cmdline_parser_symbols_values);
+  if (args_info->word_sep_given)
+    write_into_file(outfile, "word-sep", args_info->word_sep_orig, 0);
   if (args_info->input_format_given)
     write_into_file(outfile, "input-format", args_info->input_format_orig, cmdline_parser_input_format_values);
   if (args_info->output_given)
@@ -789,6 +966,28 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "outlex", args_info->outlex_orig, 0);
   if (args_info->shuffle_given)
     write_into_file(outfile, "shuffle", args_info->shuffle_orig, 0);
+  if (args_info->outlex_format_given)
+    write_into_file(outfile, "outlex-format", args_info->outlex_format_orig, cmdline_parser_outlex_format_values);
+  if (args_info->bloom_fpr_given)
+    write_into_file(outfile, "bloom-fpr", args_info->bloom_fpr_orig, 0);
+  if (args_info->bloom_stats_given)
+    write_into_file(outfile, "bloom-stats", 0, 0 );
+  if (args_info->profile_given)
+    write_into_file(outfile, "profile", args_info->profile_orig, 0);
+  if (args_info->mem_report_given)
+    write_into_file(outfile, "mem-report", args_info->mem_report_orig, 0);
+  if (args_info->checkpoint_every_given)
+    write_into_file(outfile, "checkpoint-every", args_info->checkpoint_every_orig, 0);
+  if (args_info->checkpoint_file_given)
+    write_into_file(outfile, "checkpoint-file", args_info->checkpoint_file_orig, 0);
+  if (args_info->resume_given)
+    write_into_file(outfile, "resume", args_info->resume_orig, 0);
+  if (args_info->serve_given)
+    write_into_file(outfile, "serve", args_info->serve_orig, 0);
+  if (args_info->serve_learn_given)
+    write_into_file(outfile, "serve-learn", 0, 0 );
+  if (args_info->serve_batch_given)
+    write_into_file(outfile, "serve-batch", args_info->serve_batch_orig, 0);
   if (args_info->print_given)
     write_into_file(outfile, "print", 0, 0 );
   if (args_info->print_lb_given)
@@ -818,6 +1017,28 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "score-edges", 0, 0 );
   if (args_info->alpha_given)
     write_into_file(outfile, "alpha", args_info->alpha_orig, 0);
+  if (args_info->lm_maxwlen_given)
+    write_into_file(outfile, "lm-maxwlen", args_info->lm_maxwlen_orig, 0);
+  if (args_info->gibbs_model_given)
+    write_into_file(outfile, "gibbs-model", args_info->gibbs_model_orig, cmdline_parser_gibbs_model_values);
+  if (args_info->gibbs_iter_given)
+    write_into_file(outfile, "gibbs-iter", args_info->gibbs_iter_orig, 0);
+  if (args_info->gibbs_alpha0_given)
+    write_into_file(outfile, "gibbs-alpha0", args_info->gibbs_alpha0_orig, 0);
+  if (args_info->gibbs_alpha1_given)
+    write_into_file(outfile, "gibbs-alpha1", args_info->gibbs_alpha1_orig, 0);
+  if (args_info->gibbs_pb_given)
+    write_into_file(outfile, "gibbs-pb", args_info->gibbs_pb_orig, 0);
+  if (args_info->gibbs_rho_given)
+    write_into_file(outfile, "gibbs-rho", args_info->gibbs_rho_orig, 0);
+  if (args_info->gibbs_anneal_given)
+    write_into_file(outfile, "gibbs-anneal", args_info->gibbs_anneal_orig, 0);
+  if (args_info->gibbs_temp_given)
+    write_into_file(outfile, "gibbs-temp", args_info->gibbs_temp_orig, 0);
+  if (args_info->gibbs_threads_given)
+    write_into_file(outfile, "gibbs-threads", args_info->gibbs_threads_orig, 0);
+  if (args_info->gibbs_seed_given)
+    write_into_file(outfile, "gibbs-seed", args_info->gibbs_seed_orig, 0);
   write_multiple_into_file(outfile, args_info->pred_m_given, "pred-m", args_info->pred_m_orig, cmdline_parser_pred_m_values);
   if (args_info->pred_norm_given)
     write_into_file(outfile, "pred-norm", 0, 0 );
@@ -845,6 +1066,12 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "random-rate", args_info->random_rate_orig, 0);
   if (args_info->lexicon_partial_given)
     write_into_file(outfile, "lexicon-partial", args_info->lexicon_partial_orig, cmdline_parser_lexicon_partial_values);
+  if (args_info->parse_threads_given)
+    write_into_file(outfile, "parse-threads", args_info->parse_threads_orig, 0);
+  if (args_info->parse_minlen_given)
+    write_into_file(outfile, "parse-minlen", args_info->parse_minlen_orig, 0);
+  if (args_info->max_parses_given)
+    write_into_file(outfile, "max-parses", args_info->max_parses_orig, 0);
   if (args_info->lex_nglen_given)
     write_into_file(outfile, "lex-nglen", args_info->lex_nglen_orig, 0);
   if (args_info->lex_useprior_given)
@@ -913,6 +1140,8 @@ cmdline_parser_dump(FILE *outfile, struct gengetopt_args_info *args_info)
     write_into_file(outfile, "norm", args_info->norm_orig, cmdline_parser_norm_values);
   if (args_info->vote_given)
     write_into_file(outfile, "vote", args_info->vote_orig, cmdline_parser_vote_values);
+  if (args_info->vote_kernel_given)
+    write_into_file(outfile, "vote-kernel", args_info->vote_kernel_orig, cmdline_parser_vote_kernel_values);
   if (args_info->prior_data_given)
     write_into_file(outfile, "prior-data", args_info->prior_data_orig, 0);
   
@@ -1110,12 +1339,6 @@ cmdline_parser_ext (int argc, char **argv, struct gengetopt_args_info *args_info
   int result;
   result = cmdline_parser_internal (argc, argv, args_info, params, 0);
 
-  if (result == EXIT_FAILURE)
-    {
-      cmdline_parser_free (args_info);
-      exit (EXIT_FAILURE);
-    }
-  
   return result;
 }
 
@@ -1133,12 +1356,6 @@ cmdline_parser2 (int argc, char **argv, struct gengetopt_args_info *args_info, i
 
   result = cmdline_parser_internal (argc, argv, args_info, &params, 0);
 
-  if (result == EXIT_FAILURE)
-    {
-      cmdline_parser_free (args_info);
-      exit (EXIT_FAILURE);
-    }
-  
   return result;
 }
 
@@ -1150,12 +1367,6 @@ cmdline_parser_required (struct gengetopt_args_info *args_info, const char *prog
   if (cmdline_parser_required2(args_info, prog_name, 0) > 0)
     result = EXIT_FAILURE;
 
-  if (result == EXIT_FAILURE)
-    {
-      cmdline_parser_free (args_info);
-      exit (EXIT_FAILURE);
-    }
-  
   return result;
 }
 
@@ -1528,11 +1739,24 @@ cmdline_parser_internal (
         { "progress",	2, NULL, 0 },
         { "input",	1, NULL, 'i' },
         { "stress-file",	1, NULL, 0 },
+        { "symbols",	1, NULL, 0 },
+        { "word-sep",	1, NULL, 0 },
         { "input-format",	1, NULL, 'f' },
         { "output",	1, NULL, 'o' },
         { "inlex",	1, NULL, 'I' },
         { "outlex",	1, NULL, 'O' },
         { "shuffle",	2, NULL, 0 },
+        { "outlex-format",	1, NULL, 0 },
+        { "bloom-fpr",	1, NULL, 0 },
+        { "bloom-stats",	0, NULL, 0 },
+        { "profile",	1, NULL, 0 },
+        { "mem-report",	2, NULL, 0 },
+        { "checkpoint-every",	1, NULL, 0 },
+        { "checkpoint-file",	1, NULL, 0 },
+        { "resume",	1, NULL, 0 },
+        { "serve",	2, NULL, 0 },
+        { "serve-learn",	0, NULL, 0 },
+        { "serve-batch",	1, NULL, 0 },
         { "print",	0, NULL, 'p' },
         { "print-lb",	0, NULL, 0 },
         { "print-ub",	0, NULL, 0 },
@@ -1548,6 +1772,17 @@ cmdline_parser_internal (
         { "score",	1, NULL, 0 },
         { "score-edges",	0, NULL, 0 },
         { "alpha",	1, NULL, 0 },
+        { "lm-maxwlen",	1, NULL, 0 },
+        { "gibbs-model",	1, NULL, 0 },
+        { "gibbs-iter",	1, NULL, 0 },
+        { "gibbs-alpha0",	1, NULL, 0 },
+        { "gibbs-alpha1",	1, NULL, 0 },
+        { "gibbs-pb",	1, NULL, 0 },
+        { "gibbs-rho",	1, NULL, 0 },
+        { "gibbs-anneal",	1, NULL, 0 },
+        { "gibbs-temp",	1, NULL, 0 },
+        { "gibbs-threads",	1, NULL, 0 },
+        { "gibbs-seed",	1, NULL, 0 },
         { "pred-m",	1, NULL, 0 },
         { "pred-norm",	0, NULL, 0 },
         { "pred-xlen",	1, NULL, 0 },
@@ -1562,6 +1797,9 @@ cmdline_parser_internal (
         { "random-seed",	1, NULL, 0 },
         { "random-rate",	1, NULL, 0 },
         { "lexicon-partial",	2, NULL, 0 },
+        { "parse-threads",	1, NULL, 0 },
+        { "parse-minlen",	1, NULL, 0 },
+        { "max-parses",	1, NULL, 0 },
         { "lex-nglen",	1, NULL, 0 },
         { "lex-useprior",	0, NULL, 0 },
         { "lex-minfreq",	1, NULL, 0 },
@@ -1597,6 +1835,7 @@ cmdline_parser_internal (
         { "threshold",	1, NULL, 0 },
         { "norm",	1, NULL, 0 },
         { "vote",	1, NULL, 0 },
+        { "vote-kernel",	1, NULL, 0 },
         { "prior-data",	2, NULL, 0 },
         { 0,  0, 0, 0 }
       };
@@ -1608,14 +1847,33 @@ cmdline_parser_internal (
       switch (c)
         {
         case 'h':	/* Print help and exit.  */
-          cmdline_parser_print_help ();
+        
+        
+          if (update_arg( 0 , 
+               0 , &(args_info->help_given),
+              &(local_args_info.help_given), optarg, 0, 0, ARG_NO,
+              check_ambiguity, override, 0, 0,
+              "help", 'h',
+              additional_error))
+            goto failure;
           cmdline_parser_free (&local_args_info);
-          exit (EXIT_SUCCESS);
-
+          return 0;
+        
+          break;
         case 'V':	/* Print version and exit.  */
-          cmdline_parser_print_version ();
+        
+        
+          if (update_arg( 0 , 
+               0 , &(args_info->version_given),
+              &(local_args_info.version_given), optarg, 0, 0, ARG_NO,
+              check_ambiguity, override, 0, 0,
+              "version", 'V',
+              additional_error))
+            goto failure;
           cmdline_parser_free (&local_args_info);
-          exit (EXIT_SUCCESS);
+          return 0;
+        
+          break;
 
         case 'd':	/* debug level.  */
         
@@ -1776,6 +2034,34 @@ cmdline_parser_internal (
                 additional_error))
               goto failure;
           
+          }
+          /* what a phoneme is in the input and in the -I and -O lexicons: bytes: a byte, utf8: a UTF-8 character with its combining diacritics, tokens: a space separated token. the stress file has one byte per phoneme.  */
+          else if (strcmp (long_options[option_index].name, "symbols") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->symbols_arg), 
+                 &(args_info->symbols_orig), &(args_info->symbols_given),
+                &(local_args_info.symbols_given), optarg, cmdline_parser_symbols_values, "bytes", ARG_ENUM,
+                check_ambiguity, override, 0, 0,
+                "symbols", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* the token between the words with --symbols=tokens.  */
+          else if (strcmp (long_options[option_index].name, "word-sep") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->word_sep_arg), 
+                 &(args_info->word_sep_orig), &(args_info->word_sep_given),
+                &(local_args_info.word_sep_given), optarg, 0, "#", ARG_STRING,
+                check_ambiguity, override, 0, 0,
+                "word-sep", '-',
+                additional_error))
+              goto failure;
+          
           }
           /* randomize the input utternaces. if SEED is not given, current time is used as seed.  */
           else if (strcmp (long_options[option_index].name, "shuffle") == 0)
@@ -1790,6 +2076,156 @@ cmdline_parser_internal (
                 additional_error))
               goto failure;
           
+          }
+          /* format of the output lexicon. binary lexicons are loaded much faster, -I recognizes them automatically.  */
+          else if (strcmp (long_options[option_index].name, "outlex-format") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->outlex_format_arg), 
+                 &(args_info->outlex_format_orig), &(args_info->outlex_format_given),
+                &(local_args_info.outlex_format_given), optarg, cmdline_parser_outlex_format_values, "text", ARG_ENUM,
+                check_ambiguity, override, 0, 0,
+                "outlex-format", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* false positive rate of the Bloom filters in front of the lexicon and n-gram lookups, 0 disables the filters.  */
+          else if (strcmp (long_options[option_index].name, "bloom-fpr") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->bloom_fpr_arg), 
+                 &(args_info->bloom_fpr_orig), &(args_info->bloom_fpr_given),
+                &(local_args_info.bloom_fpr_given), optarg, 0, "0", ARG_DOUBLE,
+                check_ambiguity, override, 0, 0,
+                "bloom-fpr", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* print Bloom filter lookup statistics at exit.  */
+          else if (strcmp (long_options[option_index].name, "bloom-stats") == 0)
+          {
+          
+          
+            if (update_arg((void *)&(args_info->bloom_stats_flag), 0, &(args_info->bloom_stats_given),
+                &(local_args_info.bloom_stats_given), optarg, 0, 0, ARG_FLAG,
+                check_ambiguity, override, 1, 0, "bloom-stats", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* write per-stage timings and counters to FILE at exit, as CSV if FILE ends with .csv, JSON otherwise.  */
+          else if (strcmp (long_options[option_index].name, "profile") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->profile_arg), 
+                 &(args_info->profile_orig), &(args_info->profile_given),
+                &(local_args_info.profile_given), optarg, 0, 0, ARG_STRING,
+                check_ambiguity, override, 0, 0,
+                "profile", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* print the memory held by the model structures to stderr at exit, and after every N utterances.  */
+          else if (strcmp (long_options[option_index].name, "mem-report") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->mem_report_arg), 
+                 &(args_info->mem_report_orig), &(args_info->mem_report_given),
+                &(local_args_info.mem_report_given), optarg, 0, "1000", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "mem-report", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* write a checkpoint after every N utterances (only with -m combine).  */
+          else if (strcmp (long_options[option_index].name, "checkpoint-every") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->checkpoint_every_arg), 
+                 &(args_info->checkpoint_every_orig), &(args_info->checkpoint_every_given),
+                &(local_args_info.checkpoint_every_given), optarg, 0, 0, ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "checkpoint-every", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* file name for --checkpoint-every, it is replaced atomically.  */
+          else if (strcmp (long_options[option_index].name, "checkpoint-file") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->checkpoint_file_arg), 
+                 &(args_info->checkpoint_file_orig), &(args_info->checkpoint_file_given),
+                &(local_args_info.checkpoint_file_given), optarg, 0, "seg.ckpt", ARG_STRING,
+                check_ambiguity, override, 0, 0,
+                "checkpoint-file", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* continue the run saved in the checkpoint FILE, the input and the options should be the same.  */
+          else if (strcmp (long_options[option_index].name, "resume") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->resume_arg), 
+                 &(args_info->resume_orig), &(args_info->resume_given),
+                &(local_args_info.resume_given), optarg, 0, 0, ARG_STRING,
+                check_ambiguity, override, 0, 0,
+                "resume", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* after segmenting the input, segment the utterances read line by line from stdin, or from the connections to the Unix socket SOCKET, and print the stats at exit (only with -m combine).  */
+          else if (strcmp (long_options[option_index].name, "serve") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->serve_arg), 
+                 &(args_info->serve_orig), &(args_info->serve_given),
+                &(local_args_info.serve_given), optarg, 0, "-", ARG_STRING,
+                check_ambiguity, override, 0, 0,
+                "serve", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* keep learning from the utterances segmented with --serve.  */
+          else if (strcmp (long_options[option_index].name, "serve-learn") == 0)
+          {
+          
+          
+            if (update_arg((void *)&(args_info->serve_learn_flag), 0, &(args_info->serve_learn_given),
+                &(local_args_info.serve_learn_given), optarg, 0, 0, ARG_FLAG,
+                check_ambiguity, override, 1, 0, "serve-learn", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* answer up to N requests that arrive together with one write.  */
+          else if (strcmp (long_options[option_index].name, "serve-batch") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->serve_batch_arg), 
+                 &(args_info->serve_batch_orig), &(args_info->serve_batch_given),
+                &(local_args_info.serve_batch_given), optarg, 0, "1", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "serve-batch", '-',
+                additional_error))
+              goto failure;
+          
           }
           /* print word boundary information for each measure.  */
           else if (strcmp (long_options[option_index].name, "print-lb") == 0)
@@ -1968,6 +2404,160 @@ cmdline_parser_internal (
                 additional_error))
               goto failure;
           
+          }
+          /* maximum word length for lm1 segmentation, 0 for no limit.  */
+          else if (strcmp (long_options[option_index].name, "lm-maxwlen") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->lm_maxwlen_arg), 
+                 &(args_info->lm_maxwlen_orig), &(args_info->lm_maxwlen_given),
+                &(local_args_info.lm_maxwlen_given), optarg, 0, "0", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "lm-maxwlen", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* language model for gibbs sampling.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-model") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_model_arg), 
+                 &(args_info->gibbs_model_orig), &(args_info->gibbs_model_given),
+                &(local_args_info.gibbs_model_given), optarg, cmdline_parser_gibbs_model_values, "unigram", ARG_ENUM,
+                check_ambiguity, override, 0, 0,
+                "gibbs-model", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* number of iterations.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-iter") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_iter_arg), 
+                 &(args_info->gibbs_iter_orig), &(args_info->gibbs_iter_given),
+                &(local_args_info.gibbs_iter_given), optarg, 0, "1000", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "gibbs-iter", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* concentration parameter of the unigram DP.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-alpha0") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_alpha0_arg), 
+                 &(args_info->gibbs_alpha0_orig), &(args_info->gibbs_alpha0_given),
+                &(local_args_info.gibbs_alpha0_given), optarg, 0, "20.0", ARG_DOUBLE,
+                check_ambiguity, override, 0, 0,
+                "gibbs-alpha0", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* concentration parameter of the bigram DPs.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-alpha1") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_alpha1_arg), 
+                 &(args_info->gibbs_alpha1_orig), &(args_info->gibbs_alpha1_given),
+                &(local_args_info.gibbs_alpha1_given), optarg, 0, "100.0", ARG_DOUBLE,
+                check_ambiguity, override, 0, 0,
+                "gibbs-alpha1", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* probability of a word boundary in the base distribution.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-pb") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_pb_arg), 
+                 &(args_info->gibbs_pb_orig), &(args_info->gibbs_pb_given),
+                &(local_args_info.gibbs_pb_given), optarg, 0, "0.5", ARG_DOUBLE,
+                check_ambiguity, override, 0, 0,
+                "gibbs-pb", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* prior on utterance boundaries (unigram model).  */
+          else if (strcmp (long_options[option_index].name, "gibbs-rho") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_rho_arg), 
+                 &(args_info->gibbs_rho_orig), &(args_info->gibbs_rho_given),
+                &(local_args_info.gibbs_rho_given), optarg, 0, "2.0", ARG_DOUBLE,
+                check_ambiguity, override, 0, 0,
+                "gibbs-rho", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* number of initial iterations with annealing.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-anneal") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_anneal_arg), 
+                 &(args_info->gibbs_anneal_orig), &(args_info->gibbs_anneal_given),
+                &(local_args_info.gibbs_anneal_given), optarg, 0, "0", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "gibbs-anneal", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* starting temperature for annealing.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-temp") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_temp_arg), 
+                 &(args_info->gibbs_temp_orig), &(args_info->gibbs_temp_given),
+                &(local_args_info.gibbs_temp_given), optarg, 0, "10.0", ARG_DOUBLE,
+                check_ambiguity, override, 0, 0,
+                "gibbs-temp", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* number of utterance blocks to sample in parallel.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-threads") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_threads_arg), 
+                 &(args_info->gibbs_threads_orig), &(args_info->gibbs_threads_given),
+                &(local_args_info.gibbs_threads_given), optarg, 0, "1", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "gibbs-threads", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* seed for the sampler.  */
+          else if (strcmp (long_options[option_index].name, "gibbs-seed") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->gibbs_seed_arg), 
+                 &(args_info->gibbs_seed_orig), &(args_info->gibbs_seed_given),
+                &(local_args_info.gibbs_seed_given), optarg, 0, "1", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "gibbs-seed", '-',
+                additional_error))
+              goto failure;
+          
           }
           /* measure(s) to use for predictability based segmentation.  */
           else if (strcmp (long_options[option_index].name, "pred-m") == 0)
@@ -2153,6 +2743,48 @@ cmdline_parser_internal (
                 additional_error))
               goto failure;
           
+          }
+          /* number of threads to use for parsing long inputs.  */
+          else if (strcmp (long_options[option_index].name, "parse-threads") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->parse_threads_arg), 
+                 &(args_info->parse_threads_orig), &(args_info->parse_threads_given),
+                &(local_args_info.parse_threads_given), optarg, 0, "1", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "parse-threads", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* minimum input length for parsing with multiple threads.  */
+          else if (strcmp (long_options[option_index].name, "parse-minlen") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->parse_minlen_arg), 
+                 &(args_info->parse_minlen_orig), &(args_info->parse_minlen_given),
+                &(local_args_info.parse_minlen_given), optarg, 0, "64", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "parse-minlen", '-',
+                additional_error))
+              goto failure;
+          
+          }
+          /* maximum number of parses to print for an input, 0 for no limit.  */
+          else if (strcmp (long_options[option_index].name, "max-parses") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->max_parses_arg), 
+                 &(args_info->max_parses_orig), &(args_info->max_parses_given),
+                &(local_args_info.max_parses_given), optarg, 0, "0", ARG_INT,
+                check_ambiguity, override, 0, 0,
+                "max-parses", '-',
+                additional_error))
+              goto failure;
+          
           }
           /* ngram size for keeping statistics about the phonemes in the lexicon.  */
           else if (strcmp (long_options[option_index].name, "lex-nglen") == 0)
@@ -2608,6 +3240,20 @@ cmdline_parser_internal (
                 additional_error))
               goto failure;
           
+          }
+          /* vectorized kernels for peaks and votes, all give the same results.  */
+          else if (strcmp (long_options[option_index].name, "vote-kernel") == 0)
+          {
+          
+          
+            if (update_arg( (void *)&(args_info->vote_kernel_arg), 
+                 &(args_info->vote_kernel_orig), &(args_info->vote_kernel_given),
+                &(local_args_info.vote_kernel_given), optarg, cmdline_parser_vote_kernel_values, "auto", ARG_ENUM,
+                check_ambiguity, override, 0, 0,
+                "vote-kernel", '-',
+                additional_error))
+              goto failure;
+          
           }
           /* filename to build prior statistics from, if filename is not specified, the statistics are calculated on the first pass on the input file..  */
           else if (strcmp (long_options[option_index].name, "prior-data") == 0)
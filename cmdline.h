@@ -45,7 +45,7 @@ enum enum_lex { lex__NULL = -1, lex_arg_lc = 0, lex_arg_lf, lex_arg_lp };
 enum enum_lex_dir { lex_dir__NULL = -1, lex_dir_arg_lr = 0, lex_dir_arg_rl, lex_dir_arg_both };
 enum enum_stress { stress__NULL = -1, stress_arg_ub = 0, stress_arg_transition, stress_arg_cheat, stress_arg_sylcheat };
 enum enum_ub_type { ub_type__NULL = -1, ub_type_arg_ubegin = 0, ub_type_arg_uend, ub_type_arg_both };
-enum enum_method { method__NULL = -1, method_arg_lexicon = 0, method_arg_lm, method_arg_random, method_arg_pred, method_arg_ub, method_arg_lexc, method_arg_nv, method_arg_combine };
+enum enum_method { method__NULL = -1, method_arg_lexicon = 0, method_arg_lm, method_arg_random, method_arg_pred, method_arg_ub, method_arg_lexc, method_arg_nv, method_arg_combine, method_arg_mbdp, method_arg_gibbs };
 enum enum_cues { cues__NULL = -1, cues_arg_pred = 0, cues_arg_phon, cues_arg_stress, cues_arg_lex };
 enum enum_cue_source { cue_source__NULL = -1, cue_source_arg_utterances = 0, cue_source_arg_segments, cue_source_arg_lexicon };
 enum enum_pred_source { pred_source__NULL = -1, pred_source_arg_utterances = 0, pred_source_arg_segments, pred_source_arg_lexicon };
@@ -57,6 +57,10 @@ enum enum_boundary_method { boundary_method__NULL = -1, boundary_method_arg_peak
 enum enum_peak { peak__NULL = -1, peak_arg_strict = 0, peak_arg_relaxed, peak_arg_dual, peak_arg_right, peak_arg_left, peak_arg_lr, peak_arg_strict2 };
 enum enum_norm { norm__NULL = -1, norm_arg_none = 0, norm_arg_zscore, norm_arg_mdiff, norm_arg_mdivide };
 enum enum_vote { vote__NULL = -1, vote_arg_binary = 0, vote_arg_diff, vote_arg_lgdiff };
+enum enum_gibbs_model { gibbs_model__NULL = -1, gibbs_model_arg_unigram = 0, gibbs_model_arg_bigram };
+enum enum_outlex_format { outlex_format__NULL = -1, outlex_format_arg_text = 0, outlex_format_arg_binary };
+enum enum_vote_kernel { vote_kernel__NULL = -1, vote_kernel_arg_auto = 0, vote_kernel_arg_avx2, vote_kernel_arg_sse2, vote_kernel_arg_scalar };
+enum enum_symbols { symbols__NULL = -1, symbols_arg_bytes = 0, symbols_arg_utf8, symbols_arg_tokens };
 
 /** @brief Where the command line options are stored */
 struct gengetopt_args_info
@@ -79,6 +83,12 @@ struct gengetopt_args_info
   char * stress_file_arg;	/**< @brief  filename to read stress patterns from.  */
   char * stress_file_orig;	/**< @brief  filename to read stress patterns from original value given at command line.  */
   const char *stress_file_help; /**< @brief  filename to read stress patterns from help description.  */
+  enum enum_symbols symbols_arg;	/**< @brief what a phoneme is in the input: bytes: a byte, utf8: a UTF-8 character with its combining diacritics, tokens: a space separated token (default='bytes').  */
+  char * symbols_orig;	/**< @brief what a phoneme is in the input: bytes: a byte, utf8: a UTF-8 character with its combining diacritics, tokens: a space separated token original value given at command line.  */
+  const char *symbols_help; /**< @brief what a phoneme is in the input: bytes: a byte, utf8: a UTF-8 character with its combining diacritics, tokens: a space separated token help description.  */
+  char *word_sep_arg;	/**< @brief the token between the words with --symbols=tokens (default='#').  */
+  char * word_sep_orig;	/**< @brief the token between the words with --symbols=tokens original value given at command line.  */
+  const char *word_sep_help; /**< @brief the token between the words with --symbols=tokens help description.  */
   enum enum_input_format input_format_arg;	/**< @brief input file format:
    seg: one segmented utterance/word per line
    unseg: one unsegmented utterance/word per line
@@ -103,6 +113,37 @@ struct gengetopt_args_info
   long shuffle_arg;	/**< @brief randomize the input utternaces. if SEED is not given, current time is used as seed (default='-1').  */
   char * shuffle_orig;	/**< @brief randomize the input utternaces. if SEED is not given, current time is used as seed original value given at command line.  */
   const char *shuffle_help; /**< @brief randomize the input utternaces. if SEED is not given, current time is used as seed help description.  */
+  enum enum_outlex_format outlex_format_arg;	/**< @brief format of the output lexicon. binary lexicons are loaded much faster, -I recognizes them automatically (default='text').  */
+  char * outlex_format_orig;	/**< @brief format of the output lexicon. binary lexicons are loaded much faster, -I recognizes them automatically original value given at command line.  */
+  const char *outlex_format_help; /**< @brief format of the output lexicon. binary lexicons are loaded much faster, -I recognizes them automatically help description.  */
+  double bloom_fpr_arg;	/**< @brief false positive rate of the Bloom filters in front of the lexicon and n-gram lookups, 0 disables the filters (default='0').  */
+  char * bloom_fpr_orig;	/**< @brief false positive rate of the Bloom filters in front of the lexicon and n-gram lookups, 0 disables the filters original value given at command line.  */
+  const char *bloom_fpr_help; /**< @brief false positive rate of the Bloom filters in front of the lexicon and n-gram lookups, 0 disables the filters help description.  */
+  int bloom_stats_flag;	/**< @brief print Bloom filter lookup statistics at exit (default='off').  */
+  const char *bloom_stats_help; /**< @brief print Bloom filter lookup statistics at exit help description.  */
+  char *profile_arg;	/**< @brief write per-stage timings and counters to FILE at exit, as CSV if FILE ends with .csv, JSON otherwise.  */
+  char * profile_orig;	/**< @brief write per-stage timings and counters to FILE at exit, as CSV if FILE ends with .csv, JSON otherwise original value given at command line.  */
+  const char *profile_help; /**< @brief write per-stage timings and counters to FILE at exit, as CSV if FILE ends with .csv, JSON otherwise help description.  */
+  int mem_report_arg;	/**< @brief print the memory held by the model structures to stderr at exit, and after every N utterances (default='1000').  */
+  char * mem_report_orig;	/**< @brief print the memory held by the model structures to stderr at exit, and after every N utterances original value given at command line.  */
+  const char *mem_report_help; /**< @brief print the memory held by the model structures to stderr at exit, and after every N utterances help description.  */
+  int checkpoint_every_arg;	/**< @brief write a checkpoint after every N utterances (only with -m combine).  */
+  char * checkpoint_every_orig;	/**< @brief write a checkpoint after every N utterances (only with -m combine) original value given at command line.  */
+  const char *checkpoint_every_help; /**< @brief write a checkpoint after every N utterances (only with -m combine) help description.  */
+  char *checkpoint_file_arg;	/**< @brief file name for --checkpoint-every, it is replaced atomically (default='seg.ckpt').  */
+  char * checkpoint_file_orig;	/**< @brief file name for --checkpoint-every, it is replaced atomically original value given at command line.  */
+  const char *checkpoint_file_help; /**< @brief file name for --checkpoint-every, it is replaced atomically help description.  */
+  char *resume_arg;	/**< @brief continue the run saved in the checkpoint FILE, the input and the options should be the same.  */
+  char * resume_orig;	/**< @brief continue the run saved in the checkpoint FILE, the input and the options should be the same original value given at command line.  */
+  const char *resume_help; /**< @brief continue the run saved in the checkpoint FILE, the input and the options should be the same help description.  */
+  char *serve_arg;	/**< @brief after segmenting the input, segment the utterances read line by line from stdin, or from the connections to the Unix socket SOCKET, and print the stats at exit (only with -m combine) (default='-').  */
+  char * serve_orig;	/**< @brief after segmenting the input, segment the utterances read line by line from stdin, or from the connections to the Unix socket SOCKET, and print the stats at exit (only with -m combine) original value given at command line.  */
+  const char *serve_help; /**< @brief after segmenting the input, segment the utterances read line by line from stdin, or from the connections to the Unix socket SOCKET, and print the stats at exit (only with -m combine) help description.  */
+  int serve_learn_flag;	/**< @brief keep learning from the utterances segmented with --serve (default='off').  */
+  const char *serve_learn_help; /**< @brief keep learning from the utterances segmented with --serve help description.  */
+  int serve_batch_arg;	/**< @brief answer up to N requests that arrive together with one write (default='1').  */
+  char * serve_batch_orig;	/**< @brief answer up to N requests that arrive together with one write original value given at command line.  */
+  const char *serve_batch_help; /**< @brief answer up to N requests that arrive together with one write help description.  */
   int print_flag;	/**< @brief print predictability measures given in --pred and exit (default=off).  */
   const char *print_help; /**< @brief print predictability measures given in --pred and exit help description.  */
   int print_lb_flag;	/**< @brief print word boundary information for each measure (default=off).  */
@@ -149,6 +190,39 @@ struct gengetopt_args_info
   double alpha_arg;	/**< @brief parameter for lm1 segmentation (default='0.5').  */
   char * alpha_orig;	/**< @brief parameter for lm1 segmentation original value given at command line.  */
   const char *alpha_help; /**< @brief parameter for lm1 segmentation help description.  */
+  int lm_maxwlen_arg;	/**< @brief maximum word length for lm1 segmentation, 0 for no limit (default='0').  */
+  char * lm_maxwlen_orig;	/**< @brief maximum word length for lm1 segmentation, 0 for no limit original value given at command line.  */
+  const char *lm_maxwlen_help; /**< @brief maximum word length for lm1 segmentation, 0 for no limit help description.  */
+  enum enum_gibbs_model gibbs_model_arg;	/**< @brief language model for gibbs sampling (default='unigram').  */
+  char * gibbs_model_orig;	/**< @brief language model for gibbs sampling original value given at command line.  */
+  const char *gibbs_model_help; /**< @brief language model for gibbs sampling help description.  */
+  int gibbs_iter_arg;	/**< @brief number of iterations (default='1000').  */
+  char * gibbs_iter_orig;	/**< @brief number of iterations original value given at command line.  */
+  const char *gibbs_iter_help; /**< @brief number of iterations help description.  */
+  double gibbs_alpha0_arg;	/**< @brief concentration parameter of the unigram DP (default='20.0').  */
+  char * gibbs_alpha0_orig;	/**< @brief concentration parameter of the unigram DP original value given at command line.  */
+  const char *gibbs_alpha0_help; /**< @brief concentration parameter of the unigram DP help description.  */
+  double gibbs_alpha1_arg;	/**< @brief concentration parameter of the bigram DPs (default='100.0').  */
+  char * gibbs_alpha1_orig;	/**< @brief concentration parameter of the bigram DPs original value given at command line.  */
+  const char *gibbs_alpha1_help; /**< @brief concentration parameter of the bigram DPs help description.  */
+  double gibbs_pb_arg;	/**< @brief probability of a word boundary in the base distribution (default='0.5').  */
+  char * gibbs_pb_orig;	/**< @brief probability of a word boundary in the base distribution original value given at command line.  */
+  const char *gibbs_pb_help; /**< @brief probability of a word boundary in the base distribution help description.  */
+  double gibbs_rho_arg;	/**< @brief prior on utterance boundaries (unigram model) (default='2.0').  */
+  char * gibbs_rho_orig;	/**< @brief prior on utterance boundaries (unigram model) original value given at command line.  */
+  const char *gibbs_rho_help; /**< @brief prior on utterance boundaries (unigram model) help description.  */
+  int gibbs_anneal_arg;	/**< @brief number of initial iterations with annealing (default='0').  */
+  char * gibbs_anneal_orig;	/**< @brief number of initial iterations with annealing original value given at command line.  */
+  const char *gibbs_anneal_help; /**< @brief number of initial iterations with annealing help description.  */
+  double gibbs_temp_arg;	/**< @brief starting temperature for annealing (default='10.0').  */
+  char * gibbs_temp_orig;	/**< @brief starting temperature for annealing original value given at command line.  */
+  const char *gibbs_temp_help; /**< @brief starting temperature for annealing help description.  */
+  int gibbs_threads_arg;	/**< @brief number of utterance blocks to sample in parallel (default='1').  */
+  char * gibbs_threads_orig;	/**< @brief number of utterance blocks to sample in parallel original value given at command line.  */
+  const char *gibbs_threads_help; /**< @brief number of utterance blocks to sample in parallel help description.  */
+  int gibbs_seed_arg;	/**< @brief seed for the sampler (default='1').  */
+  char * gibbs_seed_orig;	/**< @brief seed for the sampler original value given at command line.  */
+  const char *gibbs_seed_help; /**< @brief seed for the sampler help description.  */
   enum enum_pred_m *pred_m_arg;	/**< @brief measure(s) to use for predictability based segmentation (default='tp').  */
   char ** pred_m_orig;	/**< @brief measure(s) to use for predictability based segmentation original value given at command line.  */
   unsigned int pred_m_min; /**< @brief measure(s) to use for predictability based segmentation's minimum occurreces */
@@ -189,6 +263,15 @@ struct gengetopt_args_info
   enum enum_lexicon_partial lexicon_partial_arg;	/**< @brief do partial segmentation (default='none').  */
   char * lexicon_partial_orig;	/**< @brief do partial segmentation original value given at command line.  */
   const char *lexicon_partial_help; /**< @brief do partial segmentation help description.  */
+  int parse_threads_arg;	/**< @brief number of threads to use for parsing long inputs (default='1').  */
+  char * parse_threads_orig;	/**< @brief number of threads to use for parsing long inputs original value given at command line.  */
+  const char *parse_threads_help; /**< @brief number of threads to use for parsing long inputs help description.  */
+  int parse_minlen_arg;	/**< @brief minimum input length for parsing with multiple threads (default='64').  */
+  char * parse_minlen_orig;	/**< @brief minimum input length for parsing with multiple threads original value given at command line.  */
+  const char *parse_minlen_help; /**< @brief minimum input length for parsing with multiple threads help description.  */
+  int max_parses_arg;	/**< @brief maximum number of parses to print for an input, 0 for no limit (default='0').  */
+  char * max_parses_orig;	/**< @brief maximum number of parses to print for an input, 0 for no limit original value given at command line.  */
+  const char *max_parses_help; /**< @brief maximum number of parses to print for an input, 0 for no limit help description.  */
   int lex_nglen_arg;	/**< @brief ngram size for keeping statistics about the phonemes in the lexicon (default='5').  */
   char * lex_nglen_orig;	/**< @brief ngram size for keeping statistics about the phonemes in the lexicon original value given at command line.  */
   const char *lex_nglen_help; /**< @brief ngram size for keeping statistics about the phonemes in the lexicon help description.  */
@@ -296,6 +379,9 @@ struct gengetopt_args_info
   enum enum_vote vote_arg;	/**< @brief what to return as vote (default='binary').  */
   char * vote_orig;	/**< @brief what to return as vote original value given at command line.  */
   const char *vote_help; /**< @brief what to return as vote help description.  */
+  enum enum_vote_kernel vote_kernel_arg;	/**< @brief vectorized kernels for peaks and votes, all give the same results (default='auto').  */
+  char * vote_kernel_orig;	/**< @brief vectorized kernels for peaks and votes, all give the same results original value given at command line.  */
+  const char *vote_kernel_help; /**< @brief vectorized kernels for peaks and votes, all give the same results help description.  */
   char * prior_data_arg;	/**< @brief filename to build prior statistics from, if filename is not specified, the statistics are calculated on the first pass on the input file. (default='input').  */
   char * prior_data_orig;	/**< @brief filename to build prior statistics from, if filename is not specified, the statistics are calculated on the first pass on the input file. original value given at command line.  */
   const char *prior_data_help; /**< @brief filename to build prior statistics from, if filename is not specified, the statistics are calculated on the first pass on the input file. help description.  */
@@ -308,11 +394,24 @@ struct gengetopt_args_info
   unsigned int progress_given ;	/**< @brief Whether progress was given.  */
   unsigned int input_given ;	/**< @brief Whether input was given.  */
   unsigned int stress_file_given ;	/**< @brief Whether stress-file was given.  */
+  unsigned int symbols_given ;	/**< @brief Whether symbols was given.  */
+  unsigned int word_sep_given ;	/**< @brief Whether word-sep was given.  */
   unsigned int input_format_given ;	/**< @brief Whether input-format was given.  */
   unsigned int output_given ;	/**< @brief Whether output was given.  */
   unsigned int inlex_given ;	/**< @brief Whether inlex was given.  */
   unsigned int outlex_given ;	/**< @brief Whether outlex was given.  */
   unsigned int shuffle_given ;	/**< @brief Whether shuffle was given.  */
+  unsigned int outlex_format_given ;	/**< @brief Whether outlex-format was given.  */
+  unsigned int bloom_fpr_given ;	/**< @brief Whether bloom-fpr was given.  */
+  unsigned int bloom_stats_given ;	/**< @brief Whether bloom-stats was given.  */
+  unsigned int profile_given ;	/**< @brief Whether profile was given.  */
+  unsigned int mem_report_given ;	/**< @brief Whether mem-report was given.  */
+  unsigned int checkpoint_every_given ;	/**< @brief Whether checkpoint-every was given.  */
+  unsigned int checkpoint_file_given ;	/**< @brief Whether checkpoint-file was given.  */
+  unsigned int resume_given ;	/**< @brief Whether resume was given.  */
+  unsigned int serve_given ;	/**< @brief Whether serve was given.  */
+  unsigned int serve_learn_given ;	/**< @brief Whether serve-learn was given.  */
+  unsigned int serve_batch_given ;	/**< @brief Whether serve-batch was given.  */
   unsigned int print_given ;	/**< @brief Whether print was given.  */
   unsigned int print_lb_given ;	/**< @brief Whether print-lb was given.  */
   unsigned int print_ub_given ;	/**< @brief Whether print-ub was given.  */
@@ -328,6 +427,17 @@ struct gengetopt_args_info
   unsigned int score_given ;	/**< @brief Whether score was given.  */
   unsigned int score_edges_given ;	/**< @brief Whether score-edges was given.  */
   unsigned int alpha_given ;	/**< @brief Whether alpha was given.  */
+  unsigned int lm_maxwlen_given ;	/**< @brief Whether lm-maxwlen was given.  */
+  unsigned int gibbs_model_given ;	/**< @brief Whether gibbs-model was given.  */
+  unsigned int gibbs_iter_given ;	/**< @brief Whether gibbs-iter was given.  */
+  unsigned int gibbs_alpha0_given ;	/**< @brief Whether gibbs-alpha0 was given.  */
+  unsigned int gibbs_alpha1_given ;	/**< @brief Whether gibbs-alpha1 was given.  */
+  unsigned int gibbs_pb_given ;	/**< @brief Whether gibbs-pb was given.  */
+  unsigned int gibbs_rho_given ;	/**< @brief Whether gibbs-rho was given.  */
+  unsigned int gibbs_anneal_given ;	/**< @brief Whether gibbs-anneal was given.  */
+  unsigned int gibbs_temp_given ;	/**< @brief Whether gibbs-temp was given.  */
+  unsigned int gibbs_threads_given ;	/**< @brief Whether gibbs-threads was given.  */
+  unsigned int gibbs_seed_given ;	/**< @brief Whether gibbs-seed was given.  */
   unsigned int pred_m_given ;	/**< @brief Whether pred-m was given.  */
   unsigned int pred_norm_given ;	/**< @brief Whether pred-norm was given.  */
   unsigned int pred_xlen_given ;	/**< @brief Whether pred-xlen was given.  */
@@ -342,6 +452,9 @@ struct gengetopt_args_info
   unsigned int random_seed_given ;	/**< @brief Whether random-seed was given.  */
   unsigned int random_rate_given ;	/**< @brief Whether random-rate was given.  */
   unsigned int lexicon_partial_given ;	/**< @brief Whether lexicon-partial was given.  */
+  unsigned int parse_threads_given ;	/**< @brief Whether parse-threads was given.  */
+  unsigned int parse_minlen_given ;	/**< @brief Whether parse-minlen was given.  */
+  unsigned int max_parses_given ;	/**< @brief Whether max-parses was given.  */
   unsigned int lex_nglen_given ;	/**< @brief Whether lex-nglen was given.  */
   unsigned int lex_useprior_given ;	/**< @brief Whether lex-useprior was given.  */
   unsigned int lex_minfreq_given ;	/**< @brief Whether lex-minfreq was given.  */
@@ -377,6 +490,7 @@ struct gengetopt_args_info
   unsigned int threshold_given ;	/**< @brief Whether threshold was given.  */
   unsigned int norm_given ;	/**< @brief Whether norm was given.  */
   unsigned int vote_given ;	/**< @brief Whether vote was given.  */
+  unsigned int vote_kernel_given ;	/**< @brief Whether vote-kernel was given.  */
   unsigned int prior_data_given ;	/**< @brief Whether prior-data was given.  */
 
 } ;
@@ -525,6 +639,10 @@ extern const char *cmdline_parser_boundary_method_values[];  /**< @brief Possibl
 extern const char *cmdline_parser_peak_values[];  /**< @brief Possible values for peak. */
 extern const char *cmdline_parser_norm_values[];  /**< @brief Possible values for norm. */
 extern const char *cmdline_parser_vote_values[];  /**< @brief Possible values for vote. */
+extern const char *cmdline_parser_gibbs_model_values[];  /**< @brief Possible values for gibbs-model. */
+extern const char *cmdline_parser_outlex_format_values[];  /**< @brief Possible values for outlex-format. */
+extern const char *cmdline_parser_vote_kernel_values[];  /**< @brief Possible values for vote-kernel. */
+extern const char *cmdline_parser_symbols_values[];  /**< @brief Possible values for symbols. */
 
 
 #ifdef __cplusplus
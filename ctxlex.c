@@ -22,17 +22,25 @@
 #include <assert.h>
 #include <string.h>
 #include "ctxlex.h"
+#include "profile.h"
+#include "mem.h"
+#include "checkpoint.h"
+#include "cclib_debug.h"
 
 struct lexstats *
-lexstats_new()
+lexstats_new(struct mem_acct *mem)
 {
-    struct lexstats *ls = malloc(sizeof *ls);
+    struct lexstats *ls = mem_malloc(mem, MEM_OTHER, sizeof *ls);
+    ls->mem = mem;
     ls->max_wlen = 0;
     ls->nalloc = BUFSIZ;
-    ls->wldist =  calloc(ls->nalloc, sizeof (*ls->wldist));
-    ls->ctxldist = calloc(ls->nalloc, sizeof (*ls->ctxldist));
+    ls->wldist =  mem_calloc(mem, MEM_DIST, ls->nalloc, sizeof (*ls->wldist));
+    ls->ctxldist = mem_calloc(mem, MEM_DIST, ls->nalloc, 
+                              sizeof (*ls->ctxldist));
     ls->wdist = prob_dist_new();
     ls->ctxdist = prob_dist_new();
+    mem_add(mem, MEM_DIST, ls->wdist);
+    mem_add(mem, MEM_DIST, ls->ctxdist);
     return(ls);
 }
 
@@ -40,14 +48,14 @@ void
 lexstats_free(struct lexstats *ls)
 {
     int i;
-    for (i = 0; i < ls->max_wlen; i++) {
+    for (i = 0; i < ls->nalloc; i++) {
         prob_dist_free(ls->wldist[i]);
         prob_dist_free(ls->ctxldist[i]);
     }
-    if (ls->wdist) prob_dist_free(ls->wdist);
-    if (ls->ctxdist) prob_dist_free(ls->wdist);
-    if (ls->wdist) free (ls->wldist);
-    if (ls->ctxdist) free (ls->ctxldist);
+    prob_dist_free(ls->wdist);
+    prob_dist_free(ls->ctxdist);
+    free(ls->wldist);
+    free(ls->ctxldist);
     free(ls);
 }
 
@@ -76,10 +84,16 @@ dist_update(struct lexstats *ls, int len, size_t val, int type)
     }
     // type == 0 -> words, otherwise context
     if (type == UTYPE_WFREQ) {
-        if (ls->wldist[didx] == NULL) ls->wldist[didx] = prob_dist_new();
+        if (ls->wldist[didx] == NULL) {
+            ls->wldist[didx] = prob_dist_new();
+            mem_add(ls->mem, MEM_DIST, ls->wldist[didx]);
+        }
         pd = ls->wldist[didx];
     } else {
-        if (ls->ctxldist[didx] == NULL) ls->ctxldist[didx] = prob_dist_new();
+        if (ls->ctxldist[didx] == NULL) {
+            ls->ctxldist[didx] = prob_dist_new();
+            mem_add(ls->mem, MEM_DIST, ls->ctxldist[didx]);
+        }
         pd = ls->ctxldist[didx];
     }
 
@@ -103,16 +117,42 @@ lexstats_update_ctx(struct lexstats *ls, int len, int ctx)
     dist_update(ls, len, ctx, UTYPE_CTXFREQ);
 }
 
+#define CTXTAB_MINSIZE 1024
+
+/* 
+ * ctxlex_mem_refresh() - the word hash overhead, and the share of the 
+ *                        context table used by the global contexts
+ *
+ * the context table is counted in MEM_CTX_WORD as it is allocated,
+ * here it is split by the number of entries of each kind.
+ */
+static void
+ctxlex_mem_refresh(struct mem_acct *a, void *owner)
+{
+    struct ctxlex *l = owner;
+    size_t ctxbytes = a->bytes[MEM_CTX_GLOBAL] + a->bytes[MEM_CTX_WORD];
+
+    a->bytes[MEM_HASH] = mem_hash_bytes(l->lexhash);
+    a->bytes[MEM_CTX_GLOBAL] = (l->ctx.n) ? 
+                               ctxbytes * (double) l->nctx / l->ctx.n : 0;
+    a->bytes[MEM_CTX_WORD] = ctxbytes - a->bytes[MEM_CTX_GLOBAL];
+}
+
 struct ctxlex *
 ctxlex_new()
 {
     struct ctxlex *l = malloc (sizeof (*l));
 
+    l->mem = mem_acct_new("ctxlex", ctxlex_mem_refresh, l);
+    mem_add(l->mem, MEM_OTHER, l);
     l->lex = NULL;
-    l->lexhash = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, free);
-    l->ctxhash = g_hash_table_new_full(g_int64_hash, g_int64_equal, free, free);
+    l->lexhash = g_hash_table_new(str_hash, str_equal);
+    l->ctx.size = CTXTAB_MINSIZE;
+    l->ctx.n = 0;
+    l->ctx.e = mem_calloc(l->mem, MEM_CTX_WORD, l->ctx.size, 
+                          sizeof (*l->ctx.e));
     l->wntok = l->nctx = l->wntyp = 0;
-    l->stats = lexstats_new();
+    l->stats = lexstats_new(l->mem);
     l->n = l->nalloc = 0;
     
     return l;
@@ -122,54 +162,92 @@ ctxlex_new()
 static gint32
 lex_insert(struct ctxlex *lex, char *s)
 {
-    gint32 *i = NULL;
+    struct lexdata *tmp = NULL;
     assert (lex != NULL);
-    i = g_hash_table_lookup(lex->lexhash, s);
-    if (i == NULL) {
-        struct lexdata *tmp = NULL;
+    prof_count(PROF_PROBES, 1);
+    tmp = g_hash_table_lookup(lex->lexhash, s);
+    if (tmp == NULL) {
         if (lex->nalloc <= lex->n) {
             lex->nalloc += BUFSIZ;
-            lex->lex = realloc(lex->lex, 
-                               lex->nalloc * sizeof (struct lexdata *));
+            lex->lex = mem_realloc(lex->mem, MEM_INDEX, lex->lex, 
+                                   lex->nalloc * sizeof (struct lexdata *));
         }
-        tmp = malloc(sizeof (*tmp));
+        tmp = mem_malloc(lex->mem, MEM_VALUES, sizeof (*tmp));
         tmp->freq = 0;
         tmp->nctx = 0;
-        tmp->s = strdup(s);
-        tmp->freq = 0;
-        tmp->ctx = g_hash_table_new_full(g_int64_hash, g_int64_equal, free, free);
+        tmp->s = mem_strdup(lex->mem, MEM_KEYS, s);
+        prof_count(PROF_ALLOCS, 2);
+        tmp->id = lex->n;
         lex->lex[lex->n] = tmp;
-        i = malloc(sizeof (*i));
-        *i = lex->n;
-        g_hash_table_insert(lex->lexhash, tmp->s, i);
+        g_hash_table_insert(lex->lexhash, tmp->s, tmp);
         lex->n++;
     }
-    return *i;
+    return tmp->id;
 }
 
 static inline size_t
-ctx_insert(GHashTable *ctxhash, gint32 l, gint32 r)
+ctx_hash(gint32 w, gint32 l, gint32 r)
 {
-    size_t *freq;
-    gint64 *ctx = malloc (sizeof (*ctx));
-    gint64 tmp = (gint64) l;
-    *ctx =  tmp << 32;
-    tmp = (gint64) r;
-    *ctx |= tmp;
+    guint64 h = (guint32) w;
 
-    assert (ctxhash != NULL);
+    h = h * 0x9e3779b97f4a7c15ull + (guint32) l;
+    h = h * 0x9e3779b97f4a7c15ull + (guint32) r;
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ull;
+    return h ^ (h >> 32);
+}
 
-    freq = g_hash_table_lookup(ctxhash, ctx);
+static inline struct ctxent *
+ctx_find(struct ctxtab *t, gint32 w, gint32 l, gint32 r)
+{
+    size_t mask = t->size - 1;
+    size_t i = ctx_hash(w, l, r) & mask;
 
-    if (freq == NULL) {
-        freq = malloc (sizeof (*freq));
-        *freq = 1;
-        g_hash_table_insert(ctxhash, ctx, freq);
-    } else {
-        *freq = *freq + 1;
-        free(ctx);
+    while (t->e[i].freq && 
+           (t->e[i].w != w || t->e[i].l != l || t->e[i].r != r)) {
+        i = (i + 1) & mask;
+    }
+    return &t->e[i];
+}
+
+static void
+ctx_grow(struct ctxtab *t, struct mem_acct *mem)
+{
+    struct ctxent *old = t->e;
+    size_t oldsize = t->size;
+    size_t i;
+
+    t->size *= 2;
+    t->e = mem_calloc(mem, MEM_CTX_WORD, t->size, sizeof (*t->e));
+    prof_count(PROF_ALLOCS, 1);
+    for (i = 0; i < oldsize; i++) {
+        if (old[i].freq) {
+            *ctx_find(t, old[i].w, old[i].l, old[i].r) = old[i];
+        }
+    }
+    mem_free(mem, MEM_CTX_WORD, old);
+}
+
+/* ctx_insert() - count the context (l, r) of the word w, 
+ *                returns the updated count.
+ */
+static inline size_t
+ctx_insert(struct ctxtab *t, struct mem_acct *mem, gint32 w, gint32 l, 
+           gint32 r)
+{
+    struct ctxent *e = ctx_find(t, w, l, r);
+
+    if (e->freq == 0) {
+        if (2 * (t->n + 1) > t->size) {
+            ctx_grow(t, mem);
+            e = ctx_find(t, w, l, r);
+        }
+        e->w = w;
+        e->l = l;
+        e->r = r;
+        t->n++;
     }
-    return *freq;
+    return ++e->freq;
 }
 
 struct lexdata *
@@ -182,12 +260,12 @@ ctxlex_add(struct ctxlex *lex, char *s, char *l, char *r)
 
     lex->wntok++;
 
-    tmpfreq = ctx_insert(lex->ctxhash, i_l, i_r);
+    tmpfreq = ctx_insert(&lex->ctx, lex->mem, CTX_ANYWORD, i_l, i_r);
     if (tmpfreq == 1) {
         lex->nctx++;
     } 
 
-    tmpfreq = ctx_insert(lex->lex[i]->ctx, i_l, i_r);
+    tmpfreq = ctx_insert(&lex->ctx, lex->mem, i, i_l, i_r);
     if (tmpfreq == 1) {
         lex->lex[i]->nctx++;
         lexstats_update_ctx(lex->stats, strlen(s), lex->lex[i]->nctx); 
@@ -203,11 +281,21 @@ ctxlex_lookup(struct ctxlex *lex, char *s)
 {
     assert (lex != NULL);
     if (lex->lex == NULL) return NULL;
-    int *i = g_hash_table_lookup(lex->lexhash, s);
-
-    return (i) ? lex->lex[*i] : NULL;
+    prof_count(PROF_PROBES, 1);
+    return g_hash_table_lookup(lex->lexhash, s);
 }
 
+/* ctxlex_lookup_span() - look up the `len' bytes at `s', 
+ *                        `hv' is their str_hash_n() value.
+ */
+struct lexdata *
+ctxlex_lookup_span(struct ctxlex *lex, strhash_t hv, const char *s, 
+                   size_t len)
+{
+    assert (lex != NULL);
+    if (lex->lex == NULL) return NULL;
+    return str_hash_lookup(lex->lexhash, hv, s, len);
+}
 
 size_t 
 ctxlex_freq(struct ctxlex *lex, char *s)
@@ -223,16 +311,35 @@ ctxlex_freq(struct ctxlex *lex, char *s)
 
 }
 
-double
-ctxlex_freq_z(struct ctxlex *lex, char *s)
+size_t 
+ctxlex_freq_span(struct ctxlex *lex, strhash_t hv, const char *s, 
+                 size_t len)
 {
-    double freq = (double) ctxlex_freq(lex, s);
-    int len = strlen(s);
+    struct lexdata *tmp = ctxlex_lookup_span(lex, hv, s, len);
+
+    return (tmp) ? tmp->freq : 0;
+}
 
+static inline double
+freq_z(struct ctxlex *lex, double freq, size_t len)
+{
     if (freq == 0) return -INFINITY;
     return z_score(lex->stats->wldist[len - 1], freq);
 }
 
+double
+ctxlex_freq_z(struct ctxlex *lex, char *s)
+{
+    return freq_z(lex, (double) ctxlex_freq(lex, s), strlen(s));
+}
+
+double
+ctxlex_freq_z_span(struct ctxlex *lex, strhash_t hv, const char *s, 
+                   size_t len)
+{
+    return freq_z(lex, (double) ctxlex_freq_span(lex, hv, s, len), len);
+}
+
 size_t 
 ctxlex_nctx(struct ctxlex *lex, char *s)
 {
@@ -246,16 +353,183 @@ ctxlex_nctx(struct ctxlex *lex, char *s)
     }
 }
 
-double
-ctxlex_nctx_z(struct ctxlex *lex, char *s)
+size_t 
+ctxlex_nctx_span(struct ctxlex *lex, strhash_t hv, const char *s, 
+                 size_t len)
 {
-    double nctx = (double) ctxlex_nctx(lex, s);
-    int len = strlen(s);
+    struct lexdata *tmp = ctxlex_lookup_span(lex, hv, s, len);
+
+    return (tmp) ? tmp->nctx : 0;
+}
 
+static inline double
+nctx_z(struct ctxlex *lex, double nctx, size_t len)
+{
     if (nctx == 0) return -INFINITY;
     return z_score(lex->stats->ctxldist[len - 1], nctx);
 }
 
+double
+ctxlex_nctx_z(struct ctxlex *lex, char *s)
+{
+    return nctx_z(lex, (double) ctxlex_nctx(lex, s), strlen(s));
+}
+
+double
+ctxlex_nctx_z_span(struct ctxlex *lex, strhash_t hv, const char *s, 
+                   size_t len)
+{
+    return nctx_z(lex, (double) ctxlex_nctx_span(lex, hv, s, len), len);
+}
+
+/* ctxlex_scores_span() - frequency and number of contexts of the span
+ *                        with a single lookup, z-scores if `z' is set
+ */
+void
+ctxlex_scores_span(struct ctxlex *lex, strhash_t hv, const char *s, 
+                   size_t len, int z, double *freq, double *nctx)
+{
+    struct lexdata *tmp = ctxlex_lookup_span(lex, hv, s, len);
+    size_t f = (tmp) ? tmp->freq : 0,
+           n = (tmp) ? tmp->nctx : 0;
+
+    if (z) {
+        *freq = freq_z(lex, (double) f, len);
+        *nctx = nctx_z(lex, (double) n, len);
+    } else {
+        *freq = (double) f;
+        *nctx = (double) n;
+    }
+}
+
+
+/* 
+ * lexstats_write_bin() - the distributions that have been allocated,
+ *                        each with its index, -1 for wdist and ctxdist
+ */
+static void
+lexstats_write_bin(FILE *fp, struct lexstats *ls)
+{
+    int i;
+
+    ckpt_put_u64(fp, ls->max_wlen);
+    ckpt_put(fp, ls->wdist, sizeof (*ls->wdist));
+    ckpt_put(fp, ls->ctxdist, sizeof (*ls->ctxdist));
+    for (i = 0; i < ls->nalloc; i++) {
+        if (ls->wldist[i] || ls->ctxldist[i]) {
+            ckpt_put_u64(fp, i);
+            ckpt_put_u64(fp, (ls->wldist[i] != NULL) 
+                             | (ls->ctxldist[i] != NULL) << 1);
+            if (ls->wldist[i]) 
+                ckpt_put(fp, ls->wldist[i], sizeof (*ls->wldist[i]));
+            if (ls->ctxldist[i]) 
+                ckpt_put(fp, ls->ctxldist[i], sizeof (*ls->ctxldist[i]));
+        }
+    }
+    ckpt_put_u64(fp, UINT64_MAX);
+}
+
+static int
+lexstats_read_bin(struct ckpt_buf *b, struct lexstats *ls)
+{
+    uint64_t i;
+
+    ls->max_wlen = ckpt_get_u64(b);
+    ckpt_get(b, ls->wdist, sizeof (*ls->wdist));
+    ckpt_get(b, ls->ctxdist, sizeof (*ls->ctxdist));
+    while (!b->err && (i = ckpt_get_u64(b)) != UINT64_MAX) {
+        uint64_t which = ckpt_get_u64(b);
+
+        if (i >= ls->nalloc 
+            || (which & 1 && ls->wldist[i]) 
+            || (which & 2 && ls->ctxldist[i])) {
+            return -1;
+        }
+        if (which & 1) {
+            ls->wldist[i] = prob_dist_new();
+            mem_add(ls->mem, MEM_DIST, ls->wldist[i]);
+            ckpt_get(b, ls->wldist[i], sizeof (*ls->wldist[i]));
+        }
+        if (which & 2) {
+            ls->ctxldist[i] = prob_dist_new();
+            mem_add(ls->mem, MEM_DIST, ls->ctxldist[i]);
+            ckpt_get(b, ls->ctxldist[i], sizeof (*ls->ctxldist[i]));
+        }
+    }
+    return (b->err) ? -1 : 0;
+}
+
+/* 
+ * ctxlex_write_bin() - write `lex' to a checkpoint record
+ *
+ * the words are written in the order of their IDs, and the context 
+ * table as it is, so that the IDs and the probe sequences are the 
+ * same after ctxlex_read_bin().
+ */
+void
+ctxlex_write_bin(FILE *fp, struct ctxlex *lex)
+{
+    int i;
+
+    ckpt_put_u64(fp, lex->wntok);
+    ckpt_put_u64(fp, lex->wntyp);
+    ckpt_put_u64(fp, lex->nctx);
+    ckpt_put_u64(fp, lex->n);
+    for (i = 0; i < lex->n; i++) {
+        ckpt_put_u64(fp, lex->lex[i]->freq);
+        ckpt_put_u64(fp, lex->lex[i]->nctx);
+        ckpt_put_str(fp, lex->lex[i]->s);
+    }
+    ckpt_put_u64(fp, lex->ctx.size);
+    ckpt_put_u64(fp, lex->ctx.n);
+    ckpt_put(fp, lex->ctx.e, lex->ctx.size * sizeof (*lex->ctx.e));
+    lexstats_write_bin(fp, lex->stats);
+}
+
+/* ctxlex_read_bin() - a new ctxlex from a checkpoint record, NULL if
+ *                     the record is not valid
+ */
+struct ctxlex *
+ctxlex_read_bin(struct ckpt_buf *b)
+{
+    struct ctxlex *lex = ctxlex_new();
+    size_t n, i, size;
+
+    lex->wntok = ckpt_get_u64(b);
+    lex->wntyp = ckpt_get_u64(b);
+    lex->nctx = ckpt_get_u64(b);
+    n = ckpt_get_u64(b);
+    // a word takes at least 17 bytes
+    if (n > (size_t) (b->end - b->p) / 17) goto invalid;
+    for (i = 0; i < n && !b->err; i++) {
+        size_t freq = ckpt_get_u64(b),
+               nctx = ckpt_get_u64(b);
+        gint32 id = lex_insert(lex, (char *) ckpt_get_str(b));
+
+        if (id != i) goto invalid;
+        lex->lex[id]->freq = freq;
+        lex->lex[id]->nctx = nctx;
+    }
+    size = ckpt_get_u64(b);
+    if (b->err || size < CTXTAB_MINSIZE || (size & (size - 1))
+        || size > (size_t) (b->end - b->p) / sizeof (*lex->ctx.e)) {
+        goto invalid;
+    }
+    mem_free(lex->mem, MEM_CTX_WORD, lex->ctx.e);
+    lex->ctx.size = size;
+    lex->ctx.n = ckpt_get_u64(b);
+    lex->ctx.e = mem_malloc(lex->mem, MEM_CTX_WORD, 
+                            size * sizeof (*lex->ctx.e));
+    ckpt_get(b, lex->ctx.e, size * sizeof (*lex->ctx.e));
+    // a full table would never end a probe sequence
+    if (lex->ctx.n < size && lexstats_read_bin(b, lex->stats) == 0) {
+        return lex;
+    }
+invalid:
+    PERROR("`%s' of the checkpoint is not valid\n", b->tag);
+    ctxlex_free(lex);
+    return NULL;
+}
 
 void 
 ctxlex_free(struct ctxlex *lex)
@@ -263,13 +537,14 @@ ctxlex_free(struct ctxlex *lex)
     int i;
 
     g_hash_table_destroy(lex->lexhash);
-    g_hash_table_destroy(lex->ctxhash);
+    free(lex->ctx.e);
     for (i = 0; i < lex->n; i++) {
-        g_hash_table_destroy(lex->lex[i]->ctx);
         free(lex->lex[i]->s);
         free(lex->lex[i]);
     }
     free(lex->lex);
+    lexstats_free(lex->stats);
+    mem_acct_free(lex->mem);
     free(lex);
 }
 
@@ -287,36 +562,28 @@ main()
     ctxlex_add(l, "x","b","c");
     ctxlex_add(l, "b","b","c");
 
-    GHashTableIter iter;
-    g_hash_table_iter_init (&iter, l->lexhash);
-    char *key; 
-    int  *i;
-    while (g_hash_table_iter_next (&iter, (gpointer*)&key, (gpointer*)&i)) {
-        struct lexdata *val = l->lex[*i];
+    int i, j;
+    for (i = 0; i < l->n; i++) {
+        struct lexdata *val = l->lex[i];
         printf("%s: ", val->s); 
         printf("%zu ", val->freq );
         printf("%zu\n", val->nctx);
-        if (val->nctx > 0) {
-            GHashTableIter iter2;
-            g_hash_table_iter_init (&iter2, val->ctx);
-            gint64 *key2; 
-            size_t  *freq;
-            while (g_hash_table_iter_next (&iter2, (gpointer*)&key2, (gpointer*)&freq)) {
-                unsigned left = (unsigned) ((*key2) >> 32),
-                         right = (unsigned) ((*key2) & 0x00000000fffffff);
-                printf("\t%u(%s),%u(%s) = %zu\n", left , l->lex[left]->s, right, l->lex[right]->s, *freq);
+        for (j = 0; j < l->ctx.size; j++) {
+            struct ctxent *e = &l->ctx.e[j];
+            if (e->freq && e->w == val->id) {
+                printf("\t%d(%s),%d(%s) = %u\n", e->l, l->lex[e->l]->s, 
+                       e->r, l->lex[e->r]->s, e->freq);
             }
         }
     }
 
     printf("\nctx list:\n");
-    g_hash_table_iter_init (&iter, l->ctxhash);
-    gint64 *key2; 
-    size_t *freq;
-    while (g_hash_table_iter_next (&iter, (gpointer *)&key2, (gpointer *)&freq)) {
-        unsigned left = (unsigned) ((*key2) >> 32),
-                 right = (unsigned) ((*key2) & 0x00000000fffffff);
-        printf("\t%u(%s),%u(%s) = %zu\n", left , l->lex[left]->s, right, l->lex[right]->s, *freq);
+    for (j = 0; j < l->ctx.size; j++) {
+        struct ctxent *e = &l->ctx.e[j];
+        if (e->freq && e->w == CTX_ANYWORD) {
+            printf("\t%d(%s),%d(%s) = %u\n", e->l, l->lex[e->l]->s, 
+                   e->r, l->lex[e->r]->s, e->freq);
+        }
     }
 
     ctxlex_free(l);
@@ -24,13 +24,36 @@
 #include "options.h"
 #include <glib.h>
 #include "prob_dist.h"
+#include "strhash.h"
+
+struct mem_acct;
+struct ckpt_buf;
 
 
 struct lexdata {
     char *s;
+    gint32 id;      // index in ctxlex->lex
     size_t freq,
-           nctx;
-    GHashTable  *ctx;
+           nctx;    // number of distinct contexts of the word
+};
+
+/*
+ * The contexts are counted in a single open addressing table keyed 
+ * by (word, left, right) IDs. The entries with w == CTX_ANYWORD count
+ * the contexts regardless of the word in the middle. An entry with
+ * freq == 0 is empty.
+ */
+#define CTX_ANYWORD     -1
+
+struct ctxent {
+    gint32  w, l, r;
+    guint32 freq;
+};
+
+struct ctxtab {
+    struct ctxent *e;
+    size_t  n;
+    size_t  size;   // always a power of two
 };
 
 struct lexstats {
@@ -40,6 +63,7 @@ struct lexstats {
     struct prob_dist *ctxdist;
     struct prob_dist **wldist;
     struct prob_dist **ctxldist;
+    struct mem_acct *mem;
 };
 
 struct ctxlex {
@@ -51,7 +75,8 @@ struct ctxlex {
     size_t nalloc;
     struct lexstats *stats;
     GHashTable *lexhash;
-    GHashTable *ctxhash;
+    struct ctxtab ctx;
+    struct mem_acct *mem;   // for --mem-report, or NULL
 };
 
 struct ctxlex *ctxlex_new();
@@ -60,7 +85,20 @@ size_t ctxlex_freq(struct ctxlex *lex, char *s);
 size_t ctxlex_nctx(struct ctxlex *lex, char *s);
 double ctxlex_freq_z(struct ctxlex *lex, char *s);
 double ctxlex_nctx_z(struct ctxlex *lex, char *s);
+size_t ctxlex_freq_span(struct ctxlex *lex, strhash_t hv, const char *s,
+                        size_t len);
+size_t ctxlex_nctx_span(struct ctxlex *lex, strhash_t hv, const char *s,
+                        size_t len);
+double ctxlex_freq_z_span(struct ctxlex *lex, strhash_t hv, const char *s,
+                          size_t len);
+double ctxlex_nctx_z_span(struct ctxlex *lex, strhash_t hv, const char *s,
+                          size_t len);
+void ctxlex_scores_span(struct ctxlex *lex, strhash_t hv, const char *s,
+                        size_t len, int z, double *freq, double *nctx);
 void ctxlex_free(struct ctxlex *cl);
 
+void ctxlex_write_bin(FILE *fp, struct ctxlex *lex);
+struct ctxlex *ctxlex_read_bin(struct ckpt_buf *b);
+
 #endif // _CTXLEX_H
 
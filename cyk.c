@@ -24,6 +24,9 @@
 #include "lexicon.h"
 #include "strutils.h"
 #include "cyk.h"
+#include "tpool.h"
+#include "options.h"
+#include "mem.h"
 
 cyk_chart *
 cyk_chart_new(int size)
@@ -34,9 +37,11 @@ cyk_chart_new(int size)
     ret = malloc(sizeof (cyk_chart));
     ret->node = malloc (size * sizeof (cyk_chart_node *));
     ret->input = malloc (size * sizeof (char *));
+    ret->cell = malloc (size * sizeof (*ret->cell));
     ret->size = size;
     for(i = 0; i < size; i++) { 
         ret->node[i] = malloc ((size - i) * sizeof (cyk_chart_node));
+        ret->cell[i] = calloc ((size - i), sizeof (struct cyk_cell));
         for(j=0; j < size - i; j++){
             ret->node[i][j] = NULL;
         }
@@ -45,6 +50,19 @@ cyk_chart_new(int size)
     return ret;
 }
 
+static void
+cyk_cell_add(struct cyk_cell *cell, cyk_chart_node *node)
+{
+    if (cell->n == cell->nalloc) {
+        cell->nalloc = (cell->nalloc) ? 2 * cell->nalloc : 4;
+        cell->id = realloc(cell->id, cell->nalloc * sizeof (*cell->id));
+        cell->node = realloc(cell->node, cell->nalloc * sizeof (*cell->node));
+    }
+    cell->id[cell->n] = node->cat->id;
+    cell->node[cell->n] = node;
+    cell->n++;
+}
+
 void 
 cyk_chart_free(cyk_chart *chart)
 {
@@ -61,12 +79,16 @@ cyk_chart_free(cyk_chart *chart)
                 tmp = tmp->next;
                 free(tmp2);
             }
+            free(chart->cell[i][j].id);
+            free(chart->cell[i][j].node);
         }
+        free(chart->cell[i]);
         free(chart->node[i]);
         if(chart->input[i]) free(chart->input[i]);
     }
     free(chart->input);
     free(chart->node);
+    free(chart->cell);
     free(chart);
     
 }
@@ -101,6 +123,72 @@ cg_combine(cg_cat *catL, cg_cat *catR)
     }
 }
 
+/*
+ * cg_combine_id() - cg_combine() over category IDs 
+ *
+ * returns the ID of the resulting category, or -1 if the categories
+ * do not combine. the results are memoized in the lexicon, 
+ * l->comb[idL][idR] is 0 if not calculated yet, -1 if the 
+ * categories do not combine, and ID + 1 of the result otherwise.
+ */
+int
+cg_combine_id(cg_lexicon *l, int idL, int idR)
+{
+    int *row = l->comb[idL];
+    cg_cat *res;
+
+    if (row != NULL && idR < l->comb_len[idL] && row[idR] != 0) {
+        return (row[idR] > 0) ? row[idR] - 1 : -1;
+    }
+
+    if (idR >= l->comb_len[idL]) {
+        int n = l->nalloc_cats;
+        row = mem_realloc(l->mem, MEM_INDEX, row, n * sizeof (*row));
+        memset(row + l->comb_len[idL], 0, 
+               (n - l->comb_len[idL]) * sizeof (*row));
+        l->comb[idL] = row;
+        l->comb_len[idL] = n;
+    }
+
+    res = cg_combine(l->cats[idL], l->cats[idR]);
+    row[idR] = (res) ? res->id + 1 : -1;
+    return (res) ? res->id : -1;
+}
+
+/*
+ * cg_combine_id_ro() - same as cg_combine_id(), but never updates
+ *                      the memo table. 
+ *
+ * this is safe to call from multiple threads, as long as no other 
+ * thread calls cg_combine_id() at the same time.
+ */
+int
+cg_combine_id_ro(cg_lexicon *l, int idL, int idR)
+{
+    int *row = l->comb[idL];
+    cg_cat *res;
+
+    if (row != NULL && idR < l->comb_len[idL] && row[idR] != 0) {
+        return (row[idR] > 0) ? row[idR] - 1 : -1;
+    }
+
+    res = cg_combine(l->cats[idL], l->cats[idR]);
+    return (res) ? res->id : -1;
+}
+
+/*
+ * cyk_tpool() - return the thread pool to use for parsing an input of 
+ *               length N, or NULL if it should be parsed serially.
+ */
+struct tpool *
+cyk_tpool(size_t N)
+{
+    if (opt.parse_threads_arg > 1 && N >= opt.parse_minlen_arg) {
+        return tpool_shared(opt.parse_threads_arg);
+    }
+    return NULL;
+}
+
 
 /* This is a standard CYK parser. This function  returns only the chart.
  * 
@@ -117,9 +205,63 @@ cg_combine(cg_cat *catL, cg_cat *catR)
  *   
  */
 
+struct cyk_job {
+    cg_lexicon  *l;
+    cyk_chart   *chart;
+    int         i;
+    int         (*combine_id)(cg_lexicon *, int, int);
+};
+
+/*
+ * cyk_parse_cell() - fill the chart cell [job->i, j]
+ *
+ * cells on the same row (span length) only read from the rows above, 
+ * so they can be filled in any order, or in parallel.
+ */
+static void
+cyk_parse_cell(void *arg, int j, int tid)
+{
+    struct cyk_job *job = arg;
+    cyk_chart *chart = job->chart;
+    cg_lexicon *l = job->l;
+    int i = job->i;
+    int k;
+
+    for(k=1; k <= i; k++){
+        struct cyk_cell *cellL, *cellR;
+        int a, b;
+        int iL, iR, jL, jR; // indices for left/right consitituents 
+
+        iL = k - 1; jL = j;
+        iR = i - k; jR = j + k;
+        
+        /* search if any of the L,R pairs combine, the cells
+         * are visited in the order of the node lists.
+         */
+
+        cellL = &chart->cell[iL][jL];
+        cellR = &chart->cell[iR][jR];
+        for (a = cellL->n - 1; a >= 0; a--) {
+            for (b = cellR->n - 1; b >= 0; b--) {
+                int res = job->combine_id(l, cellL->id[a], cellR->id[b]);
+                if(res >= 0){
+                    chart->node[i][j] = cyk_node_new(l->cats[res], 
+                                               cellL->node[a], 
+                                               cellR->node[b], 
+                                               chart->node[i][j],
+                                               i, j);
+                    cyk_cell_add(&chart->cell[i][j], chart->node[i][j]);
+                }
+            }
+        }
+    }
+}
+
 cyk_chart *cyk_parse(cg_lexicon *l, char **input, size_t N)
 {
-    int i, j, k;
+    int i, j;
+    struct tpool *tp = cyk_tpool(N);
+    struct cyk_job job;
 
     cyk_chart *chart = cyk_chart_new(N);
 
@@ -139,48 +281,27 @@ cyk_chart *cyk_parse(cg_lexicon *l, char **input, size_t N)
             chart->node[0][j] = cyk_node_new(ll->lexi->cat, 
                                              NULL, NULL, chart->node[0][j],
                                              0, j);
+            cyk_cell_add(&chart->cell[0][j], chart->node[0][j]);
             ll = ll->next_hom;
         }
     }
 
+    job.l = l;
+    job.chart = chart;
+    job.combine_id = (tp) ? cg_combine_id_ro : cg_combine_id;
     for(i=1; i <= N; i++) {
-        for(j=0; j < (N - i ); j++){
-            for(k=1; k <= i; k++){
-                cyk_chart_node *nodeL, *nodeR;
-                cg_cat *catL, *catR;
-                int iL, iR, jL, jR; // indices for left/right consitituents 
-
-                iL = k - 1; jL = j;
-                iR = i - k; jR = j + k;
-                
-                /* search if any of the L,R pairs combine */
-                
-                nodeL = chart->node[iL][jL];
-                while(nodeL != NULL) {
-                    catL = nodeL->cat;
-                    nodeR = chart->node[iR][jR];
-                    while(nodeR != NULL) {
-                        cg_cat  *res;
-                        catR = nodeR->cat;
-                        res = cg_combine(catL, catR);
-                        if(res){
-                            chart->node[i][j] = cyk_node_new(res, 
-                                                       nodeL, nodeR, 
-                                                       chart->node[i][j],
-                                                       i, j);
-                        }
-                        nodeR = nodeR->next;
-                    }
-                    nodeL = nodeL->next;
-                }
-
+        job.i = i;
+        if (tp) {
+            tpool_run(tp, N - i, cyk_parse_cell, &job);
+        } else {
+            for(j=0; j < (N - i ); j++){
+                cyk_parse_cell(&job, j, 0);
             }
         }
     }
     return chart;
 }
 
-
 void 
 cyk_chart_write(FILE *fp, cyk_chart *chart)
 {
@@ -270,7 +391,7 @@ cyk_write_parses(FILE *fp, cyk_chart *chart)
 
     cyk_chart_node *tmp = chart->node[chart->size-1][0];
     int             i=1;
-    while(tmp) {
+    while(tmp && (opt.max_parses_arg <= 0 || i <= opt.max_parses_arg)) {
         fprintf(fp, "------------ Parse #%d:\n", i);
         cyk_write_parse(fp, tmp, chart);
         tmp = tmp->next;
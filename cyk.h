@@ -33,13 +33,28 @@ typedef struct cyk_chart_node {
     int                     i, j;   // span j: span start, i: span len
 } cyk_chart_node;
 
+/* 
+ * the category IDs of the nodes in a cell, kept in a dense array for
+ * the combination loop. node[k] is the k-th node added to the cell, 
+ * the linked list in cyk_chart->node is in the reverse order.
+ */
+struct cyk_cell {
+    int             n, nalloc;
+    int             *id;
+    cyk_chart_node  **node;
+};
+
 typedef struct cyk_chart {
     int            size;
     char           **input;
     cyk_chart_node ***node;
+    struct cyk_cell **cell;
 } cyk_chart;
 
 cg_cat *cg_combine(cg_cat *catL, cg_cat *catR);
+int cg_combine_id(cg_lexicon *l, int idL, int idR);
+int cg_combine_id_ro(cg_lexicon *l, int idL, int idR);
+struct tpool *cyk_tpool(size_t N);
 cyk_chart_node *cyk_node_new(cg_cat *cat, 
                               cyk_chart_node *bL, cyk_chart_node *bR, 
                               cyk_chart_node *next, 
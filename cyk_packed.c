@@ -23,6 +23,7 @@
 #include <string.h>
 #include "lexicon.h"
 #include "packed_chart.h"
+#include "tpool.h"
 
 /*
  * cg_combine(cg_cat *catL, cg_cat *catR)
@@ -60,10 +61,59 @@ cg_combine(cg_cat *catL, cg_cat *catR)
  *   
  */
 
+struct cyk_p_job {
+    cg_lexicon      *l;
+    struct chart    *chart;
+    unsigned short  i;
+    int             (*combine_id)(cg_lexicon *, int, int);
+};
+
+/*
+ * cyk_parse_p_cell() - fill the chart cell [job->i, j]
+ *
+ * see cyk_parse_cell() in cyk.c.
+ */
+static void
+cyk_parse_p_cell(void *arg, int j, int tid)
+{
+    struct cyk_p_job *job = arg;
+    struct chart *chart = job->chart;
+    cg_lexicon *l = job->l;
+    unsigned short i = job->i;
+    unsigned short k;
+
+    for(k=1; k <= i; k++){
+        struct chart_cell *cellL, *cellR;
+        int a, b;
+        unsigned short iL, iR, jL, jR; // indx for l/r consitituents 
+
+        iL = k - 1; jL = j;
+        iR = i - k; jR = j + k;
+        
+        /* search if any of the L,R pairs combine, the cells
+         * are visited in the order of the node lists.
+         */
+        
+        cellL = &chart->cell[iL][jL];
+        cellR = &chart->cell[iR][jR];
+        for (a = cellL->n - 1; a >= 0; a--) {
+            for (b = cellR->n - 1; b >= 0; b--) {
+                int res = job->combine_id(l, cellL->id[a], cellR->id[b]);
+                if(res >= 0){
+                    chart_node_add_t(chart, tid, i, j, l->cats[res], 
+                                     cellL->node[a], cellR->node[b]);
+                }
+            }
+        }
+    }
+}
+
 struct chart *
 cyk_parse_p(cg_lexicon *l, char **input, size_t N)
 {
-    unsigned short i, j, k;
+    unsigned short i, j;
+    struct tpool *tp = cyk_tpool(N);
+    struct cyk_p_job job;
 
     struct chart *chart = chart_new(N);
 
@@ -77,7 +127,7 @@ cyk_parse_p(cg_lexicon *l, char **input, size_t N)
             chart_free(chart);
             return NULL;
         } else {
-            chart->input[j] = strdup(input[j]);
+            chart_set_input(chart, j, input[j], strlen(input[j]));
         }
         while(ll){
             chart_node_add(chart, 0, j, ll->lexi->cat, NULL, NULL);
@@ -85,34 +135,20 @@ cyk_parse_p(cg_lexicon *l, char **input, size_t N)
         }
     }
 
+    job.l = l;
+    job.chart = chart;
+    job.combine_id = cg_combine_id;
+    if (tp) {
+        chart_threads(chart, tpool_size(tp));
+        job.combine_id = cg_combine_id_ro;
+    }
     for(i=1; i <= N; i++) {
-        for(j=0; j < (N - i ); j++){
-            for(k=1; k <= i; k++){
-                struct chart_node *nodeL, *nodeR;
-                cg_cat *catL, *catR;
-                unsigned short iL, iR, jL, jR; // indx for l/r consitituents 
-
-                iL = k - 1; jL = j;
-                iR = i - k; jR = j + k;
-                
-                /* search if any of the L,R pairs combine */
-                
-                nodeL = chart->node[iL][jL];
-                while(nodeL != NULL) {
-                    catL = nodeL->cat;
-                    nodeR = chart->node[iR][jR];
-                    while(nodeR != NULL) {
-                        cg_cat  *res;
-                        catR = nodeR->cat;
-                        res = cg_combine(catL, catR);
-                        if(res){
-                            chart_node_add(chart, i, j, res, nodeL, nodeR);
-                        }
-                        nodeR = nodeR->next;
-                    }
-                    nodeL = nodeL->next;
-                }
-
+        job.i = i;
+        if (tp) {
+            tpool_run(tp, N - i, cyk_parse_p_cell, &job);
+        } else {
+            for(j=0; j < (N - i ); j++){
+                cyk_parse_p_cell(&job, j, 0);
             }
         }
     }
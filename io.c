@@ -24,11 +24,15 @@
 #include <string.h>
 #include <assert.h>
 #include <malloc.h>
+#include <limits.h>
 #include "seg.h"
 #include "seglist.h"
 #include "io.h"
 #include "cclib_debug.h"
 #include "strutils.h"
+#include "mem.h"
+#include "checkpoint.h"
+#include "symtab.h"
 
 #define COMMENT_CHAR ';'
 #define MAX_LINE_LEN 256
@@ -64,6 +68,8 @@ read_input(char *inf)
 
     PINFO("reading file `%s'...\n", inf);
     ret = malloc(sizeof(struct input));
+    ret->mem = mem_acct_new("input", NULL, NULL);
+    mem_add(ret->mem, MEM_OTHER, ret);
     ret->size = 0;
     ret->nalloc = 0;
     ret->u = NULL;
@@ -89,7 +95,8 @@ read_input(char *inf)
         if(ret->size  >= ret->nalloc ) {
             struct input_rec    *tmp;
             ret->nalloc += BUFSIZ;
-            tmp = realloc(ret->u, ret->nalloc * sizeof (struct input_rec));
+            tmp = mem_realloc(ret->mem, MEM_BUF, ret->u, 
+                              ret->nalloc * sizeof (struct input_rec));
             if(tmp) {
                 ret->u = tmp;
             } else {
@@ -97,7 +104,8 @@ read_input(char *inf)
             }
             if (opt.stress_file_given) {
                 char **stmp;
-                stmp = realloc(ret->stress, ret->nalloc * sizeof (*stmp));
+                stmp = mem_realloc(ret->mem, MEM_BUF, ret->stress, 
+                                   ret->nalloc * sizeof (*stmp));
                 if(stmp) {
                     ret->stress = stmp;
                 } else {
@@ -106,14 +114,33 @@ read_input(char *inf)
             }
         }
 
-        str_rmch(linebuf, ' ', &ret->u[ret->size].seg);
-        str_strip(linebuf, " \t\n");
-        ret->u[ret->size].s = strdup(linebuf);
+        if (symtab_on) {
+            char *enc = symtab_encode(linebuf, &ret->u[ret->size].seg);
+
+            if (enc == NULL) {
+                PFATAL("invalid phoneme symbols, or more than %d, in "
+                       "utterance %zu of `%s'\n", SYMTAB_MAX, ret->size + 1, 
+                       inf);
+            }
+            free(linebuf);
+            linebuf = enc;
+        } else {
+            str_rmch(linebuf, ' ', &ret->u[ret->size].seg);
+            str_strip(linebuf, " \t\n");
+        }
+        mem_add(ret->mem, MEM_BUF, ret->u[ret->size].seg);
+        ret->u[ret->size].s = mem_strdup(ret->mem, MEM_BUF, linebuf);
+        ret->u[ret->size].id = symtab_ids(linebuf);
+        mem_add(ret->mem, MEM_BUF, ret->u[ret->size].id);
         if (opt.stress_file_given) {
             str_rmch(slinebuf, ' ', NULL);
             str_strip(slinebuf, " \t\n");
-            assert(strlen(linebuf) == strlen(slinebuf));
-            ret->stress[ret->size] = strdup(slinebuf);
+            if (strlen(linebuf) != strlen(slinebuf)) {
+                PFATAL("utterance %zu of the stress file has %zu stress "
+                       "marks for %zu phonemes\n", ret->size + 1, 
+                       strlen(slinebuf), strlen(linebuf));
+            }
+            ret->stress[ret->size] = mem_strdup(ret->mem, MEM_BUF, slinebuf);
             free(slinebuf);
         }
         ret->size++;
@@ -159,12 +186,14 @@ input_free(struct input *inp)
         free(inp->u[i].s);
         if(inp->u[i].seg)
             free(inp->u[i].seg);
+        free(inp->u[i].id);
         if(inp->stress && inp->stress[i]){
             free(inp->stress[i]);
         }
     }
     free(inp->u);
     if (inp->stress) free(inp->stress);
+    mem_acct_free(inp->mem);
     free(inp);
 }
 
@@ -174,10 +203,12 @@ output_new(size_t len)
 {
     struct output *ret = malloc(sizeof *ret);
 
+    ret->mem = mem_acct_new("output", NULL, NULL);
+    mem_add(ret->mem, MEM_OTHER, ret);
     if (len != 0) {
         ret->size = 0;
         ret->nalloc = len * sizeof (struct output_rec);
-        ret->u = malloc (ret->nalloc);
+        ret->u = mem_malloc(ret->mem, MEM_BUF, ret->nalloc);
         assert (ret->u != NULL);
     } else {
         ret->size = 0;
@@ -200,9 +231,25 @@ output_free(struct output *out)
         }
         free (out->u);
     }
+    mem_acct_free(out->mem);
     free(out);
 }
 
+/* seglist_count() - count the segmentations kept in the output */
+static void
+seglist_count(struct mem_acct *mem, struct seglist *segl)
+{
+    int i;
+
+    if (mem == NULL || segl == NULL) return;
+    mem_add(mem, MEM_BUF, segl);
+    mem_add(mem, MEM_BUF, segl->score);
+    mem_add(mem, MEM_BUF, segl->segs);
+    for (i = 0; i < segl->nsegs; i++) {
+        mem_add(mem, MEM_BUF, segl->segs[i]);
+    }
+}
+
 void 
 output_add(struct output *out, char *s, struct seglist *segs)
 {
@@ -211,18 +258,79 @@ output_add(struct output *out, char *s, struct seglist *segs)
     if(n * sizeof (struct output_rec) >= out->nalloc) {
         struct output_rec    *tmp;
         out->nalloc += BUFSIZ;
-        tmp = realloc(out->u, out->nalloc);
+        tmp = mem_realloc(out->mem, MEM_BUF, out->u, out->nalloc);
         if(tmp)
             out->u = tmp;
         else
             PFATAL("unable to allocate memory\n");
     }
 
-    out->u[out->size].s = strdup(s);
+    out->u[out->size].s = mem_strdup(out->mem, MEM_BUF, s);
     out->u[out->size].segl = segs;
+    seglist_count(out->mem, segs);
     ++out->size;
 }
 
+/* output_write_bin() - write the output so far to a checkpoint record */
+void
+output_write_bin(FILE *fp, struct output *out)
+{
+    size_t i;
+    int k;
+
+    ckpt_put_u64(fp, out->size);
+    for (i = 0; i < out->size; i++) {
+        struct seglist *segl = out->u[i].segl;
+
+        ckpt_put_str(fp, out->u[i].s);
+        ckpt_put_u64(fp, segl->nsegs);
+        for (k = 0; k < segl->nsegs; k++) {
+            unsigned short *seg = segl->segs[k];
+            uint64_t n = (seg) ? seg[0] + 1 : 0;
+
+            ckpt_put(fp, &segl->score[k], sizeof (*segl->score));
+            ckpt_put_u64(fp, n);
+            ckpt_put(fp, seg, n * sizeof (*seg));
+        }
+    }
+}
+
+/* output_read_bin() - append the records of a checkpoint to `out' */
+void
+output_read_bin(struct ckpt_buf *b, struct output *out)
+{
+    size_t n = ckpt_get_u64(b), i;
+
+    for (i = 0; i < n && !b->err; i++) {
+        const char *s = ckpt_get_str(b);
+        struct seglist *segl = seglist_new();
+        size_t nsegs = ckpt_get_u64(b), k;
+
+        for (k = 0; k < nsegs; k++) {
+            double score;
+            uint64_t len;
+            unsigned short *seg = NULL;
+
+            ckpt_get(b, &score, sizeof (score));
+            len = ckpt_get_u64(b);
+            if (len > USHRT_MAX + 1UL) {
+                PFATAL("`%s' of the checkpoint is not valid\n", b->tag);
+            }
+            if (len) {
+                seg = malloc(len * sizeof (*seg));
+                ckpt_get(b, seg, len * sizeof (*seg));
+                if (seg[0] + 1 != len) {
+                    PFATAL("`%s' of the checkpoint is not valid\n", b->tag);
+                }
+            }
+            seglist_add(segl, seg);
+            segl->score[k] = score;
+            free(seg);
+        }
+        output_add(out, (char *) s, segl);
+    }
+}
+
 void 
 output_write(char *outf, struct output *out)
 {
@@ -250,4 +358,76 @@ PINFO("ourput_write: 0..%zd\n", out->size);
     }
 }
 
+/* 
+ * lexicon_recode() - a copy of `L' with the words encoded with the
+ *                    symbol table, or decoded if `decode' is set
+ *
+ * the items are added in the order they were added to `L'. returns 
+ * NULL if a word has invalid symbols, or too many of them.
+ */
+static cg_lexicon *
+lexicon_recode(cg_lexicon *L, int decode)
+{
+    cg_lexicon *R = cg_lexicon_new();
+    cg_lexilist *ll;
+    size_t n = 0, i;
+    cg_lexi **items;
+
+    for (ll = L->ll; ll; ll = ll->next) n++;
+    items = malloc(n * sizeof (*items));
+    for (ll = L->ll, i = n; ll; ll = ll->next) items[--i] = ll->lexi;
+
+    for (i = 0; i < n; i++) {
+        char *pf = (decode) ? symtab_decode(items[i]->pf)
+                            : symtab_encode(items[i]->pf, NULL);
+
+        if (pf == NULL) {
+            PERROR("invalid phoneme symbols, or more than %d, in the "
+                   "lexicon word `%s'\n", SYMTAB_MAX, items[i]->pf);
+            cg_lexicon_free(R);
+            R = NULL;
+            break;
+        }
+        cg_lexicon_add_f(R, pf, items[i]->cat->str, items[i]->lf, 
+                         items[i]->freq);
+        free(pf);
+    }
+    free(items);
+    return R;
+}
+
+/* inlex_read() - the lexicon in the -I file `fn', with the words
+ *                encoded if there is a symbol table. NULL if it 
+ *                cannot be loaded.
+ */
+cg_lexicon *
+inlex_read(char *fn)
+{
+    cg_lexicon *L = cg_lexicon_load(fn), *E;
+
+    if (L == NULL || !symtab_on) return L;
+    E = lexicon_recode(L, 0);
+    cg_lexicon_free(L);
+    return E;
+}
 
+/* outlex_write() - write the lexicon `L' to the --outlex file 
+ *                  in the format selected with --outlex-format,
+ *                  with the words decoded if there is a symbol table.
+ */
+void
+outlex_write(cg_lexicon *L)
+{
+    cg_lexicon *D = NULL;
+
+    if (symtab_on) {
+        if ((D = lexicon_recode(L, 1)) == NULL) return;
+        L = D;
+    }
+    if (opt.outlex_format_arg == outlex_format_arg_binary) {
+        cg_lexicon_save_bin(opt.outlex_arg, L);
+    } else {
+        cg_lexicon_save(opt.outlex_arg, L);
+    }
+    if (D) cg_lexicon_free(D);
+}
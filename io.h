@@ -22,18 +22,26 @@
 #define _IO_H 1
 
 #include <stdlib.h>
+#include <stdint.h>
 #include "seglist.h"
+#include "lexicon.h"
+
+struct mem_acct;
+struct ckpt_buf;
 
 struct input_rec {
     char            *s;    // the input string, without delimeters
     unsigned short  *seg;  // offsets to each segment seg[0] is the number
-};                         // of segments, seg[n] is offset to nth seg.
+                           // of segments, seg[n] is offset to nth seg.
+    uint16_t        *id;   // the symbol IDs of the phonemes of s
+};
 
 struct input {
     size_t              size;
     size_t              nalloc;  // for memory management
     struct input_rec    *u;
     char                **stress; //stress pattern. has to match with u.s, can be NULL
+    struct mem_acct     *mem;     // for --mem-report, or NULL
 };
 
 struct output_rec {
@@ -45,6 +53,7 @@ struct output {
     size_t              size;
     size_t              nalloc; // for memory management
     struct output_rec   *u;
+    struct mem_acct     *mem;   // for --mem-report, or NULL
 };
 
 struct input *read_input(char *infile);
@@ -55,7 +64,11 @@ void output_write(char *outfile, struct output *O);
 void output_add(struct output *out, char *s, struct seglist *segs);
 struct output * output_new(size_t len);
 void output_free(struct output *out);
+void output_write_bin(FILE *fp, struct output *out);
+void output_read_bin(struct ckpt_buf *b, struct output *out);
 void shuffle_input(struct input *in);
+cg_lexicon *inlex_read(char *fname);
+void outlex_write(cg_lexicon *L);
 
 #endif // _IO_H
 
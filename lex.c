@@ -25,32 +25,54 @@
 #include <math.h>
 #include "ub.h"
 
-static inline void
-chart_word(char *w, struct chart *c, short pos, short end)
+/* chart_span_hash() - prefix hashes of the chart input
+ *
+ * the inputs of the segmentation charts are single characters, 
+ * a word spanning the cells j..k is the span [j, k] of the returned
+ * string.
+ */
+static inline struct span_hash *
+chart_span_hash(struct chart *c)
 {
+    static __thread struct span_hash sh;
+    char s[c->size + 1];
     int k;
-    strcpy(w, "");
-    for(k=pos; k <= end; k++) {
-        strcat(w, c->input[k]);
+
+    for (k = 0; k < c->size; k++) {
+        assert(c->input[k][0] != '\0' && c->input[k][1] == '\0');
+        s[k] = c->input[k][0];
     }
+    span_hash_set(&sh, s, c->size, 0, 0);
+    return &sh;
+}
+
+static inline size_t
+chart_word_freq(cg_lexicon *L, struct span_hash *sh, short pos, short end)
+{
+    return cg_lexicon_get_freq_span(L, span_hash_get(sh, pos, end - pos + 1),
+                                    sh->s + pos, end - pos + 1);
 }
 
 double 
-word_score(char *s, struct ctxlex *cL, enum m_id mid) 
+word_score(struct span_hash *sh, short pos, short end, 
+           struct ctxlex *cL, enum m_id mid, 
+           const struct gengetopt_args_info *o) 
 {
     double sc;
+    size_t len = end - pos + 1;
+    strhash_t hv = span_hash_get(sh, pos, len);
     
     if (mid == M_LFB || mid == M_LFE) {
-        if (opt.lex_norm_arg == lex_norm_arg_none) {
-            sc = (double) ctxlex_freq(cL, s);
+        if (o->lex_norm_arg == lex_norm_arg_none) {
+            sc = (double) ctxlex_freq_span(cL, hv, sh->s + pos, len);
         } else {
-            sc = ctxlex_freq_z(cL, s);
+            sc = ctxlex_freq_z_span(cL, hv, sh->s + pos, len);
         }
     }else {
-        if (opt.lex_norm_arg == lex_norm_arg_none) {
-            sc = (double) ctxlex_nctx(cL, s);
+        if (o->lex_norm_arg == lex_norm_arg_none) {
+            sc = (double) ctxlex_nctx_span(cL, hv, sh->s + pos, len);
         } else {
-            sc = ctxlex_nctx_z(cL, s);
+            sc = ctxlex_nctx_z_span(cL, hv, sh->s + pos, len);
         }
     }
 
@@ -61,24 +83,25 @@ double
 score_words_before(cg_lexicon *L, struct chart *c, 
                    struct ctxlex *cL, 
                    enum m_id mid, 
-                   short pos)
+                   short pos,
+                   const struct gengetopt_args_info *o)
 {
     int i, j;
     double best = -INFINITY;
     double sum = 0.0;
     int count = 0;
+    struct span_hash *sh;
     assert (c != NULL);
     assert (pos > 0);
 
+    sh = chart_span_hash(c);
     i = pos - 1;
     for (j = 0; j < pos; j++) {
         struct chart_node *node = c->node[i][j];
         
         while (node != NULL) {
             if (node->back == NULL) {
-                char w[pos - j + 1];
-                chart_word(w, c, j, pos - 1);
-                double sc = word_score(w, cL, mid);
+                double sc = word_score(sh, j, pos - 1, cL, mid, o);
                 sum += sc;
                 if (sc > best) best = sc;
                 count++;
@@ -88,7 +111,7 @@ score_words_before(cg_lexicon *L, struct chart *c,
         }
         --i;
     }
-    switch (opt.lex_wcombine_arg) {
+    switch (o->lex_wcombine_arg) {
     case lex_wcombine_arg_best:
         return best;
     break;
@@ -109,22 +132,23 @@ double
 score_words_after(cg_lexicon *L, struct chart *c, 
                    struct ctxlex *cL, 
                    enum m_id mid, 
-                   short pos)
+                   short pos,
+                   const struct gengetopt_args_info *o)
 {
     int i, count = 0;
     double best = -INFINITY;
     double sum = 0.0;
+    struct span_hash *sh;
     assert (c != NULL);
     assert (pos > 0);
 
+    sh = chart_span_hash(c);
     for (i = c->size - pos - 1; i > 0; i--) {
         struct chart_node *node = c->node[i][pos];
         
         while (node != NULL) {
             if (node->back == NULL) {
-                char w[i + 1];
-                chart_word(w, c, pos, pos + i);
-                double sc = word_score(w, cL, mid);
+                double sc = word_score(sh, pos, pos + i, cL, mid, o);
                 sum += sc;
                 if (sc > best) best = sc;
                 count++;
@@ -133,7 +157,7 @@ score_words_after(cg_lexicon *L, struct chart *c,
             node = node->next;
         }
     }
-    switch (opt.lex_wcombine_arg) {
+    switch (o->lex_wcombine_arg) {
     case lex_wcombine_arg_best:
         return best;
     break;
@@ -155,9 +179,11 @@ words_before(cg_lexicon *L, struct chart *c, short pos, short freq)
 {
     int i, j;
     int count = 0;
+    struct span_hash *sh = NULL;
     assert (c != NULL);
     assert (pos > 0);
 
+    if (freq) sh = chart_span_hash(c);
     i = pos - 1;
     for (j = 0; j < pos; j++) {
         struct chart_node *node = c->node[i][j];
@@ -166,9 +192,7 @@ words_before(cg_lexicon *L, struct chart *c, short pos, short freq)
             if (node->back == NULL) {
                 int delta = 1;
                 if(freq) {
-                    char w[pos - j + 1];
-                    chart_word(w, c, j, pos - 1);
-                    delta = cg_lexicon_get_freq_pf(L, w);
+                    delta = chart_word_freq(L, sh, j, pos - 1);
                 }
                 count += delta;
                 break;
@@ -185,9 +209,11 @@ int
 words_after(cg_lexicon *L, struct chart *c, short pos, short freq)
 {
     int i, count = 0;
+    struct span_hash *sh = NULL;
     assert (c != NULL);
     assert (pos > 0);
 
+    if (freq) sh = chart_span_hash(c);
     for (i = c->size - pos - 1; i > 0; i--) {
         struct chart_node *node = c->node[i][pos];
         
@@ -195,9 +221,7 @@ words_after(cg_lexicon *L, struct chart *c, short pos, short freq)
             if (node->back == NULL) {
                 int delta = 1;
                 if(freq) {
-                    char w[i + 1];
-                    chart_word(w, c, pos, pos + i);
-                    delta = cg_lexicon_get_freq_pf(L, w);
+                    delta = chart_word_freq(L, sh, pos, pos + i);
                 }
                 count += delta;
                 break;
@@ -215,9 +239,11 @@ best_word_before(cg_lexicon *L, struct chart *c, short pos)
     int i, j;
     char *ret = NULL;
     int max_freq = 0;
+    struct span_hash *sh;
     assert (c != NULL);
     assert (pos > 0);
 
+    sh = chart_span_hash(c);
     i = pos - 1;
     for (j = 0; j < pos; j++) {
         struct chart_node *node = c->node[i][j];
@@ -231,18 +257,11 @@ best_word_before(cg_lexicon *L, struct chart *c, short pos)
             node = node->next;
         }
         if (found) {
-            int k;
-            int freq;
-            char word[pos - j + 1];
-            strcpy(word, "");
-            for(k=j; k < pos; k++) {
-                strcat(word, c->input[k]);
-            }
-            freq = cg_lexicon_get_freq_pf(L, word);
+            int freq = chart_word_freq(L, sh, j, pos - 1);
             if (freq > max_freq) {
                 max_freq = freq;
                 if (ret != NULL) free(ret);
-                ret = strdup(word);
+                ret = strndup(sh->s + j, pos - j);
             }
         }
         --i;
@@ -256,9 +275,11 @@ best_word_after(cg_lexicon *L, struct chart *c, short pos)
     int i;
     char *ret = NULL;
     int max_freq = 0;
+    struct span_hash *sh;
     assert (c != NULL);
     assert (pos > 0);
 
+    sh = chart_span_hash(c);
 // printf("--- bwa: pos %d: ", pos);
     for (i = c->size - pos - 1; i > 0; i--) {
         struct chart_node *node = c->node[i][pos];
@@ -272,18 +293,11 @@ best_word_after(cg_lexicon *L, struct chart *c, short pos)
             node = node->next;
         }
         if (found) {
-            int k;
-            char word[i + 1];
-            int freq;
-            strcpy(word, "");
-            for(k=pos; k <= pos + i; k++) {
-                strcat(word, c->input[k]);
-            }
-            freq = cg_lexicon_get_freq_pf(L, word);
+            int freq = chart_word_freq(L, sh, pos, pos + i);
             if (freq > max_freq) {
                 max_freq = freq;
                 if (ret != NULL) free(ret);
-                ret = strdup(word);
+                ret = strndup(sh->s + pos, i + 1);
             }
         }
     }
@@ -291,8 +305,142 @@ best_word_after(cg_lexicon *L, struct chart *c, short pos)
 }
 
 
+/*
+ * lexical evidence of the current utterance
+ *
+ * all LF/LC measures, in both directions and in all --lex-mult copies,
+ * score the same words of the same chart. lexev_update() looks up 
+ * each word once, and collects the sum, best and number of the word 
+ * scores for every boundary position. calc_lex_list() then only 
+ * combines them as requested by --lex-wcombine.
+ *
+ * the evidence is kept per thread, models used from different threads
+ * (see libseg.h) do not share it. the charts are numbered across all 
+ * threads, so a chart of another model is never taken for the last one.
+ */
+enum {LEXEV_LF, LEXEV_LC, LEXEV_NKIND};
+enum {LEXEV_B, LEXEV_E, LEXEV_NDIR};
+
+static __thread struct {
+    unsigned long   gen;    // chart->gen of the chart scored
+    struct ctxlex   *cL;
+    int             nalloc;
+    double          *sum[LEXEV_NKIND][LEXEV_NDIR];
+    double          *best[LEXEV_NKIND][LEXEV_NDIR];
+    int             *count[LEXEV_NDIR];
+} lexev;
+
+static inline int
+chart_has_word(struct chart *c, int i, int j)
+{
+    struct chart_node *node;
+
+    for (node = c->node[i][j]; node != NULL; node = node->next) {
+        if (node->back == NULL) return 1;
+    }
+    return 0;
+}
+
+static inline void
+lexev_add(int dir, int pos, double *sc)
+{
+    int k;
+
+    for (k = 0; k < LEXEV_NKIND; k++) {
+        lexev.sum[k][dir][pos] += sc[k];
+        if (sc[k] > lexev.best[k][dir][pos]) lexev.best[k][dir][pos] = sc[k];
+    }
+    ++lexev.count[dir][pos];
+}
+
+/* lexev_update() - score the words in chart `c'
+ *
+ * the words ending before a boundary are visited from the longest to 
+ * the shortest, the order score_words_before() and score_words_after()
+ * use, so that the sums are exactly the same.
+ */
+static void
+lexev_update(struct chart *c, struct ctxlex *cL, 
+             const struct gengetopt_args_info *o)
+{
+    int n = c->size, i, j, k, d;
+    int z = (o->lex_norm_arg != lex_norm_arg_none);
+    struct span_hash *sh;
+
+    if (lexev.gen == c->gen && lexev.cL == cL) return;
+    lexev.gen = c->gen;
+    lexev.cL = cL;
+
+    if (lexev.nalloc < n + 1) {
+        lexev.nalloc = n + 1;
+        for (d = 0; d < LEXEV_NDIR; d++) {
+            for (k = 0; k < LEXEV_NKIND; k++) {
+                lexev.sum[k][d] = realloc(lexev.sum[k][d], 
+                                    lexev.nalloc * sizeof (double));
+                lexev.best[k][d] = realloc(lexev.best[k][d], 
+                                    lexev.nalloc * sizeof (double));
+            }
+            lexev.count[d] = realloc(lexev.count[d], 
+                                     lexev.nalloc * sizeof (int));
+        }
+    }
+    for (d = 0; d < LEXEV_NDIR; d++) {
+        for (k = 0; k < LEXEV_NKIND; k++) {
+            for (j = 0; j <= n; j++) {
+                lexev.sum[k][d][j] = 0.0;
+                lexev.best[k][d][j] = -INFINITY;
+            }
+        }
+        memset(lexev.count[d], 0, (n + 1) * sizeof (int));
+    }
+
+    sh = chart_span_hash(c);
+    for (i = n - 1; i >= 0; i--) {          // word length - 1
+        for (j = 0; j + i < n; j++) {       // word start
+            int before = (j + i + 1 < n),   // boundaries in the utterance
+                after = (j > 0 && i > 0);
+            double sc[LEXEV_NKIND];
+
+            if (!(before || after) || !chart_has_word(c, i, j)) continue;
+
+            ctxlex_scores_span(cL, span_hash_get(sh, j, i + 1), sh->s + j,
+                               i + 1, z, &sc[LEXEV_LF], &sc[LEXEV_LC]);
+            if (before) lexev_add(LEXEV_B, j + i + 1, sc);
+            if (after) lexev_add(LEXEV_E, j, sc);
+        }
+    }
+}
+
+/* lexev_list() - write the values of the measure `mid' for a string
+ *                of length `len' to `lexl'
+ */
+static void
+lexev_list(enum m_id mid, int len, double *lexl, int wcombine)
+{
+    int k = (mid == M_LFB || mid == M_LFE) ? LEXEV_LF : LEXEV_LC,
+        d = (mid == M_LFB || mid == M_LCB) ? LEXEV_B : LEXEV_E;
+    int j;
+
+    lexl[0] = 0.0;
+    switch (wcombine) {
+    case lex_wcombine_arg_best:
+        for (j = 1; j < len; j++) lexl[j] = lexev.best[k][d][j];
+    break;
+    case lex_wcombine_arg_sum:
+        for (j = 1; j < len; j++) lexl[j] = lexev.sum[k][d][j];
+    break;
+    case lex_wcombine_arg_mean:
+        for (j = 1; j < len; j++) {
+            lexl[j] = lexev.sum[k][d][j] / (double) lexev.count[d][j];
+        }
+    break;
+    default:
+        assert(!"this should not happen");
+    break;
+    }
+    lexl[len] = 0.0;
+}
 
-// TODO: avoid multiple lexicon lookups.
 static inline double 
 _calc_lex_single(struct phonstats *ps, struct mdata *m, int pos, int len)
 {
@@ -309,11 +457,13 @@ _calc_lex_single(struct phonstats *ps, struct mdata *m, int pos, int len)
     switch (m->info->mid) {
     case M_LFB:
     case M_LCB:
-        val = score_words_before(m->L, m->c, m->cL, m->info->mid, pos);
+        val = score_words_before(m->L, m->c, m->cL, m->info->mid, pos, 
+                                 m->opt);
     break;
     case M_LFE:
     case M_LCE:
-        val = score_words_after(m->L, m->c, m->cL, m->info->mid, pos);
+        val = score_words_after(m->L, m->c, m->cL, m->info->mid, pos, 
+                                m->opt);
     break;
     default: 
         assert(!"we should not be here!");
@@ -333,32 +483,31 @@ calc_lex_single(struct phonstats *ps, struct mdata *m, int pos)
 
 
 double *
-calc_lex_list(struct phonstats *ps, struct mdata *m)
+calc_lex_list(struct phonstats *ps, struct mdata *m, double *out)
 {
     int len = strlen(m->s);
-    int j = 0;
-    double *lexl = NULL;
-    short  chart_alloc = 0;
+    double *lexl = out;
+    struct chart *c = m->c;
+    static __thread struct chart *tmp_chart = NULL;
 
     assert(m->L != NULL);
 
-    if(m->c == NULL) {
-        m->c = seg_parse(m->L, m->s, seg_combine);
-        chart_alloc = 1;
+    if(c == NULL) { // the caller did not provide a chart
+        tmp_chart = seg_parse_chart(tmp_chart, m->L, m->s, seg_combine);
+        m->c = tmp_chart;
     }
 
-    lexl = malloc((len + 1) * sizeof (*lexl));
+    assert(m->info->mid == M_LFB || 
+           m->info->mid == M_LFE ||
+           m->info->mid == M_LCB ||
+           m->info->mid == M_LCE );
+    assert(m->c->size == len);
 
-    lexl[0] = 0.0;
-    for (j = 1; j < len; j++) {
-        lexl[j] = _calc_lex_single(ps, m, j, len);
-    }
-    lexl[len] = 0.0;
+    if (lexl == NULL) lexl = malloc((len + 1) * sizeof (*lexl));
+    lexev_update(m->c, m->cL, m->opt);
+    lexev_list(m->info->mid, len, lexl, m->opt->lex_wcombine_arg);
 
-    if (chart_alloc) {
-        chart_free(m->c);
-        m->c = NULL;
-    }
+    m->c = c;
 
 //    print_pred_list(m->s, lexl);
     return lexl;
@@ -378,20 +527,21 @@ lex_add_measure(struct mdlist *mdl, enum m_id mid, struct cg_lexicon *L, struct
 int
 lex_init(struct mdlist *mdl, struct cg_lexicon *L, struct phonstats *ps, struct ctxlex *cL)
 {
+    const struct gengetopt_args_info *o = mdl->opt;
     int j;
     int votec = 0;
-    int lr = (opt.lex_dir_arg == lex_dir_arg_both ||
-              opt.lex_dir_arg == lex_dir_arg_lr);
-    int rl = (opt.lex_dir_arg == lex_dir_arg_both || 
-              opt.lex_dir_arg == lex_dir_arg_rl);
-    int mcount = (opt.lex_given) ? opt.lex_given : 1;
+    int lr = (o->lex_dir_arg == lex_dir_arg_both ||
+              o->lex_dir_arg == lex_dir_arg_lr);
+    int rl = (o->lex_dir_arg == lex_dir_arg_both || 
+              o->lex_dir_arg == lex_dir_arg_rl);
+    int mcount = (o->lex_given) ? o->lex_given : 1;
 
 
 
-    for (j = 0; j < opt.lex_mult_arg; j++) {
+    for (j = 0; j < o->lex_mult_arg; j++) {
         int mi;
         for(mi = 0; mi < mcount; mi++) {
-            switch (opt.lex_arg[mi]) {
+            switch (o->lex_arg[mi]) {
             case lex_arg_lf:
                 if(lr) 
                     votec += lex_add_measure(mdl, M_LFE, L, NULL, cL);
@@ -404,11 +554,13 @@ lex_init(struct mdlist *mdl, struct cg_lexicon *L, struct phonstats *ps, struct
                 if(rl)
                     votec += lex_add_measure(mdl, M_LCB, L, NULL, cL);
             break;
-            case lex_arg_lp:
-                votec += ub_init(mdl, ps, M_LPE, M_LPB);
-            break;
+            case lex_arg_lp: {
+                int n = ub_init(mdl, ps, M_LPE, M_LPB);
+                if (n < 0) return -1;
+                votec += n;
+            } break;
             default:
-                printf("%d: %d\n", mi, opt.lex_arg[mi]);
+                printf("%d: %d\n", mi, o->lex_arg[mi]);
                 assert(!"we should not be here!");
             }
         }
@@ -421,9 +573,11 @@ void
 print_words_before(cg_lexicon *L, struct chart *c, short pos)
 {
     int i, j;
+    struct span_hash *sh;
     assert (c != NULL);
     assert (pos > 0);
 
+    sh = chart_span_hash(c);
     i = pos - 1;
     for (j = 0; j < pos; j++) {
         struct chart_node *node = c->node[i][j];
@@ -437,15 +591,8 @@ print_words_before(cg_lexicon *L, struct chart *c, short pos)
             node = node->next;
         }
         if (found) {
-//            int k;
-            char word[pos - j + 1];
-//            strcpy(word, "");
-//            printf("wb[%d]: ", pos);
-chart_word(word, c, j, pos - 1);
-//            for(k=j; k < pos; k++) {
-//                strcat(word, c->input[k]);
-//            }
-            printf("%s :: %zu\n", word, cg_lexicon_get_freq_pf(L, word));
+            printf("%.*s :: %zu\n", pos - j, sh->s + j,
+                   chart_word_freq(L, sh, j, pos - 1));
         }
         --i;
     }
@@ -455,9 +602,11 @@ void
 print_words_after(cg_lexicon *L, struct chart *c, short pos)
 {
     int i;
+    struct span_hash *sh;
     assert (c != NULL);
     assert (pos > 0);
 
+    sh = chart_span_hash(c);
     for (i = c->size - pos - 1; i > 0; i--) {
         struct chart_node *node = c->node[i][pos];
         int found = 0;
@@ -470,15 +619,8 @@ print_words_after(cg_lexicon *L, struct chart *c, short pos)
             node = node->next;
         }
         if (found) {
-//            int k;
-            char word[i + 1];
-//            strcpy(word, "");
-//            printf("wa[%d]:", pos);
-//            for(k=pos; k <= pos + i; k++) {
-//                strcat(word, c->input[k]);
-//            }
-chart_word(word, c, pos, pos + i);
-            printf("%s :: %zu\n", word, cg_lexicon_get_freq_pf(L, word));
+            printf("%.*s :: %zu\n", i + 1, sh->s + pos,
+                   chart_word_freq(L, sh, pos, pos + i));
         }
     }
 }
@@ -31,7 +31,7 @@ int words_before(cg_lexicon *L, struct chart *c, short pos, short freq);
 int words_after(cg_lexicon *L, struct chart *c, short pos, short freq);
 
 double calc_lex_single(struct phonstats *ps, struct mdata *m, int pos);
-double *calc_lex_list(struct phonstats *ps, struct mdata *m);
+double *calc_lex_list(struct phonstats *ps, struct mdata *m, double *out);
 
 int lex_init(struct mdlist *mdl, struct cg_lexicon *L, struct phonstats *ps, struct ctxlex *cL);
 
@@ -24,6 +24,7 @@
 #include "seglist.h"
 #include "segparse.h"
 #include "lexc.h"
+#include "strutils.h"
 
 
 static double
@@ -40,33 +41,71 @@ wscore(cg_lexicon *L, char *w, char *pw, char *nw)
 }
 
 static double
-uscore(unsigned short *seg, char *u)
+uscore(unsigned short nsegs)
 {
-    int nsegs = seg[0] + 1;
     return 1.0 / (double) nsegs;
 }
 
-void
-lexc_segl_score(struct seglist *segl, 
-              cg_lexicon *L, 
-              struct phonstats *ps, 
-              struct phonstats *lps, 
-              char *u)
+/* 
+ * score functions for get_segs_best(), word scores depend only on
+ * the span, so they are calculated once for each lattice edge.
+ */
+struct lexc_sdata {
+    cg_lexicon  *L;
+    char        *u;
+};
+
+static double
+lexc_wscore(struct chart *c, unsigned short start, unsigned short len,
+            void *data)
 {
-    int i, j;
-
-    for (i = 0; i < segl->nsegs; i++) {
-        double score=0.0;
-        char **words = seg_to_strlist(u, segl->segs[i]);
-        int nsegs = segl->segs[i][0] + 1;
-        for (j = 0; j < nsegs; j++) {
-            score += wscore(L, words[j], NULL, NULL);
-        }
-        segl->score[i] = (uscore(segl->segs[i], u) * score) / (double) nsegs;
-        free_strlist(words);
+    struct lexc_sdata *d = data;
+    char w[len + 1];
+
+    str_rangecpy(w, d->u, start, len);
+    return wscore(d->L, w, NULL, NULL);
+}
+
+static double
+lexc_pscore(double wsum, unsigned short nwords, void *data)
+{
+    return (uscore(nwords) * wsum) / (double) nwords;
+}
+
+/* lexc_partial_opt() - the segparse option for --lexicon-partial */
+enum segparse_opt
+lexc_partial_opt()
+{
+    switch (opt.lexicon_partial_arg) {
+        case lexicon_partial_arg_all:
+            return SPOPT_ALL;
+        case lexicon_partial_arg_one:
+            return SPOPT_ONE;
+        case lexicon_partial_arg_begin:
+            return SPOPT_BEGIN;
+        case lexicon_partial_arg_end:
+            return SPOPT_END;
+        case lexicon_partial_arg_beginend:
+            return SPOPT_BEGINEND;
+        case lexicon_partial_arg_none:
+        default:
+            return SPOPT_NONE;
     }
 }
 
+/*
+ * lexc_segl_best() - the best segmentation of `u' parsed as `c', 
+ *                    with its score
+ */
+struct seglist *
+lexc_segl_best(struct chart *c, cg_lexicon *L, char *u, 
+               enum segparse_opt o)
+{
+    struct lexc_sdata d = {L, u};
+
+    return get_segs_best(c, o, lexc_wscore, lexc_pscore, &d, 1);
+}
+
 unsigned short *
 lexc_best_seg(cg_lexicon *L, 
              struct phonstats *ps, 
@@ -75,49 +114,24 @@ lexc_best_seg(cg_lexicon *L,
 {
     struct chart *c = seg_parse(L, u, seg_combine);
     struct seglist *segl;
-    int best_seg = 0;
-    double max_score = 0.0;
     unsigned short *seg;
-    int i;
 
     if (!opt.lexicon_partial_given) { // default is partial segmentation
         opt.lexicon_partial_arg = lexicon_partial_arg_all;
     }
 
-    switch (opt.lexicon_partial_arg) {
-        case lexicon_partial_arg_all:
-            segl = get_segs_partial_opt(c, SPOPT_ALL);
-        break;
-        case lexicon_partial_arg_one:
-            segl = get_segs_partial_opt(c, SPOPT_ONE);
-        break;
-        case lexicon_partial_arg_begin:
-            segl = get_segs_partial_opt(c, SPOPT_BEGIN);
-        break;
-        case lexicon_partial_arg_end:
-            segl = get_segs_partial_opt(c, SPOPT_END);
-        break;
-        case lexicon_partial_arg_beginend:
-            segl = get_segs_partial_opt(c, SPOPT_BEGINEND);
-        break;
-        case lexicon_partial_arg_none:
-        default:
-            segl = get_segs_full(c);
-        break;
-    }
-
-    lexc_segl_score(segl, L, ps, lps, u);
+    segl = lexc_segl_best(c, L, u, lexc_partial_opt());
+    chart_free(c);
 
-    for (i = 0; i < segl->nsegs; i++) {
-        if (segl->score[i] > max_score) {
-            max_score = segl->score[i];
-            best_seg = i;
-        }
+    if (segl->nsegs == 0 || segl->segs[0] == NULL) {
+        seg = malloc(sizeof (*seg));
+        seg[0] = 0;
+    } else {
+        int seglen = (1 + segl->segs[0][0]) * sizeof (*seg);
+        seg = malloc(seglen);
+        memcpy(seg, segl->segs[0], seglen);
     }
-
-    int seglen = (1 + segl->segs[best_seg][0]) * sizeof (*seg);
-    seg = malloc(seglen);
-    memcpy(seg, segl->segs[best_seg], seglen);
+    seglist_free(segl);
 
     return seg;
 }
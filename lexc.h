@@ -23,13 +23,11 @@
 #include "options.h"
 #include "lexicon.h"
 #include "phonstats.h"
+#include "segparse.h"
 
-
-void lexc_segl_score(struct seglist *segl,
-                     cg_lexicon *L,
-                     struct phonstats *ps,
-                     struct phonstats *lps,
-                      char *u);
+enum segparse_opt lexc_partial_opt();
+struct seglist *lexc_segl_best(struct chart *c, cg_lexicon *L, char *u,
+                               enum segparse_opt o);
 
 unsigned short *lexc_best_seg(cg_lexicon *L, 
                               struct phonstats *ps, 
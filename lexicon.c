@@ -23,7 +23,29 @@
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "strutils.h"
+#include "strhash.h"
+#include "profile.h"
+#include "mem.h"
+
+/* lexicon_mem_refresh() - the overhead of the pf, lf and category 
+ *                         hashes, and the Bloom filter
+ */
+static void
+lexicon_mem_refresh(struct mem_acct *a, void *owner)
+{
+    cg_lexicon *l = owner;
+
+    a->bytes[MEM_HASH] = mem_hash_bytes(l->pfhash) 
+                         + mem_hash_bytes(l->lfhash)
+                         + mem_hash_bytes(l->cathash)
+                         + bloom_bytes(l->pfbloom);
+}
 
 /*
  * cg_lexicon_new()
@@ -37,11 +59,14 @@ cg_lexicon_new()
     cg_lexicon *new;
 
     new = malloc(sizeof(*new));
+    new->mem = mem_acct_new("lexicon", lexicon_mem_refresh, new);
+    mem_add(new->mem, MEM_OTHER, new);
 
-    new->pfhash = g_hash_table_new(g_str_hash, g_str_equal);
+    new->pfhash = g_hash_table_new(str_hash, str_equal);
+    new->pfbloom = bloom_new("lexicon");
     new->lfhash = g_hash_table_new(g_str_hash, g_str_equal);
     new->cathash = g_hash_table_new(g_str_hash, g_str_equal);
-    new->stats = malloc (sizeof(*new->stats));
+    new->stats = mem_malloc(new->mem, MEM_OTHER, sizeof(*new->stats));
     new->stats->n_typ = 0;
     new->stats->n_tok = 0;
     new->stats->n_typ_pf = 0;
@@ -50,10 +75,54 @@ cg_lexicon_new()
     new->stats->n_typ_cat_lex = 0;
     new->catl = NULL;
     new->ll = NULL;
+    new->cats = NULL;
+    new->ncats = new->nalloc_cats = 0;
+    new->comb = NULL;
+    new->comb_len = NULL;
+    new->pool = NULL;
+    new->poolsize = 0;
+    new->map = NULL;
+    new->maplen = 0;
 
     return new;
 }
 
+/*
+ * lexstr_owned() - whether `s' is a string allocated by the lexicon
+ *
+ * the strings of a lexicon loaded from a binary snapshot point into
+ * the mapped string pool, they are released with the mapping.
+ */
+static inline int
+lexstr_owned(cg_lexicon *l, char *s)
+{
+    uintptr_t p = (uintptr_t) s,
+              pool = (uintptr_t) l->pool;
+
+    return (p < pool || p >= pool + l->poolsize);
+}
+
+/* lexstr_free() - free a string owned by the lexicon */
+static inline void
+lexstr_free(cg_lexicon *l, char *s)
+{
+    if (lexstr_owned(l, s)) free(s);
+}
+
+/* lexstr_count() - count a string the lexicon takes over */
+static inline void
+lexstr_count(cg_lexicon *l, char *s)
+{
+    if (lexstr_owned(l, s)) mem_add(l->mem, MEM_KEYS, s);
+}
+
+/* lexstr_uncount() - uncount a string before lexstr_free() */
+static inline void
+lexstr_uncount(cg_lexicon *l, char *s)
+{
+    if (lexstr_owned(l, s)) mem_sub(l->mem, MEM_KEYS, s);
+}
+
 /*
  * cg_lexi_new()
  *
@@ -96,6 +165,8 @@ cg_cat_new()
     ret->res = NULL;
     ret->arg = NULL;
     ret->freq = 0;
+    ret->lex_freq = 0;
+    ret->id = -1;
     return ret;
 }
 
@@ -115,6 +186,7 @@ cg_lexilist *
 cg_lexilist_new()
 {
     cg_lexilist *ret = malloc (sizeof(cg_lexilist));
+    prof_count(PROF_ALLOCS, 1);
     ret->lexi = NULL;
     ret->next = ret->next_syn = ret->next_hom = NULL;
     return ret;
@@ -160,35 +232,86 @@ cg_lexicon_free (cg_lexicon *l)
     GHashTableIter iter;
     gpointer key, val;
 
+    int i;
+
     cg_lexilist_free(l->ll, 1);
-    cg_catlist_free(l->catl, 1);
+    cg_catlist_free(l->catl, 0);
+    for (i = 0; i < l->ncats; i++) {
+        if (l->cats[i]->str) lexstr_free(l, l->cats[i]->str);
+        free(l->cats[i]);
+    }
 
     g_hash_table_iter_init (&iter, l->pfhash);
     while (g_hash_table_iter_next (&iter, &key, &val)) {
-        if(key) free(key);
+        if(key) lexstr_free(l, key);
         if(val) free(val);
     }
     g_hash_table_iter_init (&iter, l->lfhash);
     while (g_hash_table_iter_next (&iter, &key, &val)) {
-        if(key) free(key);
+        if(key) lexstr_free(l, key);
         if(val) free(val);
     }
 
+    if (l->comb) {
+        int i;
+        for (i = 0; i < l->nalloc_cats; i++) {
+            free(l->comb[i]);
+        }
+        free(l->comb);
+        free(l->comb_len);
+    }
+    free(l->cats);
+
     g_hash_table_destroy(l->cathash);
     g_hash_table_destroy(l->pfhash);
+    bloom_free(l->pfbloom);
     g_hash_table_destroy(l->lfhash);
+    if (l->map) munmap(l->map, l->maplen);
     free(l->stats);
+    mem_acct_free(l->mem);
     free(l);
     return;
 }
 
+/*
+ * pf_span() - returns the start of `pf' without the leading white 
+ *             space, *len is set to the length without the trailing
+ *             white space. this is the normalized form without a copy.
+ */
+static inline const char *
+pf_span(const char *pf, size_t *len)
+{
+    const char *end = pf + strlen(pf);
+
+    while (*pf && strchr(" \t\n", *pf)) pf++;
+    while (end > pf && strchr(" \t\n", end[-1])) end--;
+    *len = end - pf;
+    return pf;
+}
+
 inline char *
 pf_normalize(char *pfs)
 {
-    char *s = strdup(pfs);
+    size_t len;
+    const char *s = pf_span(pfs, &len);
 
-    str_strip(s, " \t\n");
-    return s;
+    return strndup(s, len);
+}
+
+/* 
+ * lf_normalize_buf() - lf_normalize() into the caller's buffer, `dst'
+ *                      should have room for strlen(lfs) + 1 bytes.
+ */
+static inline char *
+lf_normalize_buf(char *dst, const char *lfs)
+{
+    char *d = dst;
+
+    for (; *lfs; lfs++) {
+        if (*lfs != ' ' && *lfs != '\t') *d++ = *lfs;
+    }
+    *d = '\0';
+    return dst;
 }
 
 inline char *
@@ -234,6 +357,34 @@ cat_normalize(char *cats)
     return s;
 }
 
+/*
+ * cg_lexicon_intern_cat() 
+ *
+ * assign the next free ID to `cat', and add it to the category table.
+ * IDs are never re-used, so they can be used as indices to tables 
+ * that are computed once (e.g., combination results).
+ */
+static void
+cg_lexicon_intern_cat(cg_lexicon *l, cg_cat *cat)
+{
+    if (l->ncats == l->nalloc_cats) {
+        int i, n = (l->nalloc_cats) ? 2 * l->nalloc_cats : 64;
+        l->cats = mem_realloc(l->mem, MEM_INDEX, l->cats, 
+                              n * sizeof (*l->cats));
+        l->comb = mem_realloc(l->mem, MEM_INDEX, l->comb, 
+                              n * sizeof (*l->comb));
+        l->comb_len = mem_realloc(l->mem, MEM_INDEX, l->comb_len, 
+                                  n * sizeof (*l->comb_len));
+        for (i = l->nalloc_cats; i < n; i++) {
+            l->comb[i] = NULL;
+            l->comb_len[i] = 0;
+        }
+        l->nalloc_cats = n;
+    }
+    cat->id = l->ncats;
+    l->cats[l->ncats++] = cat;
+}
+
 cg_cat *
 cg_lexicon_addcat_f(cg_lexicon *l, char *catstr, size_t freq)
 {
@@ -252,6 +403,8 @@ cg_lexicon_addcat_f(cg_lexicon *l, char *catstr, size_t freq)
 
     pcount = 0;
     cat = cg_cat_new();
+    mem_add(l->mem, MEM_VALUES, cat);
+    mem_add(l->mem, MEM_KEYS, tmp);
     cat->freq += freq;
     l->stats->n_typ_cat += 1;
     if (freq > 0 ) {
@@ -290,8 +443,9 @@ cg_lexicon_addcat_f(cg_lexicon *l, char *catstr, size_t freq)
     }
 
     g_hash_table_insert (l->cathash, cat->str, cat);
+    cg_lexicon_intern_cat(l, cat);
 
-    catl = malloc(sizeof (cg_catlist));
+    catl = mem_malloc(l->mem, MEM_INDEX, sizeof (cg_catlist));
     catl->next = l->catl;
     catl->cat = cat;
     l->catl = catl;
@@ -319,98 +473,154 @@ inc_freq(cg_lexicon *l, cg_lexi *lexi, size_t freq)
     lexi->freq += freq;
     l->stats->n_tok += freq;
     lexi->cat->freq += freq;
+    prof_count(PROF_PROBES, 2);
     if (g_hash_table_lookup_extended(l->pfhash, lexi->pf, 
                              (gpointer *)&key, (gpointer *)&val)) {
         val->n_tok += freq;
     }
 
     lfkey = lexi->lf ? lexi->lf : ":";
-    if (g_hash_table_lookup_extended(l->pfhash, lfkey,
+    if (g_hash_table_lookup_extended(l->lfhash, lfkey,
                              (gpointer *)&key, (gpointer *)&val)) {
         val->n_tok += freq;
     }
 }
 
-cg_lexi *
-cg_lexicon_add_f(cg_lexicon *l, char *pf, char *cat, char *lf, size_t freq)
+/*
+ * lexicon_link_h() - add `lexi' to the item list and the pf/lf indexes
+ *
+ * `pfs' and `lfs' are normalized strings owned by the lexicon from
+ * now on, they are freed if the indexes already have the same key.
+ *
+ * `pfh' and `lfh' are optional slots that cache the index entries of
+ * `pfs' and `lfs', used when the caller knows which items share the
+ * same pf or lf (see cg_lexicon_load_bin()). a NULL slot value means
+ * the key is not in the index yet.
+ */
+static void
+lexicon_link_h(cg_lexicon *l, cg_lexi *lexi, char *pfs, char *lfs,
+               struct cg_listhead **pfh, struct cg_listhead **lfh)
 {
     char *key = NULL;
     struct cg_listhead *val = NULL;
-    cg_lexi *lexi = NULL;
     cg_lexilist *lexl = NULL;
-    char *pfs = pf_normalize(pf);
-    char *lfs = lf_normalize(lf);
-    char *cats = cat_normalize(cat);
     char *lfkey;
-    
-    assert(l != NULL);
+    size_t freq = lexi->freq;
+    int found;
 
-    lexl = cg_lexicon_lookup_full(l, pfs, cats, lfs);
-    if (lexl != NULL) {
-        lexi = lexl->lexi; 
-        inc_freq(l, lexi, freq);
-        cg_lexilist_free(lexl, 0);
-        free(pfs);
-        free(cats);
-        if (lfs) free(lfs);
-        return lexi;
-    }
-    /* Exact lexical item <pf,cat,lf> does not exist */
-
-    lexi = cg_lexi_new();
-    lexi->freq += freq;
     l->stats->n_tok += freq;
     ++l->stats->n_typ;
     lexl = cg_lexilist_new();
+    mem_add(l->mem, MEM_INDEX, lexl);
+    mem_add(l->mem, MEM_VALUES, lexi);
     lexl->lexi = lexi;
     lexl->next = l->ll;
     l->ll = lexl;
 
-    lexi->cat = cg_lexicon_addcat_f(l, cats, freq);
-    free(cats);
-
-    
-    if(g_hash_table_lookup_extended(l->pfhash, pfs, 
-                             (gpointer *)&key, (gpointer *)&val)){
+    if (pfh) {
+        found = ((val = *pfh) != NULL);
+        key = found ? val->l->lexi->pf : NULL;
+    } else {
+        prof_count(PROF_PROBES, 1);
+        found = g_hash_table_lookup_extended(l->pfhash, pfs, 
+                             (gpointer *)&key, (gpointer *)&val);
+    }
+    if (found) {
         lexi->pf = key;
         lexl->next_hom = val->l;
         val->l = lexl;
         val->n_tok += freq;
         ++val->n_typ;
-        free(pfs);
+        if (key != pfs) lexstr_free(l, pfs);
     } else {
         lexi->pf = pfs;
-        val = malloc (sizeof (*val));
+        lexstr_count(l, pfs);
+        val = mem_malloc(l->mem, MEM_VALUES, sizeof (*val));
+        prof_count(PROF_ALLOCS, 1);
         val->n_typ = 1;
         ++l->stats->n_typ_pf;
         val->n_tok = freq;
         val->l = lexl;
         g_hash_table_insert (l->pfhash, lexi->pf, val);
+        if (l->pfbloom) {
+            bloom_add(l->pfbloom, l->pfhash, 
+                      str_hash_n(lexi->pf, strlen(lexi->pf)));
+        }
+        if (pfh) *pfh = val;
     }
     
     // key ":" collects all the lexial items with null LF
     lfkey = lfs ? lfs : ":";
 
-    if(g_hash_table_lookup_extended(l->lfhash, lfkey, 
-                             (gpointer *)&key, (gpointer *)&val)){
+    if (lfh) {
+        found = ((val = *lfh) != NULL);
+        key = found ? val->l->lexi->lf : NULL;
+    } else {
+        prof_count(PROF_PROBES, 1);
+        found = g_hash_table_lookup_extended(l->lfhash, lfkey, 
+                             (gpointer *)&key, (gpointer *)&val);
+    }
+    if (found) {
         lexi->lf = lfs ? key : NULL;
         lexl->next_syn = val->l;
         val->l = lexl;
         ++val->n_typ;
         val->n_tok += freq;
-        lfkey = key;
-        if (lfs) free(lfs);
+        if (lfs && key != lfs) lexstr_free(l, lfs);
     } else {
         lexi->lf = lfs; 
-        if(lfs == NULL) 
-            lfkey = strdup(":");
-        val = malloc (sizeof (*val));
+        if(lfs == NULL) {
+            lfkey = mem_strdup(l->mem, MEM_KEYS, ":");
+        } else {
+            lexstr_count(l, lfs);
+        }
+        val = mem_malloc(l->mem, MEM_VALUES, sizeof (*val));
+        prof_count(PROF_ALLOCS, 1);
         val->n_typ = 1;
         ++l->stats->n_typ_lf;
         val->n_tok = freq;
         val->l = lexl;
         g_hash_table_insert (l->lfhash, lfkey, val);
+        if (lfh) *lfh = val;
     }
+}
+
+static inline void
+lexicon_link(cg_lexicon *l, cg_lexi *lexi, char *pfs, char *lfs)
+{
+    lexicon_link_h(l, lexi, pfs, lfs, NULL, NULL);
+}
+
+cg_lexi *
+cg_lexicon_add_f(cg_lexicon *l, char *pf, char *cat, char *lf, size_t freq)
+{
+    cg_lexi *lexi = NULL, *li;
+    char *pfs = pf_normalize(pf);
+    char *lfs = lf_normalize(lf);
+    char *cats = cat_normalize(cat);
+    struct cg_lexicon_iter it;
+    
+    assert(l != NULL);
+
+    // the last match, cg_lexicon_lookup_full() returned it first
+    cg_lexicon_iter_init(&it, l, pfs, cats, lfs);
+    while ((li = cg_lexicon_iter_next(&it))) {
+        lexi = li;
+    }
+    if (lexi != NULL) {
+        inc_freq(l, lexi, freq);
+        free(pfs);
+        free(cats);
+        if (lfs) free(lfs);
+        return lexi;
+    }
+    /* Exact lexical item <pf,cat,lf> does not exist */
+
+    lexi = cg_lexi_new();
+    lexi->freq += freq;
+    lexi->cat = cg_lexicon_addcat_f(l, cats, freq);
+    free(cats);
+    lexicon_link(l, lexi, pfs, lfs);
 
     return lexi;
 }
@@ -494,8 +704,10 @@ cg_lexicon_remove(cg_lexicon *l, cg_lexi *li)
             if (pf_parent == ll) { // first in pf list
                 if (ll->next_hom == NULL) { // the only one
                     g_hash_table_remove(l->pfhash, li->pf);
-                    free(li->pf);
-                    free(pf_head);
+                    if (l->pfbloom) bloom_fill(l->pfbloom, l->pfhash);
+                    lexstr_uncount(l, li->pf);
+                    lexstr_free(l, li->pf);
+                    mem_free(l->mem, MEM_VALUES, pf_head);
                     --l->stats->n_typ_pf;
                 } else  {
                     pf_head->l = ll->next_hom;
@@ -514,9 +726,10 @@ cg_lexicon_remove(cg_lexicon *l, cg_lexi *li)
                         g_hash_table_remove(l->lfhash, ":");
                     } else {
                         g_hash_table_remove(l->lfhash, li->lf);
-                        free(li->lf);
+                        lexstr_uncount(l, li->lf);
+                        lexstr_free(l, li->lf);
                     }
-                    free(lf_head);
+                    mem_free(l->mem, MEM_VALUES, lf_head);
                     --l->stats->n_typ_pf;
                 } else  {
                     lf_head->l = ll->next_syn;
@@ -530,8 +743,9 @@ cg_lexicon_remove(cg_lexicon *l, cg_lexi *li)
 
             l->stats->n_tok -= li->freq;
             l->stats->n_typ -= 1;
+            mem_sub(l->mem, MEM_VALUES, ll->lexi);
             cg_lexi_free(ll->lexi);
-            free(ll);
+            mem_free(l->mem, MEM_INDEX, ll);
     }
 }
 
@@ -553,15 +767,35 @@ cg_lexicon_remove(cg_lexicon *l, cg_lexi *li)
 inline struct cg_listhead *
 cg_lexicon_lookup_h(cg_lexicon *l, char *pf)
 {
-    char        *pfn = pf_normalize(pf);
+    size_t      len;
+    const char  *s = pf_span(pf, &len);
+    unsigned long nmalloc = prof_lookup_start();
     struct cg_listhead *lh;
 
-    lh = g_hash_table_lookup(l->pfhash, pfn);
-    free(pfn);
+    lh = bloom_lookup(l->pfbloom, l->pfhash, str_hash_n(s, len), s, len);
+    prof_lookup_stop(nmalloc);
     return lh;
 }
 
 
+/*
+ * cg_lexicon_lookup_span() - look up the `len' bytes at `pf'
+ *
+ *      `hv' is the str_hash_n() value of the span. unlike 
+ *      cg_lexicon_lookup_h() the span is not normalized, it should
+ *      not contain any white space.
+ */
+inline struct cg_listhead *
+cg_lexicon_lookup_span(cg_lexicon *l, strhash_t hv, const char *pf, 
+                       size_t len)
+{
+    unsigned long nmalloc = prof_lookup_start();
+    struct cg_listhead *lh = bloom_lookup(l->pfbloom, l->pfhash, hv, pf, len);
+
+    prof_lookup_stop(nmalloc);
+    return lh;
+}
+
 cg_lexilist *
 cg_lexicon_lookup(cg_lexicon *l, char *pf)
 {
@@ -584,16 +818,18 @@ cg_lexicon_lookup(cg_lexicon *l, char *pf)
 inline struct cg_listhead *
 cg_lexicon_lookup_lf_h(cg_lexicon *l, char *lf)
 {
-    char        *lfn = lf_normalize(lf);
+    unsigned long nmalloc = prof_lookup_start();
     struct cg_listhead *lh;
 
-    if(lfn == NULL)  {
+    prof_count(PROF_PROBES, 1);
+    if(lf == NULL)  {
         lh = g_hash_table_lookup(l->lfhash, ":");
     } else {
-        lh = g_hash_table_lookup(l->lfhash, lfn);
-        free(lfn);
+        char lfn[strlen(lf) + 1];
+        lh = g_hash_table_lookup(l->lfhash, lf_normalize_buf(lfn, lf));
     }
-    return lh; 
+    prof_lookup_stop(nmalloc);
+    return lh;
 }
  
 cg_lexilist *
@@ -602,6 +838,57 @@ cg_lexicon_lookup_lf(cg_lexicon *l, char *lf)
     return (cg_lexicon_lookup_lf_h(l,lf))->l;
 }
 
+/*
+ * cg_lexicon_iter_init(), cg_lexicon_iter_next()
+ *
+ *      iterate over the lexical items matching <pf,cat,lf> without
+ *      allocating memory. `pf' is normalized on the fly, `cat' and 
+ *      `lf' should already be normalized (see cat_normalize() and 
+ *      lf_normalize()). The empty string is interpreted as "any" lf 
+ *      or cat, a NULL `lf' matches only the items without an lf.
+ *
+ *      cg_lexicon_iter_next() returns NULL after the last match.
+ */
+void
+cg_lexicon_iter_init(struct cg_lexicon_iter *it, cg_lexicon *l,
+                     char *pf, const char *cat, const char *lf)
+{
+    struct cg_listhead *lh = cg_lexicon_lookup_h(l, pf);
+
+    it->ll = lh ? lh->l : NULL;
+    it->cat = cat;
+    it->lf = lf;
+}
+
+static inline int
+lexi_match(cg_lexi *li, const char *catn, const char *lfn)
+{
+    int lf_match,
+        cat_match;
+
+    cat_match = (catn[0] != '\0') ? !strcmp(li->cat->str, catn) : 1;
+
+    if(lfn == NULL || li->lf == NULL) {
+        lf_match = (lfn == li->lf);
+    } else {
+        lf_match = (lfn[0] != '\0') ? !strcmp(li->lf, lfn) : 1;
+    }
+    return lf_match && cat_match;
+}
+
+cg_lexi *
+cg_lexicon_iter_next(struct cg_lexicon_iter *it)
+{
+    while (it->ll) {
+        cg_lexi *li = it->ll->lexi;
+        it->ll = it->ll->next_hom;
+        if (lexi_match(li, it->cat, it->lf)) {
+            return li;
+        }
+    }
+    return NULL;
+}
+
 /*
  * cg_lexicon_lookup_full(cg_lexicon *l, char *pf, char *catstr, char *lf)
  *
@@ -616,55 +903,27 @@ cg_lexicon_lookup_lf(cg_lexicon *l, char *lf)
  *
  *      This function returns a new list that points to the lexical 
  *      items in the lexicon. The caller should free it with 
- *      cg_lexilist_free(list, 0).
+ *      cg_lexilist_free(list, 0). Use cg_lexicon_iter_init() to 
+ *      avoid the copy.
  */
 
 cg_lexilist *
 cg_lexicon_lookup_full(cg_lexicon *l, char *pf, char *catstr, char *lf)
 {
-    char        *pfn = pf_normalize(pf),
-                *lfn = lf_normalize(lf), 
+    char        *lfn = lf_normalize(lf), 
                 *catn = cat_normalize(catstr);
-    int         check_lf = (lfn != NULL && strlen(lfn) != 0),
-                check_cat = (strlen(catn) != 0);
-    cg_lexilist *ret, *lret, *pnew, *pold;
-    struct cg_listhead *lh;
-
-    lh = g_hash_table_lookup(l->pfhash, pfn);
-
-    free(pfn);
-
-    if(lh == NULL) {
-        if (lfn) free(lfn);
-        if (catn) free(catn);
-        return NULL;
+    cg_lexilist *ret = NULL, *pnew;
+    cg_lexi     *li;
+    struct cg_lexicon_iter it;
+
+    cg_lexicon_iter_init(&it, l, pf, catn, lfn);
+    while ((li = cg_lexicon_iter_next(&it))) {
+        pnew = cg_lexilist_new();
+        pnew->lexi = li;
+        pnew->next = ret;
+        ret = pnew;
     }
 
-    lret = lh->l;
-    pold = lret;
-    ret = NULL;
-
-    do {
-        int lf_match,
-           cat_match;
-        
-        cat_match = (check_cat) ? !strcmp(pold->lexi->cat->str, catn) : 1;
-
-        if(lfn == NULL || pold->lexi->lf == NULL) {
-            lf_match = (lfn == pold->lexi->lf);
-        } else {
-            lf_match = (check_lf) ? !strcmp(pold->lexi->lf, lfn) : 1;
-        }
-
-        if(lf_match && cat_match) {
-            pnew = cg_lexilist_new();
-            pnew->lexi = pold->lexi;
-            pnew->next = ret;
-            ret = pnew;
-        }
-        pold = pold->next_hom;
-    } while(pold);
-
     if (catn) free(catn);
     if (lfn) free(lfn);
 
@@ -674,26 +933,25 @@ cg_lexicon_lookup_full(cg_lexicon *l, char *pf, char *catstr, char *lf)
 size_t 
 cg_lexicon_get_freq_pf(cg_lexicon *l, char *pf)
 {
-    char *key = NULL;
-    struct cg_listhead *val = NULL;
-    char *pfn = pf_normalize(pf);
+    struct cg_listhead *val = cg_lexicon_lookup_h(l, pf);
+
+    return val ? val->n_tok : 0;
+}
+
+size_t
+cg_lexicon_get_freq_span(cg_lexicon *l, strhash_t hv, const char *pf,
+                         size_t len)
+{
+    struct cg_listhead *val = cg_lexicon_lookup_span(l, hv, pf, len);
 
-    g_hash_table_lookup_extended(l->pfhash, pfn,
-                                 (gpointer *)&key, (gpointer *)&val);
-    free(pfn);
     return val ? val->n_tok : 0;
 }
 
 double 
 cg_lexicon_get_rfreq_pf(cg_lexicon *l, char *pf)
 {
-    char *key = NULL;
-    struct cg_listhead *val = NULL;
-    char *pfn = pf_normalize(pf);
+    struct cg_listhead *val = cg_lexicon_lookup_h(l, pf);
 
-    g_hash_table_lookup_extended(l->pfhash, pfn,
-                                 (gpointer *)&key, (gpointer *)&val);
-    free(pfn);
     if (val) {
         return (double) val->n_tok / (double) l->stats->n_tok ;
     } else {
@@ -810,6 +1068,435 @@ cg_lexicon_read(FILE *fp)
     return lexicon;
 }
 
+/*
+ * Binary lexicon snapshots
+ *
+ * layout (host byte order, all sections 8 byte aligned):
+ *
+ *      struct lexbin_hdr
+ *      string pool: NUL terminated strings, each stored once
+ *      struct lexbin_cat [ncats]: categories in the order of their IDs
+ *      struct lexbin_ent [nents]: lexical items, oldest first
+ *
+ * strings are referred to by their offsets in the pool and categories
+ * by their IDs. the items also record which pf and lf index entry they
+ * belong to. cg_lexicon_load_bin() maps the file and rebuilds the hash
+ * indexes in a single pass over the records, hashing each distinct 
+ * key once and without parsing or normalizing any strings. the 
+ * strings of the loaded lexicon point into the mapped pool.
+ */
+
+#define LEXBIN_MAGIC    "SEGLEXB"
+#define LEXBIN_VERSION  1
+#define LEXBIN_NONE     UINT32_MAX
+
+struct lexbin_hdr {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    ncats;
+    uint32_t    npfh, nlfh; // number of distinct pfs and lfs
+    uint64_t    nents;
+    uint64_t    poolsize;
+    uint64_t    n_typ, n_tok, n_typ_pf, n_typ_lf, 
+                n_typ_cat, n_typ_cat_lex;
+};
+
+struct lexbin_cat {
+    uint32_t    str;
+    int32_t     res, arg;   // category IDs, -1 for basic categories
+    int32_t     slash;
+    uint64_t    freq, lex_freq;
+};
+
+struct lexbin_ent {
+    uint32_t    pf, lf;     // lf is LEXBIN_NONE if the item has no lf
+    int32_t     cat;
+    uint32_t    pfh, lfh;   // dense indices of the pf and lf entries
+    uint32_t    pad;
+    uint64_t    freq;
+};
+
+#define LEXBIN_ALIGN(n) (((n) + 7) & ~(size_t) 7)
+
+struct lexbin_pool {
+    GHashTable  *off;   // string -> offset + 1
+    char        *s;
+    size_t      n, nalloc;
+};
+
+/* lexbin_head() - dense index of the index entry `lh' */
+static uint32_t
+lexbin_head(GHashTable *ids, struct cg_listhead *lh, uint32_t *n)
+{
+    uint32_t *id = g_hash_table_lookup(ids, lh);
+
+    if (id == NULL) {
+        id = malloc(sizeof (*id));
+        *id = (*n)++;
+        g_hash_table_insert(ids, lh, id);
+    }
+    return *id;
+}
+
+static uint32_t
+lexbin_str(struct lexbin_pool *p, const char *s)
+{
+    size_t *off, len;
+
+    if (s == NULL) return LEXBIN_NONE;
+    if ((off = g_hash_table_lookup(p->off, s)) != NULL) {
+        return *off - 1;
+    }
+    len = strlen(s) + 1;
+    if (p->n + len > p->nalloc) {
+        p->nalloc = 2 * (p->n + len);
+        p->s = realloc(p->s, p->nalloc);
+    }
+    memcpy(p->s + p->n, s, len);
+    off = malloc(sizeof (*off));
+    *off = p->n + 1;
+    g_hash_table_insert(p->off, (char *) s, off);
+    p->n += len;
+    assert(p->n < LEXBIN_NONE);
+    return *off - 1;
+}
+
+void
+cg_lexicon_write_bin(FILE *fp, cg_lexicon *l)
+{
+    struct lexbin_hdr   hdr;
+    struct lexbin_pool  pool;
+    struct lexbin_cat   *cats;
+    struct lexbin_ent   *ents;
+    cg_lexilist         *ll;
+    size_t              nents = 0, i;
+    uint32_t            npfh = 0, nlfh = 0;
+    GHashTable          *pfids, *lfids;
+    static const char   zero[8];
+
+    for (ll = l->ll; ll; ll = ll->next) nents++;
+
+    pool.off = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, free);
+    pool.s = NULL;
+    pool.n = pool.nalloc = 0;
+
+    cats = calloc(l->ncats + 1, sizeof (*cats));
+    for (i = 0; i < l->ncats; i++) {
+        cg_cat *cat = l->cats[i];
+        cats[i].str = lexbin_str(&pool, cat->str);
+        cats[i].res = cat->res ? cat->res->id : -1;
+        cats[i].arg = cat->arg ? cat->arg->id : -1;
+        cats[i].slash = cat->slash;
+        cats[i].freq = cat->freq;
+        cats[i].lex_freq = cat->lex_freq;
+    }
+
+    // l->ll is newest first, the snapshot keeps the order of addition
+    pfids = g_hash_table_new_full(NULL, NULL, NULL, free);
+    lfids = g_hash_table_new_full(NULL, NULL, NULL, free);
+    ents = calloc(nents + 1, sizeof (*ents));
+    for (ll = l->ll, i = nents; ll; ll = ll->next) {
+        struct lexbin_ent *e = &ents[--i];
+        e->pf = lexbin_str(&pool, ll->lexi->pf);
+        e->lf = lexbin_str(&pool, ll->lexi->lf);
+        e->cat = ll->lexi->cat->id;
+        e->freq = ll->lexi->freq;
+    }
+    // head IDs in the order the loader will meet them
+    for (i = 0; i < nents; i++) {
+        char *pf = pool.s + ents[i].pf,
+             *lf = (ents[i].lf == LEXBIN_NONE) ? ":" : pool.s + ents[i].lf;
+        ents[i].pfh = lexbin_head(pfids, 
+                           g_hash_table_lookup(l->pfhash, pf), &npfh);
+        ents[i].lfh = lexbin_head(lfids, 
+                           g_hash_table_lookup(l->lfhash, lf), &nlfh);
+    }
+    g_hash_table_destroy(pfids);
+    g_hash_table_destroy(lfids);
+
+    memset(&hdr, 0, sizeof (hdr));
+    memcpy(hdr.magic, LEXBIN_MAGIC, sizeof (hdr.magic));
+    hdr.version = LEXBIN_VERSION;
+    hdr.ncats = l->ncats;
+    hdr.npfh = npfh;
+    hdr.nlfh = nlfh;
+    hdr.nents = nents;
+    hdr.poolsize = LEXBIN_ALIGN(pool.n);
+    hdr.n_typ = l->stats->n_typ;
+    hdr.n_tok = l->stats->n_tok;
+    hdr.n_typ_pf = l->stats->n_typ_pf;
+    hdr.n_typ_lf = l->stats->n_typ_lf;
+    hdr.n_typ_cat = l->stats->n_typ_cat;
+    hdr.n_typ_cat_lex = l->stats->n_typ_cat_lex;
+
+    if (fwrite(&hdr, sizeof (hdr), 1, fp) != 1 
+        || (pool.n && fwrite(pool.s, pool.n, 1, fp) != 1)
+        || (hdr.poolsize > pool.n 
+            && fwrite(zero, hdr.poolsize - pool.n, 1, fp) != 1)
+        || (l->ncats && fwrite(cats, sizeof (*cats), l->ncats, fp) 
+                            != l->ncats)
+        || (nents && fwrite(ents, sizeof (*ents), nents, fp) != nents)) {
+        fprintf(stderr, "Error writing the binary lexicon.\n");
+        exit(-1);
+    }
+
+    g_hash_table_destroy(pool.off);
+    free(pool.s);
+    free(cats);
+    free(ents);
+}
+
+cg_lexicon *
+cg_lexicon_load_bin(char *fn)
+{
+    struct stat st;
+
+    if (stat(fn, &st) < 0) {
+        fprintf(stderr, "Error opening file `%s' for reading.\n", fn);
+        return NULL;
+    }
+    return cg_lexicon_load_bin_at(fn, 0, st.st_size);
+}
+
+/*
+ * lexbin_key_ok() - check that the entries of the index entry `h' 
+ *                   have the same key
+ *
+ * `keys' holds the key of the first entry of each index entry seen 
+ * so far, `nh' their number. the writer numbers the index entries in
+ * the order of their first entry.
+ */
+static int
+lexbin_key_ok(const char **keys, uint32_t *nh, uint32_t h, const char *key)
+{
+    if (h == *nh) {
+        keys[(*nh)++] = key;
+        return 1;
+    }
+    return h < *nh && !strcmp(keys[h], key);
+}
+
+/*
+ * lexbin_check() - check the binary lexicon at `hdr' before loading it
+ *
+ * every offset, ID and index read from the file is checked, so that a
+ * corrupt or truncated file cannot make the loader read outside the 
+ * mapping. returns NULL if the lexicon is valid, otherwise a 
+ * description of the first error found.
+ */
+static const char *
+lexbin_check(struct lexbin_hdr *hdr, size_t len)
+{
+    const char          *pool = (const char *) (hdr + 1);
+    struct lexbin_cat   *cats;
+    struct lexbin_ent   *ents;
+    const char          **pfkeys, **lfkeys, *err = NULL;
+    uint32_t            npf = 0, nlf = 0;
+    size_t              i, rest;
+
+    if (memcmp(hdr->magic, LEXBIN_MAGIC, sizeof (hdr->magic))) {
+        return "bad magic number";
+    }
+    if (hdr->version != LEXBIN_VERSION) return "unknown version";
+
+    // the sizes are checked one at a time, their sum may overflow
+    rest = len - sizeof (*hdr);
+    if (hdr->poolsize > rest || hdr->poolsize >= LEXBIN_NONE) {
+        return "string pool larger than the file";
+    }
+    rest -= hdr->poolsize;
+    if (hdr->ncats > rest / sizeof (*cats)) return "truncated categories";
+    rest -= hdr->ncats * sizeof (*cats);
+    if (hdr->nents != rest / sizeof (*ents) 
+        || rest % sizeof (*ents) != 0) {
+        return "the size of the file does not match the header";
+    }
+    if (hdr->poolsize != 0 && pool[hdr->poolsize - 1] != '\0') {
+        return "the last string of the pool is not terminated";
+    }
+    if (hdr->npfh > hdr->nents || hdr->nlfh > hdr->nents) {
+        return "more index entries than items";
+    }
+
+    cats = (struct lexbin_cat *) (pool + hdr->poolsize);
+    ents = (struct lexbin_ent *) (cats + hdr->ncats);
+
+    // the sub-categories always have smaller IDs than the category
+    for (i = 0; i < hdr->ncats; i++) {
+        int basic = (cats[i].slash == '\0');
+
+        if (cats[i].str >= hdr->poolsize) return "bad category string";
+        if (cats[i].res >= (int32_t) i || cats[i].arg >= (int32_t) i
+            || cats[i].res < -1 || cats[i].arg < -1) {
+            return "bad sub-category ID";
+        }
+        if ((!basic && cats[i].slash != '/' && cats[i].slash != '\\')
+            || basic != (cats[i].res < 0) || basic != (cats[i].arg < 0)) {
+            return "bad category operator";
+        }
+    }
+
+    pfkeys = malloc((hdr->npfh + 1) * sizeof (*pfkeys));
+    lfkeys = malloc((hdr->nlfh + 1) * sizeof (*lfkeys));
+    for (i = 0; i < hdr->nents && err == NULL; i++) {
+        struct lexbin_ent *e = &ents[i];
+
+        if (e->pf >= hdr->poolsize) {
+            err = "bad item string";
+        } else if (e->lf != LEXBIN_NONE && e->lf >= hdr->poolsize) {
+            err = "bad item logical form";
+        } else if (e->cat < 0 || (uint32_t) e->cat >= hdr->ncats) {
+            err = "bad item category";
+        } else if (e->pfh >= hdr->npfh || e->lfh >= hdr->nlfh
+                   || !lexbin_key_ok(pfkeys, &npf, e->pfh, pool + e->pf)
+                   || !lexbin_key_ok(lfkeys, &nlf, e->lfh, 
+                       (e->lf == LEXBIN_NONE) ? ":" : pool + e->lf)) {
+            err = "bad index entry";
+        }
+    }
+    if (err == NULL && (npf != hdr->npfh || nlf != hdr->nlfh)) {
+        err = "unused index entries";
+    }
+    free(pfkeys);
+    free(lfkeys);
+    return err;
+}
+
+/* 
+ * cg_lexicon_load_bin_at() - load the binary lexicon stored in the
+ *                            `len' bytes at offset `off' of `fn'
+ *
+ * `off' should be a multiple of 8. this allows a lexicon to be kept
+ * in a larger file (e.g., a checkpoint, see checkpoint.c). the file 
+ * is mapped from the start, the mapping is released with the lexicon.
+ * returns NULL, after an error message, if the file cannot be read or
+ * is not a valid binary lexicon.
+ */
+cg_lexicon *
+cg_lexicon_load_bin_at(char *fn, size_t off, size_t len)
+{
+    int                 fd;
+    struct stat         st;
+    char                *map;
+    struct lexbin_hdr   *hdr;
+    struct lexbin_cat   *cats;
+    struct lexbin_ent   *ents;
+    cg_lexicon          *l;
+    struct cg_listhead  **pfh, **lfh;
+    const char          *err;
+    size_t              i;
+
+    if ((fd = open(fn, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "Error opening file `%s' for reading.\n", fn);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    if (off % 8 || off > st.st_size || len > st.st_size - off 
+        || len < sizeof (*hdr)) {
+        fprintf(stderr, "`%s' is not a valid binary lexicon.\n", fn);
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, off + len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error mapping file `%s'.\n", fn);
+        return NULL;
+    }
+
+    hdr = (struct lexbin_hdr *) (map + off);
+    if ((err = lexbin_check(hdr, len)) != NULL) {
+        fprintf(stderr, "`%s' is not a valid binary lexicon: %s.\n", 
+                fn, err);
+        munmap(map, off + len);
+        return NULL;
+    }
+
+    l = cg_lexicon_new();
+    l->map = map;
+    l->maplen = off + len;
+    mem_add_n(l->mem, MEM_KEYS, len);
+    l->pool = (char *) (hdr + 1);
+    l->poolsize = hdr->poolsize;
+    cats = (struct lexbin_cat *) (l->pool + hdr->poolsize);
+    ents = (struct lexbin_ent *) (cats + hdr->ncats);
+
+    // checked by lexbin_check(): the offsets and IDs are in range
+    for (i = 0; i < hdr->ncats; i++) {
+        cg_cat      *cat = cg_cat_new();
+        cg_catlist  *catl = mem_malloc(l->mem, MEM_INDEX, 
+                                       sizeof (cg_catlist));
+
+        mem_add(l->mem, MEM_VALUES, cat);
+        cat->str = l->pool + cats[i].str;
+        cat->slash = cats[i].slash;
+        cat->res = (cats[i].res >= 0) ? l->cats[cats[i].res] : NULL;
+        cat->arg = (cats[i].arg >= 0) ? l->cats[cats[i].arg] : NULL;
+        cat->freq = cats[i].freq;
+        cat->lex_freq = cats[i].lex_freq;
+        g_hash_table_insert (l->cathash, cat->str, cat);
+        cg_lexicon_intern_cat(l, cat);
+        catl->next = l->catl;
+        catl->cat = cat;
+        l->catl = catl;
+    }
+
+    pfh = calloc(hdr->npfh + 1, sizeof (*pfh));
+    lfh = calloc(hdr->nlfh + 1, sizeof (*lfh));
+    for (i = 0; i < hdr->nents; i++) {
+        cg_lexi *lexi = cg_lexi_new();
+
+        lexi->freq = ents[i].freq;
+        lexi->cat = l->cats[ents[i].cat];
+        lexicon_link_h(l, lexi, l->pool + ents[i].pf, 
+                       (ents[i].lf == LEXBIN_NONE) ? NULL 
+                                                   : l->pool + ents[i].lf,
+                       &pfh[ents[i].pfh], &lfh[ents[i].lfh]);
+    }
+    free(pfh);
+    free(lfh);
+
+    l->stats->n_typ = hdr->n_typ;
+    l->stats->n_tok = hdr->n_tok;
+    l->stats->n_typ_pf = hdr->n_typ_pf;
+    l->stats->n_typ_lf = hdr->n_typ_lf;
+    l->stats->n_typ_cat = hdr->n_typ_cat;
+    l->stats->n_typ_cat_lex = hdr->n_typ_cat_lex;
+
+    return l;
+}
+
+void 
+cg_lexicon_save_bin(char *fn, cg_lexicon *l)
+{
+    FILE    *fp;
+
+    if(!strcmp(fn, "-")) {
+        fp = stdout;
+    } else {
+        fp = fopen(fn, "w");
+    }
+    if(!fp) {
+        fprintf(stderr, "Error opening file `%s' for writing.", fn);
+        exit(-1);
+    }
+
+    cg_lexicon_write_bin(fp, l);
+
+    if (fp == stdout) {
+        fflush(fp);
+    } else {
+        fclose(fp);
+    }
+}
+
+/*
+ * cg_lexicon_load() - load a lexicon in text or binary format
+ *
+ * binary snapshots are recognized by their magic number. returns NULL
+ * if the file cannot be opened, or if a binary lexicon cannot be 
+ * loaded, see cg_lexicon_load_bin_at().
+ */
 cg_lexicon *
 cg_lexicon_load(char *fn)
 {
@@ -822,8 +1509,18 @@ cg_lexicon_load(char *fn)
         fp = fopen(fn, "r");
     }
     if(!fp) {
-        fprintf(stderr, "Error opening file `%s' for reading.", fn);
-        exit(-1);
+        fprintf(stderr, "Error opening file `%s' for reading.\n", fn);
+        return NULL;
+    }
+
+    if (fp != stdin) {
+        char magic[sizeof (LEXBIN_MAGIC)];
+        size_t n = fread(magic, 1, sizeof (magic), fp);
+        if (n == sizeof (magic) && !memcmp(magic, LEXBIN_MAGIC, n)) {
+            fclose(fp);
+            return cg_lexicon_load_bin(fn);
+        }
+        rewind(fp);
     }
 
     L = cg_lexicon_read(fp);
@@ -848,6 +1545,10 @@ cg_lexicon_save(char *fn, cg_lexicon *l)
 
     cg_lexicon_write(fp, l);
 
-    fclose(fp);
+    if (fp == stdout) {
+        fflush(fp);
+    } else {
+        fclose(fp);
+    }
 }
 
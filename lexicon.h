@@ -23,6 +23,10 @@
 
 #include <stdio.h>
 #include <glib.h>
+#include "strhash.h"
+#include "bloom.h"
+
+struct mem_acct;
 
 typedef struct cg_category {
     union {
@@ -34,6 +38,7 @@ typedef struct cg_category {
     char                *str;    // this is also the key for the index 
     size_t              lex_freq;// this counts only lexical categories
     size_t              freq;    // this counts all
+    int                 id;      // index in the lexicon's category table
 } cg_cat;                        
 
 typedef struct cg_catlist {
@@ -71,13 +76,30 @@ struct lex_stats {
 
 typedef struct cg_lexicon {
     GHashTable  *pfhash;
+    struct bloom *pfbloom;  // negative lookups in pfhash, or NULL
     GHashTable  *lfhash;
     GHashTable  *cathash;
     cg_catlist  *catl;
     cg_lexilist *ll;
     struct lex_stats *stats;
+    cg_cat      **cats;     // categories indexed by their IDs
+    int         ncats;
+    int         nalloc_cats;
+    int         **comb;     // memoized combination results, see cyk.c
+    int         *comb_len;  // number of entries in each row of comb
+    char        *pool;      // strings of a lexicon loaded from a binary
+    size_t      poolsize;   //   snapshot, see cg_lexicon_load_bin()
+    void        *map;       // the mapped snapshot file, or NULL
+    size_t      maplen;
+    struct mem_acct *mem;   // for --mem-report, or NULL
 } cg_lexicon;
 
+struct cg_lexicon_iter {
+    cg_lexilist *ll;    // next candidate, followed by ->next_hom
+    const char  *cat;
+    const char  *lf;
+};
+
 #define LEX_COMMENT ';'
 
 cg_cat *cg_cat_new ();
@@ -99,16 +121,27 @@ void cg_lexilist_free(cg_lexilist *ll, int free_item);
 
 cg_lexicon *cg_lexicon_load(char *fname);
 void cg_lexicon_save(char *fname, cg_lexicon *l);
+cg_lexicon *cg_lexicon_load_bin(char *fname);
+cg_lexicon *cg_lexicon_load_bin_at(char *fname, size_t off, size_t len);
+void cg_lexicon_write_bin(FILE *fp, cg_lexicon *l);
+void cg_lexicon_save_bin(char *fname, cg_lexicon *l);
 
 struct cg_listhead *cg_lexicon_lookup_h(cg_lexicon *l, char *pf);
 struct cg_listhead *cg_lexicon_lookup_lf_h(cg_lexicon *l, char *lf);
+struct cg_listhead *cg_lexicon_lookup_span(cg_lexicon *l, strhash_t hv,
+                                           const char *pf, size_t len);
 cg_lexilist *cg_lexicon_lookup(cg_lexicon *l, char *pf);
 cg_lexilist *cg_lexicon_lookup_lf(cg_lexicon *l, char *pf);
 cg_lexilist *
    cg_lexicon_lookup_full(cg_lexicon *l, char *pf, char *cat, char *lf);
+void cg_lexicon_iter_init(struct cg_lexicon_iter *it, cg_lexicon *l,
+                          char *pf, const char *cat, const char *lf);
+cg_lexi *cg_lexicon_iter_next(struct cg_lexicon_iter *it);
 
 
 cg_lexi *cg_lexicon_add(cg_lexicon *l, char *pf, char *cat, char *lf);
+cg_lexi *cg_lexicon_add_f(cg_lexicon *l, char *pf, char *cat, char *lf, 
+                          size_t freq);
 int cg_lexicon_addstr(cg_lexicon *l, char *lexistr);
 void cg_lexicon_remove(cg_lexicon *l, cg_lexi *li);
 
@@ -117,5 +150,7 @@ cg_cat *cg_lexicon_addcat(cg_lexicon *l, char *catstr);
 
 double cg_lexicon_get_rfreq_pf(cg_lexicon *l, char *pf);
 size_t cg_lexicon_get_freq_pf(cg_lexicon *l, char *pf);
+size_t cg_lexicon_get_freq_span(cg_lexicon *l, strhash_t hv, 
+                                const char *pf, size_t len);
 
 #endif /* _LEXICON_H */
@@ -0,0 +1,370 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * A seg_model keeps its own copy of the options of seg, and the
+ * combine context of seg_combine.c that holds everything it learns.
+ * The global `opt' of seg is not used. The lock is only held while 
+ * the options are parsed and while a model is created, for the 
+ * settings of cclib_debug and bloom that are shared by all models.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include "libseg.h"
+#include "seg.h"
+#include "seg_combine.h"
+#include "seglist.h"
+#include "checkpoint.h"
+#include "bloom.h"
+#include "cclib_debug.h"
+
+#define MAXARGS 256
+
+struct seg_model {
+    struct gengetopt_args_info  opt;
+    struct combine              *c;
+    struct seg_stats            stats;
+};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline double
+now_sec()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* check_options() - reject the options seg accepts, but libseg does 
+ *                   not support
+ */
+static int
+check_options(const struct gengetopt_args_info *a)
+{
+    if (a->help_given || a->version_given) {
+        PERROR("--help and --version are not supported by libseg\n");
+    } else if (a->cues_given == 0) {
+        PERROR("no cues to combine\n");
+    } else if (a->method_arg != method_arg_combine) {
+        PERROR("only -m combine is supported by libseg\n");
+    } else if (a->bloom_fpr_arg < 0.0 || a->bloom_fpr_arg >= 1.0) {
+        PERROR("--bloom-fpr should be in [0, 1)\n");
+    } else if (a->prior_data_given) {
+        PERROR("--prior-data is not supported by libseg\n");
+    } else if (a->symbols_arg != symbols_arg_bytes) {
+        PERROR("libseg takes one byte per phoneme, not --symbols=%s\n",
+               cmdline_parser_symbols_values[a->symbols_arg]);
+    } else {
+        return 0;
+    }
+    return -1;
+}
+
+/* parse_options() - the options of seg for `o' */
+static int
+parse_options(const struct seg_options *o, struct gengetopt_args_info *a)
+{
+    static const struct { unsigned cue; char *name; } cues[] = {
+        {SEG_CUE_PRED, "pred"}, {SEG_CUE_PHON, "phon"}, 
+        {SEG_CUE_LEX, "lex"}, {SEG_CUE_STRESS, "stress"}
+    };
+    char *argv[MAXARGS] = {"seg", "-m", "combine", "--quiet"};
+    char *args = (o->args) ? strdup(o->args) : NULL, *tok, *save;
+    int argc = 4, i, ret;
+
+    for (i = 0; i < sizeof (cues) / sizeof (*cues); i++) {
+        if (o->cues & cues[i].cue) {
+            argv[argc++] = "-c";
+            argv[argc++] = cues[i].name;
+        }
+    }
+    for (tok = (args) ? strtok_r(args, " \t\n", &save) : NULL; tok;
+         tok = strtok_r(NULL, " \t\n", &save)) {
+        if (argc == MAXARGS - 1) {
+            PERROR("too many options\n");
+            free(args);
+            return -1;
+        }
+        argv[argc++] = tok;
+    }
+    argv[argc] = NULL;
+
+    pthread_mutex_lock(&lock);
+    ret = cmdline_parser(argc, argv, a);
+    pthread_mutex_unlock(&lock);
+    free(args);
+    if (ret == 0) ret = check_options(a);
+    if (ret != 0) cmdline_parser_free(a);
+    return ret;
+}
+
+void
+seg_options_init(struct seg_options *o)
+{
+    o->cues = SEG_CUE_PRED | SEG_CUE_PHON;
+    o->learn = 1;
+    o->args = NULL;
+}
+
+/* read_stats() - the libseg record of the checkpoint `ck', if any */
+static int
+read_stats(struct ckpt *ck, struct seg_stats *stats)
+{
+    struct ckpt_buf b;
+    char *data;
+
+    if (ckpt_find(ck, "libseg") == NULL) return 0;
+    if ((data = ckpt_read(ck, "libseg", &b)) == NULL) return -1;
+    ckpt_get(&b, stats, sizeof (*stats));
+    free(data);
+    return (b.err) ? -1 : 0;
+}
+
+/* model_new() - a model with the options `o', from the checkpoint 
+ *               `fname' if it is not NULL
+ */
+static struct seg_model *
+model_new(const struct seg_options *o, const char *fname)
+{
+    struct seg_model *m = calloc(1, sizeof (*m));
+    struct ckpt *ck = NULL;
+
+    if (m == NULL) return NULL;
+    if (parse_options(o, &m->opt) != 0) {
+        free(m);
+        return NULL;
+    }
+    if (fname && (ck = ckpt_open(fname)) == NULL) {
+        seg_model_free(m);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&lock);
+    cclib_debug_init(m->opt.debug_arg, 0, 0);
+    bloom_init(m->opt.bloom_fpr_arg);
+    m->c = combine_new(&m->opt, ck);
+    pthread_mutex_unlock(&lock);
+
+    if (m->c == NULL || (ck && read_stats(ck, &m->stats))) {
+        ckpt_close(ck);
+        seg_model_free(m);
+        return NULL;
+    }
+    ckpt_close(ck);
+    combine_learn(m->c, o->learn);
+    return m;
+}
+
+struct seg_model *
+seg_model_new(const struct seg_options *o)
+{
+    return model_new(o, NULL);
+}
+
+struct seg_model *
+seg_model_load(const struct seg_options *o, const char *fname)
+{
+    return model_new(o, fname);
+}
+
+void
+seg_model_free(struct seg_model *m)
+{
+    if (m == NULL) return;
+    if (m->c) combine_free(m->c);
+    cmdline_parser_free(&m->opt);
+    free(m);
+}
+
+int
+seg_model_save(struct seg_model *m, const char *fname)
+{
+    struct ckpt *ck = ckpt_create(fname);
+
+    if (ck == NULL) return -1;
+    combine_checkpoint(m->c, ck);
+    ckpt_put(ckpt_begin(ck, "libseg"), &m->stats, sizeof (m->stats));
+    ckpt_end(ck);
+    return ckpt_commit(ck);
+}
+
+void
+seg_model_stats(struct seg_model *m, struct seg_stats *st)
+{
+    *st = m->stats;
+    combine_lexsize(m->c, &st->ntypes, &st->ntokens);
+}
+
+/* check_stress() - `stress' is given as long as `len' if it is needed */
+static inline int
+check_stress(struct seg_model *m, const char *stress, size_t len)
+{
+    if (!combine_stress(m->c)) return 0;
+    return (stress && strlen(stress) == len) ? 0 : -1;
+}
+
+static int
+segment_one(struct seg_model *m, const char *utt, const char *stress,
+            size_t *bound)
+{
+    size_t len = strlen(utt);
+    struct seglist *segl;
+    char *u, *s = NULL;
+    int i, n;
+
+    if (len == 0) return 0;
+    if (len > USHRT_MAX || check_stress(m, stress, len)) return -1;
+
+    u = strdup(utt);
+    if (combine_stress(m->c)) s = strdup(stress);
+    segl = combine_segment(m->c, u, s);
+    n = segl->segs[0][0];
+    for (i = 0; i < n; i++) {
+        bound[i] = segl->segs[0][i + 1];
+    }
+    seglist_free(segl);
+    free(u);
+    free(s);
+    m->stats.nsegment++;
+    m->stats.nboundary += n;
+    return n;
+}
+
+static int
+update_one(struct seg_model *m, const char *utt, const char *stress,
+           const size_t *bound, size_t nbound)
+{
+    size_t len = strlen(utt), i;
+    unsigned short seg[nbound + 1];
+    struct seglist *segl;
+    char *u, *s = NULL;
+
+    if (len == 0 || len > USHRT_MAX || nbound >= len) return -1;
+    if (check_stress(m, stress, len)) return -1;
+    for (i = 0; i < nbound; i++) {
+        if (bound[i] == 0 || bound[i] >= len 
+                || (i && bound[i] <= bound[i - 1])) {
+            return -1;
+        }
+        seg[i + 1] = bound[i];
+    }
+    seg[0] = nbound;
+
+    u = strdup(utt);
+    if (combine_stress(m->c)) s = strdup(stress);
+    segl = seglist_new();
+    seglist_add(segl, seg);
+    combine_observe(m->c, u, s, segl);
+    seglist_free(segl);
+    free(u);
+    free(s);
+    m->stats.nupdate++;
+    return 0;
+}
+
+int
+seg_segment(struct seg_model *m, const char *utt, size_t *bound)
+{
+    return seg_segment_batch_stress(m, &utt, NULL, 1, bound, NULL);
+}
+
+int
+seg_segment_stress(struct seg_model *m, const char *utt, 
+                   const char *stress, size_t *bound)
+{
+    return seg_segment_batch_stress(m, &utt, &stress, 1, bound, NULL);
+}
+
+int
+seg_segment_batch(struct seg_model *m, const char *const *utt, size_t n,
+                  size_t *bound, size_t *nbound)
+{
+    return seg_segment_batch_stress(m, utt, NULL, n, bound, nbound);
+}
+
+int
+seg_segment_batch_stress(struct seg_model *m, const char *const *utt,
+                         const char *const *stress, size_t n,
+                         size_t *bound, size_t *nbound)
+{
+    double t0 = now_sec();
+    size_t i;
+    int ret = 0;
+
+    for (i = 0; i < n; i++) {
+        int k = segment_one(m, utt[i], (stress) ? stress[i] : NULL, bound);
+
+        if (k < 0) {
+            ret = -1;
+            break;
+        }
+        if (nbound) nbound[i] = k;
+        bound += strlen(utt[i]);
+        ret += k;
+    }
+    m->stats.seconds += now_sec() - t0;
+    return ret;
+}
+
+int
+seg_update(struct seg_model *m, const char *utt, 
+           const size_t *bound, size_t nbound)
+{
+    return seg_update_batch_stress(m, &utt, NULL, 1, bound, &nbound);
+}
+
+int
+seg_update_stress(struct seg_model *m, const char *utt, const char *stress,
+                  const size_t *bound, size_t nbound)
+{
+    return seg_update_batch_stress(m, &utt, &stress, 1, bound, &nbound);
+}
+
+int
+seg_update_batch(struct seg_model *m, const char *const *utt, size_t n,
+                 const size_t *bound, const size_t *nbound)
+{
+    return seg_update_batch_stress(m, utt, NULL, n, bound, nbound);
+}
+
+int
+seg_update_batch_stress(struct seg_model *m, const char *const *utt,
+                        const char *const *stress, size_t n,
+                        const size_t *bound, const size_t *nbound)
+{
+    double t0 = now_sec();
+    size_t i;
+    int ret = 0;
+
+    for (i = 0; i < n && ret == 0; i++) {
+        ret = update_one(m, utt[i], (stress) ? stress[i] : NULL, 
+                         bound, nbound[i]);
+        bound += strlen(utt[i]);
+    }
+    m->stats.seconds += now_sec() - t0;
+    return ret;
+}
@@ -0,0 +1,138 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _LIBSEG_H
+#define _LIBSEG_H 1
+
+/*
+ * libseg - the `-m combine' segmenter of seg as a library
+ *
+ * A model is created from a struct seg_options, and segments 
+ * utterances given as strings of phonemes, one byte per phoneme. The
+ * segmentation is returned as the offsets of the word boundaries in
+ * the utterance, in increasing order, without 0 and the length of the
+ * utterance. A model can learn from the utterances it segments, as 
+ * seg(1) does, and from utterances segmented by the caller. Models 
+ * with SEG_CUE_STRESS also need the stress of the utterances, one 
+ * byte per phoneme as in the --stress-file of seg(1), and are used
+ * with the *_stress() functions.
+ *
+ * The models are independent of each other, any number of them can be
+ * used in a process, and different models can be used from different
+ * threads at the same time. The calls on a single model should not
+ * overlap.
+ *
+ * The functions return 0 or a count on success, and -1 or NULL on 
+ * errors. Errors in the options and in reading or writing model files
+ * are also reported on stderr, none of them ends the process. A model
+ * is loaded with the options it was saved with.
+ */
+
+#include <stddef.h>
+
+#define SEG_API_VERSION 2
+
+#define SEG_API __attribute__((visibility("default")))
+
+enum seg_cue {
+    SEG_CUE_PRED   = 1, // predictability
+    SEG_CUE_PHON   = 2, // phonotactics, from the utterance boundaries
+    SEG_CUE_LEX    = 4, // the words learned so far
+    SEG_CUE_STRESS = 8, // stress patterns, from the utterance boundaries
+};
+
+struct seg_options {
+    unsigned    cues;   // SEG_CUE_* to combine
+    int         learn;  // learn from the utterances segmented
+    const char  *args;  // more options of seg(1) separated by spaces,
+};                      // e.g. "--pred-m=mi --lex-mult=2", or NULL
+
+struct seg_stats {
+    size_t      nsegment;   // utterances segmented
+    size_t      nupdate;    // segmented utterances learned from
+    size_t      nboundary;  // boundaries found in the utterances segmented
+    size_t      ntypes;     // word types learned
+    size_t      ntokens;    // word tokens learned
+    double      seconds;    // time spent segmenting and learning
+};
+
+struct seg_model;
+
+SEG_API void seg_options_init(struct seg_options *o);
+SEG_API struct seg_model *seg_model_new(const struct seg_options *o);
+SEG_API void seg_model_free(struct seg_model *m);
+
+/* seg_segment() - segment `utt', the boundaries are written to `bound'
+ *                 which has room for strlen(utt) of them. returns the 
+ *                 number of boundaries.
+ */
+SEG_API int seg_segment(struct seg_model *m, const char *utt, size_t *bound);
+
+/* seg_segment_batch() - segment the `n' utterances in `utt'
+ * 
+ * the boundaries of utt[i] are written to `bound' after the ones of 
+ * the utterances before it, and their number to nbound[i]. `bound' 
+ * has room for as many boundaries as the phonemes of all utterances.
+ * returns the number of all boundaries.
+ */
+SEG_API int seg_segment_batch(struct seg_model *m, const char *const *utt,
+                              size_t n, size_t *bound, size_t *nbound);
+
+/* seg_update() - learn from `utt' segmented with the `nbound' 
+ *                boundaries in `bound'
+ */
+SEG_API int seg_update(struct seg_model *m, const char *utt, 
+                       const size_t *bound, size_t nbound);
+
+/* seg_update_batch() - seg_update() the `n' utterances in `utt', the
+ *                      boundaries are as for seg_segment_batch()
+ */
+SEG_API int seg_update_batch(struct seg_model *m, const char *const *utt,
+                             size_t n, const size_t *bound, 
+                             const size_t *nbound);
+
+/* seg_*_stress() - the functions above, with the stress of the 
+ *                  utterances, stress[i] is as long as utt[i]
+ */
+SEG_API int seg_segment_stress(struct seg_model *m, const char *utt, 
+                               const char *stress, size_t *bound);
+SEG_API int seg_segment_batch_stress(struct seg_model *m, 
+                                     const char *const *utt, 
+                                     const char *const *stress, size_t n,
+                                     size_t *bound, size_t *nbound);
+SEG_API int seg_update_stress(struct seg_model *m, const char *utt, 
+                              const char *stress, 
+                              const size_t *bound, size_t nbound);
+SEG_API int seg_update_batch_stress(struct seg_model *m, 
+                                    const char *const *utt, 
+                                    const char *const *stress, size_t n,
+                                    const size_t *bound, 
+                                    const size_t *nbound);
+
+/* seg_model_save() - write `m' to the file `fname'. the file can also
+ *                    be a checkpoint of seg(1) with -m combine.
+ */
+SEG_API int seg_model_save(struct seg_model *m, const char *fname);
+SEG_API struct seg_model *seg_model_load(const struct seg_options *o, 
+                                         const char *fname);
+
+SEG_API void seg_model_stats(struct seg_model *m, struct seg_stats *st);
+
+#endif // _LIBSEG_H
@@ -0,0 +1,325 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+/* libsegbench.c -- benchmark of the libseg API
+ *
+ * Reads a segmented corpus, one utterance per line with the words
+ * separated by spaces, and times the models of libseg on it:
+ *
+ *   segment        seg_segment() for every utterance, learning
+ *   segment-batch  seg_segment_batch() with -b utterances per call,
+ *                  the boundaries should be the same as of `segment'
+ *   update         seg_update_batch() with the segmentation of the 
+ *                  corpus
+ *   frozen         seg_segment_batch() with a copy of the `update' 
+ *                  model loaded without learning
+ *
+ * The models are used side by side in one process, the results are
+ * written as CSV.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "libseg.h"
+
+struct corpus {
+    char        **utt;      // the utterances without the spaces
+    size_t      *bound;     // boundaries, see seg_segment_batch()
+    size_t      *nbound;
+    size_t      nutt;
+    size_t      nphon;
+};
+
+static void
+die(const char *msg, const char *arg)
+{
+    fprintf(stderr, "libsegbench: %s%s%s\n", msg, arg ? " " : "", 
+            arg ? arg : "");
+    exit(1);
+}
+
+static void *
+xrealloc(void *p, size_t size)
+{
+    p = realloc(p, size);
+    if (p == NULL) die("out of memory", NULL);
+    return p;
+}
+
+static double
+now_sec()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static struct corpus *
+corpus_read(const char *fname, size_t max)
+{
+    struct corpus *c = calloc(1, sizeof (*c));
+    size_t nalloc = 0, nalloc_bound = 0;
+    char *line = NULL;
+    size_t n = 0;
+    FILE *fp = fopen(fname, "r");
+
+    if (fp == NULL) die("cannot read", fname);
+    while (c->nutt < max && getline(&line, &n, fp) > 0) {
+        char *u, *p;
+        size_t len = 0;
+
+        if (c->nutt == nalloc) {
+            nalloc = nalloc ? 2 * nalloc : 1024;
+            c->utt = xrealloc(c->utt, nalloc * sizeof (*c->utt));
+            c->nbound = xrealloc(c->nbound, nalloc * sizeof (*c->nbound));
+        }
+        if (c->nphon + strlen(line) > nalloc_bound) {
+            nalloc_bound = 2 * (c->nphon + strlen(line));
+            c->bound = xrealloc(c->bound, nalloc_bound * sizeof (*c->bound));
+        }
+        u = malloc(strlen(line) + 1);
+        c->nbound[c->nutt] = 0;
+        for (p = line; *p && *p != '\n'; p++) {
+            if (*p == ' ') {
+                if (len && p[1] != ' ' && p[1] != '\n' && p[1]) {
+                    c->bound[c->nphon + c->nbound[c->nutt]++] = len;
+                }
+            } else {
+                u[len++] = *p;
+            }
+        }
+        u[len] = '\0';
+        if (len == 0) {
+            free(u);
+            continue;
+        }
+        c->utt[c->nutt++] = u;
+        c->nphon += len;
+    }
+    free(line);
+    fclose(fp);
+    if (c->nutt == 0) die("no utterances in", fname);
+    return c;
+}
+
+static void
+corpus_free(struct corpus *c)
+{
+    size_t i;
+
+    for (i = 0; i < c->nutt; i++) free(c->utt[i]);
+    free(c->utt);
+    free(c->bound);
+    free(c->nbound);
+    free(c);
+}
+
+static void
+report(const char *name, struct seg_model *m, size_t nutt, double sec)
+{
+    struct seg_stats st;
+
+    seg_model_stats(m, &st);
+    printf("%s,%zu,%.3f,%.0f,%zu,%zu\n", name, nutt, sec, nutt / sec,
+           st.nboundary, st.ntypes);
+}
+
+/* segment() - segment `c' with `m', `batch' utterances at a time */
+static double
+segment(struct seg_model *m, struct corpus *c, size_t batch, 
+        size_t *bound, size_t *nbound)
+{
+    double t0 = now_sec();
+    size_t i, off = 0;
+
+    for (i = 0; i < c->nutt; i += batch) {
+        size_t n = (i + batch > c->nutt) ? c->nutt - i : batch, j;
+
+        if (seg_segment_batch(m, (const char *const *) c->utt + i, n,
+                              bound + off, nbound + i) < 0) {
+            die("seg_segment_batch() failed", NULL);
+        }
+        for (j = i; j < i + n; j++) off += strlen(c->utt[j]);
+    }
+    return now_sec() - t0;
+}
+
+struct job {
+    struct seg_model    *m;
+    struct corpus       *c;
+    size_t              batch;
+    size_t              *bound;
+    size_t              *nbound;
+};
+
+static void *
+segment_job(void *arg)
+{
+    struct job *j = arg;
+
+    segment(j->m, j->c, j->batch, j->bound, j->nbound);
+    return NULL;
+}
+
+/* same() - the segmentations `bound1' and `bound2' of `c' are the same */
+static int
+same(struct corpus *c, size_t *bound1, size_t *nbound1, 
+     size_t *bound2, size_t *nbound2)
+{
+    size_t i, off;
+
+    for (i = 0, off = 0; i < c->nutt; off += strlen(c->utt[i++])) {
+        if (nbound1[i] != nbound2[i] || memcmp(bound1 + off, bound2 + off, 
+                                     nbound1[i] * sizeof (*bound1))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void
+usage()
+{
+    fprintf(stderr, 
+"usage: libsegbench [-n utterances] [-b batch] [-a args] [corpus]\n"
+"  -n N   use the first N utterances of the corpus (10000)\n"
+"  -b N   utterances per call of the batch functions (64)\n"
+"  -a S   more options of seg for the models, e.g. \"--pred-m=mi\"\n"
+"  the corpus is data/br-phono.txt by default\n");
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *src = "data/br-phono.txt";
+    size_t max = 10000, batch = 64, i, off;
+    struct seg_options o;
+    struct seg_model *m1, *m2, *m3, *m4;
+    struct job jobs[3];
+    pthread_t th[2];
+    struct corpus *c;
+    size_t *bound1, *bound2, *nbound1, *nbound2;
+    char fname[4096];
+    double sec;
+    int ch;
+
+    seg_options_init(&o);
+    o.args = "--pred-m=mi";
+    while ((ch = getopt(argc, argv, "n:b:a:h")) != -1) {
+        switch (ch) {
+        case 'n': max = strtoul(optarg, NULL, 10); break;
+        case 'b': batch = strtoul(optarg, NULL, 10); break;
+        case 'a': o.args = optarg; break;
+        default: usage();
+        }
+    }
+    if (optind < argc) src = argv[optind];
+    if (max == 0 || batch == 0) usage();
+
+    c = corpus_read(src, max);
+    fprintf(stderr, "libsegbench: %zu utterances from %s\n", c->nutt, src);
+    bound1 = malloc(c->nphon * sizeof (*bound1));
+    bound2 = malloc(c->nphon * sizeof (*bound2));
+    nbound1 = malloc(c->nutt * sizeof (*nbound1));
+    nbound2 = malloc(c->nutt * sizeof (*nbound2));
+
+    if ((m1 = seg_model_new(&o)) == NULL || (m2 = seg_model_new(&o)) == NULL) {
+        die("cannot create a model with", o.args);
+    }
+
+    printf("case,utterances,seconds,utt_per_s,boundaries,word_types\n");
+    sec = segment(m1, c, 1, bound1, nbound1);
+    report("segment", m1, c->nutt, sec);
+    sec = segment(m2, c, batch, bound2, nbound2);
+    report("segment-batch", m2, c->nutt, sec);
+    if (!same(c, bound1, nbound1, bound2, nbound2)) {
+        die("the batch segmentation differs", NULL);
+    }
+
+    // models with the lexical cue, one alone and two at the same time
+    o.cues |= SEG_CUE_LEX;
+    for (i = 0; i < 3; i++) {
+        jobs[i].m = seg_model_new(&o);
+        if (jobs[i].m == NULL) die("cannot create a model with", o.args);
+        jobs[i].c = c;
+        jobs[i].batch = batch;
+        jobs[i].bound = malloc(c->nphon * sizeof (*jobs[i].bound));
+        jobs[i].nbound = malloc(c->nutt * sizeof (*jobs[i].nbound));
+    }
+    segment_job(&jobs[2]);
+    sec = now_sec();
+    for (i = 0; i < 2; i++) {
+        pthread_create(&th[i], NULL, segment_job, &jobs[i]);
+    }
+    for (i = 0; i < 2; i++) pthread_join(th[i], NULL);
+    report("threads", jobs[0].m, 2 * c->nutt, now_sec() - sec);
+    for (i = 0; i < 3; i++) {
+        if (i < 2 && !same(c, jobs[2].bound, jobs[2].nbound, 
+                           jobs[i].bound, jobs[i].nbound)) {
+            die("the segmentation in a thread differs", NULL);
+        }
+        seg_model_free(jobs[i].m);
+        free(jobs[i].bound);
+        free(jobs[i].nbound);
+    }
+
+    if ((m3 = seg_model_new(&o)) == NULL) {
+        die("cannot create a model with", o.args);
+    }
+
+    sec = now_sec();
+    for (i = 0, off = 0; i < c->nutt; i += batch) {
+        size_t n = (i + batch > c->nutt) ? c->nutt - i : batch, j;
+
+        if (seg_update_batch(m3, (const char *const *) c->utt + i, n,
+                             c->bound + off, c->nbound + i) < 0) {
+            die("seg_update_batch() failed", NULL);
+        }
+        for (j = i; j < i + n; j++) off += strlen(c->utt[j]);
+    }
+    report("update", m3, c->nutt, now_sec() - sec);
+
+    snprintf(fname, sizeof fname, "/tmp/libsegbench-%d.model", getpid());
+    seg_model_save(m3, fname);
+    o.learn = 0;
+    if ((m4 = seg_model_load(&o, fname)) == NULL) {
+        die("cannot load", fname);
+    }
+    unlink(fname);
+    sec = segment(m4, c, batch, bound2, nbound2);
+    report("frozen", m4, c->nutt, sec);
+
+    seg_model_free(m1);
+    seg_model_free(m2);
+    seg_model_free(m3);
+    seg_model_free(m4);
+    free(bound1);
+    free(bound2);
+    free(nbound1);
+    free(nbound2);
+    corpus_free(c);
+    return 0;
+}
@@ -35,6 +35,8 @@ mdata_new()
     md->cL = NULL;
     md->c = NULL;
     md->ps = NULL;
+    md->kern = NULL;
+    md->opt = &opt;
     return md;
 }
 
@@ -61,7 +63,8 @@ mdlist_new()
     struct mdlist *mdl = malloc (sizeof (*mdl));
     mdl->md = NULL;
     mdl->n = mdl->nalloc = 0;
-    
+    mdl->opt = &opt;
+
     return mdl;
 }
 
@@ -73,6 +76,7 @@ mdlist_add (struct mdlist *mdl, struct mdata *md)
         mdl->md = malloc (mdl->nalloc * sizeof (*mdl->md));
     }
     
+    md->opt = mdl->opt;
     mdl->md[mdl->n] = md;
     mdl->n++;
 }
@@ -27,6 +27,7 @@
 
 struct minfo;
 enum m_id;
+struct span_hash;
 
 struct mdata {
     struct minfo *info;
@@ -41,12 +42,18 @@ struct mdata {
     cg_lexicon *L;  //these two are used by lexicon based seg.
     struct ctxlex *cL;  //these two are used by lexicon based seg.
     struct chart *c;//chart can be null
+    const struct gengetopt_args_info *opt;  // the options of the model
+    void (*kern)(struct phonstats *ps,  // list kernel, set once by
+                 struct mdata *m,       // pred_resolve(), NULL for
+                 struct span_hash *sh,  // measures without one
+                 int len, double *out);
 };
 
 struct mdlist {
     struct mdata **md;
     size_t n;
     size_t nalloc;
+    const struct gengetopt_args_info *opt;  // the global `opt' by default
 };
 
 
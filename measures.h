@@ -60,8 +60,9 @@ struct minfo {
     double (*calc_single)(struct phonstats *ps,
                           struct mdata *mdata,
                           int pos);
-    double *(*calc_list)(struct phonstats *ps,
-                         struct mdata *mdata);
+    double *(*calc_list)(struct phonstats *ps, // the values are written
+                         struct mdata *mdata,  // to `out', or to a new
+                         double *out);         // list if it is NULL
 };
 
 
@@ -0,0 +1,164 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <glib.h>
+#include "mem.h"
+
+int mem_on = 0;
+
+static int mem_every = 0;           // report every N utterances, or 0
+static struct mem_acct *accts = NULL;
+static pthread_mutex_t accts_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *cat_name[MEM_NCAT] = {
+    "hash", "keys", "values", "index", "dist", "ctx_global", 
+    "ctx_word", "buf", "other"
+};
+
+/* mem_init() - start counting, and report after every `every' 
+ *              utterances if it is positive. 
+ *
+ * the accounts created before are not counted, this should be called
+ * before anything is allocated.
+ */
+void
+mem_init(int every)
+{
+    mem_every = (every > 0) ? every : 0;
+    mem_on = 1;
+#ifdef MEM_NO_BLOCK_SIZE
+    fprintf(stderr, "mem: the sizes of the allocated blocks are not "
+                    "known on this system, only the estimates are "
+                    "reported\n");
+#endif
+}
+
+struct mem_acct *
+mem_acct_new(const char *name, mem_refresh_fn refresh, void *owner)
+{
+    struct mem_acct *a, **p = &accts;
+
+    if (!mem_on) return NULL;
+
+    a = calloc(1, sizeof (*a));
+    assert(a != NULL);
+    mem_acct_name(a, name);
+    a->refresh = refresh;
+    a->owner = owner;
+    pthread_mutex_lock(&accts_lock);
+    while (*p) p = &(*p)->next;  // the report lists them in this order
+    *p = a;
+    pthread_mutex_unlock(&accts_lock);
+    return a;
+}
+
+void
+mem_acct_name(struct mem_acct *a, const char *name)
+{
+    if (a == NULL) return;
+    strncpy(a->name, name, sizeof (a->name) - 1);
+    a->name[sizeof (a->name) - 1] = '\0';
+}
+
+void
+mem_acct_free(struct mem_acct *a)
+{
+    struct mem_acct **p = &accts;
+
+    if (a == NULL) return;
+    pthread_mutex_lock(&accts_lock);
+    while (*p && *p != a) p = &(*p)->next;
+    assert(*p != NULL);
+    *p = a->next;
+    pthread_mutex_unlock(&accts_lock);
+    free(a);
+}
+
+/* mem_hash_bytes() - estimated size of the table `h' without its keys 
+ *                    and values
+ *
+ * a GHashTable keeps three arrays, the hash values, the keys and the
+ * values, sized to the power of two above 4/3 of the entries.
+ */
+size_t
+mem_hash_bytes(GHashTable *h)
+{
+    size_t n, size = 8;
+
+    if (h == NULL) return 0;
+    n = g_hash_table_size(h) * 4 / 3;
+    while (size <= n) size <<= 1;
+    return 128 + size * (sizeof (guint) + 2 * sizeof (gpointer));
+}
+
+void
+mem_tick(size_t n)
+{
+    char when[64];
+
+    if (!mem_on || !mem_every || n % mem_every) return;
+    snprintf(when, sizeof when, "after %zu utterances", n);
+    mem_report(when);
+}
+
+/* mem_report() - print the bytes held by each account to stderr */
+void
+mem_report(const char *when)
+{
+    struct mem_acct *a;
+    size_t sum[MEM_NCAT] = {0}, total = 0;
+    int c;
+
+    if (!mem_on) return;
+
+    pthread_mutex_lock(&accts_lock);
+    fprintf(stderr, "mem: %s\n", when);
+    fprintf(stderr, "mem: %-10s %12s", "account", "total");
+    for (c = 0; c < MEM_NCAT; c++) {
+        fprintf(stderr, " %10s", cat_name[c]);
+    }
+    fprintf(stderr, "\n");
+    for (a = accts; a; a = a->next) {
+        size_t atotal = 0;
+
+        if (a->refresh) a->refresh(a, a->owner);
+        for (c = 0; c < MEM_NCAT; c++) {
+            atotal += a->bytes[c];
+            sum[c] += a->bytes[c];
+        }
+        total += atotal;
+        fprintf(stderr, "mem: %-10s %12zu", a->name, atotal);
+        for (c = 0; c < MEM_NCAT; c++) {
+            fprintf(stderr, " %10zu", a->bytes[c]);
+        }
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, "mem: %-10s %12zu", "total", total);
+    for (c = 0; c < MEM_NCAT; c++) {
+        fprintf(stderr, " %10zu", sum[c]);
+    }
+    fprintf(stderr, "\n");
+    pthread_mutex_unlock(&accts_lock);
+}
@@ -0,0 +1,174 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MEM_H
+#define _MEM_H       1
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+/* the usable size of a malloc()ed block, where the C library tells */
+#if defined(__GLIBC__) || defined(__linux__)
+# include <malloc.h>
+# define mem_block_size(p)  malloc_usable_size(p)
+#elif defined(__APPLE__)
+# include <malloc/malloc.h>
+# define mem_block_size(p)  malloc_size(p)
+#elif defined(__FreeBSD__)
+# include <malloc_np.h>
+# define mem_block_size(p)  malloc_usable_size(p)
+#else
+# define MEM_NO_BLOCK_SIZE  1
+# define mem_block_size(p)  ((size_t) 0)
+#endif
+
+/*
+ * Memory accounting for --mem-report.
+ *
+ * Each long-lived structure (a phonstats, a lexicon, the input ...)
+ * owns an account, and counts the blocks it allocates and frees with
+ * the mem_*() wrappers below, by category. The sizes are the usable
+ * sizes reported by malloc, so the allocator's rounding is included,
+ * its per-block headers are not. On the C libraries that do not 
+ * report the size of a block (MEM_NO_BLOCK_SIZE), only the estimates
+ * and the sizes counted with mem_add_n() are reported.
+ *
+ * The memory allocated inside glib cannot be counted this way. The
+ * hash table overhead is estimated from the number of entries by the
+ * refresh callback of the account, which is run before each report.
+ *
+ * All wrappers fall back to the plain calls when the account is NULL,
+ * which is always the case unless mem_init() is called. Counting is
+ * atomic, so the wrappers can be used from the parser threads.
+ */
+
+enum mem_cat {
+    MEM_HASH = 0,   // hash tables and Bloom filters, estimated
+    MEM_KEYS,       // hash keys: n-gram, pf, lf, category and word strings
+    MEM_VALUES,     // hash values: counts, list heads, items, categories
+    MEM_INDEX,      // ngstr arrays, lexilists, category and word tables
+    MEM_DIST,       // prob_dist structures
+    MEM_CTX_GLOBAL, // context table entries regardless of the word
+    MEM_CTX_WORD,   // context table entries of each word
+    MEM_BUF,        // input/output records and chart storage
+    MEM_OTHER,      // the structures themselves and small arrays
+    MEM_NCAT
+};
+
+struct mem_acct;
+typedef void (*mem_refresh_fn)(struct mem_acct *a, void *owner);
+
+struct mem_acct {
+    char            name[32];
+    size_t          bytes[MEM_NCAT];
+    mem_refresh_fn  refresh;    // sets the estimated categories, or NULL
+    void            *owner;
+    struct mem_acct *next;
+};
+
+extern int mem_on;
+
+void mem_init(int every);
+void mem_tick(size_t n);
+void mem_report(const char *when);
+
+struct mem_acct *mem_acct_new(const char *name, mem_refresh_fn refresh,
+                              void *owner);
+void mem_acct_name(struct mem_acct *a, const char *name);
+void mem_acct_free(struct mem_acct *a);
+
+size_t mem_hash_bytes(GHashTable *h);
+
+static inline void
+mem_add_n(struct mem_acct *a, enum mem_cat c, size_t n)
+{
+    if (a) __atomic_add_fetch(&a->bytes[c], n, __ATOMIC_RELAXED);
+}
+
+/* 
+ * subtracting from a category that a refresh callback re-splits can
+ * wrap around in between, the sum over the categories is still right.
+ */
+static inline void
+mem_sub_n(struct mem_acct *a, enum mem_cat c, size_t n)
+{
+    if (a) __atomic_sub_fetch(&a->bytes[c], n, __ATOMIC_RELAXED);
+}
+
+/* mem_add() - count the block `p' allocated outside the wrappers */
+static inline void
+mem_add(struct mem_acct *a, enum mem_cat c, void *p)
+{
+    if (a && p) mem_add_n(a, c, mem_block_size(p));
+}
+
+/* mem_sub() - uncount the block `p' before it is freed */
+static inline void
+mem_sub(struct mem_acct *a, enum mem_cat c, void *p)
+{
+    if (a && p) mem_sub_n(a, c, mem_block_size(p));
+}
+
+static inline void *
+mem_malloc(struct mem_acct *a, enum mem_cat c, size_t size)
+{
+    void *p = malloc(size);
+
+    mem_add(a, c, p);
+    return p;
+}
+
+static inline void *
+mem_calloc(struct mem_acct *a, enum mem_cat c, size_t n, size_t size)
+{
+    void *p = calloc(n, size);
+
+    mem_add(a, c, p);
+    return p;
+}
+
+static inline void *
+mem_realloc(struct mem_acct *a, enum mem_cat c, void *p, size_t size)
+{
+    mem_sub(a, c, p);
+    p = realloc(p, size);
+    mem_add(a, c, p);
+    return p;
+}
+
+static inline char *
+mem_strdup(struct mem_acct *a, enum mem_cat c, const char *s)
+{
+    char *p = strdup(s);
+
+    mem_add(a, c, p);
+    return p;
+}
+
+static inline void
+mem_free(struct mem_acct *a, enum mem_cat c, void *p)
+{
+    mem_sub(a, c, p);
+    free(p);
+}
+
+#endif // _MEM_H
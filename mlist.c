@@ -27,6 +27,7 @@
 #include <string.h>
 #include "mlist.h"
 #include "mdata.h"
+#include "profile.h"
 
 
 struct mlist *
@@ -40,37 +41,108 @@ mlist_new(int mcount)
     ml->m = (mcount == 0) ? NULL : calloc(mcount, sizeof (*ml->m));
     ml->mlist = (mcount == 0) ? NULL : calloc(mcount, sizeof (*ml->mlist));
     ml->nalloc = (mcount == 0) ? 0 : mcount;
+    ml->val = NULL;
+    ml->nalloc_val = 0;
+    ml->vote_l = ml->vote_r = NULL;
+    ml->nalloc_vote = 0;
     return ml;
 }
 
+/* the rows that are not in ml->val are added with mlist_add2() */
+static inline int
+row_owned(struct mlist *ml, double *row)
+{
+    return row >= ml->val && row < ml->val + ml->nalloc_val;
+}
+
+static void
+mlist_release_rows(struct mlist *ml)
+{
+    int i;
+
+    for (i = 0; i < ml->len; i++) {
+        if (!row_owned(ml, ml->mlist[i])) free(ml->mlist[i]);
+        ml->mlist[i] = NULL;
+    }
+}
+
+/* mlist_reset() - empty the list, and prepare it for the string `s' */
+void
+mlist_reset(struct mlist *ml, char *s, int slen)
+{
+    size_t need = ml->nalloc * (slen + 1);
+
+    mlist_release_rows(ml);
+    ml->len = 0;
+    ml->s = s;
+    ml->slen = slen;
+    if (ml->nalloc_val < need) {
+        free(ml->val);
+        ml->val = malloc(need * sizeof (*ml->val));
+        ml->nalloc_val = need;
+    }
+}
+
 void 
 mlist_free(struct mlist *ml, int free_data)
 {
     int i;
 
-    for (i = 0; i < ml->len; i++) {
-        if (free_data) {
+    mlist_release_rows(ml);
+    if (free_data) {
+        for (i = 0; i < ml->len; i++) {
             free(ml->m[i]);
             ml->m[i] = NULL;
         }
-        free(ml->mlist[i]);
     }
     free(ml->mlist);
     free(ml->m);
+    free(ml->val);
+    free(ml->vote_l);
+    free(ml->vote_r);
     free(ml);
 }
 
-/* mlist_add2() : add the specified measure values to given mlist
+/* mlist_grow() - make room for one more measure
+ *
+ * the rows in ml->val move if it is re-allocated.
  */
+static void
+mlist_grow(struct mlist *ml)
+{
+    size_t stride = ml->slen + 1;
+    double *val;
+    int i;
+
+    ml->nalloc = (ml->nalloc) ? 2 * ml->nalloc : 8;
+    ml->m = realloc(ml->m, ml->nalloc * sizeof (*ml->m));
+    ml->mlist = realloc(ml->mlist, ml->nalloc * sizeof (*ml->mlist));
+    prof_count(PROF_ALLOCS, 2);
 
-#define ALLOC_INCR (BUFSIZ / sizeof (*ml->mlist))
+    if (ml->nalloc * stride <= ml->nalloc_val) return;
+
+    val = malloc(ml->nalloc * stride * sizeof (*val));
+    prof_count(PROF_ALLOCS, 1);
+    for (i = 0; i < ml->len; i++) {
+        if (row_owned(ml, ml->mlist[i])) {
+            double *row = val + (ml->mlist[i] - ml->val);
+            memcpy(row, ml->mlist[i], stride * sizeof (*row));
+            ml->mlist[i] = row;
+        }
+    }
+    free(ml->val);
+    ml->val = val;
+    ml->nalloc_val = ml->nalloc * stride;
+}
+
+/* mlist_add2() : add the specified measure values to given mlist
+ *
+ * `val' should be allocated with malloc(), it is freed with the list.
+ */
 void mlist_add2(struct mlist *ml, struct mdata *m, double *val)
 {
-
     if (ml->nalloc == ml->len) {
-        ml->nalloc += ALLOC_INCR;
-        ml->m = realloc(ml->m, ml->nalloc * sizeof (*ml->m));
-        ml->mlist = realloc(ml->m, ml->nalloc * sizeof (*ml->mlist));
+        mlist_grow(ml);
     }
 
     ml->m[ml->len] = m;
@@ -78,6 +150,16 @@ void mlist_add2(struct mlist *ml, struct mdata *m, double *val)
     ++ml->len;
 }
 
+static inline double *
+mlist_row(struct mlist *ml)
+{
+    if (ml->nalloc == ml->len || 
+        (ml->len + 1) * (ml->slen + 1) > ml->nalloc_val) {
+        mlist_grow(ml);
+    }
+    return ml->val + ml->len * (ml->slen + 1);
+}
+
 /* mlist_add() : add the specified measure to given mlist, calculating 
  *               it from the supplied function in mdata
  */
@@ -85,15 +167,49 @@ void mlist_add2(struct mlist *ml, struct mdata *m, double *val)
 void 
 mlist_add(struct mlist *ml, struct mdata *m)
 {
+    double *row;
+
+    struct prof_mark pm = prof_start(PROF_MEASURES);
+
     assert (m->info->calc_list != NULL);
-    mlist_add2(ml, m,  m->info->calc_list(m->ps, m));
+    row = mlist_row(ml);
+    ml->m[ml->len] = m;
+    ml->mlist[ml->len] = m->info->calc_list(m->ps, m, row);
+    ++ml->len;
+    prof_stop_md(&pm, m);
 }
 
 void 
 mlist_add_old(struct mlist *ml, struct mdata *m, struct phonstats *ps)
 {
+    double *row;
+
+    struct prof_mark pm = prof_start(PROF_MEASURES);
+
     assert (m->info->calc_list != NULL);
-    mlist_add2(ml, m,  m->info->calc_list(ps, m));
+    row = mlist_row(ml);
+    ml->m[ml->len] = m;
+    ml->mlist[ml->len] = m->info->calc_list(ps, m, row);
+    ++ml->len;
+    prof_stop_md(&pm, m);
+}
+
+/* mlist_votes() - make room for the votes of all measures */
+void
+mlist_votes(struct mlist *ml, int dual)
+{
+    size_t need = ml->len * ml->slen;
+
+    if (ml->nalloc_vote < need) {
+        free(ml->vote_l);
+        free(ml->vote_r);
+        ml->vote_l = malloc(need * sizeof (*ml->vote_l));
+        ml->vote_r = NULL;
+        ml->nalloc_vote = need;
+    }
+    if (dual && ml->vote_r == NULL) {
+        ml->vote_r = malloc(ml->nalloc_vote * sizeof (*ml->vote_r));
+    }
 }
 
 #define PREC 2
@@ -26,6 +26,14 @@
 #include "measures.h"
 
 
+/*
+ * The values of all measures are kept in a single measures x positions
+ * matrix, mlist[m] is the row (slen + 1 values) of the m-th measure.
+ * The votes are kept the other way around, positions x measures, so 
+ * that the votes of all measures for a position are contiguous, see
+ * MLIST_VOTES(). An mlist is meant to be kept by the segmenter and 
+ * reused for all utterances with mlist_reset(), the buffers only grow.
+ */
 struct mlist {
     char *s;         //pointer to the (utterance) string 
     int  slen;       //lenght of s, to avoid re-calculation
@@ -33,10 +41,19 @@ struct mlist {
     size_t   nalloc; // amount of memory used (internal use)
     struct mdata **m;
     double **mlist;
+    double *val;     // storage for the rows of mlist
+    size_t nalloc_val;
+    double *vote_l;  // votes for each position and measure
+    double *vote_r;  //   vote_r is only used for dual peaks
+    size_t nalloc_vote;
 };
 
+#define MLIST_VOTES(ml, v, i) ((v) + (size_t) (i) * (ml)->len)
+
 struct mlist *mlist_new(int len);
+void mlist_reset(struct mlist *ml, char *s, int slen);
 void mlist_free(struct mlist *ml, int free_mdata);
+void mlist_votes(struct mlist *ml, int dual);
 void mlist_add(struct mlist *ml, struct mdata *m);
 void mlist_add_old(struct mlist *ml, struct mdata *m, struct phonstats *ps);
 void mlist_add2(struct mlist *ml, struct mdata *m, double *val);
@@ -21,20 +21,92 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
-#include "options.h"
 #include "mvote.h"
 #include "peak.h"
 #include "mdata.h"
+#include "vote_kernel.h"
+#include "cclib_debug.h"
+#include "profile.h"
 
-static int nvotes = -1;
+static double
+combine_mv(struct mv_state *mv, double sum, int votec, int len,
+           double *w_l, double *w_r, double *vote_l, double *vote_r)
+{
+    return (sum + (double) len) / 2 - mv->combine_rate * (double) len;
+}
+
+static double
+combine_any(struct mv_state *mv, double sum, int votec, int len,
+            double *w_l, double *w_r, double *vote_l, double *vote_r)
+{
+    return (votec > 0) ? 1 : -1;
+}
+
+static double
+combine_all(struct mv_state *mv, double sum, int votec, int len,
+            double *w_l, double *w_r, double *vote_l, double *vote_r)
+{
+    return (votec == len) ? 1 : -1;
+}
 
-void mv_init()
+static double
+combine_wmv(struct mv_state *mv, double sum, int votec, int len,
+            double *w_l, double *w_r, double *vote_l, double *vote_r)
 {
-    nvotes = 0;
+    double mvtmp = (sum + (double) len) / 2 - mv->combine_rate * (double) len;
+
+    mv->vkern->wupdate(w_l, vote_l, mvtmp, mv->nvotes, len);
+    if (mv->dual_weights) {
+        mv->vkern->wupdate(w_r, vote_r, mvtmp, mv->nvotes, len);
+    } else {
+        memcpy(w_r, w_l, len * sizeof (*w_r));
+    }
+    return mvtmp;
+}
+
+/* 
+ * mv_init() - set up the voting of `mv' from the options `o'
+ *
+ * returns 0, or -1 if the options are not usable, e.g., the vote 
+ * kernels are not supported on this machine.
+ */
+int
+mv_init(struct mv_state *mv, const struct gengetopt_args_info *o)
+{
+    const char *k = cmdline_parser_vote_kernel_values[o->vote_kernel_arg];
+
+    mv->nvotes = 0;
+    mv->combine_rate = o->combine_rate_arg;
+    mv->dual_weights = (o->peak_arg == peak_arg_dual);
+    mv->peak = o->peak_arg;
+    mv->vote = o->vote_arg;
+    mv->boundary_method = o->boundary_method_arg;
+    switch (o->combine_arg) {
+        case combine_arg_mv:  mv->combine = combine_mv;  break;
+        case combine_arg_any: mv->combine = combine_any; break;
+        case combine_arg_all: mv->combine = combine_all; break;
+        case combine_arg_wmv:
+        default:              mv->combine = combine_wmv; break;
+    }
+    if (o->peak_arg == peak_arg_strict2 && !o->pred_norm_flag) {
+        PERROR("--peak=strict2 needs --pred-norm\n");
+        return -1;
+    }
+    if (o->boundary_method_arg != boundary_method_arg_peak) {
+        PERROR("--boundary-method=%s is not supported with voting\n",
+               cmdline_parser_boundary_method_values[o->boundary_method_arg]);
+        return -1;
+    }
+    if ((mv->vkern = vote_kernel_find(k)) == NULL) {
+        PERROR("vote kernels `%s' are not supported on this machine\n", k);
+        return -1;
+    }
+    PDEBUG(1, "using %s vote kernels\n", mv->vkern->name);
+    return 0;
 }
 
 double 
-weight_update(double vote, double mvote, double cweight)
+weight_update(double vote, double mvote, double cweight, int nvotes)
 {
     double diff = (SIGN(mvote) == SIGN(vote)) ? 1.0 : -1.0;
     double tpcount = (double) (nvotes - 1)  * cweight + diff;
@@ -47,24 +119,26 @@ weight_update(double vote, double mvote, double cweight)
 
 
 double *
-mv_getvotes(double *mv, struct mlist *ml) 
+mv_getvotes(struct mv_state *st, double *mv, struct mlist *ml) 
 {
     int i, m;
     if (ml->slen == 0) ml->slen = strlen(ml->s);
 
-    assert(nvotes >= 0);
+    assert(st->nvotes >= 0 && st->combine != NULL);
     assert(ml->len != 0);
 
-    double **vote_l = NULL;
-    double **vote_r = NULL;
+    double w_l[ml->len], w_r[ml->len];
+    double p_l[ml->len], p_r[ml->len];
+    const struct vote_kernel *vkern = st->vkern;
+    struct prof_mark pm = prof_start(PROF_VOTE);
 
     int vc = 0;
-    switch (opt.boundary_method_arg) {
+    switch (st->boundary_method) {
     case boundary_method_arg_peak:
-        vc = get_votes_peak(&vote_l, &vote_r, ml);
+        vc = get_votes_peak(ml, st);
     break;
 //    case boundary_method_arg_threshold:
-//        vc = get_votes_threshold(&vote_l, &vote_r, ml);
+//        vc = get_votes_threshold(ml);
 //    break;
     default:
         assert("we should not be here!");
@@ -74,62 +148,39 @@ mv_getvotes(double *mv, struct mlist *ml)
         mv = malloc (ml->slen * sizeof (*mv));
     }
 
+    // the weights are updated in place, and copied back at the end
+    for (m = 0; m < ml->len; m++) {
+        w_l[m] = ml->m[m]->w_l;
+        w_r[m] = ml->m[m]->w_r;
+    }
+
     for (i = 1; i < ml->slen; i++) {
         int votec = 0;
+        double *vote_l = MLIST_VOTES(ml, ml->vote_l, i),
+               *vote_r = (vc == 2) ? MLIST_VOTES(ml, ml->vote_r, i) : NULL;
 
         mv[i] = 0.0;
-        ++nvotes;
+        ++st->nvotes;
+        // the products are vectorized, the sum keeps the scalar order
+        vkern->wmul(p_l, w_l, vote_l, ml->len);
+        votec = vkern->npos(vote_l, ml->len);
+        if (vc == 2 ) { // we have votes for both left and right
+            vkern->wmul(p_r, w_r, vote_r, ml->len);
+            votec += vkern->npos(vote_r, ml->len);
+        }
         for (m = 0; m < ml->len; m++) {
-            mv[i] += ml->m[m]->w_l * vote_l[m][i];
-            if (vote_l[m][i] > 0.0) votec++;
-            if (vc == 2 ) { // we have votes for both left and right
-                mv[i] += ml->m[m]->w_r * vote_r[m][i];
-                if (vote_r[m][i] > 0.0) votec++;
-            }
+            mv[i] += p_l[m];
+            if (vc == 2) mv[i] += p_r[m];
         }
 
-        switch (opt.combine_arg) {
-            case combine_arg_mv:
-                mv[i] = (mv[i] + (double) ml->len) / 2 
-                          - opt.combine_rate_arg * (double) ml->len;
-            break;
-            case combine_arg_any:
-                mv[i] = (votec > 0) ? 1 : -1;
-            break; 
-            case combine_arg_all:
-                mv[i] = (votec == ml->len) ? 1 : -1;
-            break; 
-            case combine_arg_wmv: 
-            default: {
-                double mvtmp =  (mv[i] + (double) ml->len) / 2 
-                               - opt.combine_rate_arg * (double) ml->len;
-                for (m = 0; m < ml->len; m++) {
-                    ml->m[m]->w_l = weight_update(vote_l[m][i], mvtmp, 
-                                                            ml->m[m]->w_l);
-                    if (opt.peak_arg == peak_arg_dual) {
-                        ml->m[m]->w_r = weight_update(vote_r[m][i], mvtmp, 
-                                                                ml->m[m]->w_r);
-                    } else {
-                        ml->m[m]->w_r = ml->m[m]->w_l;
-                    }
-                }
-                mv[i] = mvtmp;
-            } break;
-        }
+        mv[i] = st->combine(st, mv[i], votec, ml->len, 
+                            w_l, w_r, vote_l, vote_r);
     }
 
-
-    if (vote_l) {
-        for (m = 0; m < ml->len; m++) {
-            free(vote_l[m]);
-        }
-        free(vote_l);
-    }
-    if (vote_r) {
-        for (m = 0; m < ml->len; m++) {
-            free(vote_r[m]);
-        }
-        free(vote_r);
+    for (m = 0; m < ml->len; m++) {
+        ml->m[m]->w_l = w_l[m];
+        ml->m[m]->w_r = w_r[m];
     }
+    prof_stop(&pm);
     return mv;
 }
@@ -21,8 +21,34 @@
 #ifndef _MVOTE_H
 #define _MVOTE_H 1
 #include "mlist.h"
+#include "cmdline.h"
 
-void mv_init();
-double *mv_getvotes(double *vote, struct mlist *mv);
+struct vote_kernel;
+struct mv_state;
+
+/* the combination of the votes at a position, resolved by mv_init() */
+typedef double (*mv_combine_fn)(struct mv_state *mv, 
+                                double sum, int votec, int len,
+                                double *w_l, double *w_r,
+                                double *vote_l, double *vote_r);
+
+/* 
+ * the voting of a model: the options it is set up from by mv_init(),
+ * and the number of positions voted so far, which is a part of the 
+ * learner state (see segment_combine_checkpoint())
+ */
+struct mv_state {
+    int                         nvotes;
+    mv_combine_fn               combine;
+    double                      combine_rate;
+    int                         dual_weights;
+    int                         peak;       // enum peak_arg
+    int                         vote;       // enum vote_arg
+    int                         boundary_method;
+    const struct vote_kernel    *vkern;
+};
+
+int mv_init(struct mv_state *mv, const struct gengetopt_args_info *o);
+double *mv_getvotes(struct mv_state *mv, double *vote, struct mlist *ml);
 
 #endif // _PEAK_H
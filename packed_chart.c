@@ -18,71 +18,194 @@
     <http://www.gnu.org/licenses/>.
 */
 
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
 #include "packed_chart.h"
 #include "lexicon.h"
 #include "strutils.h"
 #include "stack.h"
 #include "cclib_debug.h"
+#include "options.h"
+#include "profile.h"
+#include "mem.h"
+
+/*
+ * The chart cells are kept in a single triangular array, 
+ * chart->node[i] points to the first cell of the row for the spans of
+ * length i + 1. The nodes, backlinks and the input symbols are 
+ * allocated from an arena owned by the chart, so that the chart can be
+ * emptied with chart_reset() and reused for the next input.
+ * When a chart is filled by multiple threads, each thread allocates
+ * from its own arena (see chart_threads()).
+ */
+
+/* 
+ * chart->gen identifies the contents of a chart, data derived from a 
+ * chart can be cached until the chart is reset (see lex.c).
+ */
+static unsigned long chart_gen = 0;
+
+/* all charts share one account for --mem-report */
+static struct mem_acct *chart_mem = NULL;
+static pthread_once_t chart_mem_once = PTHREAD_ONCE_INIT;
+
+static void
+chart_mem_init()
+{
+    chart_mem = mem_acct_new("charts", NULL, NULL);
+}
+
+static void
+chart_cells_init(struct chart *c, unsigned short size)
+{
+    int i;
+    size_t ncells = (size_t) size * (size + 1) / 2;
+
+    if (size > c->nalloc) {
+        mem_free(chart_mem, MEM_BUF, c->cells);
+        mem_free(chart_mem, MEM_BUF, c->cellv);
+        mem_free(chart_mem, MEM_BUF, c->node);
+        mem_free(chart_mem, MEM_BUF, c->cell);
+        mem_free(chart_mem, MEM_BUF, c->input);
+        c->cells = mem_malloc(chart_mem, MEM_BUF, 
+                              ncells * sizeof (*c->cells));
+        c->cellv = mem_malloc(chart_mem, MEM_BUF, 
+                              ncells * sizeof (*c->cellv));
+        c->node = mem_malloc(chart_mem, MEM_BUF, size * sizeof (*c->node));
+        c->cell = mem_malloc(chart_mem, MEM_BUF, size * sizeof (*c->cell));
+        c->input = mem_malloc(chart_mem, MEM_BUF, 
+                              size * sizeof (*c->input));
+        c->nalloc = size;
+        prof_count(PROF_ALLOCS, 5);
+    }
+
+    c->size = size;
+    for(i = 0; i < size; i++) { 
+        size_t off = (size_t) i * size - (size_t) i * (i - 1) / 2;
+        c->node[i] = c->cells + off;
+        c->cell[i] = c->cellv + off;
+        c->input[i] = NULL;
+    }
+    memset(c->cells, 0, ncells * sizeof (*c->cells));
+    memset(c->cellv, 0, ncells * sizeof (*c->cellv));
+}
 
 struct chart *
 chart_new(unsigned short size)
 {
     struct chart   *ret;
-    int            i, j;
 
-    ret = malloc(sizeof (cyk_chart));
-    ret->node = malloc (size * sizeof (cyk_chart_node *));
-    ret->input = malloc (size * sizeof (char *));
-    ret->size = size;
+    pthread_once(&chart_mem_once, chart_mem_init);
+    ret = mem_malloc(chart_mem, MEM_OTHER, sizeof (*ret));
+    ret->arena = arena_new(0, chart_mem);
+    ret->cells = NULL;
+    ret->cellv = NULL;
+    ret->node = NULL;
+    ret->cell = NULL;
+    ret->input = NULL;
+    ret->nalloc = 0;
+    ret->tarena = NULL;
+    ret->ntarena = 0;
+    ret->gen = __atomic_add_fetch(&chart_gen, 1, __ATOMIC_RELAXED);
+    chart_cells_init(ret, size);
+    return ret;
+}
+
+/* 
+ * chart_reset() - empty the chart, and resize it for an input of
+ *                 length `size'.
+ *
+ * all nodes, backlinks and input symbols of the chart are released
+ * at once. only the cell array is cleared, which is not re-allocated
+ * unless the chart grows.
+ */
+void
+chart_reset(struct chart *chart, unsigned short size)
+{
+    int i;
 
-    for(i = 0; i < size; i++) { 
-        ret->node[i] = malloc ((size - i) * sizeof (cyk_chart_node));
-        for(j=0; j < size - i; j++){
-            ret->node[i][j] = NULL;
-        }
-        ret->input[i] = NULL;
+    arena_reset(chart->arena);
+    for (i = 1; i < chart->ntarena; i++) {
+        arena_reset(chart->tarena[i]);
     }
-    return ret;
+    chart->gen = __atomic_add_fetch(&chart_gen, 1, __ATOMIC_RELAXED);
+    chart_cells_init(chart, size);
 }
 
-static void
-chart_node_free(struct chart_node *node)
+/* chart_set_input() - set the input symbol at position j
+ *
+ * the chart keeps its own copy of the first `len' characters of `s'.
+ */
+void
+chart_set_input(struct chart *chart, unsigned short j, const char *s, size_t len)
 {
-    struct backlink *b = node->back;
-    struct backlink *tmp;
-    while(b != NULL) {
-        tmp = b->next;
-        free(b);
-        b = tmp;
-    }
-    free(node);
+    chart->input[j] = arena_strndup(chart->arena, s, len);
 }
 
-void 
+/* chart_threads() - prepare the chart for being filled by `nthreads'
+ *                   threads
+ *
+ * thread 0 uses the main arena of the chart, others get their own
+ * arenas which live (and are reset) together with the chart.
+ */
+void
+chart_threads(struct chart *chart, int nthreads)
+{
+    int i;
+
+    if (nthreads <= chart->ntarena)
+        return;
+    chart->tarena = mem_realloc(chart_mem, MEM_OTHER, chart->tarena, 
+                                nthreads * sizeof (*chart->tarena));
+    chart->tarena[0] = chart->arena;
+    for (i = (chart->ntarena) ? chart->ntarena : 1; i < nthreads; i++) {
+        chart->tarena[i] = arena_new(0, chart_mem);
+    }
+    chart->ntarena = nthreads;
+}
+
+void
 chart_free(struct chart *chart)
 {
-    int i, j;
+    int i;
 
     if(chart == NULL) 
         return;
 
-    for(i=0; i < chart->size; i++) {
-        for(j=0; j < chart->size - i; j++) {
-            struct chart_node *tmp = chart->node[i][j]; 
-            struct chart_node *tmp2;
-            while(tmp) {
-                tmp2 = tmp->next;
-                chart_node_free(tmp);
-                tmp = tmp2;
-            }
+    for (i = 1; i < chart->ntarena; i++) {
+        arena_free(chart->tarena[i]);
+    }
+    mem_free(chart_mem, MEM_OTHER, chart->tarena);
+    arena_free(chart->arena);
+    mem_free(chart_mem, MEM_BUF, chart->cells);
+    mem_free(chart_mem, MEM_BUF, chart->cellv);
+    mem_free(chart_mem, MEM_BUF, chart->input);
+    mem_free(chart_mem, MEM_BUF, chart->node);
+    mem_free(chart_mem, MEM_BUF, chart->cell);
+    mem_free(chart_mem, MEM_OTHER, chart);
+}
+
+static void
+chart_cell_add(struct arena *a, struct chart_cell *cell, 
+               struct chart_node *node)
+{
+    if (cell->n == cell->nalloc) {
+        unsigned short n = (cell->nalloc) ? 2 * cell->nalloc : 4;
+        int *id = arena_alloc(a, n * sizeof (*id));
+        struct chart_node **nodes = arena_alloc(a, n * sizeof (*nodes));
+        if (cell->n) {
+            memcpy(id, cell->id, cell->n * sizeof (*id));
+            memcpy(nodes, cell->node, cell->n * sizeof (*nodes));
         }
-        free(chart->node[i]);
-        if(chart->input[i]) free(chart->input[i]);
+        cell->id = id;
+        cell->node = nodes;
+        cell->nalloc = n;
     }
-    free(chart->input);
-    free(chart->node);
-    free(chart);
-    
+    cell->id[cell->n] = node->cat->id;
+    cell->node[cell->n] = node;
+    cell->n++;
 }
 
 /*
@@ -95,6 +218,8 @@ chart_free(struct chart *chart)
  * node or adding backlinks to an existing node) and returns 
  * the pointer to the newly created or modified node.
  *
+ * chart_node_add_t() does the same on behalf of the thread `tid'.
+ * concurrent calls are safe as long as they add to different cells.
  */
 struct chart_node *
 chart_node_add(struct chart *c,
@@ -103,10 +228,26 @@ chart_node_add(struct chart *c,
                struct chart_node *bL, 
                struct chart_node *bR) 
 {
-    struct chart_node *node = c->node[i][j];
+    return chart_node_add_t(c, 0, i, j, cat, bL, bR);
+}
 
-    while(node != NULL && node->cat != cat) {
-        node = node->next;
+struct chart_node *
+chart_node_add_t(struct chart *c, int tid,
+                 unsigned short i, unsigned short j,
+                 cg_cat *cat, 
+                 struct chart_node *bL, 
+                 struct chart_node *bR) 
+{
+    struct arena *a = (tid == 0) ? c->arena : c->tarena[tid];
+    struct chart_node *node = NULL;
+    struct chart_cell *cell = &c->cell[i][j];
+    int k;
+
+    for (k = 0; k < cell->n; k++) {
+        if (cell->id[k] == cat->id && cell->node[k]->cat == cat) {
+            node = cell->node[k];
+            break;
+        }
     }
 
     if(node != NULL) { // we have the category
@@ -116,16 +257,17 @@ chart_node_add(struct chart *c,
             b = b->next;
         }
         if(b == NULL) { // we don't have the cat with same backlinks
-            b = malloc (sizeof (*b));
+            b = arena_alloc(a, sizeof (*b));
             b->next = node->back;
             b->L = bL;
             b->R = bR;
             node->back = b;
+            node->nderiv = 0;
         } // else (if we have <cat,bL,bR> just return the node
     } else {
-        node = malloc (sizeof (*node));
+        node = arena_alloc(a, sizeof (*node));
         if(bL != NULL) {
-            node->back = malloc (sizeof (*node->back));
+            node->back = arena_alloc(a, sizeof (*node->back));
             node->back->L = bL;
             node->back->R = bR;
             node->back->next = NULL;
@@ -135,8 +277,11 @@ chart_node_add(struct chart *c,
         node->cat = cat;
         node->sp_start = j;
         node->sp_len = i + 1;
+        node->nderiv = 0;
+        node->inside = 0;
         node->next = c->node[i][j];
         c->node[i][j] = node;
+        chart_cell_add(a, cell, node);
     }
     return node;
 }
@@ -310,6 +455,240 @@ parse_list_add(struct parse_list **l, struct parse_tree *t)
     return new;
 }
 
+void
+parse_tree_free(struct parse_tree *t)
+{
+    if (t == NULL)
+        return;
+    parse_tree_free(t->L);
+    parse_tree_free(t->R);
+    free(t);
+}
+
+/* parse_list_free() - free the list `l' together with the parse trees */
+void
+parse_list_free(struct parse_list *l)
+{
+    while (l) {
+        struct parse_list *next = l->next;
+        parse_tree_free(l->t);
+        free(l);
+        l = next;
+    }
+}
+
+/*
+ * Derivations in the packed forest.
+ *
+ * A node is derived either lexically (it has no backlinks, or it has 
+ * a backlink without children), or through one of its backlinks. 
+ * The derivations of a node are numbered in the order of its 
+ * backlinks, and within a backlink the derivations of the right child
+ * vary fastest. The derivation counts are memoized in the nodes, 
+ * so a derivation is extracted without enumerating the others.
+ * The counts are doubles, and they are exact up to 2^53.
+ */
+
+/* chart_node_count() - number of derivations of the node */
+double
+chart_node_count(struct chart_node *node)
+{
+    struct backlink *b;
+    double n = 0;
+
+    if (node->nderiv > 0) 
+        return node->nderiv;
+
+    if (node->back == NULL) 
+        n = 1;
+    for (b = node->back; b != NULL; b = b->next) {
+        if (b->L == NULL) {
+            n += 1;
+        } else {
+            n += chart_node_count(b->L) * chart_node_count(b->R);
+        }
+    }
+    node->nderiv = n;
+    return n;
+}
+
+/* chart_count_parses() - number of derivations spanning the input */
+double
+chart_count_parses(struct chart *chart)
+{
+    struct chart_node *node;
+    double n = 0;
+
+    for (node = chart->node[chart->size - 1][0]; node; node = node->next) {
+        n += chart_node_count(node);
+    }
+    return n;
+}
+
+/*
+ * chart_node_get_parse() - return the i-th derivation of the node
+ *
+ * only the nodes on the returned derivation are visited. the tree
+ * should be freed with parse_tree_free().
+ */
+struct parse_tree *
+chart_node_get_parse(struct chart_node *node, double i)
+{
+    struct backlink *b;
+    struct parse_tree *t;
+
+    if (node->back == NULL) {
+        assert(i == 0);
+        return parse_tree_new(node, NULL);
+    }
+
+    for (b = node->back; b != NULL; b = b->next) {
+        double n = (b->L == NULL) ? 1 
+                   : chart_node_count(b->L) * chart_node_count(b->R);
+        if (i < n) break;
+        i -= n;
+    }
+    assert(b != NULL);
+
+    t = parse_tree_new(node, b);
+    if (b->L != NULL) {
+        double nR = chart_node_count(b->R);
+        double iL = floor(i / nR);
+        t->L = chart_node_get_parse(b->L, iL);
+        t->R = chart_node_get_parse(b->R, i - iL * nR);
+    }
+    t->expanded = 1;
+    return t;
+}
+
+/*
+ * chart_get_parse() - return the i-th derivation spanning the input,
+ *                     or NULL if there are not that many.
+ *
+ * the derivations of the categories in the top cell are numbered
+ * in the order of the node list.
+ */
+struct parse_tree *
+chart_get_parse(struct chart *chart, double i)
+{
+    struct chart_node *node;
+
+    for (node = chart->node[chart->size - 1][0]; node; node = node->next) {
+        double n = chart_node_count(node);
+        if (i < n) {
+            return chart_node_get_parse(node, i);
+        }
+        i -= n;
+    }
+    return NULL;
+}
+
+static inline double
+backlink_weight(struct chart_node *node, struct backlink *b,
+                parse_weight_funct_t weight, void *data)
+{
+    double w = (weight) ? weight(node, b, data) : 1.0;
+
+    if (b != NULL && b->L != NULL) {
+        w *= b->L->inside * b->R->inside;
+    }
+    return w;
+}
+
+/*
+ * chart_inside() - calculate the total weight of the derivations of 
+ *                  every node in the chart.
+ *
+ * the weight of a derivation is the product of the weights of the 
+ * backlinks it uses. if `weight' is NULL all weights are 1, and the 
+ * result is the number of derivations.
+ */
+void
+chart_inside(struct chart *chart, parse_weight_funct_t weight, void *data)
+{
+    int i, j;
+
+    for (i = 0; i < chart->size; i++) {
+        for (j = 0; j < chart->size - i; j++) {
+            struct chart_node *node;
+            for (node = chart->node[i][j]; node; node = node->next) {
+                struct backlink *b;
+                if (node->back == NULL) {
+                    node->inside = backlink_weight(node, NULL, weight, data);
+                    continue;
+                }
+                node->inside = 0;
+                for (b = node->back; b != NULL; b = b->next) {
+                    node->inside += backlink_weight(node, b, weight, data);
+                }
+            }
+        }
+    }
+}
+
+static struct parse_tree *
+chart_node_sample(struct chart_node *node, 
+                  parse_weight_funct_t weight, void *data)
+{
+    struct backlink *b;
+    struct parse_tree *t;
+    double r;
+
+    if (node->back == NULL) {
+        return parse_tree_new(node, NULL);
+    }
+
+    r = node->inside * ((double) rand() / ((double) RAND_MAX + 1));
+    for (b = node->back; b->next != NULL; b = b->next) {
+        double w = backlink_weight(node, b, weight, data);
+        if (r < w) break;
+        r -= w;
+    }
+
+    t = parse_tree_new(node, b);
+    if (b->L != NULL) {
+        t->L = chart_node_sample(b->L, weight, data);
+        t->R = chart_node_sample(b->R, weight, data);
+    }
+    t->expanded = 1;
+    return t;
+}
+
+/*
+ * chart_sample_parses() - draw `n' derivations spanning the input
+ *
+ * the derivations are drawn with probabilities proportional to their
+ * weights (see chart_inside()), or uniformly if `weight' is NULL. 
+ * returns NULL if there is no derivation with a positive weight.
+ */
+struct parse_list *
+chart_sample_parses(struct chart *chart, size_t n,
+                    parse_weight_funct_t weight, void *data)
+{
+    struct parse_list *ret = NULL;
+    struct chart_node *top = chart->node[chart->size - 1][0];
+    struct chart_node *node;
+    double total = 0;
+    size_t k;
+
+    chart_inside(chart, weight, data);
+    for (node = top; node; node = node->next) {
+        total += node->inside;
+    }
+    if (total <= 0)
+        return NULL;
+
+    for (k = 0; k < n; k++) {
+        double r = total * ((double) rand() / ((double) RAND_MAX + 1));
+        for (node = top; node->next != NULL; node = node->next) {
+            if (r < node->inside) break;
+            r -= node->inside;
+        }
+        parse_list_add(&ret, chart_node_sample(node, weight, data));
+    }
+    return ret;
+}
+
 struct parse_list *
 get_parselist_full(struct chart *chart)
 {
@@ -427,9 +806,16 @@ write_parse(FILE *fp, struct parse_tree *t, struct chart *c)
     write_parse(fp, t->R, c);
 }
 
+/*
+ * write_parses() - write the derivations spanning the input
+ *
+ * at most --max-parses derivations are written, if it is set.
+ */
 void 
 write_parses(FILE *fp, struct chart *chart)
 {
+    double  n, i, max;
+
     if (chart == NULL) {
        fprintf(stderr,"Chart is NULL\n");   
        return;
@@ -440,14 +826,17 @@ write_parses(FILE *fp, struct chart *chart)
        return;
     }
 
-    struct parse_list *parses = get_parselist_full(chart);
+    n = chart_count_parses(chart);
+    max = n;
+    if (opt.max_parses_arg > 0 && opt.max_parses_arg < n) {
+        max = opt.max_parses_arg;
+    }
 
-    struct parse_list *tmp = parses;
-    printf("%zd parses.\n", tmp->parse_num + 1);
-    while (tmp) {
-        printf("--------- %zd ----------\n", tmp->parse_num);
-        write_parse(fp, tmp->t, chart);
-        tmp = tmp->next;
+    fprintf(fp, "%.0f parses.\n", n);
+    for (i = 0; i < max; i++) {
+        struct parse_tree *t = chart_get_parse(chart, i);
+        fprintf(fp, "--------- %.0f ----------\n", i);
+        write_parse(fp, t, chart);
+        parse_tree_free(t);
     }
 }
-
@@ -23,6 +23,7 @@
 
 #include "lexicon.h"
 #include "cyk.h"
+#include "arena.h"
 
 /*
  * Each location in the chart is a list of `chart_node's linked with ->next
@@ -44,12 +45,32 @@ struct chart_node {
     struct backlink         *back;  // backlinks to children
     unsigned short      sp_start,  // span start and span length repeated
                         sp_len;   // for convenience during decoding/printing
+    double              nderiv;   // number of derivations, 0 if not known
+    double              inside;   // total weight of the derivations
 };                              
 
+/* 
+ * category IDs of the nodes in a cell, in the order they were added
+ * (the reverse of the node list).
+ */
+struct chart_cell {
+    unsigned short      n, nalloc;
+    int                 *id;
+    struct chart_node   **node;
+};
+
 struct chart {
     int                 size;
     char                **input;
-    struct chart_node   ***node;
+    struct chart_node   ***node;    // node[i][j]: span of length i+1 at j
+    struct chart_node   **cells;    // storage for all node[i][j]
+    struct chart_cell   **cell;     // cell[i][j]: IDs of nodes in node[i][j]
+    struct chart_cell   *cellv;     // storage for all cell[i][j]
+    int                 nalloc;     // max. size without re-allocation
+    struct arena        *arena;     // nodes, backlinks and input symbols
+    struct arena        **tarena;   // per-thread arenas for parallel parsing
+    int                 ntarena;
+    unsigned long       gen;        // unique for each chart_new/reset
 };
 
 // data structures for recovered parses from the chart
@@ -68,8 +89,20 @@ struct parse_list {
     struct parse_list   *next;
 };
 
+/* 
+ * weight of deriving `node' through the backlink `b', not including
+ * the weights of the children. `b' is NULL (or a backlink without 
+ * children) for lexical nodes.
+ */
+typedef double (*parse_weight_funct_t)(struct chart_node *node, 
+                                       struct backlink *b, void *data);
+
 struct chart *chart_new(unsigned short size);
+void chart_reset(struct chart *chart, unsigned short size);
+void chart_set_input(struct chart *chart, unsigned short j, 
+                     const char *s, size_t len);
 void chart_free(struct chart *chart);
+void chart_threads(struct chart *chart, int nthreads);
 
 struct chart_node *chart_node_add(struct chart *c,
                                    unsigned short i, 
@@ -77,6 +110,24 @@ struct chart_node *chart_node_add(struct chart *c,
                                    cg_cat *cat, 
                                    struct chart_node *bL, 
                                    struct chart_node *bR);
+struct chart_node *chart_node_add_t(struct chart *c, int tid,
+                                     unsigned short i, 
+                                     unsigned short j,
+                                     cg_cat *cat, 
+                                     struct chart_node *bL, 
+                                     struct chart_node *bR);
+
+double chart_node_count(struct chart_node *node);
+double chart_count_parses(struct chart *chart);
+struct parse_tree *chart_node_get_parse(struct chart_node *node, double i);
+struct parse_tree *chart_get_parse(struct chart *chart, double i);
+void chart_inside(struct chart *chart, parse_weight_funct_t weight, 
+                  void *data);
+struct parse_list *chart_sample_parses(struct chart *chart, size_t n,
+                                       parse_weight_funct_t weight, 
+                                       void *data);
+void parse_tree_free(struct parse_tree *t);
+void parse_list_free(struct parse_list *l);
 
 void chart_write(FILE *fp, struct chart *chart);
 void write_parses(FILE *fp, struct chart *chart);
@@ -21,17 +21,11 @@
 #include <stdlib.h>
 #include <assert.h>
 #include "peak.h"
+#include "vote_kernel.h"
 
-double
-get_vote_peak(double prev, double curr, double next, 
-              int peak_type,
-              struct mdata *md)
+static inline enum vk_peak
+peak_kind(int peak_type, struct mdata *md)
 {
-    int mdir = md->info->dir;
-    double left  = mdir * (curr - prev);
-    double right = mdir * (curr - next);
-    double peak;
-
     if (peak_type == peak_arg_dual) peak_type = peak_arg_left;
     if (peak_type == peak_arg_lr)  {
         peak_type = (md->info->lr == -1) ? peak_arg_right : peak_arg_left;
@@ -39,78 +33,67 @@ get_vote_peak(double prev, double curr, double next,
 
     switch (peak_type) {
         case peak_arg_strict: 
-            if(SIGN(left) != SIGN(right)) peak = 0.0;
-            else peak = left + right;
-        break;
-        case peak_arg_strict2: 
-            assert(opt.pred_norm_flag);
-            if(SIGN(left) != SIGN(right)) peak = 0.0;
-            else if(curr < 0.0) peak = 0.0;
-            else peak = left + right;
-        break;
+            return VK_PEAK_STRICT;
+        case peak_arg_strict2:      // needs --pred-norm, see mv_init()
+            return VK_PEAK_STRICT2;
         case peak_arg_relaxed:
-            peak = left + right;
-        break;
+            return VK_PEAK_RELAXED;
         case peak_arg_right:
-            peak = right;
-        break;
+            return VK_PEAK_RIGHT;
         case peak_arg_left:
-            peak = left;
-        break;
+        default:
+            return VK_PEAK_LEFT;
     }
+}
 
-    switch (opt.vote_arg) {
-        case vote_arg_binary: 
-            return (peak > 0.0) ? 1.0 : -1.0; 
-        break;
+static inline enum vk_vote
+vote_kind(int vote)
+{
+    switch (vote) {
         case vote_arg_diff: 
-            return peak; 
-        break;
+            return VK_VOTE_DIFF;
         case vote_arg_lgdiff: 
-            return 2 * LOGISTIC(peak) - 1;
-        break;
+            return VK_VOTE_LGDIFF;
+        case vote_arg_binary: 
         default: 
-            fprintf(stderr, "unknown vote arg %d\n", opt.vote_arg);
-            exit (-1);
+            return VK_VOTE_BINARY;
     }
 }
 
+/* get_votes_peak() - votes of all measures in `ml' at all positions
+ *
+ * the votes are written to ml->vote_l (and ml->vote_r for dual peaks),
+ * returns the number of votes per measure. the votes of a measure are 
+ * calculated for the whole row with the kernels of `mv', see 
+ * vote_kernel.c.
+ */
 int
-get_votes_peak(double ***vote_l, double ***vote_r, struct mlist *ml)
+get_votes_peak(struct mlist *ml, const struct mv_state *mv)
 {
     int m, i;
-    int dual = (opt.peak_arg == peak_arg_dual);
+    int dual = (mv->peak == peak_arg_dual);
+    enum vk_vote vt = vote_kind(mv->vote);
+    const struct vote_kernel *vkern = mv->vkern;
+    double row[ml->slen + 1];
 
-    double **vl = NULL, **vr = NULL;
-    
-    if (*vote_l == NULL) {
-        assert (*vote_r == NULL);
-        vl = malloc(ml->len * sizeof (double *));
-        if (dual) {
-            vr = malloc (ml->len * sizeof (double *));
-        }
-        for (m = 0; m < ml->len; m++) {
-            vl[m] = malloc (ml->slen * sizeof (double));
-            if (dual) {
-                vr[m] = malloc (ml->slen * sizeof (double));
-            }
-        }
-    }
+    mlist_votes(ml, dual);
 
     for (m = 0; m < ml->len; m++) {
         struct mdata *md = ml->m[m];
         double *mval = ml->mlist[m];
+        double dir = md->info->dir;
+
+        vkern->peak(row, mval, ml->slen, dir, peak_kind(mv->peak, md), vt);
         for (i = 1; i < ml->slen; i++) {
-            vl[m][i] = get_vote_peak(mval[i - 1], mval[i], mval[i + 1],
-                                         opt.peak_arg, md);
-            if (dual) {
-                vr[m][i] = get_vote_peak(mval[i - 1], mval[i], mval[i + 1],
-                                             peak_arg_right, md);
+            MLIST_VOTES(ml, ml->vote_l, i)[m] = row[i];
+        }
+        if (dual) {
+            vkern->peak(row, mval, ml->slen, dir, VK_PEAK_RIGHT, vt);
+            for (i = 1; i < ml->slen; i++) {
+                MLIST_VOTES(ml, ml->vote_r, i)[m] = row[i];
             }
         }
     }
 
-    *vote_l = vl;
-    *vote_r = (dual) ? vr : NULL;
     return (dual) ? 2 : 1;
 }
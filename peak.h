@@ -23,11 +23,9 @@
 #include "options.h"
 #include "mlist.h"
 #include "mdata.h"
+#include "mvote.h"
 
-double get_vote_peak(double prev, double curr, double next, 
-                     int peak_type, struct mdata *md);
-
-int get_votes_peak(double ***vote_l, double ***vote_r, struct mlist *ml);
+int get_votes_peak(struct mlist *ml, const struct mv_state *mv);
 
 
 #endif // _PEAK_H
@@ -29,6 +29,12 @@
 #include <math.h>
 #include "phonstats.h"
 #include "io.h"
+#include "strhash.h"
+#include "profile.h"
+#include "mem.h"
+#include "checkpoint.h"
+#include "symtab.h"
+#include "cclib_debug.h"
 
 /* phonstats_init() - initialize the phoneme statistics data
  *
@@ -43,23 +49,62 @@
  * if the set of phonemes are given)
  *
  */
+/* phonstats_mem_refresh() - the hash table and Bloom filter overhead */
+static void
+phonstats_mem_refresh(struct mem_acct *a, void *owner)
+{
+    struct phonstats *ps = owner;
+
+    a->bytes[MEM_HASH] = mem_hash_bytes(ps->hash) + bloom_bytes(ps->bloom);
+}
+
+/* counts_new() - the empty counters of a channel of `max_ng' */
+static void
+counts_new(struct phonstats *ps, size_t max_ng, struct mem_acct *mem)
+{
+    ps->mem = mem;
+    ps->max_ng = max_ng;
+    ps->n_updt = 0;
+    ps->n_tok = mem_calloc(mem, MEM_OTHER, max_ng, sizeof (*ps->n_tok));
+    ps->n_typ = mem_calloc(mem, MEM_OTHER, max_ng, sizeof (*ps->n_typ));
+    ps->nalloc = mem_calloc(mem, MEM_OTHER, max_ng, sizeof (*ps->nalloc));
+    ps->ngstr = mem_calloc(mem, MEM_INDEX, max_ng, sizeof (*ps->ngstr));
+    ps->ug_freq = mem_calloc(mem, MEM_INDEX, SYMTAB_NIDS, 
+                             sizeof (*ps->ug_freq));
+    ps->st = NULL;
+    ps->chan = 0;
+    ps->next_chan = NULL;
+}
+
+/* counts_free() - free the counters of a channel */
+static void
+counts_free(struct phonstats *ps)
+{
+    int i;
+
+    for (i = 0; i < ps->max_ng; i++) {
+        free(ps->ngstr[i]);
+        if (ps->st) prob_dist_free(ps->st[i]);
+    }
+    if (ps->st) free(ps->st);
+    free(ps->ngstr);
+    free(ps->ug_freq);
+    free(ps->n_tok);
+    free(ps->n_typ);
+    free(ps->nalloc);
+}
+
 struct phonstats * 
 phonstats_new(size_t max_ng, char *phon_list)
 {
     assert (max_ng >= 1);
     struct phonstats *ps = malloc(sizeof *ps); 
-    ps->max_ng = max_ng;
-    ps->n_updt = 0;
-    ps->n_tok = malloc(max_ng * sizeof (*ps->n_tok));
-    ps->n_typ = malloc(max_ng * sizeof (*ps->n_typ));
-    ps->nalloc = malloc((max_ng) * sizeof (*ps->nalloc));
-    ps->ngstr = malloc((max_ng) * sizeof (*ps->ngstr));
-    ps->st = NULL;
-    memset(ps->n_tok, 0, max_ng * sizeof(*ps->n_tok));
-    memset(ps->n_typ, 0, max_ng * sizeof(*ps->n_typ));
-    memset(ps->nalloc, 0, max_ng * sizeof(*ps->nalloc));
-    memset(ps->ngstr, 0, max_ng * sizeof(*ps->ngstr));
-    ps->hash = g_hash_table_new_full(g_str_hash, g_str_equal, free, free);
+    struct mem_acct *mem = mem_acct_new("phonstats", 
+                                        phonstats_mem_refresh, ps);
+    mem_add(mem, MEM_OTHER, ps);
+    counts_new(ps, max_ng, mem);
+    ps->hash = g_hash_table_new_full(str_hash, str_equal, free, free);
+    ps->bloom = bloom_new("n-gram");
 
     if (phon_list != NULL) {
         phonstats_update(ps, phon_list);
@@ -67,40 +112,114 @@ phonstats_new(size_t max_ng, char *phon_list)
     return ps;
 }
 
-struct phonstats * 
-phonstats_new_st(size_t max_ng, char *phon_list)
+static void
+st_new(struct phonstats *ps)
 {
     int i;
-    struct phonstats *ps = phonstats_new(max_ng, NULL);
-    ps->st = malloc(max_ng * sizeof (*ps->st));
-    for(i=0; i < max_ng; i++) {
+
+    ps->st = mem_malloc(ps->mem, MEM_DIST, ps->max_ng * sizeof (*ps->st));
+    for(i=0; i < ps->max_ng; i++) {
         ps->st[i] = prob_dist_new();
+        mem_add(ps->mem, MEM_DIST, ps->st[i]);
     }
+}
+
+struct phonstats * 
+phonstats_new_st(size_t max_ng, char *phon_list)
+{
+    struct phonstats *ps = phonstats_new(max_ng, NULL);
+
+    st_new(ps);
     return ps;
 }
 
+/* 
+ * phonstats_add_channel() - add a channel to `ps', see phonstats.h
+ *
+ * the channel is freed with `ps'.
+ */
+struct phonstats *
+phonstats_add_channel(struct phonstats *ps)
+{
+    struct phonstats *c, **p = &ps->next_chan;
+    int chan = 1;
+
+    assert(ps->chan == 0);
+    while (*p) {
+        p = &(*p)->next_chan;
+        ++chan;
+    }
+    assert(chan < ' ');  // the prefixes should not be phonemes
+    c = mem_malloc(ps->mem, MEM_OTHER, sizeof *c);
+    counts_new(c, ps->max_ng, ps->mem);
+    if (ps->st) st_new(c);
+    c->hash = ps->hash;
+    c->bloom = ps->bloom;
+    c->chan = chan;
+    *p = c;
+    return c;
+}
+
 void
 phonstats_free(struct phonstats *ps)
 {
-    int i;
-    g_hash_table_destroy(ps->hash);
-    for (i = 0; i < ps->max_ng; i++) {
-        free(ps->ngstr[i]);
-        if (ps->st) prob_dist_free(ps->st[i]);
+    struct phonstats *c, *next;
+
+    assert(ps->chan == 0);  // the channels go with the first one
+    for (c = ps->next_chan; c; c = next) {
+        next = c->next_chan;
+        counts_free(c);
+        free(c);
     }
-    if (ps->st) free(ps->st);
-    free(ps->ngstr);
-    free(ps->n_tok);
-    free(ps->n_typ);
-    free(ps->nalloc);
+    g_hash_table_destroy(ps->hash);
+    bloom_free(ps->bloom);
+    counts_free(ps);
+    mem_acct_free(ps->mem);
     free(ps);
 }
 
+/* chan_key() - a new key for the ngram `ng' in the channel of `ps' */
+static char *
+chan_key(struct phonstats *ps, const char *ng)
+{
+    size_t len = strlen(ng);
+    char *key;
+
+    if (ps->chan == 0) return mem_strdup(ps->mem, MEM_KEYS, ng);
+    key = mem_malloc(ps->mem, MEM_KEYS, len + 2);
+    key[0] = ps->chan;
+    memcpy(key + 1, ng, len + 1);
+    return key;
+}
+
 
 size_t
 phonstats_freq_ng(struct phonstats *ps, char *ng)
 {
-    size_t *freq = g_hash_table_lookup(ps->hash, ng);
+    size_t len = strlen(ng);
+
+    return phonstats_freq_span(ps, str_hash_n(ng, len), ng, len);
+}
+
+/* phonstats_freq_span() - frequency of the ngram made of the `len' 
+ *                         bytes at `ng', `hv' is their str_hash_n()
+ */
+size_t
+phonstats_freq_span(struct phonstats *ps, strhash_t hv, const char *ng,
+                    size_t len)
+{
+    size_t *freq;
+
+    if (ps->chan) {
+        char key[len + 1];
+
+        key[0] = ps->chan;
+        memcpy(key + 1, ng, len);
+        freq = bloom_lookup(ps->bloom, ps->hash, 
+                            str_hash_cat(ps->chan, hv, len), key, len + 1);
+    } else {
+        freq = bloom_lookup(ps->bloom, ps->hash, hv, ng, len);
+    }
     return (freq != NULL) ? *freq : 0;
 }
 
@@ -124,6 +243,9 @@ size_t
 phonstats_freq_p(struct phonstats *ps, char ch)
 {
     char tmp[2];
+    int id = symtab_code_id(ch);
+
+    if (ps->chan == 0 && id >= 0) return phonstats_freq_id(ps, id);
     tmp[0] = ch;
     tmp[1] = '\0';
 /*
@@ -133,6 +255,14 @@ phonstats_freq_p(struct phonstats *ps, char ch)
     return phonstats_freq_ng(ps, tmp);
 }
 
+/* phonstats_freq_id() - the frequency of the phoneme with the ID `id' */
+size_t
+phonstats_freq_id(struct phonstats *ps, uint16_t id)
+{
+    assert(ps->chan == 0 && id < SYMTAB_NIDS);
+    return (ps->ug_freq[id]) ? *ps->ug_freq[id] : 0;
+}
+
 /* phonstats_rfreq_p() - return relative frequency of a phoneme
  * 
  * Note: (1) we use `add-one smooting'. 
@@ -155,6 +285,16 @@ phonstats_rfreq_p(struct phonstats *ps, unsigned char ch)
 //           (double) (ps->n_tok[NG_UNIGRAM] + ps->n_typ[NG_UNIGRAM] + 1);
 }
 
+/* phonstats_rfreq_id() - phonstats_rfreq_p() of the phoneme with the
+ *                        ID `id'
+ */
+double 
+phonstats_rfreq_id(struct phonstats *ps, uint16_t id)
+{
+    return (double) (phonstats_freq_id(ps, id) + 1) /
+           (double) (ps->n_tok[NG_UNIGRAM] - 2 * ps->n_updt + 1);
+}
+
 /* phonstats_rfreq_p2() - same as phonstats_rfreq_p, but 
  * also count boundaries as if they are phonemes.
  * 
@@ -168,38 +308,57 @@ phonstats_rfreq_p2(struct phonstats *ps, unsigned char ch)
            (double) (ps->n_tok[NG_UNIGRAM] + 1);
 }
 
+/* ng_add() - add the new ngram `key' of length ng + 1 with the 
+ *            count `val' to the index
+ */
+static void
+ng_add(struct phonstats *ps, int ng, char *key, size_t *val)
+{
+    if(ps->n_typ[ng] * sizeof (key) >= ps->nalloc[ng]) {
+        char **tmp;
+        ps->nalloc[ng] += BUFSIZ;
+        tmp = mem_realloc(ps->mem, MEM_INDEX, ps->ngstr[ng], 
+                          ps->nalloc[ng]);
+        assert(tmp != NULL);
+        ps->ngstr[ng] = tmp;
+    }
+
+    ps->ngstr[ng][ps->n_typ[ng]] = key + (ps->chan != 0);
+    ++(ps->n_typ[ng]);
+    if (ng == NG_UNIGRAM && ps->chan == 0) {
+        int id = symtab_code_id(key[0]);
+        if (id >= 0) ps->ug_freq[id] = val;
+    }
+    g_hash_table_insert(ps->hash, key, val);
+    if (ps->bloom) {
+        bloom_add(ps->bloom, ps->hash, str_hash_n(key, strlen(key)));
+    }
+}
+
 void
 inc_ng_freq(struct phonstats *ps, int ng, char *ngstr)
 {
-    char *key = strdup(ngstr);
+    char *key = chan_key(ps, ngstr);
     size_t *val;
 
     assert(ps->hash != NULL);
+    prof_count(PROF_ALLOCS, 1);
 
     ++(ps->n_tok[ng]);
+    prof_count(PROF_PROBES, 1);
     val = g_hash_table_lookup(ps->hash, key);
     if (val != NULL) {
         ++(*val);
-        free(key);
+        mem_free(ps->mem, MEM_KEYS, key);
         if(ps->st) {
             prob_dist_remove(ps->st[ng], *val - 1);
             prob_dist_update(ps->st[ng], *val);
         }
     } else {
-        val = malloc(sizeof *val);
+        val = mem_malloc(ps->mem, MEM_VALUES, sizeof *val);
         *val = 1;
-
-        if(ps->n_typ[ng] * sizeof (key) >= ps->nalloc[ng]) {
-            char **tmp;
-            ps->nalloc[ng] += BUFSIZ;
-            tmp = realloc(ps->ngstr[ng], ps->nalloc[ng]);
-            assert(tmp != NULL);
-            ps->ngstr[ng] = tmp;
-        }
-
-        ps->ngstr[ng][ps->n_typ[ng]] = key;
-        ++(ps->n_typ[ng]);
-        g_hash_table_insert(ps->hash, key, val);
+        prof_count(PROF_ALLOCS, 1);
+        ng_add(ps, ng, key, val);
         if (ps->st) {
             prob_dist_update(ps->st[ng], *val);
         }
@@ -207,6 +366,16 @@ inc_ng_freq(struct phonstats *ps, int ng, char *ngstr)
 }
 
 
+/* bracket() - `s' between BOW_CH and EOW_CH in `buf' */
+static inline void
+bracket(char *buf, const char *s, int len)
+{
+    buf[0] = BOW_CH;
+    memcpy(buf + 1, s, len);
+    buf[len + 1] = EOW_CH;
+    buf[len + 2] = '\0';
+}
+
 void 
 phonstats_update(struct phonstats *ps, char *s)
 {
@@ -214,11 +383,9 @@ phonstats_update(struct phonstats *ps, char *s)
     char stmp[len + 3],
          ngtmp[len + 3];
     int start, ng;
+    struct prof_mark pm = prof_start(PROF_PHONSTATS);
 
-    stmp[0] = BOW_CH;
-    strcpy(stmp + 1, s);
-    stmp[len + 1] = EOW_CH;
-    stmp[len + 2] = '\0';
+    bracket(stmp, s, len);
     len += 2;
 
     ++ps->n_updt;
@@ -239,19 +406,54 @@ phonstats_update(struct phonstats *ps, char *s)
             }
         }
     }
+    prof_stop(&pm);
 }
 
-double
-phonstats_P(struct phonstats *ps, char *ng, int options)
+/* 
+ * phonstats_update_joint() - update `ps' with `s' and its next channel 
+ *                            with `t' in one pass 
+ *
+ * `t' is the parallel string of the second channel, with one symbol
+ * for each phoneme of `s', e.g., the stress of the phonemes.
+ */
+void 
+phonstats_update_joint(struct phonstats *ps, char *s, char *t)
 {
-    int nglen = strlen(ng) - 1;
-    size_t freq;
-    double p;
+    struct phonstats *ts = ps->next_chan;
+    int len = strlen(s);
+    char stmp[len + 3],
+         ttmp[len + 3],
+         ngtmp[len + 3];
+    int start, ng;
+    struct prof_mark pm = prof_start(PROF_PHONSTATS);
+
+    assert(ts != NULL && strlen(t) == len);
+    bracket(stmp, s, len);
+    bracket(ttmp, t, len);
+    len += 2;
 
+    ++ps->n_updt;
+    ++ts->n_updt;
+
+    for (start = 0; start < len; start++) {
+        for (ng = 0; ng < ps->max_ng && ng < len - start; ng++) {
+            memcpy(ngtmp, stmp + start, ng + 1);
+            ngtmp[ng + 1] = '\0';
+            inc_ng_freq(ps, ng, ngtmp);
+            memcpy(ngtmp, ttmp + start, ng + 1);
+            inc_ng_freq(ts, ng, ngtmp);
+        }
+    }
+    prof_stop(&pm);
+}
+
+static inline double
+ng_prob(struct phonstats *ps, size_t freq, int nglen, int options)
+{
+    double p;
 
     assert (nglen <= ps->max_ng);
 
-    freq = phonstats_freq_ng(ps, ng);
     switch (options) {
         case SMOOTH_ADD1: {
             p =  (double) (freq + 1) / (double) (ps->n_tok[nglen] + 1);
@@ -267,6 +469,20 @@ phonstats_P(struct phonstats *ps, char *ng, int options)
     return p;
 }
 
+double
+phonstats_P(struct phonstats *ps, char *ng, int options)
+{
+    return ng_prob(ps, phonstats_freq_ng(ps, ng), strlen(ng) - 1, options);
+}
+
+double
+phonstats_P_span(struct phonstats *ps, strhash_t hv, const char *ng,
+                 size_t len, int options)
+{
+    return ng_prob(ps, phonstats_freq_span(ps, hv, ng, len), len - 1, 
+                   options);
+}
+
 void 
 phonstats_update_from_file(struct phonstats *ps, char *fname)
 {
@@ -278,6 +494,104 @@ phonstats_update_from_file(struct phonstats *ps, char *fname)
     input_free(in);
 }
 
+/* 
+ * phonstats_write_bin() - write `ps' to a checkpoint record
+ *
+ * the ngrams are written in the order they were first seen, so that
+ * phonstats_read_bin() rebuilds the same ngstr arrays.
+ */
+static void
+counts_write_bin(FILE *fp, struct phonstats *ps)
+{
+    size_t ng, i;
+
+    ckpt_put_u64(fp, ps->n_updt);
+    for (ng = 0; ng < ps->max_ng; ng++) {
+        ckpt_put_u64(fp, ps->n_tok[ng]);
+        ckpt_put_u64(fp, ps->n_typ[ng]);
+        if (ps->st) ckpt_put(fp, ps->st[ng], sizeof (*ps->st[ng]));
+    }
+    for (ng = 0; ng < ps->max_ng; ng++) {
+        for (i = 0; i < ps->n_typ[ng]; i++) {
+            char *ngs = ps->ngstr[ng][i];
+            ckpt_put_u64(fp, phonstats_freq_ng(ps, ngs));
+            ckpt_put_str(fp, ngs);
+        }
+    }
+}
+
+void
+phonstats_write_bin(FILE *fp, struct phonstats *ps)
+{
+    struct phonstats *c;
+    size_t nchan = 0;
+
+    assert(ps->chan == 0);
+    for (c = ps->next_chan; c; c = c->next_chan) ++nchan;
+    ckpt_put_u64(fp, ps->max_ng);
+    ckpt_put_u64(fp, ps->st != NULL);
+    ckpt_put_u64(fp, nchan);
+    for (c = ps; c; c = c->next_chan) {
+        counts_write_bin(fp, c);
+    }
+}
+
+static int
+counts_read_bin(struct ckpt_buf *b, struct phonstats *ps)
+{
+    size_t ng, i;
+    size_t n_typ[ps->max_ng];
+
+    ps->n_updt = ckpt_get_u64(b);
+    for (ng = 0; ng < ps->max_ng; ng++) {
+        ps->n_tok[ng] = ckpt_get_u64(b);
+        n_typ[ng] = ckpt_get_u64(b);
+        if (ps->st) ckpt_get(b, ps->st[ng], sizeof (*ps->st[ng]));
+    }
+    for (ng = 0; ng < ps->max_ng && !b->err; ng++) {
+        // an ngram takes at least 9 bytes
+        if (n_typ[ng] > (size_t) (b->end - b->p) / 9) return -1;
+        for (i = 0; i < n_typ[ng] && !b->err; i++) {
+            size_t *val = mem_malloc(ps->mem, MEM_VALUES, sizeof *val);
+
+            *val = ckpt_get_u64(b);
+            ng_add(ps, ng, chan_key(ps, ckpt_get_str(b)), val);
+        }
+    }
+    return (b->err) ? -1 : 0;
+}
+
+/* phonstats_read_bin() - a new phonstats from a checkpoint record, 
+ *                        NULL if the record is not valid
+ */
+struct phonstats *
+phonstats_read_bin(struct ckpt_buf *b)
+{
+    size_t max_ng = ckpt_get_u64(b),
+           has_st = ckpt_get_u64(b),
+           nchan = ckpt_get_u64(b);
+    struct phonstats *ps;
+    int err;
+
+    if (b->err || max_ng < 1 || max_ng > (size_t) (b->end - b->p) 
+            || nchan >= ' ') {
+        PERROR("`%s' of the checkpoint is not valid\n", b->tag);
+        return NULL;
+    }
+    ps = (has_st) ? phonstats_new_st(max_ng, NULL) 
+                  : phonstats_new(max_ng, NULL);
+    err = counts_read_bin(b, ps);
+    while (!err && nchan--) {
+        err = counts_read_bin(b, phonstats_add_channel(ps));
+    }
+    if (err) {
+        PERROR("`%s' of the checkpoint is not valid\n", b->tag);
+        phonstats_free(ps);
+        return NULL;
+    }
+    return ps;
+}
+
 void
 phonstats_dump(struct phonstats *ps)
 {
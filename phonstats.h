@@ -21,9 +21,16 @@
 #ifndef _PHONSTATS_H
 #define _PHONSTATS_H 1
 
+#include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <glib.h>
 #include "prob_dist.h"
+#include "strhash.h"
+#include "bloom.h"
+
+struct mem_acct;
+struct ckpt_buf;
 
 #define BOW_CH  '<'
 #define EOW_CH  '>'
@@ -51,6 +58,19 @@ enum prob_opts {
  * the ngrams of respective size. These are mainly used for
  * enumerating all possible ngrams for a given n.
  *
+ * Channels: a phonstats can keep more than one channel of symbols,
+ * for example the phonemes and their stress, in the same table. The
+ * other channels are added with phonstats_add_channel(), each is a
+ * phonstats of its own that shares `hash' and `bloom' with the first 
+ * one, and can be passed to any function that takes a phonstats. The
+ * keys of channel `chan' are the ngrams prefixed with the byte `chan',
+ * so the projection of the table to a channel is a lookup with the
+ * prefix. phonstats_update_joint() counts the ngrams of all channels 
+ * of an utterance in one pass.
+ *
+ * Unigrams: the count of each phoneme in `hash' is also pointed to 
+ * from ug_freq, indexed by the symbol ID of the phoneme, see symtab.h.
+ * Only the first channel has them, `<' and `>' only without --symbols.
  */
 struct phonstats {
     size_t      max_ng;  
@@ -60,25 +80,39 @@ struct phonstats {
     struct prob_dist **st; // mean&variance for each nglen
     size_t      *nalloc; // internal use, to alloc/realloc memory
     char        ***ngstr;
+    size_t      **ug_freq; // unigram counts in `hash' by symbol ID
     GHashTable  *hash;
+    struct bloom *bloom; // negative lookups in hash, or NULL
+    struct mem_acct *mem; // for --mem-report, or NULL
+    unsigned char chan;   // the key prefix of the channel, 0 for the first
+    struct phonstats *next_chan; // the next channel, or NULL
 };
 
 struct phonstats * phonstats_new(size_t max_ng, char *phon_list);
 struct phonstats * phonstats_new_st(size_t max_ng, char *phon_list);
 void phonstats_free(struct phonstats *ps);
+struct phonstats *phonstats_add_channel(struct phonstats *ps);
 // void inc_phonfreq(struct phonstats *ps, unsigned char ph);
 
 size_t phonstats_freq_p(struct phonstats *ps, char ch);
+size_t phonstats_freq_id(struct phonstats *ps, uint16_t id);
 
 size_t phonstats_freq_ng(struct phonstats *ps, char *ng);
+size_t phonstats_freq_span(struct phonstats *ps, strhash_t hv, 
+                           const char *ng, size_t len);
 
 double phonstats_rfreq_p(struct phonstats *ps, unsigned char ch);
 double phonstats_rfreq_p2(struct phonstats *ps, unsigned char ch);
+double phonstats_rfreq_id(struct phonstats *ps, uint16_t id);
 double phonstats_rfreq_ng(struct phonstats *ps, char *ch);
 void phonstats_update(struct phonstats *ps, char *s);
+void phonstats_update_joint(struct phonstats *ps, char *s, char *t);
 
 double
 phonstats_P(struct phonstats *ps, char *ng, int options);
+double
+phonstats_P_span(struct phonstats *ps, strhash_t hv, const char *ng,
+                 size_t len, int options);
 
 void phonstats_dump(struct phonstats *ps);
 
@@ -90,4 +124,7 @@ double phonstats_freq_z(struct phonstats *ps, char *ng);
 
 void phonstats_copy(struct phonstats *dst, struct phonstats *src);
 
+void phonstats_write_bin(FILE *fp, struct phonstats *ps);
+struct phonstats *phonstats_read_bin(struct ckpt_buf *b);
+
 #endif // _PHONSTATS_H
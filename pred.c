@@ -38,6 +38,7 @@
 #include <math.h>
 #include "strutils.h"
 #include "pred.h"
+#include "cclib_debug.h"
 
 /* P() - probability estimate of a string, for now, this only 
  *       an alias to phonstats_rfreq_ng()
@@ -418,32 +419,60 @@ ng_r (struct mdata *m, int pos, int len)
     return s;
 }
 
+/* the utterance with the boundary markers and its prefix hashes,
+ * the ngrams around a position are looked up as spans of it.
+ */
+static __thread struct span_hash ng_sh;
+
+static inline size_t
+ng_freq(struct phonstats *ps, struct span_hash *sh, int start, int end)
+{
+    return phonstats_freq_span(ps, span_hash_get(sh, start, end - start),
+                               sh->s + start, end - start);
+}
+
+static inline double
+ng_P(struct phonstats *ps, struct span_hash *sh, int start, int end)
+{
+    return phonstats_P_span(ps, span_hash_get(sh, start, end - start),
+                            sh->s + start, end - start, 0);
+}
+
+/*
+ * _calc_pred_single() - measure `m' at the position `pos'
+ *
+ * `sh' should be set to m->s with BOW_CH and EOW_CH added. The 
+ * left context ng_l() is the span [l0, mid) of it and the right 
+ * context ng_r() is [mid, r1).
+ */
 double
-_calc_pred_single(struct phonstats *ps, struct mdata *m, int pos, int len)
+_calc_pred_single(struct phonstats *ps, struct mdata *m, int pos, int len,
+                  struct span_hash *sh)
 {
     char *l = NULL;
     char *r = NULL;
     double pm = 0.0;
+    int mid = pos + 1;
+    int l0 = (mid - m->len_l > 0) ? mid - m->len_l : 0;
+    int r1 = (mid + m->len_r < len + 2) ? mid + m->len_r : len + 2;
 
     assert(m->info->mmask & (M_PFMASK | M_PRMASK));
+    assert(pos >= 0 && pos <= len);
 
     switch(m->info->mid) {
         case M_JP: {
-            l = ng_l(m, pos, len);
-            r = ng_r(m, pos, len);
-            pm =  joint_p(ps, l, r);
+            assert(m->len_l > 0 && m->len_r > 0);
+            pm =  ng_P(ps, sh, l0, r1);
         } break;
         case M_TP: {
-            l = ng_l(m, pos, len);
-            r = ng_r(m, pos, len);
-//printf("%d-%d: %s-%s\n", m->len_l, m->len_r, l, r);
-            pm =  cond_p(ps, l, r);
-// printf("tp ... %s-%s: %f\n", l, r, pm);
+            assert(m->len_l > 0 && m->len_r > 0);
+            pm = (double) ng_freq(ps, sh, l0, r1) / 
+                 (double) ng_freq(ps, sh, l0, mid);
         } break;
         case M_MI: {
-            l = ng_l(m, pos, len);
-            r = ng_r(m, pos, len);
-            pm =  pmi(ps, l, r);
+            assert(m->len_l > 0 && m->len_r > 0);
+            pm = log2(ng_P(ps, sh, l0, r1) / 
+                      (ng_P(ps, sh, l0, mid) * ng_P(ps, sh, mid, r1)));
         } break;
         case M_H: {
             assert(m->len_r != 0);
@@ -456,9 +485,9 @@ _calc_pred_single(struct phonstats *ps, struct mdata *m, int pos, int len)
             pm =  (double) sv(ps, l, m->len_r);
         } break;
         case M_RTP: {
-            l = ng_l(m, pos, len);
-            r = ng_r(m, pos, len);
-            pm = cond_p_r(ps, l, r);
+            assert(m->len_l > 0 && m->len_r > 0);
+            pm = (double) ng_freq(ps, sh, l0, r1) / 
+                 (double) ng_freq(ps, sh, mid, r1);
         } break;
         case M_RH: {
             assert(m->len_l != 0);
@@ -484,24 +513,150 @@ double
 calc_pred_single(struct phonstats *ps, struct mdata *m, int pos)
 {
     int len = strlen(m->s);
-    return _calc_pred_single(ps, m, pos, len);
+
+    span_hash_set(&ng_sh, m->s, len, BOW_CH, EOW_CH);
+    return _calc_pred_single(ps, m, pos, len, &ng_sh);
+}
+
+/*
+ * List kernels. calc_pred_list() does not go through the switch in
+ * _calc_pred_single() for every position, pred_resolve() picks one of
+ * the variants below for each mdata once. PRED_KERNEL() defines the
+ * variant of a span measure for fixed context lengths `LL' and `LR',
+ * 0 means that the length is taken from the mdata. The fixed ones
+ * cover the lengths used by the default options.
+ */
+typedef void (*pred_kernel)(struct phonstats *, struct mdata *,
+                            struct span_hash *, int, double *);
+
+#define PRED_KERNEL(name, LL, LR, expr)                                 \
+static void                                                             \
+pred_list_##name##_##LL##_##LR(struct phonstats *ps, struct mdata *m,   \
+                               struct span_hash *sh, int len,           \
+                               double *out)                             \
+{                                                                       \
+    const int len_l = (LL) ? (LL) : m->len_l,                           \
+              len_r = (LR) ? (LR) : m->len_r;                           \
+    int j;                                                              \
+                                                                        \
+    for (j = 0; j <= len; j++) {                                        \
+        int mid = j + 1;                                                \
+        int l0 = (mid - len_l > 0) ? mid - len_l : 0;                   \
+        int r1 = (mid + len_r < len + 2) ? mid + len_r : len + 2;       \
+        out[j] = (expr);                                                \
+    }                                                                   \
+}
+
+#define PRED_KERNELS(name, expr)                                        \
+    PRED_KERNEL(name, 0, 0, expr)                                       \
+    PRED_KERNEL(name, 1, 1, expr)                                       \
+    PRED_KERNEL(name, 2, 1, expr)                                       \
+    PRED_KERNEL(name, 3, 1, expr)                                       \
+    PRED_KERNEL(name, 1, 2, expr)                                       \
+    PRED_KERNEL(name, 1, 3, expr)
+
+/* indexed by [len_l][len_r], [0][0] is the generic one */
+#define PRED_KERNEL_TABLE(name) {                                       \
+    {pred_list_##name##_0_0, NULL, NULL, NULL},                         \
+    {NULL, pred_list_##name##_1_1, pred_list_##name##_1_2,              \
+           pred_list_##name##_1_3},                                     \
+    {NULL, pred_list_##name##_2_1, NULL, NULL},                         \
+    {NULL, pred_list_##name##_3_1, NULL, NULL}}
+
+PRED_KERNELS(jp, ng_P(ps, sh, l0, r1))
+PRED_KERNELS(tp, (double) ng_freq(ps, sh, l0, r1) /
+                 (double) ng_freq(ps, sh, l0, mid))
+PRED_KERNELS(mi, log2(ng_P(ps, sh, l0, r1) /
+                      (ng_P(ps, sh, l0, mid) * ng_P(ps, sh, mid, r1))))
+PRED_KERNELS(rtp, (double) ng_freq(ps, sh, l0, r1) /
+                  (double) ng_freq(ps, sh, mid, r1))
+
+static const pred_kernel jp_kernels[4][4] = PRED_KERNEL_TABLE(jp);
+static const pred_kernel tp_kernels[4][4] = PRED_KERNEL_TABLE(tp);
+static const pred_kernel mi_kernels[4][4] = PRED_KERNEL_TABLE(mi);
+static const pred_kernel rtp_kernels[4][4] = PRED_KERNEL_TABLE(rtp);
+
+/* the measures that need all continuations of a context, these
+ * only have a generic variant
+ */
+#define PRED_KERNEL_CTX(name, ctx, expr)                                \
+static void                                                             \
+pred_list_##name(struct phonstats *ps, struct mdata *m,                 \
+                 struct span_hash *sh, int len, double *out)            \
+{                                                                       \
+    int j;                                                              \
+                                                                        \
+    for (j = 0; j <= len; j++) {                                        \
+        char *x = ctx(m, j, len);                                       \
+        out[j] = (expr);                                                \
+        free(x);                                                        \
+    }                                                                   \
+}
+
+PRED_KERNEL_CTX(h, ng_l, cond_entropy(ps, x, m->len_r))
+PRED_KERNEL_CTX(sv, ng_l, (double) sv(ps, x, m->len_r))
+PRED_KERNEL_CTX(rh, ng_r, cond_entropy_r(ps, x, m->len_l))
+PRED_KERNEL_CTX(rsv, ng_r, (double) sv_r(ps, x, m->len_l))
+
+static inline pred_kernel
+span_kernel(const pred_kernel k[4][4], struct mdata *m)
+{
+    pred_kernel f = NULL;
+
+    assert(m->len_l > 0 && m->len_r > 0);
+    if (m->len_l < 4 && m->len_r < 4) f = k[m->len_l][m->len_r];
+    return (f != NULL) ? f : k[0][0];
+}
+
+/*
+ * pred_resolve() - set the list kernel of `m' for its measure and
+ *                  context lengths
+ */
+void
+pred_resolve(struct mdata *m)
+{
+    switch(m->info->mid) {
+        case M_JP:  m->kern = span_kernel(jp_kernels, m); break;
+        case M_TP:  m->kern = span_kernel(tp_kernels, m); break;
+        case M_MI:  m->kern = span_kernel(mi_kernels, m); break;
+        case M_RTP: m->kern = span_kernel(rtp_kernels, m); break;
+        case M_H: {
+            assert(m->len_r != 0);
+            m->kern = pred_list_h;
+        } break;
+        case M_SV: {
+            assert(m->len_r != 0);
+            m->kern = pred_list_sv;
+        } break;
+        case M_RH: {
+            assert(m->len_l != 0);
+            m->kern = pred_list_rh;
+        } break;
+        case M_RSV: {
+            assert(m->len_l != 0);
+            m->kern = pred_list_rsv;
+        } break;
+        default : {
+            fprintf(stderr, "pred_resolve(): unknown measure %d\n",
+                    m->info->mid);
+            exit(-1);
+        }
+    };
 }
 
 double *
-calc_pred_list(struct phonstats *ps, struct mdata *m)
+calc_pred_list(struct phonstats *ps, struct mdata *m, double *out)
 {
     int len = strlen(m->s);
-    int j = 0;
-    double *plist = NULL;
+    double *plist = out;
 
     assert(ps->max_ng > m->len_l);
 
-    plist = malloc((len + 1) * sizeof (*plist));
+    if (plist == NULL) plist = malloc((len + 1) * sizeof (*plist));
+    if (m->kern == NULL) pred_resolve(m);
 
-    for (j = 0; j <= len; j++) {
-        plist[j] = _calc_pred_single(ps, m, j, len);
-//printf("%s .. plist[%d] = %f\n", m->info->sname, j, plist[j]);
-    }
+    span_hash_set(&ng_sh, m->s, len, BOW_CH, EOW_CH);
+    m->kern(ps, m, &ng_sh, len, plist);
     return plist;
 }
 
@@ -511,29 +666,33 @@ pred_init(struct mdlist *mdl, struct phonstats *ps)
 {
     int  pred_votec = 0;
     int  lmin = 0, rmin = 0, lmax = 0, rmax = 0;
-    int mcount = (opt.pred_m_given) ? opt.pred_m_given : 1;
+    const struct gengetopt_args_info *o = mdl->opt;
+    int mcount = (o->pred_m_given) ? o->pred_m_given : 1;
     int pi;
     int li, ri;
 
-    lmin = opt.pred_xmin_arg;
-    rmin = opt.pred_ymin_arg;
-    lmax = opt.pred_xmax_arg;
-    rmax = opt.pred_ymax_arg;
+    lmin = o->pred_xmin_arg;
+    rmin = o->pred_ymin_arg;
+    lmax = o->pred_xmax_arg;
+    rmax = o->pred_ymax_arg;
 
-    if(opt.pred_xlen_given) {
-        lmin = lmax = opt.pred_xlen_arg;
+    if(o->pred_xlen_given) {
+        lmin = lmax = o->pred_xlen_arg;
     }
-    if(opt.pred_ylen_given) {
-        rmin = rmax = opt.pred_ylen_arg;
+    if(o->pred_ylen_given) {
+        rmin = rmax = o->pred_ylen_arg;
     }
 
-    assert(lmax >= lmin && rmax >= rmin);
+    if (lmax < lmin || rmax < rmin) {
+        PERROR("the minimum --pred-* lengths exceed the maximum\n");
+        return -1;
+    }
 
     pred_votec = (lmax - lmin + 1) * (rmax - rmin + 1)
                 * mcount;
 
     for (pi = 0; pi < mcount; pi++) {
-        enum m_id m = opt.pred_m_arg[pi];
+        enum m_id m = o->pred_m_arg[pi];
         assert (m & (M_PFMASK | M_PRMASK));
         for (li = lmin; li <= lmax; li++) {
             for (ri = rmin; ri <= rmax; ri++) {
@@ -541,7 +700,7 @@ pred_init(struct mdlist *mdl, struct phonstats *ps)
                 md->ps = ps;
                 md->info = &m_info[m];
                 md->s = NULL;
-                if (opt.pred_swaplr_flag && 
+                if (o->pred_swaplr_flag && 
                        (md->info->mmask & M_PRMASK)) {
                     md->len_l = ri;
                     md->len_r = li;
@@ -549,6 +708,7 @@ pred_init(struct mdlist *mdl, struct phonstats *ps)
                     md->len_l = li;
                     md->len_r = ri;
                 }
+                pred_resolve(md);
                 mdlist_add(mdl, md);
             }
         }
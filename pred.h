@@ -38,7 +38,8 @@ size_t sv_r(struct phonstats *ps, char *x, int y_len);
 double npmi(struct phonstats *ps, char *x, char *y);
 
 double calc_pred_single(struct phonstats *ps, struct mdata *m, int len);
-double *calc_pred_list(struct phonstats *ps, struct mdata *m);
+double *calc_pred_list(struct phonstats *ps, struct mdata *m, double *out);
+void pred_resolve(struct mdata *m);
 
 void add_bow_eow(char *dest, const char *src);
 inline void char_swap(char *s, int len, int pos);
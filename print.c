@@ -32,6 +32,7 @@
 #include "predictability.h"
 #include "prob_dist.h"
 #include "print.h"
+#include "symtab.h"
 
 #define SEP ','
 /* print_pred() - print predictability scores for given input
@@ -154,7 +155,8 @@ print_pred(FILE *fp, struct input *in)
             }
             if (opt.print_ph_flag) { 
                 if (!first) fprintf(fp, "%c", SEP);
-                fprintf(fp, "%c", (j == 0) ? '<' : s[j-1]);
+                if (j == 0) fprintf(fp, "<");
+                else symtab_fputsn(fp, s + j - 1, 1);
                 first = 0;
             } else if (opt.print_phng_flag) { 
                 if(offset < 0) {
@@ -163,9 +165,9 @@ print_pred(FILE *fp, struct input *in)
                         fprintf(fp, "<");
                         tmp++;
                     }
-                    fprintf(fp, "%.*s", winsz + offset, s);
+                    symtab_fputsn(fp, s, winsz + offset);
                 } else {
-                    fprintf(fp, "%.*s", winsz, s + offset);
+                    symtab_fputsn(fp, s + offset, winsz);
                 }
                 int tmp = j + y_len - len;
                 while (tmp > 0) {
@@ -317,7 +319,8 @@ print_ptp(FILE *fp, struct input *in)
     while (g_hash_table_iter_next (&iter, &key, &val)) {
         char *pp = (char *) key;
         struct ptp_stat *counts = (struct ptp_stat *) val;
-        fprintf(fp, "%s,%zu,%zu,%zu,%zu,%zu,%zu,%zu", pp,
+        symtab_fputs(fp, pp);
+        fprintf(fp, ",%zu,%zu,%zu,%zu,%zu,%zu,%zu",
                     counts->wbound, counts->count - counts->wbound,
                     counts->wbegin, counts->wend,
                     counts->ubegin, counts->uend,
@@ -404,7 +407,8 @@ print_wfreq(FILE *fp, struct input *in)
     for (i = 0; i < ps->max_ng; i++) {
         for (j = 0; j < ps->n_typ[i]; j++) {
             char *ng = ps->ngstr[i][j];
-            printf("%s,%d,%zu,%c\n", ng, i, phonstats_freq_ng(ps, ng), 
+            symtab_fputs(stdout, ng);
+            printf(",%d,%zu,%c\n", i, phonstats_freq_ng(ps, ng), 
                    g_hash_table_lookup(lexhash, ng) ? 'T' : 'F');
         }
     }
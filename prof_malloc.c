@@ -0,0 +1,92 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+/* Counting malloc() for the profile, see profile.h. Only linked into 
+ * seg-prof, the seg binary segbench uses for its --profile runs: seg 
+ * and libseg keep the allocator of the C library.
+ * The wrappers call the glibc allocator directly, on other C libraries
+ * and with the address sanitizer, which has its own malloc(), nothing 
+ * is replaced and the allocations are not counted.
+ */
+
+#include <stddef.h>
+#include <errno.h>
+#include "profile.h"
+
+#if defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  define __SANITIZE_ADDRESS__ 1
+# endif
+#endif
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+
+/* count() - one allocation, the wrappers run on the tpool workers too */
+static inline void
+count()
+{
+    if (prof_on) __atomic_fetch_add(&prof_nmalloc, 1, __ATOMIC_RELAXED);
+}
+
+void *
+malloc(size_t size)
+{
+    count();
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t n, size_t size)
+{
+    count();
+    return __libc_calloc(n, size);
+}
+
+void *
+realloc(void *p, size_t size)
+{
+    count();
+    return __libc_realloc(p, size);
+}
+
+int
+posix_memalign(void **p, size_t align, size_t size)
+{
+    void *q;
+
+    if (align < sizeof (void *) || (align & (align - 1))) return EINVAL;
+    count();
+    if ((q = __libc_memalign(align, size)) == NULL) return ENOMEM;
+    *p = q;
+    return 0;
+}
+
+static void __attribute__((constructor))
+prof_malloc_init()
+{
+    prof_malloc_counted = 1;
+}
+
+#endif
@@ -0,0 +1,256 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <glib.h>
+#include "profile.h"
+#include "mdata.h"
+#include "measures.h"
+#include "cclib_debug.h"
+
+struct prof_stats {
+    unsigned long   calls;
+    uint64_t        ns;         // including the nested stages
+    uint64_t        self_ns;
+    unsigned long   count[PROF_NCOUNTERS];
+};
+
+/* the time spent in calc_list() of a measure */
+struct prof_md {
+    const char      *name;
+    short           len_l;
+    short           len_r;
+    unsigned long   calls;
+    uint64_t        ns;
+};
+
+static const char *stage_name[PROF_NSTAGES] = {
+    "other", "input", "init", "segment", "phonstats", "parse",
+    "measures", "vote", "update", "score", "output"
+};
+static const char *counter_name[PROF_NCOUNTERS] = {
+    "probes", "allocs", "lookups", "lookup_mallocs"
+};
+
+int prof_on = 0;
+int prof_malloc_counted = 0;
+__thread unsigned long prof_nmalloc = 0;
+
+static char *prof_fname = NULL;
+static struct prof_stats stats[PROF_NSTAGES];
+static short cur = PROF_OTHER;      // the innermost running stage
+static uint64_t child_ns = 0;       //   and the time of its nested stages
+static uint64_t t_start;
+static GHashTable *mdtab = NULL;    // struct mdata * -> index in mdstats
+static struct prof_md *mdstats = NULL;
+static size_t nmd = 0, nalloc_md = 0;
+
+static inline uint64_t
+now_ns()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+/* prof_init() - start profiling, the report is written to `fname'
+ *               by prof_report(). a NULL `fname' leaves it off.
+ */
+void
+prof_init(const char *fname)
+{
+    if (fname == NULL) return;
+
+    prof_fname = strdup(fname);
+    memset(stats, 0, sizeof stats);
+    cur = PROF_OTHER;
+    child_ns = 0;
+    mdtab = g_hash_table_new(g_direct_hash, g_direct_equal);
+    t_start = now_ns();
+    prof_on = 1;
+}
+
+void
+prof_enter(struct prof_mark *pm, enum prof_stage st)
+{
+    pm->st = st;
+    pm->prev = cur;
+    pm->child = child_ns;
+    cur = st;
+    child_ns = 0;
+    pm->t0 = now_ns();
+}
+
+static void
+prof_md_add(struct mdata *md, uint64_t ns)
+{
+    gpointer idx;
+
+    if (!g_hash_table_lookup_extended(mdtab, md, NULL, &idx)) {
+        if (nmd == nalloc_md) {
+            nalloc_md = nalloc_md ? 2 * nalloc_md : 64;
+            mdstats = realloc(mdstats, nalloc_md * sizeof (*mdstats));
+            assert(mdstats != NULL);
+        }
+        mdstats[nmd].name = md->info->sname;
+        mdstats[nmd].len_l = md->len_l;
+        mdstats[nmd].len_r = md->len_r;
+        mdstats[nmd].calls = 0;
+        mdstats[nmd].ns = 0;
+        idx = GSIZE_TO_POINTER(nmd);
+        g_hash_table_insert(mdtab, md, idx);
+        ++nmd;
+    }
+    ++mdstats[GPOINTER_TO_SIZE(idx)].calls;
+    mdstats[GPOINTER_TO_SIZE(idx)].ns += ns;
+}
+
+void
+prof_leave(struct prof_mark *pm, struct mdata *md)
+{
+    uint64_t ns = now_ns() - pm->t0;
+    struct prof_stats *s = &stats[pm->st];
+
+    assert(cur == pm->st);
+    ++s->calls;
+    s->ns += ns;
+    s->self_ns += ns - child_ns;
+    cur = pm->prev;
+    child_ns = pm->child + ns;
+    if (md != NULL) prof_md_add(md, ns);
+}
+
+void
+prof_add(enum prof_counter c, unsigned long n)
+{
+    short st = __atomic_load_n(&cur, __ATOMIC_RELAXED);
+
+    __atomic_add_fetch(&stats[st].count[c], n, __ATOMIC_RELAXED);
+}
+
+static void
+report_json(FILE *fp, double wall, double useg)
+{
+    size_t i;
+    int c;
+
+    fprintf(fp, "{\n  \"wall_seconds\": %.6f,\n", wall);
+    fprintf(fp, "  \"utterances\": %lu,\n", stats[PROF_SEGMENT].calls);
+    fprintf(fp, "  \"utterances_per_second\": %.1f,\n", useg);
+    fprintf(fp, "  \"mallocs_counted\": %s,\n", 
+            (prof_malloc_counted) ? "true" : "false");
+    fprintf(fp, "  \"stages\": [\n");
+    for (i = 0; i < PROF_NSTAGES; i++) {
+        struct prof_stats *s = &stats[i];
+        fprintf(fp, "    {\"stage\": \"%s\", \"calls\": %lu, "
+                "\"seconds\": %.6f, \"self_seconds\": %.6f",
+                stage_name[i], s->calls, s->ns / 1e9, s->self_ns / 1e9);
+        for (c = 0; c < PROF_NCOUNTERS; c++) {
+            fprintf(fp, ", \"%s\": %lu", counter_name[c], s->count[c]);
+        }
+        fprintf(fp, "}%s\n", (i + 1 < PROF_NSTAGES) ? "," : "");
+    }
+    fprintf(fp, "  ],\n  \"measures\": [\n");
+    for (i = 0; i < nmd; i++) {
+        struct prof_md *m = &mdstats[i];
+        fprintf(fp, "    {\"measure\": \"%s\", \"len_l\": %d, "
+                "\"len_r\": %d, \"calls\": %lu, \"seconds\": %.6f}%s\n",
+                m->name, m->len_l, m->len_r, m->calls, m->ns / 1e9,
+                (i + 1 < nmd) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+static void
+report_csv(FILE *fp, double wall, double useg)
+{
+    size_t i;
+    int c;
+
+    fprintf(fp, "kind,name,len_l,len_r,calls,seconds,self_seconds");
+    for (c = 0; c < PROF_NCOUNTERS; c++) fprintf(fp, ",%s", counter_name[c]);
+    fprintf(fp, "\ntotal,wall,,,%lu,%.6f,", stats[PROF_SEGMENT].calls, wall);
+    for (c = 0; c < PROF_NCOUNTERS; c++) fprintf(fp, ",");
+    fprintf(fp, "\ntotal,utterances_per_second,,,,%.1f,", useg);
+    for (c = 0; c < PROF_NCOUNTERS; c++) fprintf(fp, ",");
+    fprintf(fp, "\n");
+    for (i = 0; i < PROF_NSTAGES; i++) {
+        struct prof_stats *s = &stats[i];
+        fprintf(fp, "stage,%s,,,%lu,%.6f,%.6f", stage_name[i], 
+                s->calls, s->ns / 1e9, s->self_ns / 1e9);
+        for (c = 0; c < PROF_NCOUNTERS; c++) {
+            fprintf(fp, ",%lu", s->count[c]);
+        }
+        fprintf(fp, "\n");
+    }
+    for (i = 0; i < nmd; i++) {
+        struct prof_md *m = &mdstats[i];
+        fprintf(fp, "measure,%s,%d,%d,%lu,%.6f,", m->name, 
+                m->len_l, m->len_r, m->calls, m->ns / 1e9);
+        for (c = 0; c < PROF_NCOUNTERS; c++) fprintf(fp, ",");
+        fprintf(fp, "\n");
+    }
+}
+
+/* prof_report() - write the report to the file given to prof_init(),
+ *                 CSV if its name ends with `.csv', JSON otherwise
+ */
+void
+prof_report()
+{
+    FILE *fp = stdout;
+    size_t flen;
+    double wall, useg;
+
+    if (!prof_on) return;
+    prof_on = 0;
+
+    wall = (now_ns() - t_start) / 1e9;
+    useg = stats[PROF_SEGMENT].ns ? 
+           stats[PROF_SEGMENT].calls / (stats[PROF_SEGMENT].ns / 1e9) : 0.0;
+
+    if (strcmp(prof_fname, "-")) {
+        fp = fopen(prof_fname, "w");
+        if (fp == NULL) {
+            PFATAL("cannot open profile file `%s' for writing\n", 
+                   prof_fname);
+        }
+    }
+    flen = strlen(prof_fname);
+    if (flen > 4 && !strcmp(prof_fname + flen - 4, ".csv")) {
+        report_csv(fp, wall, useg);
+    } else {
+        report_json(fp, wall, useg);
+    }
+    if (fp != stdout) fclose(fp);
+
+    g_hash_table_destroy(mdtab);
+    mdtab = NULL;
+    free(mdstats);
+    mdstats = NULL;
+    nmd = nalloc_md = 0;
+    free(prof_fname);
+    prof_fname = NULL;
+}
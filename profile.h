@@ -0,0 +1,134 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PROFILE_H
+#define _PROFILE_H       1
+
+#include <stdint.h>
+#include <time.h>
+
+struct mdata;
+
+/*
+ * Per-stage timers and counters for --profile.
+ *
+ * A stage is timed between prof_start() and prof_stop(). Stages nest,
+ * the report gives both the total time of a stage and its self time,
+ * the time not spent in the stages inside it. The timers are only 
+ * used on the main thread. The counters can be bumped from any thread,
+ * they are added to the stage the main thread is in at the time.
+ *
+ * Everything is a no-op unless prof_init() is called with a file
+ * name, the cost when profiling is off is a test of prof_on.
+ *
+ * The lexicon lookups are counted with the number of allocations made
+ * inside them. The allocations are counted by the malloc() wrappers
+ * in prof_malloc.c, which are only linked into seg-prof (make seg-prof).
+ * Without them, prof_nmalloc stays 0 and the report says so.
+ */
+
+enum prof_stage {
+    PROF_OTHER = 0,     // outside of the stages below
+    PROF_INPUT,         // read_input()
+    PROF_INIT,          // segment_*_init()
+    PROF_SEGMENT,       // segment_*() for one utterance
+    PROF_PHONSTATS,     // phonstats_update()
+    PROF_PARSE,         // seg_parse_chart()
+    PROF_MEASURES,      // mlist_add()
+    PROF_VOTE,          // mv_getvotes()
+    PROF_UPDATE,        // segment_*_update()
+    PROF_SCORE,         // print_prf()
+    PROF_OUTPUT,        // output_add() and output_write()
+    PROF_NSTAGES
+};
+
+enum prof_counter {
+    PROF_PROBES = 0,    // hash table lookups
+    PROF_ALLOCS,        // allocations in the model and per-utterance data
+    PROF_LOOKUPS,       // lexicon lookups
+    PROF_LOOKUP_MALLOCS,// malloc() calls inside the lexicon lookups
+    PROF_NCOUNTERS
+};
+
+struct prof_mark {
+    uint64_t    t0;
+    uint64_t    child;  // time spent in the nested stages
+    short       st;
+    short       prev;
+};
+
+extern int prof_on;
+extern int prof_malloc_counted;             // set by prof_malloc.c
+extern __thread unsigned long prof_nmalloc; // malloc() calls of the thread
+
+void prof_init(const char *fname);
+void prof_report();
+
+void prof_enter(struct prof_mark *pm, enum prof_stage st);
+void prof_leave(struct prof_mark *pm, struct mdata *md);
+void prof_add(enum prof_counter c, unsigned long n);
+
+static inline struct prof_mark
+prof_start(enum prof_stage st)
+{
+    struct prof_mark pm = {0, 0, 0, 0};
+
+    if (prof_on) prof_enter(&pm, st);
+    return pm;
+}
+
+static inline void
+prof_stop(struct prof_mark *pm)
+{
+    if (prof_on) prof_leave(pm, NULL);
+}
+
+/* prof_stop_md() - prof_stop(), also counting the time for measure `md' */
+static inline void
+prof_stop_md(struct prof_mark *pm, struct mdata *md)
+{
+    if (prof_on) prof_leave(pm, md);
+}
+
+static inline void
+prof_count(enum prof_counter c, unsigned long n)
+{
+    if (prof_on) prof_add(c, n);
+}
+
+/* prof_lookup_start(), prof_lookup_stop() - count a lexicon lookup and
+ *                                          the allocations it makes
+ */
+static inline unsigned long
+prof_lookup_start()
+{
+    return (prof_on) ? prof_nmalloc : 0;
+}
+
+static inline void
+prof_lookup_stop(unsigned long nmalloc)
+{
+    if (prof_on) {
+        prof_add(PROF_LOOKUPS, 1);
+        prof_add(PROF_LOOKUP_MALLOCS, prof_nmalloc - nmalloc);
+    }
+}
+
+#endif // _PROFILE_H
@@ -40,11 +40,19 @@
 #include "seg_combine.h"
 #include "seg_lexicon.h"
 #include "seg_lexc.h"
+#include "seg_mbdp.h"
+#include "seg_gibbs.h"
 #include "seglist.h"
 #include "score.h"
 #include "predictability.h"
 #include "print.h"
 #include "cclib_debug.h"
+#include "bloom.h"
+#include "profile.h"
+#include "mem.h"
+#include "checkpoint.h"
+#include "serve.h"
+#include "symtab.h"
 
 void process_input(struct input *in);
 
@@ -52,19 +60,43 @@ int
 main(int argc, char **argv)
 {
     struct input *I;
+    struct prof_mark pm;
 
     if (cmdline_parser(argc, argv, &opt) != 0) {
-        PFATAL("");
+        cmdline_parser_free(&opt);
+        exit(EXIT_FAILURE);
+    }
+    if (opt.help_given || opt.version_given) {
+        if (opt.help_given) cmdline_parser_print_help();
+        else cmdline_parser_print_version();
+        cmdline_parser_free(&opt);
+        exit(EXIT_SUCCESS);
     }
 
     cclib_debug_init(opt.debug_arg, !opt.quiet_flag, opt.color_flag);
 
+    if (opt.bloom_fpr_arg < 0.0 || opt.bloom_fpr_arg >= 1.0) {
+        PFATAL("--bloom-fpr should be in [0, 1)\n");
+    }
+    bloom_init(opt.bloom_fpr_arg);
+    if (opt.bloom_stats_flag) bloom_stats_enable();
+    prof_init(opt.profile_given ? opt.profile_arg : NULL);
+    if (opt.mem_report_given) {
+        mem_init(opt.mem_report_arg);
+    }
+    if (opt.word_sep_given && opt.symbols_arg != symbols_arg_tokens) {
+        PFATAL("--word-sep is only used with --symbols=tokens\n");
+    }
+    symtab_init(opt.symbols_arg, opt.word_sep_arg);
+
     assert(opt.print_flag || opt.method_given);
 
+    pm = prof_start(PROF_INPUT);
     I = read_input(opt.input_arg);
     if (opt.shuffle_given) {
        shuffle_input(I); 
     }
+    prof_stop(&pm);
 
     if(opt.print_flag) {
         FILE *fp = stdout;
@@ -88,12 +120,116 @@ main(int argc, char **argv)
     } else {
         process_input(I);
     }
+    bloom_report();
+    prof_report();
     input_free(I);
+    symtab_free();
     cmdline_parser_free(&opt);
     return 0;
 } /* main */
 
 
+/* input_fingerprint() - FNV-1a hash of the utterances of `in' in 
+ *                       order, a resumed run checks it against the one
+ *                       in the checkpoint
+ */
+static uint64_t
+input_fingerprint(struct input *in)
+{
+    uint64_t h = 14695981039346656037ULL;
+    size_t i;
+    const unsigned char *p;
+
+    for (i = 0; i < in->size; i++) {
+        for (p = (const unsigned char *) in->u[i].s; ; p++) {
+            h = (h ^ *p) * 1099511628211ULL;
+            if (*p == '\0') break;
+        }
+    }
+    return h;
+}
+
+/* checkpoint_write() - save everything needed to continue after the 
+ *                      utterance `i' to --checkpoint-file
+ */
+static void
+checkpoint_write(struct input *in, struct output *out, int i)
+{
+    struct ckpt *ck = ckpt_create(opt.checkpoint_file_arg);
+    FILE *fp;
+
+    if (ck == NULL) {
+        PFATAL("cannot write the checkpoint\n");
+    }
+    fp = ckpt_begin(ck, "run");
+
+    ckpt_put_u64(fp, i + 1);
+    ckpt_put_u64(fp, in->size);
+    ckpt_put_u64(fp, input_fingerprint(in));
+    ckpt_end(ck);
+    output_write_bin(ckpt_begin(ck, "output"), out);
+    ckpt_end(ck);
+    segment_combine_checkpoint(ck);
+    if (ckpt_commit(ck)) {
+        PFATAL("cannot write the checkpoint\n");
+    }
+}
+
+/* checkpoint_resume() - restore the output and the position in the 
+ *                       input from the checkpoint being resumed, and 
+ *                       return the first utterance to segment
+ */
+static int
+checkpoint_resume(struct input *in, struct output *out)
+{
+    struct ckpt_buf b;
+    char *data = ckpt_read(ckpt_in, "run", &b);
+    int i;
+
+    if (data == NULL) {
+        PFATAL("cannot resume from the checkpoint\n");
+    }
+    i = ckpt_get_u64(&b);
+    if (ckpt_get_u64(&b) != in->size 
+            || ckpt_get_u64(&b) != input_fingerprint(in)) {
+        PFATAL("the input differs from the one of the checkpointed run\n");
+    }
+    free(data);
+    data = ckpt_read(ckpt_in, "output", &b);
+    if (data == NULL) {
+        PFATAL("cannot resume from the checkpoint\n");
+    }
+    output_read_bin(&b, out);
+    if (b.err) {
+        PFATAL("cannot resume from the checkpoint\n");
+    }
+    free(data);
+    ckpt_close(ckpt_in);
+    ckpt_in = NULL;
+    return i;
+}
+
+/* print_prf_replay() - print the --print-prf=N scores of the first `n'
+ *                      utterances of the resumed `out' again, so that 
+ *                      the output is the one of a run from the start,
+ *                      returns the offset of the next score
+ */
+static size_t
+print_prf_replay(struct input *in, struct output *out, size_t n, 
+                 size_t incr)
+{
+    size_t size = out->size, off = 0, end;
+
+    for (end = opt.print_prf_arg; end <= n; end += opt.print_prf_arg) {
+        out->size = end;
+        print_prf(in, out, off, 
+                  (end == opt.print_prf_arg) ? opt.print_header_flag : 0);
+        off += incr;
+    }
+    out->size = size;
+    return off;
+}
+
 /* process_input()
  * 
  * This is where the main loop over the input is run.
@@ -108,7 +244,28 @@ process_input(struct input *in)
     int i;
     size_t prf_off = 0;
     size_t prf_incr = 0;
+    struct prof_mark pm;
 
+    if ((opt.checkpoint_every_given || opt.resume_given)
+            && opt.method_arg != method_arg_combine) {
+        PFATAL("checkpoints are only supported with `-m combine'\n");
+    }
+    if (opt.serve_given && opt.method_arg != method_arg_combine) {
+        PFATAL("--serve is only supported with `-m combine'\n");
+    }
+    if (opt.serve_given && !strcmp(opt.serve_arg, "-")
+            && !strcmp(opt.input_arg, "-")) {
+        PFATAL("--serve cannot read requests from stdin if the input "
+               "is read from stdin\n");
+    }
+    if (opt.resume_given) {
+        ckpt_in = ckpt_open(opt.resume_arg);
+        if (ckpt_in == NULL) {
+            PFATAL("cannot resume from the checkpoint\n");
+        }
+    }
+
+    pm = prof_start(PROF_INIT);
     switch (opt.method_arg) {
         case method_arg_combine:
             seg_func = segment_combine;
@@ -152,47 +309,92 @@ process_input(struct input *in)
             seg_cleanup_func = segment_lexc_cleanup;
             segment_lexc_init(in);
         break;
+        case method_arg_mbdp:
+            seg_func = segment_mbdp;
+            seg_cleanup_func = segment_mbdp_cleanup;
+            segment_mbdp_init(in);
+        break;
+        case method_arg_gibbs:
+            seg_func = segment_gibbs;
+            seg_cleanup_func = segment_gibbs_cleanup;
+            segment_gibbs_init(in);
+        break;
         default:
             assert(opt.print_flag);
         break;
     }
+    prof_stop(&pm);
 
     out = output_new(0);
     if (opt.print_prf_arg < 0) {
         prf_incr = opt.print_prf_arg = -opt.print_prf_arg;
     }
 
-    for (i = 0; i < in->size; i++) {
+    i = 0;
+    if (ckpt_in) {
+        i = checkpoint_resume(in, out);
+        if (opt.print_prf_arg) {
+            pm = prof_start(PROF_SCORE);
+            prf_off = print_prf_replay(in, out, i, prf_incr);
+            prof_stop(&pm);
+        }
+    }
+    for (; i < in->size; i++) {
         struct seglist *segl;
+
+        pm = prof_start(PROF_SEGMENT);
         segl = seg_func(in, i);
+        prof_stop(&pm);
+        pm = prof_start(PROF_OUTPUT);
         output_add(out, in->u[i].s, segl);
+        prof_stop(&pm);
+        mem_tick(i + 1);
         if (opt.progress_given) {
             if((i %  opt.progress_arg) == 0) {
                 fprintf(stderr,"%*d/%zu\r", 6, i, in->size);
             }
         }
         if (opt.print_prf_arg && ((i+1) % opt.print_prf_arg) == 0){
+            pm = prof_start(PROF_SCORE);
             if (i < opt.print_prf_arg) {
                 print_prf(in, out, prf_off, opt.print_header_flag);
             } else {
                 print_prf(in, out, prf_off, 0);
             }
             prf_off += prf_incr;
+            prof_stop(&pm);
+        }
+        if (opt.checkpoint_every_arg > 0 
+                && ((i+1) % opt.checkpoint_every_arg) == 0) {
+            checkpoint_write(in, out, i);
         }
     }
 
     if (opt.print_prf_given) {
+        pm = prof_start(PROF_SCORE);
         if (opt.print_prf_arg) {
             print_prf(in, out, prf_off, 0);
         } else {
             print_prf(in, out, prf_off, opt.print_header_flag);
         }
+        prof_stop(&pm);
     }
 
+    if (opt.serve_given) {
+        segment_combine_learn(opt.serve_learn_flag);
+        serve(opt.serve_arg, seg_func, opt.serve_batch_arg);
+    }
+
+    mem_report("at exit");
     seg_cleanup_func();
 
-    output_write(opt.output_arg, out);
+    pm = prof_start(PROF_OUTPUT);
+    // with --serve the answers go to stdout, the output only if asked for
+    if (!opt.serve_given || opt.output_given) {
+        output_write(opt.output_arg, out);
+    }
     output_free(out);
+    prof_stop(&pm);
 
 /*
     if (opt.outlex_given){
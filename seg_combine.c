@@ -29,132 +29,360 @@
 #include "mlist.h"
 #include "mdata.h"
 #include "lex.h"
+#include "segparse.h"
+#include "profile.h"
+#include "mem.h"
+#include "checkpoint.h"
+#include "measures.h"
+#include "tpool.h"
+#include "cclib_debug.h"
 
-static struct phonstats *ps_u = NULL; // phoneme stats over utterances
-static struct phonstats *ps_b = NULL; // phoneme stats over utterance boundaries
-static struct phonstats *ps_l = NULL; // phoneme stats over lexicon
-static struct phonstats *ss_u = NULL; // stress stats over utterances
-static struct phonstats *ss_b = NULL; // stress stats over utterance boundaries
-static struct phonstats *ss_l = NULL; // stress stats over lexicon
-static struct mdlist *mdl = NULL;
-static int nvotes = 0;
-
-static short seg_lex = 0;   // or not.
-
-static struct cg_lexicon *lex = NULL;
-static struct ctxlex *lex_b = NULL;
-
+/*
+ * struct combine - a model of -m combine
+ *
+ * everything the model learns from the input is here, together with 
+ * the options it was set up with. the models are independent of each
+ * other, they can be used from different threads (see libseg.c).
+ */
+struct combine {
+    const struct gengetopt_args_info *opt;
+    struct phonstats    *ps_u;  // phoneme stats over utterances
+    struct phonstats    *ps_b;  // phoneme stats over utterance boundaries
+    struct phonstats    *ps_l;  // phoneme stats over lexicon
+    // the stress stats are the second channel of the phoneme stats above
+    struct phonstats    *ss_u;  // stress stats over utterances
+    struct phonstats    *ss_b;  // stress stats over utterance boundaries
+    struct phonstats    *ss_l;  // stress stats over lexicon
+    struct mdlist       *mdl;
+    int                 nvotes;
+    short               seg_lex;
+    struct cg_lexicon   *lex;
+    struct ctxlex       *lex_b;
+    struct chart        *lex_chart; // shared by all lexical measures
+    struct mlist        *ml;        // measures and votes, reused
+    int                 learn;      // update the model after segmenting
+    struct mv_state     mv;
+    struct tpool        *tp;        // parses long utterances, or NULL
+};
 
 #define max_of(x,y) ((x > y) ? x : y)
 
 static inline int 
-get_maxng()
+get_maxng(const struct gengetopt_args_info *o)
 {
     int max = 0;
 
-    max = max_of(opt.pred_xlen_arg, max);
-    max = max_of(opt.pred_ylen_arg, max);
-    max = max_of(opt.pred_xmax_arg, max);
-    max = max_of(opt.pred_ymax_arg, max);
-    max = max_of(opt.ub_nglen_arg, max);
-    max = max_of(opt.ub_ngmax_arg, max);
-    max = max_of(opt.sub_ngmax_arg, max);
-    max = max_of(opt.ub_lmax_arg, max);
-    max = max_of(opt.ub_rmax_arg, max);
-    max = max_of(opt.lex_nglen_arg, max);
+    max = max_of(o->pred_xlen_arg, max);
+    max = max_of(o->pred_ylen_arg, max);
+    max = max_of(o->pred_xmax_arg, max);
+    max = max_of(o->pred_ymax_arg, max);
+    max = max_of(o->ub_nglen_arg, max);
+    max = max_of(o->ub_ngmax_arg, max);
+    max = max_of(o->sub_ngmax_arg, max);
+    max = max_of(o->ub_lmax_arg, max);
+    max = max_of(o->ub_rmax_arg, max);
+    max = max_of(o->lex_nglen_arg, max);
     return max;
 }
 
-void 
-segment_combine_init(struct input *in)
+/* 
+ * new_phonstats() - an empty phonstats, or the one saved as `tag' in
+ *                   the checkpoint `ck' if it is not NULL
+ */
+static struct phonstats *
+new_phonstats(struct ckpt *ck, const char *tag, int maxng)
+{
+    struct ckpt_buf b;
+    struct phonstats *ps;
+    char *data;
+
+    if (ck == NULL) return phonstats_new(maxng, NULL);
+
+    if ((data = ckpt_read(ck, tag, &b)) == NULL) return NULL;
+    ps = phonstats_read_bin(&b);
+    free(data);
+    if (ps && ps->max_ng != maxng) {
+        PERROR("the n-gram sizes differ from the checkpointed run\n");
+        phonstats_free(ps);
+        return NULL;
+    }
+    return ps;
+}
+
+/* 
+ * stress_channel() - the stress channel of the phoneme statistics `ps'
+ *                    (see phonstats.h), it is counted together with 
+ *                    the phonemes with phonstats_update_joint()
+ */
+static struct phonstats *
+stress_channel(struct ckpt *ck, struct phonstats *ps)
+{
+    if (ck == NULL) return phonstats_add_channel(ps);
+
+    if (ps->next_chan == NULL) {
+        PERROR("the cues differ from the checkpointed run\n");
+    }
+    return ps->next_chan;
+}
+
+static struct ctxlex *
+new_ctxlex(struct ckpt *ck)
 {
-    int mi = 0;
-    int maxng = 1 + 2 * get_maxng();
-    int pred_src = (opt.pred_source_given) ? opt.pred_source_arg
-                                           : opt.cue_source_arg,
-        phon_src = (opt.phon_source_given) ? opt.phon_source_arg
-                                           : opt.cue_source_arg,
-        stress_src = (opt.stress_source_given) ? opt.stress_source_arg
-                                               : opt.cue_source_arg;
-//        lex_src = (opt.lex_source_given) ? opt.lex_source_arg
-//                                         : opt.cue_source_arg;
-
-    mdl = mdlist_new();
-
-    lex_b = ctxlex_new();
-    ps_u = phonstats_new(maxng, NULL);
-    ps_b = phonstats_new(maxng, NULL);
-    ps_l = phonstats_new(maxng, NULL);
-
-    for (mi = 0; mi < opt.cues_given; mi++) {
-        switch (opt.cues_arg[mi]) {
+    struct ckpt_buf b;
+    struct ctxlex *cl;
+    char *data;
+
+    if (ck == NULL) return ctxlex_new();
+
+    if ((data = ckpt_read(ck, "lex_b", &b)) == NULL) return NULL;
+    cl = ctxlex_read_bin(&b);
+    free(data);
+    return cl;
+}
+
+static struct cg_lexicon *
+new_lexicon(struct ckpt *ck, const struct gengetopt_args_info *o)
+{
+    const struct ckpt_rec *r;
+    struct cg_lexicon *L;
+
+    if (ck != NULL) {
+        if ((r = ckpt_find(ck, "lex")) == NULL) {
+            PERROR("checkpoint has no lexicon, the options should be "
+                   "the same as the run that wrote it\n");
+            return NULL;
+        }
+        L = cg_lexicon_load_bin_at(ck->fname, r->off, r->len);
+    } else if (o->inlex_given) {
+        L = inlex_read(o->inlex_arg);
+    } else {
+        L = cg_lexicon_new();
+    }
+    if (L == NULL) PERROR("cannot load the lexicon\n");
+    return L;
+}
+
+/* 
+ * weights_read() - the weights of the measures and the vote count
+ *                  from the checkpoint `ck'
+ *
+ * the measures are checked against the ones set up from the options.
+ * returns 0, or -1 if they differ.
+ */
+static int
+weights_read(struct combine *c, struct ckpt *ck)
+{
+    struct ckpt_buf b;
+    char *data = ckpt_read(ck, "weights", &b);
+    struct mdlist *mdl = c->mdl;
+    size_t j;
+
+    if (data == NULL) return -1;
+    c->mv.nvotes = ckpt_get_u64(&b);
+    if (ckpt_get_u64(&b) != mdl->n) {
+        PERROR("the measures differ from the checkpointed run\n");
+        free(data);
+        return -1;
+    }
+    for (j = 0; j < mdl->n && !b.err; j++) {
+        struct mdata *md = mdl->md[j];
+        const char *sname = ckpt_get_str(&b);
+        int64_t len_l = ckpt_get_u64(&b),
+                len_r = ckpt_get_u64(&b);
+
+        if (strcmp(sname, md->info->sname) 
+            || len_l != md->len_l || len_r != md->len_r) {
+            PERROR("the measures differ from the checkpointed run\n");
+            free(data);
+            return -1;
+        }
+        ckpt_get(&b, &md->w_l, sizeof (md->w_l));
+        ckpt_get(&b, &md->w_r, sizeof (md->w_r));
+    }
+    free(data);
+    return (b.err) ? -1 : 0;
+}
+
+static void
+weights_write(struct combine *c, FILE *fp)
+{
+    struct mdlist *mdl = c->mdl;
+    size_t j;
+
+    ckpt_put_u64(fp, c->mv.nvotes);
+    ckpt_put_u64(fp, mdl->n);
+    for (j = 0; j < mdl->n; j++) {
+        struct mdata *md = mdl->md[j];
+
+        ckpt_put_str(fp, md->info->sname);
+        ckpt_put_u64(fp, md->len_l);
+        ckpt_put_u64(fp, md->len_r);
+        ckpt_put(fp, &md->w_l, sizeof (md->w_l));
+        ckpt_put(fp, &md->w_r, sizeof (md->w_r));
+    }
+}
+
+/* 
+ * combine_checkpoint() - write the learner state of `c' to `ck'
+ *
+ * this is everything combine_segment() learns from the input: the 
+ * phoneme and stress statistics, the lexicons, the weights of the 
+ * measures and the number of votes they were updated with.
+ */
+void
+combine_checkpoint(struct combine *c, struct ckpt *ck)
+{
+    struct { const char *tag; struct phonstats *ps; } pstab[] = {
+        {"ps_u", c->ps_u}, {"ps_b", c->ps_b}, {"ps_l", c->ps_l}, // with ss_*
+    };
+    int i;
+
+    for (i = 0; i < sizeof (pstab) / sizeof (*pstab); i++) {
+        if (pstab[i].ps) {
+            phonstats_write_bin(ckpt_begin(ck, pstab[i].tag), pstab[i].ps);
+            ckpt_end(ck);
+        }
+    }
+    ctxlex_write_bin(ckpt_begin(ck, "lex_b"), c->lex_b);
+    ckpt_end(ck);
+    if (c->lex) {
+        cg_lexicon_write_bin(ckpt_begin(ck, "lex"), c->lex);
+        ckpt_end(ck);
+    }
+    weights_write(c, ckpt_begin(ck, "weights"));
+    ckpt_end(ck);
+}
+
+/* add_measures() - the measures of the cues in the options of `c' */
+static int
+add_measures(struct combine *c, struct ckpt *ck, int maxng)
+{
+    const struct gengetopt_args_info *o = c->opt;
+    struct mdlist *mdl = c->mdl;
+    int pred_src = (o->pred_source_given) ? o->pred_source_arg
+                                          : o->cue_source_arg,
+        phon_src = (o->phon_source_given) ? o->phon_source_arg
+                                          : o->cue_source_arg,
+        stress_src = (o->stress_source_given) ? o->stress_source_arg
+                                              : o->cue_source_arg;
+//        lex_src = (o->lex_source_given) ? o->lex_source_arg
+//                                        : o->cue_source_arg;
+    int mi;
+
+    for (mi = 0; mi < o->cues_given; mi++) {
+        int n = 0;
+
+        switch (o->cues_arg[mi]) {
         case cues_arg_phon: {
             switch (phon_src) {
             case pred_source_arg_utterances:
-                nvotes += ub_init(mdl, ps_u, M_PUB, M_PUE);
+                n = ub_init(mdl, c->ps_u, M_PUB, M_PUE);
             break;
             case pred_source_arg_segments:
-                nvotes += ub_init(mdl, ps_b, M_PUB, M_PUE);
+                n = ub_init(mdl, c->ps_b, M_PUB, M_PUE);
             break;
             case pred_source_arg_lexicon:
-                nvotes += ub_init(mdl, ps_l, M_PUB, M_PUE);
+                n = ub_init(mdl, c->ps_l, M_PUB, M_PUE);
             break;
             }
         } break;
         case cues_arg_stress: {
-            assert(opt.stress_file_given);
+            struct phonstats **ss = NULL, *ps = NULL;
+
             switch (stress_src) {
             case pred_source_arg_utterances:
-                ss_u = phonstats_new(maxng, NULL);
-                nvotes += ub_init(mdl, ss_u, M_SUB, M_SUE);
+                ss = &c->ss_u; ps = c->ps_u;
             break;
             case pred_source_arg_segments:
-                ss_b = phonstats_new(maxng, NULL);
-                nvotes += ub_init(mdl, ss_b, M_SUB, M_SUE);
+                ss = &c->ss_b; ps = c->ps_b;
             break;
             case pred_source_arg_lexicon:
-                ss_l = phonstats_new(maxng, NULL);
-                nvotes += ub_init(mdl, ss_l, M_SUB, M_SUE);
+                ss = &c->ss_l; ps = c->ps_l;
             break;
             }
+            if (ss == NULL) break;
+            if (*ss == NULL && (*ss = stress_channel(ck, ps)) == NULL) {
+                return -1;
+            }
+            n = ub_init(mdl, *ss, M_SUB, M_SUE);
         } break;
         case cues_arg_pred: {
             switch (pred_src) {
             case pred_source_arg_utterances:
-                nvotes += pred_init(mdl, ps_u);
+                n = pred_init(mdl, c->ps_u);
             break;
             case pred_source_arg_segments:
-                nvotes += pred_init(mdl, ps_b);
+                n = pred_init(mdl, c->ps_b);
             break;
             case pred_source_arg_lexicon:
-                nvotes += pred_init(mdl, ps_b);
+                n = pred_init(mdl, c->ps_b);
             break;
             }
         } break;
         case cues_arg_lex: {
-            if (ps_l == NULL) ps_l = phonstats_new(maxng, NULL);
-            if(opt.inlex_given){
-                lex = cg_lexicon_load(opt.inlex_arg);
-            } else {
-                lex = cg_lexicon_new();
+            if (c->ps_l == NULL) c->ps_l = phonstats_new(maxng, NULL);
+            if (c->lex == NULL && (c->lex = new_lexicon(ck, o)) == NULL) {
+                return -1;
             }
-            nvotes += lex_init(mdl, lex, ps_l, lex_b);
-            seg_lex = 1;
+            n = lex_init(mdl, c->lex, c->ps_l, c->lex_b);
+            c->seg_lex = 1;
         } break;
         default:
-            fprintf(stderr, "I don not know how to combine method `%d'.\n", 
-                     opt.cues_arg[mi]);
-            exit(-1);
+            PERROR("I don not know how to combine method `%d'.\n", 
+                   o->cues_arg[mi]);
+            return -1;
         break;
         }
+        if (n < 0) return -1;
+        c->nvotes += n;
+    }
+    return 0;
+}
+
+/* 
+ * combine_new() - a model with the options `o', restored from the 
+ *                 checkpoint `ck' if it is not NULL
+ *
+ * `o' is used as long as the model is. returns NULL if the options 
+ * or the checkpoint are not usable, the reason is reported on stderr.
+ */
+struct combine *
+combine_new(const struct gengetopt_args_info *o, struct ckpt *ck)
+{
+    struct combine *c = calloc(1, sizeof (*c));
+    int maxng = 1 + 2 * get_maxng(o);
+
+    c->opt = o;
+    c->learn = 1;
+    c->mdl = mdlist_new();
+    c->mdl->opt = o;
+
+    if ((c->lex_b = new_ctxlex(ck)) == NULL
+        || (c->ps_u = new_phonstats(ck, "ps_u", maxng)) == NULL
+        || (c->ps_b = new_phonstats(ck, "ps_b", maxng)) == NULL
+        || (c->ps_l = new_phonstats(ck, "ps_l", maxng)) == NULL
+        || add_measures(c, ck, maxng) 
+        || mv_init(&c->mv, o)) {
+        combine_free(c);
+        return NULL;
     }
 
+    // account names for --mem-report
+    mem_acct_name(c->ps_u->mem, "ps_u");
+    mem_acct_name(c->ps_b->mem, "ps_b");
+    mem_acct_name(c->ps_l->mem, "ps_l");
 
-    mv_init();
+    c->ml = mlist_new(c->nvotes);
+    if (o->parse_threads_arg > 1) c->tp = tpool_new(o->parse_threads_arg);
 
-    if (opt.prior_data_given) {
-        phonstats_update_from_file(ps_u, opt.prior_data_arg);
-        phonstats_copy(ps_b, ps_u);
+    if (ck) {
+        if (weights_read(c, ck)) {
+            combine_free(c);
+            return NULL;
+        }
+    } else if (o->prior_data_given) {
+        phonstats_update_from_file(c->ps_u, o->prior_data_arg);
+        phonstats_copy(c->ps_b, c->ps_u);
     }
 
 /*
@@ -163,41 +391,127 @@ segment_combine_init(struct input *in)
     }
     printf("\n");
 */
+    return c;
+}
+
+/* 
+ * combine_learn() - whether combine_segment() learns from the 
+ *                   utterances it segments, it does by default
+ *
+ * when off, the statistics, the lexicons, the weights of the measures
+ * and the vote count are left as they are.
+ */
+void
+combine_learn(struct combine *c, int on)
+{
+    c->learn = on;
+}
+
+/* combine_stress() - whether `c' needs the stress of the utterances */
+int
+combine_stress(struct combine *c)
+{
+    return c->ss_u || c->ss_b || c->ss_l;
 }
 
+/* learn_utterance() - the statistics updated from the utterance before
+ *                     it is segmented
+ */
+static inline void
+learn_utterance(struct combine *c, char *u, char *stress)
+{
+    if (c->ss_u) {
+        phonstats_update_joint(c->ps_u, u, stress);
+    } else if (c->ps_u) {
+        phonstats_update(c->ps_u, u);
+    }
+    if (c->opt->psb_cheat_flag && c->ps_b) phonstats_update(c->ps_b, u);
+}
+
+/* 
+ * combine_observe() - learn from the utterance `u' segmented as 
+ *                     `segl', the way combine_segment() learns from 
+ *                     its own segmentation
+ */
+void
+combine_observe(struct combine *c, char *u, char *stress, 
+                struct seglist *segl)
+{
+    learn_utterance(c, u, stress);
+    combine_update(c, u, stress, segl);
+}
+
+/* combine_lexsize() - word types and tokens learned so far */
+void
+combine_lexsize(struct combine *c, size_t *ntypes, size_t *ntokens)
+{
+    struct ctxlex *lex_b = c->lex_b;
+    int i;
+
+    *ntypes = 0;
+    for (i = 0; i < lex_b->n; i++) {   // not the contexts `<' and `>'
+        if (lex_b->lex[i]->freq) ++*ntypes;
+    }
+    *ntokens = lex_b->wntok;
+}
+
+/* 
+ * combine_segment() - segment the utterance `u', with the stress 
+ *                     `stress' if combine_stress()
+ */
 struct seglist * 
-segment_combine(struct input *in, int idx)
+combine_segment(struct combine *c, char *u, char *stress)
 {
-    char *u = in->u[idx].s;
-    char *stress = (in->stress) ? in->stress[idx] : NULL;
+    struct mdlist *mdl = c->mdl;
+    int nvotes = c->nvotes;
     struct seglist *segl = seglist_new();
     int len = strlen(u);
     int j = 0;
     int i = 1;
     unsigned short seg[len + 1];
     double votes[len];
-    struct mlist *ml = mlist_new(nvotes);
+    double w[2 * nvotes];   // the weights to restore if not learning
+    int nv = c->mv.nvotes;
 
     seg[0] = 0;
     
-    if (ps_u) phonstats_update(ps_u, u);
-    if (ss_u) phonstats_update(ss_u, stress);
-    if (opt.psb_cheat_flag && ps_b) phonstats_update(ps_b, u);
+    if (c->learn) learn_utterance(c, u, stress);
+
+    if (c->seg_lex) {
+        struct tpool *tp = (len >= c->opt->parse_minlen_arg) ? c->tp : NULL;
 
-    ml->s = u;
-    ml->slen = len;
+        c->lex_chart = seg_parse_chart_tp(c->lex_chart, c->lex, u, 
+                                          seg_combine, tp);
+    }
+
+    mlist_reset(c->ml, u, len);
     for (j = 0; j < nvotes; j++) {
         if(mdl->md[j]->info->mid == M_SUB || mdl->md[j]->info->mid == M_SUE)
             mdl->md[j]->s = stress;
         else
             mdl->md[j]->s = u;
+        if (mdl->md[j]->L != NULL) 
+            mdl->md[j]->c = c->lex_chart;
 // printf("%s:%d:%d:\n", md[j].info->sname, md[j].len_l, md[j].len_r);
-        mlist_add(ml, mdl->md[j]);
+        mlist_add(c->ml, mdl->md[j]);
 //        printf("%s... ", md[j].info->sname);
 //        print_pred_list(u, ml->mlist[j]);
     }
 
-    mv_getvotes(votes, ml);
+    if (!c->learn) {
+        for (j = 0; j < nvotes; j++) {
+            w[2 * j] = mdl->md[j]->w_l;
+            w[2 * j + 1] = mdl->md[j]->w_r;
+        }
+    }
+    mv_getvotes(&c->mv, votes, c->ml);
+    if (!c->learn) {
+        for (j = 0; j < nvotes; j++) {
+            mdl->md[j]->w_l = w[2 * j];
+            mdl->md[j]->w_r = w[2 * j + 1];
+        }
+        c->mv.nvotes = nv;
+    }
 
     i = 1;
     for (j = 1; j < len; j++) {
@@ -210,54 +524,129 @@ segment_combine(struct input *in, int idx)
     }
 
     seglist_add(segl, seg);
-    mlist_free(ml, 0);
 
-    segment_combine_update(u, stress, segl);
+    if (c->learn) combine_update(c, u, stress, segl);
     return segl;
 }
 
 void 
-segment_combine_update(char *s, char *stress, struct seglist *segl)
+combine_update(struct combine *c, char *s, char *stress, struct seglist *segl)
 {
+    const struct gengetopt_args_info *o = c->opt;
     char **words = seg_to_strlist(s, segl->segs[0]);
     char **wstress = (stress) ? seg_to_strlist(stress, segl->segs[0]) : NULL;
+    struct prof_mark pm = prof_start(PROF_UPDATE);
     int i;
 
     for (i = 0; i <= segl->segs[0][0]; i++) {
-        if (ps_b) {
-            phonstats_update(ps_b, words[i]);
+        if (c->ss_b) {
+            phonstats_update_joint(c->ps_b, words[i], wstress[i]);
+        } else if (c->ps_b) {
+            phonstats_update(c->ps_b, words[i]);
         }
-        if (ss_b) phonstats_update(ss_b, wstress[i]);
-        struct lexdata *ld = ctxlex_add(lex_b, words[i], 
+        struct lexdata *ld = ctxlex_add(c->lex_b, words[i], 
                              (i == 0) ? "<" : words[i - 1],
                              (i == segl->segs[0][0]) ? ">" : words[i + 1]);
         if (ld->freq == 1) {
-            if (ps_l) phonstats_update(ps_l, words[i]);
-            if (ss_l) phonstats_update(ss_l, wstress[i]);
+            if (c->ss_l) {
+                phonstats_update_joint(c->ps_l, words[i], wstress[i]);
+            } else if (c->ps_l) {
+                phonstats_update(c->ps_l, words[i]);
+            }
         }
 
-        if (seg_lex) {
-            if (phonstats_freq_ng(ps_u, words[i]) > opt.lex_minfreq_arg 
-              &&cond_entropy(ps_u, words[i], 1) > opt.lex_minent_arg
-              &&cond_entropy_r(ps_u, words[i], 1) > opt.lex_minent_arg) {
-                cg_lexicon_add(lex, words[i], "x", NULL);
+        if (c->seg_lex) {
+            if (phonstats_freq_ng(c->ps_u, words[i]) > o->lex_minfreq_arg 
+              &&cond_entropy(c->ps_u, words[i], 1) > o->lex_minent_arg
+              &&cond_entropy_r(c->ps_u, words[i], 1) > o->lex_minent_arg) {
+                cg_lexicon_add(c->lex, words[i], "x", NULL);
             }
         }
     }
 
     free_strlist(words);
+    if (wstress) free_strlist(wstress);
+    prof_stop(&pm);
+}
+
+void 
+combine_free(struct combine *c)
+{
+    if (c == NULL) return;
+    if (c->ps_u) phonstats_free(c->ps_u);
+    if (c->ps_b) phonstats_free(c->ps_b);
+    if (c->ps_l) phonstats_free(c->ps_l);  // and the ss_* channels
+    if (c->lex) cg_lexicon_free(c->lex);
+    if (c->lex_b) ctxlex_free(c->lex_b);
+    if (c->lex_chart) chart_free(c->lex_chart);
+    if (c->ml) mlist_free(c->ml, 0);
+    if (c->tp) tpool_free(c->tp);
+    mdlist_free(c->mdl);
+    free(c);
+}
+
+/*
+ * segment_combine_*() - the model of seg(1), with the global options
+ */
+static struct combine *model = NULL;
+
+void 
+segment_combine_init(struct input *in)
+{
+    int i;
+
+    for (i = 0; i < opt.cues_given; i++) {
+        if (opt.cues_arg[i] == cues_arg_stress && !opt.stress_file_given) {
+            PFATAL("-c stress needs --stress-file\n");
+        }
+    }
+    if ((model = combine_new(&opt, ckpt_in)) == NULL) {
+        PFATAL("cannot set up -m combine\n");
+    }
+}
+
+struct seglist * 
+segment_combine(struct input *in, int idx)
+{
+    return combine_segment(model, in->u[idx].s, 
+                           (in->stress) ? in->stress[idx] : NULL);
+}
+
+void 
+segment_combine_update(char *s, char *stress, struct seglist *segl)
+{
+    combine_update(model, s, stress, segl);
+}
+
+void
+segment_combine_learn(int on)
+{
+    combine_learn(model, on);
+}
+
+void
+segment_combine_observe(char *u, char *stress, struct seglist *segl)
+{
+    combine_observe(model, u, stress, segl);
+}
+
+void
+segment_combine_lexsize(size_t *ntypes, size_t *ntokens)
+{
+    combine_lexsize(model, ntypes, ntokens);
+}
+
+void
+segment_combine_checkpoint(struct ckpt *ck)
+{
+    combine_checkpoint(model, ck);
 }
 
 void 
 segment_combine_cleanup()
 {
-    if (ps_u) phonstats_free(ps_u);
-    if (ps_b) phonstats_free(ps_b);
-    if (ps_l) phonstats_free(ps_l);
-    if (ss_u) phonstats_free(ss_u);
-    if (ss_b) phonstats_free(ss_b);
-    if (ss_l) phonstats_free(ss_l);
-    if (lex) cg_lexicon_free(lex);
-    if (lex_b) ctxlex_free(lex_b);
-    mdlist_free(mdl);
+    if (model == NULL) return;
+    if (model->lex && opt.outlex_given) outlex_write(model->lex);
+    combine_free(model);
+    model = NULL;
 }
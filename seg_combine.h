@@ -25,10 +25,32 @@
 #include "io.h"
 #include "lexicon.h"
 
+#include "cmdline.h"
+
+struct combine;
+struct ckpt;
+
+struct combine *combine_new(const struct gengetopt_args_info *o, 
+                            struct ckpt *ck);
+void combine_free(struct combine *c);
+struct seglist *combine_segment(struct combine *c, char *u, char *stress);
+void combine_update(struct combine *c, char *s, char *stress, 
+                    struct seglist *segl);
+void combine_observe(struct combine *c, char *u, char *stress, 
+                     struct seglist *segl);
+void combine_learn(struct combine *c, int on);
+int combine_stress(struct combine *c);
+void combine_lexsize(struct combine *c, size_t *ntypes, size_t *ntokens);
+void combine_checkpoint(struct combine *c, struct ckpt *ck);
+
 void segment_combine_init(struct input *in);
 struct seglist *segment_combine(struct input *in, int i);
 void segment_combine_update(char *s, char *stress, struct seglist *segl);
 void segment_combine_cleanup();
+void segment_combine_learn(int on);
+void segment_combine_observe(char *u, char *stress, struct seglist *segl);
+void segment_combine_lexsize(size_t *ntypes, size_t *ntokens);
+void segment_combine_checkpoint(struct ckpt *ck);
 
 
 
@@ -0,0 +1,603 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Bayesian segmentation with Gibbs sampling (Goldwater, Griffiths &
+ * Johnson, 2009).
+ *
+ * The sampler keeps a boundary variable for each position between
+ * two phonemes, and resamples them one at a time given all others.
+ *
+ * Unigram model: words are drawn from a DP with concentration alpha0
+ * and base distribution P0(w) = pb (1 - pb)^(|w| - 1) / |S|^|w|,
+ * where |S| is the number of phonemes. Each word ends the utterance
+ * with a probability that has a Beta(rho/2, rho/2) prior.
+ *
+ * Bigram model: each word is drawn from a DP with concentration 
+ * alpha1 that depends on the previous word. All of these DPs share 
+ * the unigram DP above as their base distribution. The utterance 
+ * boundary is treated as a special word `$' that has probability pb 
+ * under the base distribution; the other words get (1 - pb) P0(w).
+ * The table counts of the shared DP are approximated with the 
+ * number of distinct contexts of a word (the `minimal path' 
+ * assumption).
+ *
+ * Every substring of the input is given an integer ID before 
+ * sampling. The IDs are node indices in a trie of all substrings; 
+ * the root (ID 0) stands for `$'. Each utterance keeps the IDs of all
+ * of its spans, so a resampling step needs only array lookups and 
+ * O(1) count updates.
+ *
+ * With --gibbs-threads=N the utterances are split into N blocks that
+ * are sampled in parallel. Each block works on its own copy of the
+ * counts, and the counts are recalculated from the segmentations 
+ * after every iteration. The result depends on N, but not on thread
+ * scheduling.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <assert.h>
+#include <time.h>
+#include "cmdline.h"
+#include "io.h"
+#include "seg.h"
+#include "seglist.h"
+#include "seg_gibbs.h"
+#include "wtrie.h"
+#include "tpool.h"
+#include "cclib_debug.h"
+
+struct gibbs_utt {
+    int             len;    // number of phonemes
+    int             *span;  // IDs of all spans, see SPAN()
+    unsigned char   *b;     // b[i] = 1 if there is a boundary after i
+};
+
+// ID of the word u[s..e-1]
+#define SPAN(gu, s, e) \
+    ((gu)->span[(s) * (gu)->len - (s) * ((s) - 1) / 2 + (e) - (s) - 1])
+
+/*
+ * counts of bigrams <prev,w>, kept in an open addressing hash table
+ * keyed by (prev << 32 | w). entries are never removed, a bigram
+ * that is not used any more has count 0.
+ */
+struct pair_counts {
+    size_t      size;       // power of 2
+    size_t      n;
+    uint64_t    *key;
+    int         *count;
+};
+
+#define PAIR_EMPTY  UINT64_MAX
+#define PAIR_KEY(prev, w) (((uint64_t) (prev) << 32) | (uint32_t) (w))
+
+struct gibbs_counts {
+    int                 *nw;    // unigram: tokens, bigram: tables
+    long                n;      // total of nw
+    long                nfinal; // utterance final tokens (unigram)
+    int                 *nctx;  // tokens following a word (bigram)
+    struct pair_counts  pc;     // bigram tokens
+};
+
+struct gibbs_block {
+    int                 first, last;    // utterances [first, last)
+    unsigned int        seed;
+    struct gibbs_counts *c;
+};
+
+static struct gibbs_utt *utt;
+static size_t nutt;
+static int nwords;              // number of IDs, including `$'
+static double *lp0;             // log base distribution for each ID
+static struct gibbs_counts *counts;
+static struct gibbs_block *blocks;
+static int nblocks;
+static double temp;             // current temperature
+
+static int bigram;
+static double alpha0, alpha1, rho;
+static double lalpha0, lalpha1;
+
+static void
+pair_init(struct pair_counts *pc, size_t size)
+{
+    size_t i;
+
+    pc->size = size;
+    pc->n = 0;
+    pc->key = malloc(size * sizeof (*pc->key));
+    pc->count = malloc(size * sizeof (*pc->count));
+    for (i = 0; i < size; i++) {
+        pc->key[i] = PAIR_EMPTY;
+    }
+}
+
+static inline size_t
+pair_slot(struct pair_counts *pc, uint64_t key)
+{
+    size_t i = (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (pc->size - 1);
+
+    while (pc->key[i] != key && pc->key[i] != PAIR_EMPTY) {
+        i = (i + 1) & (pc->size - 1);
+    }
+    return i;
+}
+
+static int *
+pair_count(struct pair_counts *pc, int prev, int w)
+{
+    uint64_t key = PAIR_KEY(prev, w);
+    size_t i = pair_slot(pc, key);
+
+    if (pc->key[i] == PAIR_EMPTY) {
+        if (2 * (pc->n + 1) > pc->size) {
+            struct pair_counts old = *pc;
+            size_t j;
+            pair_init(pc, 2 * old.size);
+            for (j = 0; j < old.size; j++) {
+                if (old.key[j] != PAIR_EMPTY) {
+                    size_t k = pair_slot(pc, old.key[j]);
+                    pc->key[k] = old.key[j];
+                    pc->count[k] = old.count[j];
+                    pc->n++;
+                }
+            }
+            free(old.key);
+            free(old.count);
+            i = pair_slot(pc, key);
+        }
+        pc->key[i] = key;
+        pc->count[i] = 0;
+        pc->n++;
+    }
+    return &pc->count[i];
+}
+
+static inline int
+pair_get(struct pair_counts *pc, int prev, int w)
+{
+    size_t i = pair_slot(pc, PAIR_KEY(prev, w));
+
+    return (pc->key[i] == PAIR_EMPTY) ? 0 : pc->count[i];
+}
+
+static struct gibbs_counts *
+counts_new()
+{
+    struct gibbs_counts *c = malloc(sizeof (*c));
+
+    c->nw = calloc(nwords, sizeof (*c->nw));
+    c->n = c->nfinal = 0;
+    c->nctx = NULL;
+    c->pc.key = NULL;
+    c->pc.count = NULL;
+    if (bigram) {
+        c->nctx = calloc(nwords, sizeof (*c->nctx));
+        pair_init(&c->pc, 1024);
+    }
+    return c;
+}
+
+static void
+counts_copy(struct gibbs_counts *dst, struct gibbs_counts *src)
+{
+    memcpy(dst->nw, src->nw, nwords * sizeof (*dst->nw));
+    dst->n = src->n;
+    dst->nfinal = src->nfinal;
+    if (bigram) {
+        memcpy(dst->nctx, src->nctx, nwords * sizeof (*dst->nctx));
+        if (dst->pc.size != src->pc.size) {
+            free(dst->pc.key);
+            free(dst->pc.count);
+            pair_init(&dst->pc, src->pc.size);
+        }
+        memcpy(dst->pc.key, src->pc.key, 
+               src->pc.size * sizeof (*dst->pc.key));
+        memcpy(dst->pc.count, src->pc.count, 
+               src->pc.size * sizeof (*dst->pc.count));
+        dst->pc.n = src->pc.n;
+    }
+}
+
+static void
+counts_clear(struct gibbs_counts *c)
+{
+    size_t i;
+
+    memset(c->nw, 0, nwords * sizeof (*c->nw));
+    c->n = c->nfinal = 0;
+    if (bigram) {
+        memset(c->nctx, 0, nwords * sizeof (*c->nctx));
+        for (i = 0; i < c->pc.size; i++) {
+            c->pc.key[i] = PAIR_EMPTY;
+        }
+        c->pc.n = 0;
+    }
+}
+
+static void
+counts_free(struct gibbs_counts *c)
+{
+    free(c->nw);
+    free(c->nctx);
+    free(c->pc.key);
+    free(c->pc.count);
+    free(c);
+}
+
+/*
+ * count updates and predictive probabilities
+ *
+ * in the unigram model `prev' is ignored, and `final' tells whether
+ * the word ends the utterance. in the bigram model `w' may be `$' (0).
+ */
+static inline void
+counts_add(struct gibbs_counts *c, int prev, int w, int final)
+{
+    if (bigram) {
+        int *n = pair_count(&c->pc, prev, w);
+        if ((*n)++ == 0) {
+            c->nw[w]++;
+            c->n++;
+        }
+        c->nctx[prev]++;
+    } else {
+        c->nw[w]++;
+        c->n++;
+        c->nfinal += final;
+    }
+}
+
+static inline void
+counts_remove(struct gibbs_counts *c, int prev, int w, int final)
+{
+    if (bigram) {
+        int *n = pair_count(&c->pc, prev, w);
+        assert(*n > 0);
+        if (--(*n) == 0) {
+            c->nw[w]--;
+            c->n--;
+        }
+        c->nctx[prev]--;
+    } else {
+        c->nw[w]--;
+        c->n--;
+        c->nfinal -= final;
+    }
+}
+
+static inline double
+counts_logp(struct gibbs_counts *c, int prev, int w, int final)
+{
+    double lp;
+
+    // the base probabilities of long words underflow, 
+    // so they are only exponentiated when added to a count
+    if (c->nw[w]) {
+        lp = log(c->nw[w] + alpha0 * exp(lp0[w])) - log(c->n + alpha0);
+    } else {
+        lp = lalpha0 + lp0[w] - log(c->n + alpha0);
+    }
+
+    if (bigram) {
+        int n = pair_get(&c->pc, prev, w);
+        if (n) {
+            lp = log(n + alpha1 * exp(lp));
+        } else {
+            lp = lalpha1 + lp;
+        }
+        return lp - log(c->nctx[prev] + alpha1);
+    } else {
+        long nu = (final) ? c->nfinal : c->n - c->nfinal;
+        return lp + log(nu + rho / 2) - log(c->n + rho);
+    }
+}
+
+static void
+counts_add_utt(struct gibbs_counts *c, struct gibbs_utt *gu)
+{
+    int s = 0, e, prev = 0;
+
+    for (e = 1; e <= gu->len; e++) {
+        if (e == gu->len || gu->b[e - 1]) {
+            int w = SPAN(gu, s, e);
+            counts_add(c, prev, w, e == gu->len);
+            prev = w;
+            s = e;
+        }
+    }
+    if (bigram) {
+        counts_add(c, prev, 0, 1);
+    }
+}
+
+static inline double
+rand01(unsigned int *seed)
+{
+    return (double) rand_r(seed) / ((double) RAND_MAX + 1);
+}
+
+/*
+ * resample the boundary after the phoneme i of the utterance
+ */
+static void
+sample_boundary(struct gibbs_counts *c, struct gibbs_utt *gu, int i, 
+                unsigned int *seed)
+{
+    int s, e, m = i + 1;    // w1 = [s, e), w2 = [s, m), w3 = [m, e)
+    int w1, w2, w3, wl = 0, wr = 0;
+    int final;
+    double lp1, lp2, p2;
+
+    for (s = i; s > 0 && !gu->b[s - 1]; s--);
+    for (e = m + 1; e < gu->len && !gu->b[e - 1]; e++);
+    w1 = SPAN(gu, s, e);
+    w2 = SPAN(gu, s, m);
+    w3 = SPAN(gu, m, e);
+    final = (e == gu->len);
+
+    if (bigram) {
+        int k;
+        if (s > 0) {
+            for (k = s - 1; k > 0 && !gu->b[k - 1]; k--);
+            wl = SPAN(gu, k, s);
+        }
+        if (e < gu->len) {
+            for (k = e + 1; k < gu->len && !gu->b[k - 1]; k++);
+            wr = SPAN(gu, e, k);
+        }
+    }
+
+    if (gu->b[i]) {
+        counts_remove(c, wl, w2, 0);
+        counts_remove(c, w2, w3, final);
+    } else {
+        counts_remove(c, wl, w1, final);
+    }
+    if (bigram) {
+        counts_remove(c, (gu->b[i]) ? w3 : w1, wr, 1);
+    }
+
+    lp1 = counts_logp(c, wl, w1, final);
+    if (bigram) {
+        counts_add(c, wl, w1, final);
+        lp1 += counts_logp(c, w1, wr, 1);
+        counts_remove(c, wl, w1, final);
+    }
+
+    lp2 = counts_logp(c, wl, w2, 0);
+    counts_add(c, wl, w2, 0);
+    lp2 += counts_logp(c, w2, w3, final);
+    if (bigram) {
+        counts_add(c, w2, w3, final);
+        lp2 += counts_logp(c, w3, wr, 1);
+        counts_remove(c, w2, w3, final);
+    }
+    counts_remove(c, wl, w2, 0);
+
+    p2 = 1.0 / (1.0 + exp((lp1 - lp2) / temp));
+    gu->b[i] = (rand01(seed) < p2);
+
+    if (gu->b[i]) {
+        counts_add(c, wl, w2, 0);
+        counts_add(c, w2, w3, final);
+    } else {
+        counts_add(c, wl, w1, final);
+    }
+    if (bigram) {
+        counts_add(c, (gu->b[i]) ? w3 : w1, wr, 1);
+    }
+}
+
+static void
+sample_block(void *arg, int item, int tid)
+{
+    struct gibbs_block *blk = &blocks[item];
+    int j, i;
+
+    for (j = blk->first; j < blk->last; j++) {
+        struct gibbs_utt *gu = &utt[j];
+        for (i = 0; i < gu->len - 1; i++) {
+            sample_boundary(blk->c, gu, i, &blk->seed);
+        }
+    }
+}
+
+/*
+ * assign IDs to all substrings of the input, and calculate the base
+ * distribution for each of them.
+ */
+static void
+gibbs_index(struct input *in, double pb)
+{
+    struct wtrie *t = wtrie_new();
+    int *depth;
+    int nphon = 0, ndepth;
+    int seen[256] = {0};
+    size_t j;
+    int i;
+
+    for (j = 0; j < nutt; j++) {
+        struct gibbs_utt *gu = &utt[j];
+        char *u = in->u[j].s;
+        int s, e;
+
+        gu->len = strlen(u);
+        gu->span = malloc(((size_t) gu->len * (gu->len + 1) / 2 + 1)
+                          * sizeof (*gu->span));
+        gu->b = calloc(gu->len + 1, 1);
+        for (s = 0; s < gu->len; s++) {
+            int node = 0;
+            if (!seen[(unsigned char) u[s]]) {
+                seen[(unsigned char) u[s]] = 1;
+                nphon++;
+            }
+            for (e = s + 1; e <= gu->len; e++) {
+                node = wtrie_add_child(t, node, u[e - 1]);
+                SPAN(gu, s, e) = node;
+            }
+        }
+    }
+
+    // word lengths are the node depths, parents come before children
+    nwords = t->n;
+    ndepth = nwords;
+    depth = calloc(ndepth, sizeof (*depth));
+    for (i = 0; i < nwords; i++) {
+        int c;
+        for (c = t->node[i].child; c != 0; c = t->node[c].sibling) {
+            depth[c] = depth[i] + 1;
+        }
+    }
+
+    lp0 = malloc(nwords * sizeof (*lp0));
+    for (i = 1; i < nwords; i++) {
+        lp0[i] = log(pb) + (depth[i] - 1) * log(1 - pb) 
+                 - depth[i] * log(nphon);
+        if (bigram) lp0[i] += log(1 - pb);
+    }
+    lp0[0] = (bigram) ? log(pb) : -HUGE_VAL;
+
+    free(depth);
+    wtrie_free(t);
+}
+
+void 
+segment_gibbs_init(struct input *in)
+{
+    struct tpool *tp = NULL;
+    int it, b;
+    size_t j;
+    unsigned int seed = opt.gibbs_seed_arg;
+    clock_t t0 = clock();
+
+    bigram = (opt.gibbs_model_arg == gibbs_model_arg_bigram);
+    alpha0 = opt.gibbs_alpha0_arg;
+    alpha1 = opt.gibbs_alpha1_arg;
+    rho = opt.gibbs_rho_arg;
+    lalpha0 = log(alpha0);
+    lalpha1 = log(alpha1);
+
+    nutt = in->size;
+    utt = malloc(nutt * sizeof (*utt));
+    gibbs_index(in, opt.gibbs_pb_arg);
+    PINFO("gibbs: %zu utterances, %d distinct substrings\n", nutt, nwords);
+
+    // random initial segmentation
+    counts = counts_new();
+    for (j = 0; j < nutt; j++) {
+        int i;
+        for (i = 0; i < utt[j].len - 1; i++) {
+            utt[j].b[i] = (rand01(&seed) < 0.5);
+        }
+        counts_add_utt(counts, &utt[j]);
+    }
+
+    nblocks = (opt.gibbs_threads_arg > 1) ? opt.gibbs_threads_arg : 1;
+    if (nblocks > nutt) nblocks = (nutt) ? nutt : 1;
+    blocks = malloc(nblocks * sizeof (*blocks));
+    for (b = 0; b < nblocks; b++) {
+        blocks[b].first = nutt * b / nblocks;
+        blocks[b].last = nutt * (b + 1) / nblocks;
+        blocks[b].seed = opt.gibbs_seed_arg + b + 1;
+        blocks[b].c = (nblocks > 1) ? counts_new() : counts;
+    }
+    if (nblocks > 1) {
+        tp = tpool_new(nblocks);
+    }
+
+    for (it = 0; it < opt.gibbs_iter_arg; it++) {
+        temp = 1.0;
+        if (it < opt.gibbs_anneal_arg) {  // 10 equal steps down to 1
+            int step = 10 * it / opt.gibbs_anneal_arg;
+            temp = opt.gibbs_temp_arg - 
+                   (opt.gibbs_temp_arg - 1.0) * step / 10.0;
+        }
+
+        if (nblocks == 1) {
+            sample_block(NULL, 0, 0);
+        } else {
+            for (b = 0; b < nblocks; b++) {
+                counts_copy(blocks[b].c, counts);
+            }
+            tpool_run(tp, nblocks, sample_block, NULL);
+            counts_clear(counts);
+            for (j = 0; j < nutt; j++) {
+                counts_add_utt(counts, &utt[j]);
+            }
+        }
+        if (opt.progress_given && (it % opt.progress_arg) == 0) {
+            fprintf(stderr,"%*d/%d\r", 6, it, opt.gibbs_iter_arg);
+        }
+    }
+
+    if (tp) {
+        tpool_free(tp);
+        for (b = 0; b < nblocks; b++) {
+            counts_free(blocks[b].c);
+        }
+    }
+    PINFO("gibbs: %d iterations in %.2f s\n", opt.gibbs_iter_arg,
+          (double) (clock() - t0) / CLOCKS_PER_SEC);
+}
+
+struct seglist * 
+segment_gibbs(struct input *in, int idx)
+{
+    struct gibbs_utt *gu = &utt[idx];
+    struct seglist *segl = seglist_new();
+    unsigned short seg[gu->len + 1];
+    int i;
+
+    seg[0] = 0;
+    for (i = 0; i < gu->len - 1; i++) {
+        if (gu->b[i]) {
+            seg[++seg[0]] = i + 1;
+        }
+    }
+    if (seg[0]) {
+        seglist_add(segl, seg);
+    } else {
+        segl->nsegs = 1;
+        segl->segs = malloc(sizeof *segl->segs);
+        segl->segs[0] = NULL;
+    }
+    return segl;
+}
+
+void 
+segment_gibbs_cleanup()
+{
+    size_t j;
+
+    for (j = 0; j < nutt; j++) {
+        free(utt[j].span);
+        free(utt[j].b);
+    }
+    free(utt);
+    free(lp0);
+    free(blocks);
+    counts_free(counts);
+}
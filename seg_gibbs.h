@@ -18,15 +18,12 @@
     <http://www.gnu.org/licenses/>.
 */
 
-#ifndef _STRESS_H
-#define _STRESS_H 1
-#include "options.h"
-#include "phonstats.h"
+#ifndef _SEG_GIBBS_H
+#define _SEG_GIBBS_H 1
+#include "seg.h"
 
-int stress_init(struct mdlist *mdl, struct phonstats *ps, enum m_id ub_id, enum m_id ue_id);
-double calc_stress_single(struct phonstats *ps, struct mdata *m, int pos);
-double * calc_stress_list(struct phonstats *ps, struct mdata *m);
-
-
-#endif // _STRESS_H
+void segment_gibbs_init(struct input *in);
+struct seglist *segment_gibbs(struct input *in, int i);
+void segment_gibbs_cleanup();
 
+#endif // _SEG_GIBBS_H
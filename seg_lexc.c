@@ -23,20 +23,26 @@
 #include <stdlib.h>
 #include "seglist.h"
 #include "lexc.h"
+#include "ctxlex.h"
 #include "mvote.h"
 #include "mlist.h"
 #include "io.h"
 #include "pred.h"
 #include "mdata.h"
 #include "seg_lexc.h"
+#include "profile.h"
+#include "cclib_debug.h"
 
 
 static struct phonstats *ps = NULL;     // statistics over the corpus
 static struct phonstats *lps = NULL;    // statistics over the lexicon
 static cg_lexicon *L;
+static struct ctxlex *cL;               // the words of L in context
 
 static struct mdata *md = NULL;
 static int nvotes = 0;
+static struct mlist *ml = NULL;  // measures and votes, reused
+static struct mv_state mv;
 
 static short seg_pred = 0;  // Just for conveniently checking if
 static short seg_ub = 0;    // particular measure is in use 
@@ -169,6 +175,7 @@ segment_lexc_init(struct input *in)
                     md[i].len_r = ri;
                 }
                 md[i].w_l = md[i].w_r = 1;
+                pred_resolve(&md[i]);
                 ++i;
             }
         }
@@ -183,10 +190,12 @@ segment_lexc_init(struct input *in)
     seg_lex = 1;
 
     if(opt.inlex_given){
-        L = cg_lexicon_load(opt.inlex_arg);
+        L = inlex_read(opt.inlex_arg);
+        if (L == NULL) PFATAL("cannot load the lexicon\n");
     } else {
         L = cg_lexicon_new();
     }
+    cL = ctxlex_new();
 
     lps = phonstats_new_st(opt.lex_nglen_arg, NULL);
     if (opt.prior_data_given && opt.lex_useprior_flag) {
@@ -205,6 +214,8 @@ segment_lexc_init(struct input *in)
         md[i].len_r = -1;
         md[i].w_l = md[i].w_r = 1;
         md[i].L = L;
+        md[i].cL = cL;
+        md[i].opt = &opt;
         md[i].c = NULL;
         ++i;
         md[i].info = &m_info[M_LFE];
@@ -213,6 +224,8 @@ segment_lexc_init(struct input *in)
         md[i].len_r = -1;
         md[i].w_l = md[i].w_r = 1;
         md[i].L = L;
+        md[i].cL = cL;
+        md[i].opt = &opt;
         md[i].c = NULL;
         ++i;
     }
@@ -223,7 +236,8 @@ segment_lexc_init(struct input *in)
     maxng = 1 + 2 * maxng;
     ps = phonstats_new_st(maxng, NULL);
 
-    mv_init();
+    if (mv_init(&mv, &opt)) exit(-1);
+    ml = mlist_new(nvotes);
 
     if (opt.prior_data_given) {
         phonstats_update_from_file(ps, opt.prior_data_arg);
@@ -244,18 +258,16 @@ seg_nonlex (char *u)
     int i = 1;
     unsigned short *seg = malloc ((len + 1) * sizeof (*seg));
     double votes[len];
-    struct mlist *ml = mlist_new(nvotes);
 
     seg[0] = 0;
     
-    ml->s = u;
-    ml->slen = len;
+    mlist_reset(ml, u, len);
     for (j = 0; j < nvotes; j++) {
         md[j].s = u;
         mlist_add_old(ml, &md[j], ps);
     }
 
-    mv_getvotes(votes, ml);
+    mv_getvotes(&mv, votes, ml);
 
     i = 1;
     for (j = 1; j < len; j++) {
@@ -267,8 +279,6 @@ seg_nonlex (char *u)
         }
     }
 
-    mlist_free(ml, 0);
-
     return seg;
 
 }
@@ -358,33 +368,44 @@ ent_score(char *ng) {
 void 
 segment_lexc_update(char *s, struct seglist *segl)
 {
+    struct prof_mark pm = prof_start(PROF_UPDATE);
     char **words = seg_to_strlist(s, segl->segs[0]);
     int i;
 
 //printf("%s\n", s);
     for (i = 0; i <= segl->segs[0][0]; i++) {
+        int add = 0;
 //        printf("\t%s: ", words[i]);
         if (cg_lexicon_lookup(L, words[i]) ) {
 //            printf("lex\n");
             cg_lexicon_add(L, words[i], "x", NULL);
+            add = 1;
         } else {
 //            printf("nonlex f:%f, e:%f ", freq_score(words[i]), ent_score(words[i]));
             if (freq_score(words[i]) > opt.lex_minfreq_arg 
                 && ent_score(words[i]) > opt.lex_minent_arg){
                 cg_lexicon_add(L, words[i], "x", NULL);
                 phonstats_update(lps, words[i]);
+                add = 1;
 //                printf("ok\n");
             } 
 //            else  printf("nok\n");
         }
+        if (add) {
+            ctxlex_add(cL, words[i], (i == 0) ? "<" : words[i - 1],
+                       (i == segl->segs[0][0]) ? ">" : words[i + 1]);
+        }
 //        printf("\n");
     }
     free_strlist(words);
+    prof_stop(&pm);
 }
 
 void 
 segment_lexc_cleanup()
 {
-    cg_lexicon_write(stdout, L);
+    outlex_write(L);
+    if (cL) ctxlex_free(cL);
+    if (ml) mlist_free(ml, 0);
     return;
 }
@@ -33,6 +33,7 @@
 #include "seg.h"
 #include "lexc.h"
 #include "mdata.h"
+#include "cclib_debug.h"
 
 static cg_lexicon *L;
 
@@ -42,7 +43,8 @@ segment_lexicon_init(struct input *in)
 
     assert(opt.inlex_given);
 
-    L = cg_lexicon_load(opt.inlex_arg);
+    L = inlex_read(opt.inlex_arg);
+    if (L == NULL) PFATAL("cannot load the lexicon\n");
 
     if (opt.score_arg == score_arg_best) {
         int i, j;
@@ -58,7 +60,6 @@ segment_lexicon_init(struct input *in)
             }
         }
     }
-printf ("!!! %d\n", opt.lexicon_partial_given);
 }
 
 struct seglist *
@@ -69,6 +70,12 @@ lexicon_segment(struct cg_lexicon *l, char *u)
 
     c = seg_parse(l, u, seg_combine);
 
+    if (opt.score_arg == score_arg_best) {
+        segl = lexc_segl_best(c, l, u, lexc_partial_opt());
+        chart_free(c);
+        return segl;
+    }
+
     switch (opt.lexicon_partial_arg) {
         case lexicon_partial_arg_all:
             segl = get_segs_partial_opt(c, SPOPT_ALL);
@@ -95,10 +102,6 @@ lexicon_segment(struct cg_lexicon *l, char *u)
 
     chart_free(c);
 
-    if (opt.score_arg == score_arg_best) {
-        lexc_segl_score(segl, l, NULL, NULL, u);
-    }
-
     return segl;
 }
 
@@ -40,6 +40,7 @@
 #include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <time.h>
 #include "cmdline.h"
 #include "lexicon.h"
 #include "strutils.h"
@@ -47,31 +48,24 @@
 #include "phonstats.h"
 #include "seg.h"
 #include "seg_lm.h"
+#include "wtrie.h"
+#include "cclib_debug.h"
+#include "profile.h"
 
 static cg_lexicon *L;
 static struct phonstats *ps;
 
-static double 
-wordscore(char *u, int firstch, int lastch, double alpha)
-{
-    char    *w = str_span(u, firstch, lastch-firstch+1);
-    double  score;
-
-    score = cg_lexicon_get_rfreq_pf(L, w);
-
-    if (score != 0.0) { // existing word
-        score = log(alpha) + log(score);
-    } else {            // new word
-        char *tmp = w;
-        score = log(1 - alpha);
-        while (*tmp) {
-            score += log(phonstats_rfreq_p(ps, *tmp));
-            tmp++;
-        }
-    }
-    free(w);
-    return score;
-}
+/*
+ * The words in the lexicon are also kept in a trie, so that all 
+ * lexicon entries starting at a given position of the utterance are
+ * found with a single walk. The data of each word node is its 
+ * lexicon entry, the counts are always read from the lexicon.
+ */
+static struct wtrie *trie;
+
+/* timing for the throughput reported at cleanup */
+static size_t lm_nutt;
+static double lm_time;
 
 void 
 segment_lm_init(struct input *in)
@@ -79,8 +73,28 @@ segment_lm_init(struct input *in)
     // TODO: input lexicon?
     L = cg_lexicon_new();
     ps = phonstats_new(1, "IE&AaOU6ie9Quo73R#%*()pbmtdnkgNfvTDszSZhcGlrL~MywW");
+    trie = wtrie_new();
+    lm_nutt = 0;
+    lm_time = 0.0;
 }
 
+/*
+ * The score of a word u[firstch..lastch] is
+ *
+ *      log(alpha) + log(rfreq(word))               if the word is known, 
+ *      log(1 - alpha) + sum log(rfreq_p(phoneme))  otherwise.
+ *
+ * For each start position, the words are extended one phoneme at a
+ * time, following the lexicon trie and summing the phoneme 
+ * log-probabilities (calculated once per utterance) as we go. 
+ * The search itself does not allocate or hash.
+ *
+ * The best segmentation is found with Brent's (1999) search 
+ * algorithm. Words are visited by start position, but the candidates
+ * for each end position are compared in the same order as the
+ * original loops over the end position. Words longer than 
+ * --lm-maxwlen are not considered if it is set.
+ */
 struct seglist * 
 segment_lm(struct input *in, int idx)
 {
@@ -88,25 +102,49 @@ segment_lm(struct input *in, int idx)
     struct seglist *segl;
     int j, firstch, lastch, nsegs;
     int  len = strlen(u) - 1;
-    double  bestsc[len];
-    int  bestst[len];
-    unsigned short    seg[len];
+    double  bestsc[len + 1];
+    int  bestst[len + 1];
+    double  logp[len + 1];
+    unsigned short    seg[len + 1];
     float alpha = opt.alpha_arg;
+    double logalpha = log(alpha), 
+           lognew = log(1 - alpha);
+    int maxwlen = (opt.lm_maxwlen_arg > 0) ? opt.lm_maxwlen_arg : len + 1;
+    clock_t t0 = clock();
 
-    for (j = 0; j < len; j++) {
-        bestsc[j] = 0.0;
+    for (j = 0; j <= len; j++) {
+        bestsc[j] = -HUGE_VAL;
         bestst[j] = 0;
+        logp[j] = log(phonstats_rfreq_id(ps, in->u[idx].id[j]));
     }
 
-    // these loops are almost verbatim copies from Brent's (1999) 
-    // search algorithm.
     // first: calculate best word ending in each possible end point.
-    for (lastch = 0; lastch <= len; lastch++){
-        bestsc[lastch] = wordscore(u, 0, lastch, alpha);
-        bestst[lastch] = 0;
-        for (firstch = 1; firstch <= lastch; firstch++) {
-            double wordsc = wordscore(u, firstch, lastch, alpha);
-            if (wordsc + bestsc[firstch - 1] > bestsc[lastch]) {
+    for (firstch = 0; firstch <= len; firstch++) {
+        int node = 0;
+        double newsc = lognew;
+        int maxch = firstch + maxwlen - 1;
+
+        if (maxch > len) maxch = len;
+        for (lastch = firstch; lastch <= maxch; lastch++) {
+            double wordsc;
+
+            newsc += logp[lastch];
+            if (node >= 0) {
+                node = wtrie_child(trie, node, u[lastch]);
+                if (node == 0) node = -1;
+            }
+            if (node > 0 && trie->node[node].data != NULL) {
+                struct cg_listhead *lh = trie->node[node].data;
+                wordsc = logalpha + 
+                         log((double) lh->n_tok / (double) L->stats->n_tok);
+            } else {
+                wordsc = newsc;
+            }
+
+            if (firstch == 0) {
+                bestsc[lastch] = wordsc;
+                bestst[lastch] = 0;
+            } else if (wordsc + bestsc[firstch - 1] > bestsc[lastch]) {
                 bestsc[lastch] = wordsc + bestsc[firstch - 1] ;
                 bestst[lastch] = firstch;
             }
@@ -132,16 +170,10 @@ segment_lm(struct input *in, int idx)
         firstch = bestst[lastch];
         while (nsegs) {
             seg[nsegs] = firstch;
-//            printf("%.*s=%f ", 
-//                    lastch - firstch + 1, u + firstch, 
-//                    wordscore(u, firstch, lastch, alpha));
             lastch = firstch - 1;
             firstch = bestst[lastch];
             nsegs--;
         }
-//        printf("%.*s=%f\n", 
-//                lastch - firstch + 1, u + firstch, 
-//                wordscore(u, firstch, lastch, alpha));
         seglist_add(segl, seg);
 //printf("DDD: %s ", u);
 //print_intarray(seg);
@@ -149,17 +181,19 @@ segment_lm(struct input *in, int idx)
         segl->nsegs = 1;
         segl->segs = malloc(sizeof *segl->segs);
         segl->segs[0] = NULL;
-//printf        printf("%s=%f\n", u, wordscore(u, 0, len, alpha));
     }
 
     segment_lm_update(u, segl);
 
+    lm_time += (double) (clock() - t0) / CLOCKS_PER_SEC;
+    lm_nutt++;
     return segl;
 }
 
 void 
 segment_lm_update(char *s, struct seglist *segl)
 {
+    struct prof_mark pm = prof_start(PROF_UPDATE);
     char **segstr;
     char **seg;
     assert(segl->nsegs == 1);
@@ -167,15 +201,27 @@ segment_lm_update(char *s, struct seglist *segl)
     segstr = seg_to_strlist(s, segl->segs[0]);
     seg = segstr;
     while (*seg) {
+        int isnew = (cg_lexicon_lookup(L, *seg) == NULL);
         cg_lexicon_add(L, *seg, "C", NULL);
+        if (isnew) {
+            int node = wtrie_add(trie, *seg);
+            trie->node[node].data = cg_lexicon_lookup_h(L, *seg);
+        }
         phonstats_update(ps, *seg);
         ++seg;
     }
     free_strlist(segstr);
+    prof_stop(&pm);
 }
 
 void 
 segment_lm_cleanup()
 {
-    return;
+    if (lm_time > 0.0) {
+        PINFO("lm: %zu utterances in %.2f s, %.0f utterances/s\n", 
+              lm_nutt, lm_time, lm_nutt / lm_time);
+    }
+    if (opt.outlex_given) outlex_write(L);
+    wtrie_free(trie);
+    trie = NULL;
 }
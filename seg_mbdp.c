@@ -0,0 +1,246 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Incremental MBDP-1 segmentation (Brent, 1999).
+ *
+ * Each utterance is segmented with the segmentation that maximizes 
+ * the product of the relative probabilities of its words given the 
+ * lexicon learned from the earlier utterances, and the lexicon is 
+ * updated with the result. With k = number of word tokens and 
+ * n = number of word types in the lexicon after adding the word, 
+ * the relative probability of a word w is
+ *
+ *      f/k * ((f - 1)/f)^2                             if w is known,
+ *      6/pi^2 * n/k * P_S(w)/(1 - P(#)) * ((n - 1)/n)^2  otherwise,
+ *
+ * where f is the frequency of w after adding it, and P_S(w) is the 
+ * probability of spelling out w with the phonemes of the lexicon 
+ * types followed by a boundary #. The last factor is taken to be 1 
+ * for the very first word. The phoneme probabilities are add-one 
+ * smoothed relative frequencies over the phonemes of the lexicon 
+ * types, and the boundaries (one per type), with the phonemes seen so
+ * far and the boundary as the alphabet. As in Brent's search, 
+ * the words of the same utterance are scored independently.
+ *
+ * The word specific part of the score of the known words is cached 
+ * with the words, and recalculated only when the frequency of the 
+ * word changes. The phoneme log-probabilities are recalculated only 
+ * when a new type is added to the lexicon. The rest depends only on
+ * the token and type counts, and it is calculated once per utterance.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <time.h>
+#include "cmdline.h"
+#include "lexicon.h"
+#include "strutils.h"
+#include "io.h"
+#include "phonstats.h"
+#include "symtab.h"
+#include "seg.h"
+#include "seg_mbdp.h"
+#include "wtrie.h"
+#include "cclib_debug.h"
+#include "profile.h"
+
+struct mbdp_word {
+    struct cg_listhead  *lh;
+    double              lscore; // log(f) + 2 log((f - 1)/f)
+};
+
+static cg_lexicon *L;
+static struct phonstats *ps;
+static struct wtrie *trie;      // node data is a struct mbdp_word
+
+static double lp_phon[SYMTAB_NIDS]; // log P(phoneme) by symbol ID
+static double lp_bound;         // log(P(#) / (1 - P(#)))
+static int phon_changed;
+
+static size_t mbdp_nutt;
+static double mbdp_time;
+
+static void
+mbdp_word_score(struct mbdp_word *w)
+{
+    double f = (double) w->lh->n_tok + 1;
+
+    w->lscore = log(f) + 2 * log((f - 1) / f);
+}
+
+static void
+mbdp_phon_update()
+{
+    // phonemes and one boundary per type, phonstats also counts 
+    // the beginning of the words, which we do not use. the add-one 
+    // denominator adds the alphabet: the phonemes seen (the unigram
+    // types without `<' and `>') and the boundary.
+    size_t nphon = (ps->n_updt) ? ps->n_typ[NG_UNIGRAM] - 2 : 0;
+    double ntok = (double) (ps->n_tok[NG_UNIGRAM] - ps->n_updt) 
+                  + nphon + 1;
+    double pb = ((double) ps->n_updt + 1) / ntok;
+    int id;
+
+    for (id = 0; id < SYMTAB_NIDS; id++) {
+        lp_phon[id] = log(((double) phonstats_freq_id(ps, id) + 1) / ntok);
+    }
+    lp_bound = log(pb) - log(1 - pb);
+    phon_changed = 0;
+}
+
+void 
+segment_mbdp_init(struct input *in)
+{
+    L = cg_lexicon_new();
+    ps = phonstats_new(1, NULL);
+    trie = wtrie_new();
+    phon_changed = 1;
+    mbdp_nutt = 0;
+    mbdp_time = 0.0;
+}
+
+struct seglist * 
+segment_mbdp(struct input *in, int idx)
+{
+    char *u = in->u[idx].s;
+    uint16_t *id = in->u[idx].id;
+    struct seglist *segl;
+    int firstch, lastch, nsegs;
+    int  len = strlen(u) - 1;
+    double  bestsc[len + 1];
+    int  bestst[len + 1];
+    unsigned short    seg[len + 1];
+    double k = (double) L->stats->n_tok + 1,
+           n = (double) L->stats->n_typ_pf + 1;
+    double known = -log(k), novel;
+    clock_t t0 = clock();
+
+    if (phon_changed) {
+        mbdp_phon_update();
+    }
+    novel = log(6 / (M_PI * M_PI)) + log(n) - log(k) + lp_bound;
+    if (n > 1) {
+        novel += 2 * log((n - 1) / n);
+    }
+
+    for (firstch = 0; firstch <= len; firstch++) {
+        int node = 0;
+        double newsc = novel;
+
+        for (lastch = firstch; lastch <= len; lastch++) {
+            double wordsc;
+
+            newsc += lp_phon[id[lastch]];
+            if (node >= 0) {
+                node = wtrie_child(trie, node, u[lastch]);
+                if (node == 0) node = -1;
+            }
+            if (node > 0 && trie->node[node].data != NULL) {
+                struct mbdp_word *w = trie->node[node].data;
+                wordsc = w->lscore + known;
+            } else {
+                wordsc = newsc;
+            }
+
+            if (firstch == 0) {
+                bestsc[lastch] = wordsc;
+                bestst[lastch] = 0;
+            } else if (wordsc + bestsc[firstch - 1] > bestsc[lastch]) {
+                bestsc[lastch] = wordsc + bestsc[firstch - 1];
+                bestst[lastch] = firstch;
+            }
+        }
+    }
+
+    nsegs = 0;
+    for (firstch = bestst[len]; firstch > 0; firstch = bestst[firstch - 1]) {
+        nsegs++;
+    }
+
+    segl = seglist_new();
+    if (nsegs) {
+        seg[0] = nsegs;
+        for (firstch = bestst[len]; firstch > 0; 
+                firstch = bestst[firstch - 1]) {
+            seg[nsegs--] = firstch;
+        }
+        seglist_add(segl, seg);
+    } else {
+        segl->nsegs = 1;
+        segl->segs = malloc(sizeof *segl->segs);
+        segl->segs[0] = NULL;
+    }
+
+    segment_mbdp_update(u, segl);
+
+    mbdp_time += (double) (clock() - t0) / CLOCKS_PER_SEC;
+    mbdp_nutt++;
+    return segl;
+}
+
+void 
+segment_mbdp_update(char *s, struct seglist *segl)
+{
+    struct prof_mark pm = prof_start(PROF_UPDATE);
+    char **segstr;
+    char **seg;
+    assert(segl->nsegs == 1);
+
+    segstr = seg_to_strlist(s, segl->segs[0]);
+    for (seg = segstr; *seg; seg++) {
+        int node = wtrie_find(trie, *seg);
+        struct mbdp_word *w = (node) ? trie->node[node].data : NULL;
+
+        cg_lexicon_add(L, *seg, "C", NULL);
+        if (w == NULL) {
+            w = malloc(sizeof (*w));
+            w->lh = cg_lexicon_lookup_h(L, *seg);
+            node = wtrie_add(trie, *seg);
+            trie->node[node].data = w;
+            phonstats_update(ps, *seg);
+            phon_changed = 1;
+        }
+        mbdp_word_score(w);
+    }
+    free_strlist(segstr);
+    prof_stop(&pm);
+}
+
+void 
+segment_mbdp_cleanup()
+{
+    int i;
+
+    if (mbdp_time > 0.0) {
+        PINFO("mbdp: %zu utterances in %.2f s, %.0f utterances/s\n", 
+              mbdp_nutt, mbdp_time, mbdp_nutt / mbdp_time);
+    }
+    for (i = 0; i < trie->n; i++) {
+        free(trie->node[i].data);
+    }
+    wtrie_free(trie);
+    phonstats_free(ps);
+    if (opt.outlex_given) outlex_write(L);
+    cg_lexicon_free(L);
+}
@@ -25,6 +25,8 @@
 #include <assert.h>
 #include "packed_chart.h"
 #include "strutils.h"
+#include "profile.h"
+#include "cclib_debug.h"
 
 static cg_lexicon *L;
 
@@ -33,7 +35,8 @@ void
 segment_nv_init(struct input *in)
 {
     if(opt.inlex_given){
-        L = cg_lexicon_load(opt.inlex_arg);
+        L = inlex_read(opt.inlex_arg);
+        if (L == NULL) PFATAL("cannot load the lexicon\n");
     } else {
         L = cg_lexicon_new();
     }
@@ -93,6 +96,7 @@ segment_nv(struct input *in, int idx)
 void 
 segment_nv_update(char *s, struct seglist *segl)
 {
+    struct prof_mark pm = prof_start(PROF_UPDATE);
     char tmp[strlen(s)];
 
     if (segl->segs[0] == NULL || segl->segs[0][0] == 0) {
@@ -108,7 +112,7 @@ segment_nv_update(char *s, struct seglist *segl)
         }
     }
 
-    return;
+    prof_stop(&pm);
 }
 
 void 
@@ -39,6 +39,8 @@ static int  rmin = 0;
 static int  rmax = 0; 
 static int  votec = 0; 
 static struct mdata *md = NULL;
+static struct mlist *ml = NULL;  // measures and votes, reused
+static struct mv_state mv;
 
 
 void 
@@ -104,7 +106,8 @@ segment_ub_init(struct input *in)
 
     assert (i == votec);
 
-    mv_init();
+    if (mv_init(&mv, &opt)) exit(-1);
+    ml = mlist_new(votec);
 
     ps = phonstats_new(1 + ((rmax > lmax) ? rmax : lmax), NULL);
 
@@ -123,20 +126,18 @@ segment_ub(struct input *in, int idx)
     int i = 1;
     unsigned short seg[len + 1];
     double votes[len];
-    struct mlist *ml = mlist_new(votec);
 
     seg[0] = 0;
     
     phonstats_update(ps, u);
 
-    ml->s = u;
-    ml->slen = len;
+    mlist_reset(ml, u, len);
     for (j = 0; j < votec; j++) {
         md[j].s = u;
         mlist_add_old(ml, &md[j], ps);
     }
 
-    mv_getvotes(votes, ml);
+    mv_getvotes(&mv, votes, ml);
 
     i = 1;
     for (j = 1; j < len; j++) {
@@ -168,4 +169,5 @@ segment_ub_cleanup()
     }
 */
     free(md);
+    mlist_free(ml, 0);
 }
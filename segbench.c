@@ -0,0 +1,639 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+/* segbench.c -- throughput benchmark for seg
+ *
+ * Generates a synthetic corpus by resampling the words of a source
+ * corpus, runs seg with each of a fixed set of methods on it, and 
+ * writes the wall time, utterances per second and peak RSS of every
+ * case as CSV. With a baseline CSV from an earlier run, the relative
+ * throughput of each case is added to the output.
+ *
+ * The corpus keeps the word frequencies and the utterance lengths
+ * of the source. Some cases run on long utterances, made by joining 
+ * a number of consecutive utterances of the corpus. The word types 
+ * can be rewritten over a different alphabet and with a different 
+ * word length distribution, keeping their frequencies. The same seed
+ * gives the same corpus.
+ *
+ * Each case is run once more with --profile, to report the number of
+ * lexicon lookups and the malloc() calls per lookup. The extra run is
+ * not timed, and uses the binary given with -P, seg-prof by default,
+ * which is seg linked with the counting malloc() of prof_malloc.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <glib.h>
+
+#define MAXARGS 32
+#define MAXWLEN 64
+
+struct bench_case {
+    const char  *name;
+    const char  *args[MAXARGS];  // `@LEX' is replaced by the lexicon file
+    int         join;            // utterances joined into one, if > 1
+};
+
+static const struct bench_case cases[] = {
+    {"combine-pred",            {"-m", "combine", "-c", "pred", NULL}},
+    {"combine-pred-phon",       {"-m", "combine", "-c", "pred", 
+                                 "-c", "phon", NULL}},
+    {"combine-pred-phon-lex",   {"-m", "combine", "-c", "pred", 
+                                 "-c", "phon", "-c", "lex", NULL}},
+    {"combine-lex",             {"-m", "combine", "-c", "lex", NULL}},
+    {"lm",                      {"-m", "lm", NULL}},
+    {"lm-long",                 {"-m", "lm", NULL}, 20},
+    {"lm-long-maxwlen",         {"-m", "lm", "--lm-maxwlen=16", NULL}, 20},
+    {"lexc",                    {"-m", "lexc", NULL}},
+    {"nv",                      {"-m", "nv", NULL}},
+    {"lexicon",                 {"-m", "lexicon", "-I", "@LEX", NULL}},
+    {"print-pred",              {"--print", "--pred-m=tp", 
+                                 "--pred-m=mi", NULL}},
+    {"print-ptp",               {"--print", "--print-ptp=tp", NULL}},
+    {"print-wfreq",             {"--print", "--print-wfreq", NULL}},
+    {NULL, {NULL}}
+};
+
+/* the symbols used for a rewritten alphabet: printable, and none of 
+ * the characters with a special meaning in seg's inputs or lexicons
+ */
+static const char symbols[] = 
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "0123456789!\"#$%&'()*+,/;=?@[\\]^_`{|}~";
+
+struct corpus {
+    GHashTable  *types;     // word -> type index + 1
+    char        **type;     // type strings
+    size_t      ntypes;
+    size_t      nalloc_types;
+    size_t      *tok;       // type index of every token
+    size_t      ntok;
+    size_t      nalloc_tok;
+    int         *ulen;      // number of words in every utterance
+    size_t      nutt;
+    size_t      nalloc_utt;
+    char        alpha[256]; // symbols seen in the source
+};
+
+static uint64_t rng_state;
+
+static inline uint64_t
+rng()
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+static inline double
+rng_unif()
+{
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void
+die(const char *msg, const char *arg)
+{
+    fprintf(stderr, "segbench: %s%s%s\n", msg, arg ? " " : "", 
+            arg ? arg : "");
+    exit(1);
+}
+
+static void *
+xrealloc(void *p, size_t size)
+{
+    p = realloc(p, size);
+    if (p == NULL) die("out of memory", NULL);
+    return p;
+}
+
+static void
+corpus_add_word(struct corpus *c, const char *w)
+{
+    size_t t = GPOINTER_TO_SIZE(g_hash_table_lookup(c->types, w));
+
+    if (t == 0) {
+        const unsigned char *p;
+
+        if (c->ntypes == c->nalloc_types) {
+            c->nalloc_types = c->nalloc_types ? 2 * c->nalloc_types : 1024;
+            c->type = xrealloc(c->type, c->nalloc_types * sizeof (*c->type));
+        }
+        c->type[c->ntypes] = strdup(w);
+        for (p = (const unsigned char *) w; *p; p++) c->alpha[*p] = 1;
+        t = ++c->ntypes;
+        g_hash_table_insert(c->types, c->type[t - 1], GSIZE_TO_POINTER(t));
+    }
+    if (c->ntok == c->nalloc_tok) {
+        c->nalloc_tok = c->nalloc_tok ? 2 * c->nalloc_tok : 4096;
+        c->tok = xrealloc(c->tok, c->nalloc_tok * sizeof (*c->tok));
+    }
+    c->tok[c->ntok++] = t - 1;
+}
+
+/* corpus_read() - read the segmented corpus `fn', one utterance per
+ *                 line with the words separated by spaces
+ */
+static struct corpus *
+corpus_read(const char *fn)
+{
+    struct corpus *c = calloc(1, sizeof (*c));
+    FILE *fp = fopen(fn, "r");
+    char *line = NULL;
+    size_t n = 0;
+
+    if (fp == NULL) die("cannot open", fn);
+    c->types = g_hash_table_new(g_str_hash, g_str_equal);
+    while (getline(&line, &n, fp) != -1) {
+        char *w, *save = NULL;
+        int nw = 0;
+
+        for (w = strtok_r(line, " \t\r\n", &save); w != NULL;
+             w = strtok_r(NULL, " \t\r\n", &save)) {
+            if (strlen(w) >= MAXWLEN) continue;
+            corpus_add_word(c, w);
+            ++nw;
+        }
+        if (nw == 0) continue;
+        if (c->nutt == c->nalloc_utt) {
+            c->nalloc_utt = c->nalloc_utt ? 2 * c->nalloc_utt : 1024;
+            c->ulen = xrealloc(c->ulen, c->nalloc_utt * sizeof (*c->ulen));
+        }
+        c->ulen[c->nutt++] = nw;
+    }
+    free(line);
+    fclose(fp);
+    if (c->nutt == 0) die("no utterances in", fn);
+    return c;
+}
+
+/* word length distributions for the rewritten types */
+enum wlen_dist {WLEN_SOURCE, WLEN_GEOM, WLEN_UNIFORM};
+
+struct wlen {
+    enum wlen_dist  dist;
+    double          mean;
+    int             min, max;
+};
+
+static void
+wlen_parse(struct wlen *wl, const char *s)
+{
+    if (!strcmp(s, "source")) {
+        wl->dist = WLEN_SOURCE;
+    } else if (sscanf(s, "geom:%lf", &wl->mean) == 1 && wl->mean >= 1.0) {
+        wl->dist = WLEN_GEOM;
+    } else if (sscanf(s, "uniform:%d-%d", &wl->min, &wl->max) == 2 &&
+               wl->min >= 1 && wl->max >= wl->min && wl->max < MAXWLEN) {
+        wl->dist = WLEN_UNIFORM;
+    } else {
+        die("bad word length distribution", s);
+    }
+}
+
+static int
+wlen_draw(const struct wlen *wl, int srclen)
+{
+    int len = srclen;
+
+    switch (wl->dist) {
+    case WLEN_SOURCE:
+    break;
+    case WLEN_GEOM: // number of trials until the first success, p = 1/mean
+        len = 1 + (int) floor(log(1.0 - rng_unif()) / 
+                              log(1.0 - 1.0 / wl->mean));
+    break;
+    case WLEN_UNIFORM:
+        len = wl->min + rng() % (wl->max - wl->min + 1);
+    break;
+    }
+    return (len < MAXWLEN) ? len : MAXWLEN - 1;
+}
+
+/* corpus_rewrite() - replace every type with a distinct random string
+ *                    over `nsym' symbols, with a length drawn from `wl'
+ */
+static void
+corpus_rewrite(struct corpus *c, int nsym, const struct wlen *wl)
+{
+    char alpha[256];
+    int nalpha = 0;
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+    size_t t;
+    int i;
+
+    if (nsym == 0) {
+        for (i = 1; i < 256; i++) if (c->alpha[i]) alpha[nalpha++] = i;
+    } else {
+        if (nsym > (int) sizeof (symbols) - 1) die("alphabet too large", NULL);
+        memcpy(alpha, symbols, nsym);
+        nalpha = nsym;
+    }
+
+    for (t = 0; t < c->ntypes; t++) {
+        int len = wlen_draw(wl, strlen(c->type[t]));
+        char *w = malloc(MAXWLEN);
+        int tries = 0;
+
+        do {
+            if (++tries % 64 == 0 && len < MAXWLEN - 1) ++len;
+            for (i = 0; i < len; i++) w[i] = alpha[rng() % nalpha];
+            w[len] = '\0';
+        } while (g_hash_table_lookup(seen, w) != NULL);
+        g_hash_table_insert(seen, w, w);
+        free(c->type[t]);
+        c->type[t] = w;
+    }
+    g_hash_table_destroy(seen);
+}
+
+/* corpus_write() - write `nutt' utterances sampled from `c' to `fn',
+ *                  and the word types to the lexicon `lexfn'
+ */
+static void
+corpus_write(struct corpus *c, size_t nutt, const char *fn, 
+             const char *lexfn)
+{
+    FILE *fp = fopen(fn, "w");
+    FILE *lfp = fopen(lexfn, "w");
+    size_t u, t;
+    int i;
+
+    if (fp == NULL) die("cannot write", fn);
+    if (lfp == NULL) die("cannot write", lexfn);
+    for (u = 0; u < nutt; u++) {
+        int nw = c->ulen[rng() % c->nutt];
+        for (i = 0; i < nw; i++) {
+            fprintf(fp, "%s%s", i ? " " : "", c->type[c->tok[rng() % c->ntok]]);
+        }
+        fputc('\n', fp);
+    }
+    for (t = 0; t < c->ntypes; t++) {
+        fprintf(lfp, "%s := x\n", c->type[t]);
+    }
+    fclose(fp);
+    fclose(lfp);
+}
+
+/* corpus_join() - write the utterances of `fn' to `outfn', `join' of
+ *                 them in one line. returns the number of lines.
+ */
+static size_t
+corpus_join(const char *fn, const char *outfn, int join)
+{
+    FILE *fp = fopen(fn, "r");
+    FILE *out = fopen(outfn, "w");
+    char *line = NULL;
+    size_t n = 0, nin = 0;
+    ssize_t len;
+
+    if (fp == NULL) die("cannot open", fn);
+    if (out == NULL) die("cannot write", outfn);
+    while ((len = getline(&line, &n, fp)) != -1) {
+        if (len && line[len - 1] == '\n') line[--len] = '\0';
+        fprintf(out, "%s%s", (nin % join) ? " " : "", line);
+        if (++nin % join == 0) fputc('\n', out);
+    }
+    if (nin % join) fputc('\n', out);
+    free(line);
+    fclose(fp);
+    fclose(out);
+    return (nin + join - 1) / join;
+}
+
+static void
+corpus_free(struct corpus *c)
+{
+    size_t t;
+
+    for (t = 0; t < c->ntypes; t++) free(c->type[t]);
+    g_hash_table_destroy(c->types);
+    free(c->type);
+    free(c->tok);
+    free(c->ulen);
+    free(c);
+}
+
+struct run_result {
+    double      sec;
+    long        maxrss; // kB
+    int         status;
+};
+
+static double
+now_sec()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* run_case() - run seg once with the arguments of `bc', 
+ *              and with --profile if `proffn' is not NULL 
+ */
+static struct run_result
+run_case(const char *seg, const struct bench_case *bc, const char *corpus,
+         const char *lexfn, const char *proffn)
+{
+    char profarg[4096 + 16];
+    const char *argv[MAXARGS + 8];
+    struct run_result r = {0.0, 0, 0};
+    struct rusage ru;
+    double t0;
+    pid_t pid;
+    int i, n = 0;
+
+    argv[n++] = seg;
+    for (i = 0; bc->args[i] != NULL; i++) {
+        argv[n++] = strcmp(bc->args[i], "@LEX") ? bc->args[i] : lexfn;
+    }
+    argv[n++] = "--quiet";
+    argv[n++] = "-i";
+    argv[n++] = corpus;
+    argv[n++] = "-o";
+    argv[n++] = "/dev/null";
+    if (proffn) {
+        snprintf(profarg, sizeof profarg, "--profile=%s", proffn);
+        argv[n++] = profarg;
+    }
+    argv[n] = NULL;
+
+    t0 = now_sec();
+    pid = fork();
+    if (pid < 0) die("fork failed", NULL);
+    if (pid == 0) {
+        int fd = open("/dev/null", O_WRONLY);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        execv(seg, (char **) argv);
+        _exit(127);
+    }
+    if (wait4(pid, &r.status, 0, &ru) < 0) die("wait4 failed", NULL);
+    r.sec = now_sec() - t0;
+    r.maxrss = ru.ru_maxrss;
+    return r;
+}
+
+/* profile_lookups() - the lexicon lookups and the malloc() calls made
+ *                     in them, summed over the stages of a --profile CSV
+ */
+static int
+profile_lookups(const char *fn, unsigned long *lookups, 
+                unsigned long *mallocs)
+{
+    FILE *fp = fopen(fn, "r");
+    char *line = NULL;
+    size_t n = 0;
+    int col_l = -1, col_m = -1;
+
+    *lookups = *mallocs = 0;
+    if (fp == NULL) return 0;
+    while (getline(&line, &n, fp) != -1) {
+        char *tok, *rest = line;
+        int col, head = !strncmp(line, "kind,", 5);
+
+        if (!head && strncmp(line, "stage,", 6)) continue;
+        line[strcspn(line, "\n")] = '\0';
+        for (col = 0; (tok = strsep(&rest, ",")) != NULL; col++) {
+            if (head && !strcmp(tok, "lookups")) col_l = col;
+            if (head && !strcmp(tok, "lookup_mallocs")) col_m = col;
+            if (!head && col == col_l) *lookups += strtoul(tok, NULL, 10);
+            if (!head && col == col_m) *mallocs += strtoul(tok, NULL, 10);
+        }
+    }
+    free(line);
+    fclose(fp);
+    return col_l >= 0 && col_m >= 0;
+}
+
+static int
+cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/* baseline_read() - utterances per second of each case in `fn' */
+static GHashTable *
+baseline_read(const char *fn)
+{
+    GHashTable *h = g_hash_table_new_full(g_str_hash, g_str_equal, 
+                                          free, free);
+    FILE *fp = fopen(fn, "r");
+    char *line = NULL;
+    size_t n = 0;
+
+    if (fp == NULL) die("cannot open baseline", fn);
+    while (getline(&line, &n, fp) != -1) {
+        char name[256];
+        double *ups = malloc(sizeof (*ups));
+
+        // case,"args",utterances,runs,seconds,utt_per_s,...
+        if (sscanf(line, "%255[^,],\"%*[^\"]\",%*d,%*d,%*f,%lf", 
+                   name, ups) == 2) {
+            g_hash_table_insert(h, strdup(name), ups);
+        } else {
+            free(ups);
+        }
+    }
+    free(line);
+    fclose(fp);
+    return h;
+}
+
+static void
+usage()
+{
+    fprintf(stderr, 
+"usage: segbench [options]\n"
+"  -s SEG       seg binary to run (./seg)\n"
+"  -P SEG       seg binary for the --profile run (./seg-prof)\n"
+"  -c FILE      source corpus to resample (data/br-phono.txt)\n"
+"  -n N         number of utterances to generate (10000)\n"
+"  -a N         rewrite the words over N symbols, 0 keeps them (0)\n"
+"  -w DIST      word lengths of the rewritten words: source,\n"
+"               geom:MEAN or uniform:MIN-MAX (source)\n"
+"  -r SEED      random seed (1)\n"
+"  -R N         runs per case, the median time is reported (3)\n"
+"  -t NAME      run only the case NAME, can be repeated\n"
+"  -d DIR       directory for the generated corpus (/tmp)\n"
+"  -o FILE      output CSV, - for stdout (-)\n"
+"  -b FILE      baseline CSV to compare with\n"
+"  -l           list the cases and exit\n");
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *seg = "./seg", *pseg = "./seg-prof", *src = "data/br-phono.txt", *dir = "/tmp",
+               *outfn = "-", *basefn = NULL;
+    const char *only[64];
+    int nonly = 0;
+    size_t nutt = 10000;
+    int nsym = 0, runs = 3;
+    struct wlen wl = {WLEN_SOURCE, 0.0, 0, 0};
+    unsigned long seed = 1;
+    char corpusfn[4096], lexfn[4096], joinfn[4096], proffn[4096];
+    GHashTable *base = NULL;
+    struct corpus *c;
+    FILE *out = stdout;
+    int i, ch;
+
+    while ((ch = getopt(argc, argv, "s:P:c:n:a:w:r:R:t:d:o:b:lh")) != -1) {
+        switch (ch) {
+        case 's': seg = optarg; break;
+        case 'P': pseg = optarg; break;
+        case 'c': src = optarg; break;
+        case 'n': nutt = strtoul(optarg, NULL, 10); break;
+        case 'a': nsym = atoi(optarg); break;
+        case 'w': wlen_parse(&wl, optarg); break;
+        case 'r': seed = strtoul(optarg, NULL, 10); break;
+        case 'R': runs = atoi(optarg); break;
+        case 't': 
+            if (nonly < 64) only[nonly++] = optarg; 
+        break;
+        case 'd': dir = optarg; break;
+        case 'o': outfn = optarg; break;
+        case 'b': basefn = optarg; break;
+        case 'l':
+            for (i = 0; cases[i].name; i++) printf("%s\n", cases[i].name);
+            return 0;
+        default: usage();
+        }
+    }
+    if (nutt == 0 || runs < 1 || nsym < 0) usage();
+
+    rng_state = seed * 0x9e3779b97f4a7c15ull + 1;
+    c = corpus_read(src);
+    if (nsym != 0 || wl.dist != WLEN_SOURCE) corpus_rewrite(c, nsym, &wl);
+    snprintf(corpusfn, sizeof corpusfn, "%s/segbench-%d.txt", dir, getpid());
+    snprintf(lexfn, sizeof lexfn, "%s/segbench-%d.lex", dir, getpid());
+    snprintf(proffn, sizeof proffn, "%s/segbench-%d.prof.csv", dir, 
+             getpid());
+    corpus_write(c, nutt, corpusfn, lexfn);
+    fprintf(stderr, "segbench: %zu utterances, %zu word types from %s\n",
+            nutt, c->ntypes, src);
+    corpus_free(c);
+
+    if (basefn) base = baseline_read(basefn);
+    if (strcmp(outfn, "-") && (out = fopen(outfn, "w")) == NULL) {
+        die("cannot write", outfn);
+    }
+    fprintf(out, "case,args,utterances,runs,seconds,utt_per_s,"
+                 "peak_rss_kb,status,lookups,mallocs_per_lookup%s\n", 
+            base ? ",base_utt_per_s,speedup" : "");
+
+    for (i = 0; cases[i].name; i++) {
+        const struct bench_case *bc = &cases[i];
+        double sec[runs], med, ups;
+        long maxrss = 0;
+        unsigned long nlookup = 0, nmalloc = 0;
+        int status = 0, prof = 0, j, k;
+        const char *infn = corpusfn;
+        size_t nu = nutt;
+        char args[1024] = "";
+        double *bups;
+
+        for (k = 0; k < nonly && strcmp(only[k], bc->name); k++);
+        if (nonly && k == nonly) continue;
+
+        for (j = 0; bc->args[j]; j++) {
+            strncat(args, j ? " " : "", sizeof args - strlen(args) - 1);
+            strncat(args, bc->args[j], sizeof args - strlen(args) - 1);
+        }
+
+        if (bc->join > 1) {
+            snprintf(joinfn, sizeof joinfn, "%s/segbench-%d-%d.txt", dir, 
+                     getpid(), bc->join);
+            nu = corpus_join(corpusfn, joinfn, bc->join);
+            infn = joinfn;
+        }
+
+        for (j = 0; j < runs; j++) {
+            struct run_result r = run_case(seg, bc, infn, lexfn, NULL);
+            sec[j] = r.sec;
+            if (r.maxrss > maxrss) maxrss = r.maxrss;
+            if (r.status) status = r.status;
+        }
+        qsort(sec, runs, sizeof (*sec), cmp_double);
+        med = sec[runs / 2];
+        ups = nu / med;
+        if (status == 0 && 
+            run_case(pseg, bc, infn, lexfn, proffn).status == 0) {
+            prof = profile_lookups(proffn, &nlookup, &nmalloc);
+        }
+        unlink(proffn);
+        if (bc->join > 1) unlink(joinfn);
+
+        // the time and throughput of failed cases are left empty
+        fprintf(out, "%s,\"%s\",%zu,%d,", bc->name, args, nu, runs);
+        if (status == 0) {
+            fprintf(out, "%.4f,%.1f,%ld,ok", med, ups, maxrss);
+        } else if (WIFSIGNALED(status)) {
+            fprintf(out, ",,%ld,signal %d", maxrss, WTERMSIG(status));
+        } else {
+            fprintf(out, ",,%ld,exit %d", maxrss, WEXITSTATUS(status));
+        }
+        if (prof && nlookup) {
+            fprintf(out, ",%lu,%.3f", nlookup, (double) nmalloc / nlookup);
+        } else if (prof) {
+            fprintf(out, ",0,");
+        } else {
+            fprintf(out, ",,");
+        }
+        if (base) {
+            bups = g_hash_table_lookup(base, bc->name);
+            if (bups && status == 0) {
+                fprintf(out, ",%.1f,%.3f", *bups, ups / *bups);
+            } else if (bups) {
+                fprintf(out, ",%.1f,", *bups);
+            } else {
+                fprintf(out, ",,");
+            }
+        }
+        fprintf(out, "\n");
+        fflush(out);
+        if (status == 0) {
+            fprintf(stderr, "segbench: %-24s %9.1f utt/s %8ld kB\n", 
+                    bc->name, ups, maxrss);
+        } else {
+            fprintf(stderr, "segbench: %-24s failed\n", bc->name);
+        }
+    }
+
+    if (out != stdout) fclose(out);
+    if (base) g_hash_table_destroy(base);
+    unlink(corpusfn);
+    unlink(lexfn);
+    return 0;
+}
@@ -40,6 +40,8 @@
 #include "options.h"
 #include "strutils.h"
 #include "seglist.h"
+#include "profile.h"
+#include "symtab.h"
 #define   ABS(N)    ( (N) >= 0 ? (N) : -(N) )
 
 /* seg_check() : check if pos is in `seg', i.e., if we have a 
@@ -71,6 +73,7 @@ seglist_new()
     struct seglist *new;
 
     new = malloc(sizeof (struct seglist));
+    prof_count(PROF_ALLOCS, 1);
     new->nsegs = new->nalloc = 0;
     new->segs = NULL;
     new->score = NULL;
@@ -127,6 +130,7 @@ seglist_add(struct seglist *segl, unsigned short *seg)
     
     if (seg != NULL) {
         newseg = malloc((seg[0] + 1) * sizeof(*seg));
+        prof_count(PROF_ALLOCS, 1);
 
         for(i=0; i <= seg[0]; i++) {
             newseg[i] = seg[i];
@@ -144,6 +148,7 @@ seglist_add(struct seglist *segl, unsigned short *seg)
                             (segl->nalloc + alloc_len) * sizeof (*segl->score));
         assert(segl->score != NULL);
         segl->nalloc += alloc_len;
+        prof_count(PROF_ALLOCS, 2);
     }
 
     segl->segs[segl->nsegs - 1] = newseg;
@@ -179,6 +184,7 @@ seg_to_strlist(char *s, unsigned short *seg)
     if(seg == NULL || seg[0] == 0) {
         ret = malloc (2 * sizeof *ret);
         ret[0] = strdup(s);
+        prof_count(PROF_ALLOCS, 2);
         ret[1] = NULL;
         return ret;       
     }
@@ -186,6 +192,7 @@ seg_to_strlist(char *s, unsigned short *seg)
     nsegs = seg[0];
     
     ret = malloc((nsegs + 2) * sizeof *ret);
+    prof_count(PROF_ALLOCS, nsegs + 2);
     firstch = 0;
 //printf("str_to_seg: %s ", s);
 //print_intarray(seg);
@@ -258,9 +265,11 @@ seglist_print_segs(FILE *fp, struct seglist *segl, char *s)
         char **segstr = seg_to_strlist(s, segl->segs[j]);
         char **tmp = segstr;
         while (*tmp) {
-            fprintf(fp, "%s", *tmp);
+            symtab_fputs(fp, *tmp);
             tmp++;
-            if (*tmp) fprintf(fp, "%s", SEG_SEP);
+            if (*tmp) {
+                fprintf(fp, "%s", (symtab_on) ? symtab_word_sep() : SEG_SEP);
+            }
         }
         if (j < segl->nsegs - 1) {
             fprintf(fp, "%s", SEGS_SEP);
@@ -43,7 +43,8 @@
 #include <assert.h>
 #include "segparse.h"
 #include "stack.h"
-#include "strutils.h"
+#include "tpool.h"
+#include "profile.h"
 
 inline void
 print_intarray_fp(FILE *fp, short *a)
@@ -62,22 +63,18 @@ print_intarray_fp(FILE *fp, short *a)
 }
 
 
-cg_cat *seg_combined_cat = NULL; // cat to return when combining two elements
-
 /*
  * seg_combine(cg_cat *L, cg_cat *R)
  * 
- * returns `seg_combined_cat' regardless of the input categories.
- * 
- * 
+ * combines any two elements to the category `C' of the lexicon being
+ * parsed. the category belongs to the lexicon, so seg_parse_chart()
+ * does the combination itself, this function only names it.
  */
 cg_cat *
 seg_combine(cg_cat *L, cg_cat *R)
 {
-    if(seg_combined_cat == NULL)  {
-        PFATAL("seg_combined_cat is not initialized\n");
-    }
-    return seg_combined_cat;
+    assert(!"seg_combine() is done by seg_parse_chart()");
+    return NULL;
 }
 
 /* 
@@ -93,60 +90,130 @@ seg_combine(cg_cat *L, cg_cat *R)
 struct chart *
 seg_parse(cg_lexicon *l, char *input, combine_funct_t combine)
 {
-    unsigned short i, j, k;
-    size_t         N = strlen(input);
+    return seg_parse_chart(NULL, l, input, combine);
+}
 
-    struct chart *chart = chart_new(N);
+struct seg_parse_job {
+    cg_lexicon      *l;
+    struct chart    *chart;
+    struct span_hash *sh;   // prefix hashes of the input
+    combine_funct_t combine;
+    cg_cat          *ccat;  // the result of seg_combine for `l'
+    unsigned short  i;
+};
+
+/*
+ * seg_parse_cell() - fill the chart cell [job->i, j]
+ *
+ * the cells of a row are filled in parallel for long inputs, so the 
+ * combine function should be safe to call from multiple threads.
+ */
+static void
+seg_parse_cell(void *arg, int j, int tid)
+{
+    struct seg_parse_job *job = arg;
+    struct chart *chart = job->chart;
+    unsigned short i = job->i;
+    unsigned short k;
+    struct cg_listhead *lh = cg_lexicon_lookup_span(job->l, 
+                                    span_hash_get(job->sh, j, i + 1),
+                                    job->sh->s + j, i + 1);
+    cg_lexilist *ll = lh ? lh->l : NULL;
+
+    while(ll) {
+        chart_node_add_t(chart, tid, i, j, ll->lexi->cat, NULL, NULL);
+        ll = ll->next_hom;
+    }
+
+    for(k=1; k <= i; k++){
+        struct chart_cell *cellL, *cellR;
+        int a, b;
+        unsigned short iL, iR, jL, jR; // indx for l/r consitituents 
+
+        iL = k - 1; jL = j;
+        iR = i - k; jR = j + k;
+        
+        /* search if any of the L,R pairs combine */
+        
+        cellL = &chart->cell[iL][jL];
+        cellR = &chart->cell[iR][jR];
+        for (a = cellL->n - 1; a >= 0; a--) {
+            struct chart_node *nodeL = cellL->node[a];
+            for (b = cellR->n - 1; b >= 0; b--) {
+                struct chart_node *nodeR = cellR->node[b];
+                cg_cat  *res = (job->ccat) ? job->ccat 
+                                   : job->combine(nodeL->cat, nodeR->cat);
+                if(res){
+                    chart_node_add_t(chart, tid, i, j, res, nodeL, nodeR);
+                }
+            }
+        }
+    }
+}
+
+/* 
+ * seg_parse_chart() -- same as seg_parse(), but reuse the chart `chart'
+ *
+ * the chart is reset before parsing. if `chart' is NULL a new chart
+ * is allocated.
+ */
+struct chart *
+seg_parse_chart(struct chart *chart, cg_lexicon *l, char *input, 
+                combine_funct_t combine)
+{
+    return seg_parse_chart_tp(chart, l, input, combine, 
+                              cyk_tpool(strlen(input)));
+}
+
+/* 
+ * seg_parse_chart_tp() -- same as seg_parse_chart(), with the rows 
+ *                         filled by the thread pool `tp', or serially
+ *                         if `tp' is NULL
+ */
+struct chart *
+seg_parse_chart_tp(struct chart *chart, cg_lexicon *l, char *input, 
+                   combine_funct_t combine, struct tpool *tp)
+{
+    unsigned short i, j;
+    size_t         N = strlen(input);
+    struct seg_parse_job job;
+    static __thread struct span_hash sh;
+    struct prof_mark pm = prof_start(PROF_PARSE);
+
+    if (chart == NULL) {
+        chart = chart_new(N);
+    } else {
+        chart_reset(chart, N);
+    }
 
     for (j=0; j < N; j++){
-        char *sp = str_span(input, j, 1);
-        chart->input[j] = sp;
+        chart_set_input(chart, j, input + j, 1);
     }
 
+    job.ccat = NULL;
     if (combine == seg_combine) {
-        seg_combined_cat = cg_lexicon_addcat(l, "C");
+        job.ccat = cg_lexicon_addcat(l, "C");
     }
 
+    job.l = l;
+    job.chart = chart;
+    span_hash_set(&sh, input, N, 0, 0);
+    job.sh = &sh;
+    job.combine = combine;
+    if (tp) {
+        chart_threads(chart, tpool_size(tp));
+    }
     for(i=0; i <= N; i++) {
-        for(j=0; j < (N - i ); j++){
-            char *sp = str_span(input, j, i+1);
-            cg_lexilist *ll = cg_lexicon_lookup(l, sp);
-
-            while(ll) {
-                chart_node_add(chart, i, j, ll->lexi->cat, NULL, NULL);
-                ll = ll->next_hom;
-            }
-            free(sp);
-
-            for(k=1; k <= i; k++){
-                struct chart_node *nodeL, *nodeR;
-                cg_cat *catL, *catR;
-                unsigned short iL, iR, jL, jR; // indx for l/r consitituents 
-
-                iL = k - 1; jL = j;
-                iR = i - k; jR = j + k;
-                
-                /* search if any of the L,R pairs combine */
-                
-                nodeL = chart->node[iL][jL];
-                while(nodeL != NULL) {
-                    catL = nodeL->cat;
-                    nodeR = chart->node[iR][jR];
-                    while(nodeR != NULL) {
-                        cg_cat  *res;
-                        catR = nodeR->cat;
-                        res = combine(catL, catR);
-                        if(res){
-                            chart_node_add(chart, i, j, res, nodeL, nodeR);
-                        }
-                        nodeR = nodeR->next;
-                    }
-                    nodeL = nodeL->next;
-                }
-
+        job.i = i;
+        if (tp) {
+            tpool_run(tp, N - i, seg_parse_cell, &job);
+        } else {
+            for(j=0; j < (N - i ); j++){
+                seg_parse_cell(&job, j, 0);
             }
         }
     }
+    prof_stop(&pm);
     return chart;
 }
 
@@ -354,6 +421,273 @@ get_segs_partial_opt(struct chart *chart, enum segparse_opt o)
     return segs;
 }
 
+/*
+ * Best and k-best segmentations over the lexical lattice.
+ *
+ * Instead of enumerating all segmentations, the chart is viewed as a
+ * lattice whose vertices are the positions 0..size and whose edges
+ * are the (lexical or non-lexical) segments. The edges are the same
+ * ones get_segs_full()/get_segs_partial_opt() would follow:
+ *
+ *   - a lexical edge <j, j+i+1> for every terminal node at <i, j>.
+ *     for partial segmentations, like get_segs_partial_opt(), the
+ *     lexical words end at least two symbols before the end of the
+ *     input.
+ *   - for partial segmentations, a non-lexical edge from j to the 
+ *     next position a lexical edge starts from (or to the end of
+ *     the input), if there are no lexical edges starting at j.
+ *
+ * The SPOPT_* options restrict the use of the non-lexical edges. 
+ * SPOPT_ONE needs to know whether a non-lexical edge was used
+ * already, this is kept as a part of the lattice state. If a path
+ * score function is given, the number of words is also a part of the
+ * state, since the path score may depend on it.
+ *
+ * Ties are broken in favor of the segmentation that would be
+ * enumerated first by get_segs_full()/get_segs_partial_opt(), i.e.,
+ * the one with the larger boundary at the first difference.
+ */
+
+struct lat_entry {
+    double  sc;         // sum of the word scores so far
+    int     prev;       // index of the previous entry, -1 at start
+    unsigned short pos; // position (vertex) of this entry
+};
+
+struct lattice {
+    int     nw;         // number of word counts tracked (1 if none)
+    int     nc;         // number of constraint states
+    int     k;          // max. number of entries per state
+    int     *n;         // number of entries filled for each state
+    struct lat_entry *e;
+};
+
+#define LAT_STATE(lat, pos, w, c) (((pos) * (lat)->nw + (w)) * (lat)->nc + (c))
+
+static inline int
+lat_terminal(struct chart *chart, int i, int j)
+{
+    struct chart_node *n = chart->node[i][j];
+    while (n) {
+        if (n->back == NULL) return 1;
+        n = n->next;
+    }
+    return 0;
+}
+
+/* lat_cmp() - compare two entries with the same position
+ *
+ * returns a positive number if `a' is better than `b'. the ties are
+ * broken at the first boundary after the last entry the two paths 
+ * share, found by following the back pointers of both paths until
+ * they meet.
+ */
+static int
+lat_cmp(struct lattice *lat, struct lat_entry *a, struct lat_entry *b)
+{
+    int ia = a->prev, ib = b->prev,
+        fa = a->pos, fb = b->pos;
+
+    if (a->sc != b->sc) {
+        return (a->sc > b->sc) ? 1 : -1;
+    }
+
+    while (ia != ib) {
+        int pa = lat->e[ia].pos, pb = lat->e[ib].pos;
+        if (pa >= pb) {
+            fa = pa;
+            ia = lat->e[ia].prev;
+        }
+        if (pb >= pa) {
+            fb = pb;
+            ib = lat->e[ib].prev;
+        }
+    }
+    if (fa == fb) return 0;
+    return (fa > fb) ? 1 : -1;
+}
+
+/* lat_insert() - insert a new entry to the sorted list of a state,
+ *                keeping at most lat->k entries
+ */
+static void
+lat_insert(struct lattice *lat, int state, struct lat_entry *new)
+{
+    struct lat_entry *e = lat->e + state * lat->k;
+    int n = lat->n[state];
+    int i;
+
+    if (n == lat->k && lat_cmp(lat, new, &e[n - 1]) <= 0) {
+        return;
+    }
+    i = (n < lat->k) ? n : n - 1;
+    while (i > 0 && lat_cmp(lat, new, &e[i - 1]) > 0) {
+        e[i] = e[i - 1];
+        --i;
+    }
+    e[i] = *new;
+    if (n < lat->k) lat->n[state]++;
+}
+
+static void
+lat_relax(struct lattice *lat, int from, int to, double w, int c_to)
+{
+    int w_from, c_from, i;
+
+    for (w_from = 0; w_from < lat->nw; w_from++) {
+        int w_to = (lat->nw == 1) ? 0 : w_from + 1;
+        if (w_to >= lat->nw) break;
+        for (c_from = 0; c_from < lat->nc; c_from++) {
+            int st = LAT_STATE(lat, from, w_from, c_from);
+            int cc = (c_to < 0) ? c_from : c_to;
+            if (c_to >= 0 && c_from != 0) continue;
+            for (i = 0; i < lat->n[st]; i++) {
+                struct lat_entry new;
+                new.sc = lat->e[st * lat->k + i].sc + w;
+                new.prev = st * lat->k + i;
+                new.pos = to;
+                lat_insert(lat, LAT_STATE(lat, to, w_to, cc), &new);
+            }
+        }
+    }
+}
+
+/*
+ * get_segs_best() - return (at most) k best segmentations
+ *
+ * o        SPOPT_NONE for only the full segmentations, or one of
+ *          the partial segmentation options.
+ * wscore   score of a word spanning <start, start+len> in the chart,
+ *          it is called once for every edge in the lattice.
+ * pscore   if not NULL, the score of a segmentation is 
+ *          pscore(sum of word scores, number of words), otherwise
+ *          it is the sum of word scores. pscore should not decrease
+ *          with increasing sum of word scores.
+ * data     passed to the score functions as is.
+ *
+ * the returned list is sorted, best first, and the scores are set.
+ * like get_segs_full(), the list contains a NULL segmentation if
+ * there are no full segmentations. the result may be empty for
+ * partial segmentations with restrictive options.
+ */
+struct seglist *
+get_segs_best(struct chart *chart, enum segparse_opt o,
+              seg_wscore_funct_t wscore, 
+              seg_pscore_funct_t pscore, 
+              void *data, int k)
+{
+    struct seglist  *segs = seglist_new();
+    struct lattice  lat;
+    int     N = chart->size;
+    int     partial = (o != SPOPT_NONE);
+    int     nstates, i, j, w, c;
+    char    lexstart[N + 1];
+    unsigned short  nextlex[N + 1];
+    struct lat_entry *best;
+    int     nbest = 0;
+
+    assert(k > 0);
+
+    lat.nw = (pscore != NULL) ? N + 1 : 1;
+    lat.nc = (o == SPOPT_ONE) ? 2 : 1;
+    lat.k = k;
+    nstates = (N + 1) * lat.nw * lat.nc;
+    lat.n = calloc(nstates, sizeof (*lat.n));
+    lat.e = malloc(nstates * k * sizeof (*lat.e));
+
+    for (j = 0; j < N; j++) {
+        int maxi = (partial) ? N - j - 2 : N - j;
+        lexstart[j] = 0;
+        for (i = 0; i < maxi; i++) {
+            if (lat_terminal(chart, i, j)) {
+                lexstart[j] = 1;
+                break;
+            }
+        }
+    }
+    lexstart[N] = 1;
+    nextlex[N] = N;
+    for (j = N - 1; j >= 0; j--) {
+        nextlex[j] = (lexstart[j + 1]) ? j + 1 : nextlex[j + 1];
+    }
+
+    lat.n[LAT_STATE(&lat, 0, 0, 0)] = 1;
+    lat.e[LAT_STATE(&lat, 0, 0, 0) * k].sc = 0.0;
+    lat.e[LAT_STATE(&lat, 0, 0, 0) * k].prev = -1;
+    lat.e[LAT_STATE(&lat, 0, 0, 0) * k].pos = 0;
+
+    for (j = 0; j < N; j++) {
+        if (lexstart[j]) {
+            int maxi = (partial) ? N - j - 2 : N - j;
+            for (i = 0; i < maxi; i++) {
+                if (lat_terminal(chart, i, j)) {
+                    lat_relax(&lat, j, j + i + 1, 
+                              wscore(chart, j, i + 1, data), -1);
+                }
+            }
+        } else if (partial) {
+            int end = nextlex[j];
+            int c_to = -1;
+            switch (o) {
+                case SPOPT_ONE: c_to = 1; break;
+                case SPOPT_END: if (end != N) continue; break;
+                case SPOPT_BEGIN: if (j != 0) continue; break;
+                case SPOPT_BEGINEND: 
+                    if (j != 0 && end != N) continue; 
+                    break;
+                default: break;
+            }
+            lat_relax(&lat, j, end, wscore(chart, j, end - j, data), c_to);
+        }
+    }
+
+    /* collect the complete paths, and sort them according to 
+     * the final score.
+     */
+    best = malloc(lat.nw * lat.nc * k * sizeof (*best));
+    for (w = 0; w < lat.nw; w++) {
+        for (c = 0; c < lat.nc; c++) {
+            int st = LAT_STATE(&lat, N, w, c);
+            for (i = 0; i < lat.n[st]; i++) {
+                struct lat_entry new = lat.e[st * k + i];
+                if (pscore) new.sc = pscore(new.sc, w, data);
+                j = nbest;
+                while (j > 0 && lat_cmp(&lat, &new, &best[j - 1]) > 0) {
+                    best[j] = best[j - 1];
+                    --j;
+                }
+                best[j] = new;
+                ++nbest;
+            }
+        }
+    }
+
+    for (i = 0; i < nbest && i < k; i++) {
+        unsigned short seg[N + 1];
+        struct lat_entry *tmp;
+        int nb = 0;
+        for (tmp = &best[i]; tmp->prev >= 0; tmp = &lat.e[tmp->prev]) {
+            if (tmp->pos != N) ++nb;
+        }
+        seg[0] = nb;
+        for (tmp = &best[i]; tmp->prev >= 0; tmp = &lat.e[tmp->prev]) {
+            if (tmp->pos != N) seg[nb--] = tmp->pos;
+        }
+        seglist_add(segs, seg);
+        segs->score[segs->nsegs - 1] = best[i].sc;
+    }
+
+    if (nbest == 0 && !partial) {
+        seglist_add(segs, NULL);
+    }
+
+    free(best);
+    free(lat.n);
+    free(lat.e);
+
+    return segs;
+}
+
 struct seglist *
 get_segs_partial(struct chart *chart)
 {
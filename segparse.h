@@ -34,6 +34,7 @@ enum segparse_opt {
     SPOPT_BEGIN,
     SPOPT_BEGINEND,
     SPOPT_ALL,
+    SPOPT_NONE,     // full segmentations only
 };
 
 void seglist_free(struct seglist *segl);
@@ -42,12 +43,31 @@ typedef cg_cat * (*combine_funct_t)(cg_cat *, cg_cat*);
 
 cg_cat * seg_combine(cg_cat *L, cg_cat *R);
 struct chart * seg_parse(cg_lexicon *l, char *input, combine_funct_t combine);
+struct chart * seg_parse_chart(struct chart *chart, cg_lexicon *l, 
+                               char *input, combine_funct_t combine);
+struct tpool;
+struct chart * seg_parse_chart_tp(struct chart *chart, cg_lexicon *l, 
+                                  char *input, combine_funct_t combine,
+                                  struct tpool *tp);
 void write_segs(FILE *fp, struct chart *c);
 
 struct seglist *get_segs_partial_opt(struct chart *chart, enum segparse_opt o);
 struct seglist *get_segs_partial(struct chart *chart);
 struct seglist *get_segs_full(struct chart *chart);
 
+typedef double (*seg_wscore_funct_t)(struct chart *c, 
+                                     unsigned short start,
+                                     unsigned short len,
+                                     void *data);
+typedef double (*seg_pscore_funct_t)(double wsum, 
+                                     unsigned short nwords, 
+                                     void *data);
+
+struct seglist *get_segs_best(struct chart *chart, enum segparse_opt o,
+                              seg_wscore_funct_t wscore, 
+                              seg_pscore_funct_t pscore, 
+                              void *data, int k);
+
 
 
 #endif // _SEGPARSE_H 
@@ -0,0 +1,310 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "serve.h"
+#include "seg.h"
+#include "strutils.h"
+#include "symtab.h"
+#include "cclib_debug.h"
+
+#define SERVE_BUFSIZ 65536
+
+static volatile sig_atomic_t stop = 0;
+
+/* latencies of the requests in microseconds, from the start of the 
+ * batch of a request to writing its answer
+ */
+static double *lat = NULL;
+static size_t nlat = 0, nalloc_lat = 0;
+static size_t nbatch = 0;
+
+static void
+on_signal(int sig)
+{
+    stop = 1;
+}
+
+static inline uint64_t
+now_ns()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+static void
+lat_add(double us)
+{
+    if (nlat == nalloc_lat) {
+        nalloc_lat = (nalloc_lat) ? 2 * nalloc_lat : 1024;
+        lat = realloc(lat, nalloc_lat * sizeof (*lat));
+        if (lat == NULL) {
+            PFATAL("unable to allocate memory\n");
+        }
+    }
+    lat[nlat++] = us;
+}
+
+static int
+cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+/* percentile() - the nearest-rank `q' percentile of sorted `v' */
+static double
+percentile(const double *v, size_t n, double q)
+{
+    size_t k = (size_t) (q * n / 100.0 + 0.999999);
+
+    if (n == 0) return 0.0;
+    if (k < 1) k = 1;
+    if (k > n) k = n;
+    return v[k - 1];
+}
+
+static void
+serve_report()
+{
+    double *v = malloc((nlat + 1) * sizeof (*v));
+
+    memcpy(v, lat, nlat * sizeof (*v));
+    qsort(v, nlat, sizeof (*v), cmp_double);
+    fprintf(stderr, "serve: %zu requests in %zu batches (%.2f per batch)\n",
+            nlat, nbatch, (nbatch) ? (double) nlat / nbatch : 0.0);
+    fprintf(stderr, "serve: latency p50 %.1f us, p99 %.1f us, "
+            "max %.1f us\n", percentile(v, nlat, 50), 
+            percentile(v, nlat, 99), (nlat) ? v[nlat - 1] : 0.0);
+    free(v);
+}
+
+static int
+write_all(int fd, const char *p, size_t n)
+{
+    while (n) {
+        ssize_t k = write(fd, p, n);
+
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += k;
+        n -= k;
+    }
+    return 0;
+}
+
+/* answer() - segment the request `line' and print the answer to `fp' */
+static void
+answer(FILE *fp, char *line, 
+       struct seglist *(*seg_func)(struct input *, int))
+{
+    struct input_rec rec = {NULL, NULL, NULL};
+    struct input in = {1, 1, &rec, NULL, NULL};
+    struct seglist *segl;
+    char *stress = strchr(line, '\t'), *enc = NULL;
+    size_t len = strlen(line);
+
+    if (len && line[len - 1] == '\r') line[len - 1] = '\0';
+    if (stress) {
+        *stress++ = '\0';
+        stress = str_strip(str_rmch(stress, ' ', NULL), " \t");
+    }
+    if (symtab_on) {
+        if ((line = enc = symtab_encode(line, NULL)) == NULL) {
+            fprintf(fp, "; error: invalid phoneme symbols, or more than %d\n",
+                    SYMTAB_MAX);
+            return;
+        }
+    } else {
+        line = str_strip(str_rmch(line, ' ', NULL), " \t");
+    }
+    if (opt.stress_file_given) {
+        if (stress == NULL || strlen(stress) != strlen(line)) {
+            fprintf(fp, "; error: the stress pattern is missing or does "
+                        "not match the phonemes\n");
+            free(enc);
+            return;
+        }
+        in.stress = &stress;
+    }
+    if (*line == '\0') {
+        fprintf(fp, "\n");
+    } else {
+        rec.s = line;
+        rec.id = symtab_ids(line);
+        segl = seg_func(&in, 0);
+        seglist_print_segs(fp, segl, line);
+        seglist_free(segl);
+        free(rec.id);
+    }
+    free(enc);
+}
+
+/* serve_fd() - answer the requests read from `in_fd' on `out_fd' until
+ *              the end of input, or until the server is stopped
+ */
+static void
+serve_fd(int in_fd, int out_fd, 
+         struct seglist *(*seg_func)(struct input *, int), int batch)
+{
+    size_t size = SERVE_BUFSIZ, len = 0;
+    char *buf = malloc(size + 1);
+    int eof = 0;
+
+    while (!eof && !stop) {
+        char *p = buf, *nl;
+        ssize_t n;
+
+        if (len == size) {
+            size *= 2;
+            buf = realloc(buf, size + 1);
+            if (buf == NULL) {
+                PFATAL("unable to allocate memory\n");
+            }
+            p = buf;
+        }
+        n = read(in_fd, buf + len, size - len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            PERROR("serve: read: %s\n", strerror(errno));
+            break;
+        }
+        len += n;
+        if (n == 0) {
+            eof = 1;
+            if (len && buf[len - 1] != '\n') buf[len++] = '\n';
+        }
+
+        // the complete lines read so far, `batch' at a time. a batch 
+        // is timed from its own start, not from the read, the earlier
+        // batches of the same read are not part of its latency.
+        while ((nl = memchr(p, '\n', buf + len - p)) != NULL) {
+            char *obuf = NULL;
+            size_t olen = 0, nreq = 0;
+            uint64_t t0 = now_ns(), t1;
+            FILE *fp = open_memstream(&obuf, &olen);
+
+            do {
+                *nl = '\0';
+                answer(fp, p, seg_func);
+                p = nl + 1;
+                nreq++;
+            } while (nreq < batch
+                     && (nl = memchr(p, '\n', buf + len - p)) != NULL);
+            fclose(fp);
+            if (write_all(out_fd, obuf, olen) < 0) {
+                PERROR("serve: write: %s\n", strerror(errno));
+                free(obuf);
+                eof = 1;
+                break;
+            }
+            free(obuf);
+            t1 = now_ns();
+            nbatch++;
+            while (nreq--) lat_add((t1 - t0) / 1000.0);
+        }
+        len -= p - buf;
+        memmove(buf, p, len);
+    }
+    free(buf);
+}
+
+/* serve_listen() - a socket listening on the Unix socket `path' */
+static int
+serve_listen(const char *path)
+{
+    struct sockaddr_un sa;
+    int fd;
+
+    if (strlen(path) >= sizeof (sa.sun_path)) {
+        PFATAL("socket name `%s' is too long\n", path);
+    }
+    memset(&sa, 0, sizeof (sa));
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+        PFATAL("socket: %s\n", strerror(errno));
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *) &sa, sizeof (sa)) < 0
+            || listen(fd, 16) < 0) {
+        PFATAL("cannot listen on `%s': %s\n", path, strerror(errno));
+    }
+    return fd;
+}
+
+/* serve() - answer requests from stdin if `addr' is "-", or from the 
+ *           connections to the Unix socket `addr' one at a time, 
+ *           until the end of input or SIGINT/SIGTERM
+ */
+void
+serve(const char *addr, struct seglist *(*seg_func)(struct input *, int),
+      int batch)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof (sa));
+    sa.sa_handler = on_signal;      // no SA_RESTART, to stop accept()
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (batch < 1) batch = 1;
+    fflush(stdout);
+    if (!strcmp(addr, "-")) {
+        PINFO("serving on stdin\n");
+        serve_fd(STDIN_FILENO, STDOUT_FILENO, seg_func, batch);
+    } else {
+        int lfd = serve_listen(addr);
+
+        PINFO("serving on `%s'\n", addr);
+        while (!stop) {
+            int fd = accept(lfd, NULL, NULL);
+
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                PFATAL("accept: %s\n", strerror(errno));
+            }
+            serve_fd(fd, fd, seg_func, batch);
+            close(fd);
+        }
+        close(lfd);
+        unlink(addr);
+    }
+    serve_report();
+    free(lat);
+    lat = NULL;
+    nlat = nalloc_lat = nbatch = 0;
+}
@@ -0,0 +1,42 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SERVE_H
+#define _SERVE_H 1
+
+#include "seglist.h"
+#include "io.h"
+
+/*
+ * --serve: segment utterances as they arrive, with the model built
+ * from the input.
+ *
+ * Requests are read one utterance per line, from stdin or from the
+ * connections to a Unix socket, and each is answered with one line 
+ * of segmentation in the format of the output file. The spaces in a 
+ * request are ignored. With --stress-file, the stress pattern follows
+ * the phonemes after a TAB. The requests that arrive together are
+ * answered with a single write, up to `batch' at a time.
+ */
+
+void serve(const char *addr, struct seglist *(*seg_func)(struct input *, int),
+           int batch);
+
+#endif // _SERVE_H
@@ -0,0 +1,150 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "strhash.h"
+#include "profile.h"
+
+/* the key used for lookups by span, see str_hash_lookup() */
+static __thread struct {
+    const char  *s;
+    size_t      len;
+    strhash_t   h;
+} probe;
+
+strhash_t
+str_hash_n(const char *s, size_t len)
+{
+    strhash_t h = 0;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h = h * STRHASH_MULT + (unsigned char) s[i];
+    }
+    return h;
+}
+
+/* str_hash_cat() - hash of the concatenation of the strings with 
+ *                  hashes `a' and `b', `blen' is the length of the
+ *                  second string.
+ */
+strhash_t
+str_hash_cat(strhash_t a, strhash_t b, size_t blen)
+{
+    strhash_t p = 1, m = STRHASH_MULT;
+
+    while (blen) {
+        if (blen & 1) p *= m;
+        m *= m;
+        blen >>= 1;
+    }
+    return a * p + b;
+}
+
+/* the polynomial hash is weak in the low bits for short keys, 
+ * mix it before handing it over to the hash table.
+ */
+static inline guint
+str_hash_mix(strhash_t h)
+{
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    return h;
+}
+
+guint
+str_hash(gconstpointer s)
+{
+    if (s == (gconstpointer) &probe) {
+        return str_hash_mix(probe.h);
+    }
+    return str_hash_mix(str_hash_n(s, strlen(s)));
+}
+
+static inline gboolean
+probe_equal(const char *key)
+{
+    return strncmp(key, probe.s, probe.len) == 0 && key[probe.len] == '\0';
+}
+
+gboolean
+str_equal(gconstpointer a, gconstpointer b)
+{
+    if (b == (gconstpointer) &probe) return probe_equal(a);
+    if (a == (gconstpointer) &probe) return probe_equal(b);
+    return strcmp(a, b) == 0;
+}
+
+/* str_hash_lookup() - look up the `len' bytes at `s' in `h'
+ *
+ * `hv' should be str_hash_n(s, len), and `h' should be created with
+ * str_hash() and str_equal(). The bytes are only compared for the 
+ * keys with the same hash value.
+ */
+gpointer
+str_hash_lookup(GHashTable *h, strhash_t hv, const char *s, size_t len)
+{
+    prof_count(PROF_PROBES, 1);
+    probe.s = s;
+    probe.len = len;
+    probe.h = hv;
+    return g_hash_table_lookup(h, &probe);
+}
+
+void
+span_hash_set(struct span_hash *sh, const char *s, size_t len,
+              char bow, char eow)
+{
+    size_t n = len + (bow != 0) + (eow != 0);
+    size_t i;
+
+    if (sh->nalloc < n + 1) {
+        sh->nalloc = n + 1;
+        sh->s = realloc(sh->s, sh->nalloc);
+        sh->h = realloc(sh->h, sh->nalloc * sizeof (*sh->h));
+        sh->p = realloc(sh->p, sh->nalloc * sizeof (*sh->p));
+    }
+    i = 0;
+    if (bow) sh->s[i++] = bow;
+    memcpy(sh->s + i, s, len);
+    i += len;
+    if (eow) sh->s[i++] = eow;
+    sh->s[i] = '\0';
+    sh->len = n;
+
+    sh->h[0] = 0;
+    sh->p[0] = 1;
+    for (i = 0; i < n; i++) {
+        sh->h[i + 1] = sh->h[i] * STRHASH_MULT + (unsigned char) sh->s[i];
+        sh->p[i + 1] = sh->p[i] * STRHASH_MULT;
+    }
+}
+
+void
+span_hash_free(struct span_hash *sh)
+{
+    free(sh->s);
+    free(sh->h);
+    free(sh->p);
+    memset(sh, 0, sizeof (*sh));
+}
@@ -0,0 +1,75 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _STRHASH_H
+#define _STRHASH_H       1
+
+#include <stddef.h>
+#include <glib.h>
+
+/*
+ * Polynomial string hashes that can be computed for any span of an
+ * utterance in constant time.
+ *
+ * str_hash() and str_equal() are drop-in replacements for g_str_hash()
+ * and g_str_equal(). Hash tables created with them can be searched
+ * with str_hash_lookup() for a (hash, pointer, length) triple without
+ * copying the span into a NUL-terminated string first. The hash of the
+ * span is typically taken from a `struct span_hash' that keeps the
+ * prefix hashes of the whole utterance.
+ */
+
+typedef guint32 strhash_t;
+
+#define STRHASH_MULT    0x01000193u
+
+strhash_t   str_hash_n(const char *s, size_t len);
+strhash_t   str_hash_cat(strhash_t a, strhash_t b, size_t blen);
+guint       str_hash(gconstpointer s);
+gboolean    str_equal(gconstpointer a, gconstpointer b);
+gpointer    str_hash_lookup(GHashTable *h, strhash_t hv, 
+                            const char *s, size_t len);
+
+/*
+ * span_hash keeps a copy of the string `s' (optionally surrounded by
+ * the boundary characters `bow' and `eow') with the prefix hashes
+ * h[i] = hash(s[0..i)) and the powers p[i] = STRHASH_MULT^i. 
+ * Offsets passed to span_hash_get() refer to the copy, so they
+ * are shifted by one if `bow' is set.
+ */
+struct span_hash {
+    char        *s;
+    size_t      len;
+    size_t      nalloc;
+    strhash_t   *h;
+    strhash_t   *p;
+};
+
+void span_hash_set(struct span_hash *sh, const char *s, size_t len,
+                   char bow, char eow);
+void span_hash_free(struct span_hash *sh);
+
+static inline strhash_t
+span_hash_get(const struct span_hash *sh, size_t start, size_t len)
+{
+    return sh->h[start + len] - sh->h[start] * sh->p[len];
+}
+
+#endif // _STRHASH_H
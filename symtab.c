@@ -0,0 +1,293 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <glib.h>
+#include "symtab.h"
+#include "cclib_debug.h"
+
+int symtab_on = 0;
+
+static enum symtab_mode mode = SYM_BYTES;
+static char *wsep = NULL;           // the word separator of SYM_TOKENS
+static GHashTable *ids = NULL;      // symbol -> ID + 1
+static char **sym = NULL;           // ID -> symbol
+static unsigned char code[256];     // ID -> code
+static int id_of[256];              // code -> ID, or -1
+static size_t nsym = 0;
+
+/* the codes that are not special in the inputs, the lexicons and the
+ * contexts of seg
+ */
+static int
+code_ok(int c)
+{
+    if (c >= 0x80) return 1;
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') 
+           || (c >= '0' && c <= '9') || (c && strchr("!$%&()*+,-.=?@[]^_`{}~", c));
+}
+
+void
+symtab_init(enum symtab_mode m, const char *sep)
+{
+    int c;
+
+    mode = m;
+    symtab_on = (m != SYM_BYTES);
+    if (!symtab_on) return;
+
+    wsep = strdup(sep);
+    ids = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, NULL);
+    sym = calloc(256, sizeof (*sym));
+    for (c = 0; c < 256; c++) id_of[c] = -1;
+    nsym = 0;
+}
+
+void
+symtab_free()
+{
+    size_t i;
+
+    if (!symtab_on) return;
+    g_hash_table_destroy(ids);
+    for (i = 0; i < nsym; i++) free(sym[i]);
+    free(sym);
+    free(wsep);
+    ids = NULL;
+    sym = NULL;
+    wsep = NULL;
+    symtab_on = 0;
+}
+
+/* 
+ * symtab_id() - the ID of the symbol of `len' bytes at `s', a new one
+ *               if it is not seen before. -1 if the table is full.
+ */
+int
+symtab_id(const char *s, size_t len)
+{
+    char key[len + 1];
+    gpointer v;
+    int c;
+
+    memcpy(key, s, len);
+    key[len] = '\0';
+    if ((v = g_hash_table_lookup(ids, key)) != NULL) {
+        return GPOINTER_TO_INT(v) - 1;
+    }
+
+    c = (unsigned char) key[0];
+    if (len != 1 || !code_ok(c) || id_of[c] != -1) {
+        int i;
+
+        // the non-ASCII codes first, to leave the ASCII ones to themselves
+        for (i = 0; i < 256; i++) {
+            c = (i + 0x80) & 0xff;
+            if (code_ok(c) && id_of[c] == -1) break;
+        }
+        if (i == 256) return -1;
+    }
+    sym[nsym] = strdup(key);
+    code[nsym] = c;
+    id_of[c] = nsym;
+    g_hash_table_insert(ids, sym[nsym], GINT_TO_POINTER(nsym + 1));
+    PDEBUG(2, "symbol %zu `%s' is coded as `%c'\n", nsym, key, c);
+    return nsym++;
+}
+
+const char *
+symtab_sym(uint16_t id)
+{
+    assert(id < nsym);
+    return sym[id];
+}
+
+size_t
+symtab_size()
+{
+    return nsym;
+}
+
+/* symtab_code_id() - the ID of the phoneme stored as `c', -1 if `c' is
+ *                    not the code of a phoneme
+ */
+int
+symtab_code_id(unsigned char c)
+{
+    return (symtab_on) ? id_of[c] : c;
+}
+
+/* symtab_ids() - the IDs of the phonemes of the string of codes `s', 
+ *                as a new array of strlen(s) IDs
+ */
+uint16_t *
+symtab_ids(const char *s)
+{
+    size_t n = strlen(s), i;
+    uint16_t *id = malloc((n + 1) * sizeof (*id));
+
+    for (i = 0; i < n; i++) {
+        int c = symtab_code_id(s[i]);
+
+        assert(c >= 0);
+        id[i] = c;
+    }
+    return id;
+}
+
+/* utf8_len() - the length of the UTF-8 character at `s', or 0 */
+static size_t
+utf8_len(const unsigned char *s)
+{
+    size_t n, i;
+
+    if (s[0] < 0x80) return 1;
+    else if ((s[0] & 0xe0) == 0xc0) n = 2;
+    else if ((s[0] & 0xf0) == 0xe0) n = 3;
+    else if ((s[0] & 0xf8) == 0xf0) n = 4;
+    else return 0;
+    for (i = 1; i < n; i++) {
+        if ((s[i] & 0xc0) != 0x80) return 0;
+    }
+    return n;
+}
+
+/* utf8_combining() - whether the character at `s' is a combining 
+ *                    diacritic, U+0300 to U+036F
+ */
+static inline int
+utf8_combining(const unsigned char *s)
+{
+    return (s[0] == 0xcc && (s[1] & 0xc0) == 0x80) 
+           || (s[0] == 0xcd && s[1] >= 0x80 && s[1] < 0xb0);
+}
+
+/* 
+ * symtab_encode() - the phonemes of the input line `line' as codes
+ *
+ * the word boundaries are returned in `pos' as str_rmch() returns the
+ * positions of the removed spaces: pos[0] is their number, followed
+ * by their offsets in the phonemes, or NULL if there are none. returns
+ * a new string, or NULL if `line' is not valid or has too many symbols.
+ */
+char *
+symtab_encode(const char *line, unsigned short **pos)
+{
+    size_t len = strlen(line), n = 0, nb = 0, k;
+    char *out = malloc(len + 1);
+    unsigned short bound[len + 1];
+    const unsigned char *p = (const unsigned char *) line;
+    int boundary = 0;
+
+    assert(symtab_on);
+    while (*p) {
+        int id;
+
+        if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            boundary |= (mode == SYM_UTF8 && *p == ' ');
+            p++;
+            continue;
+        }
+        if (mode == SYM_UTF8) {
+            if ((k = utf8_len(p)) == 0) break;
+            while (p[k] && utf8_combining(p + k)) k += 2;
+        } else {
+            k = strcspn((const char *) p, " \t\r\n");
+            if (k == strlen(wsep) && !memcmp(p, wsep, k)) {
+                boundary = 1;
+                p += k;
+                continue;
+            }
+        }
+        if ((id = symtab_id((const char *) p, k)) < 0) break;
+        if (boundary && n && (nb == 0 || bound[nb - 1] != n)) {
+            bound[nb++] = n;
+        }
+        boundary = 0;
+        out[n++] = code[id];
+        p += k;
+    }
+    if (*p || n > USHRT_MAX) {
+        free(out);
+        return NULL;
+    }
+    out[n] = '\0';
+
+    if (pos) {
+        *pos = NULL;
+        if (nb) {
+            *pos = malloc((nb + 1) * sizeof (**pos));
+            (*pos)[0] = nb;
+            memcpy(*pos + 1, bound, nb * sizeof (*bound));
+        }
+    }
+    return out;
+}
+
+/* 
+ * symtab_fputs_codes() - write the symbols of at most `n' codes of 
+ *                        `s'. the bytes that are not codes, like the
+ *                        `<' and `>' of the utterance boundaries, are
+ *                        written as they are.
+ */
+void
+symtab_fputs_codes(FILE *fp, const char *s, size_t n)
+{
+    const unsigned char *p;
+
+    for (p = (const unsigned char *) s; *p && n; p++, n--) {
+        int id = id_of[*p];
+
+        if (mode == SYM_TOKENS && p != (const unsigned char *) s) {
+            fputc(' ', fp);
+        }
+        if (id >= 0) fputs(sym[id], fp);
+        else fputc(*p, fp);
+    }
+}
+
+/* symtab_decode() - the symbols of the codes in `s' as a new string */
+char *
+symtab_decode(const char *s)
+{
+    char *buf = NULL;
+    size_t size;
+    FILE *fp = open_memstream(&buf, &size);
+
+    if (fp == NULL) return NULL;
+    symtab_fputs_codes(fp, s, SIZE_MAX);
+    fclose(fp);
+    return buf;
+}
+
+/* symtab_word_sep() - the separator of the words on output */
+const char *
+symtab_word_sep()
+{
+    static char buf[64];
+
+    if (mode != SYM_TOKENS) return " ";
+    snprintf(buf, sizeof buf, " %s ", wsep);
+    return buf;
+}
@@ -0,0 +1,101 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SYMTAB_H
+#define _SYMTAB_H 1
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * The phoneme symbols of the input, for --symbols.
+ *
+ * seg works on strings with one byte per phoneme. With --symbols=utf8
+ * a phoneme is a UTF-8 character, with the combining diacritics that
+ * follow it. With --symbols=tokens the phonemes are separated by 
+ * spaces, and the words by the --word-sep token. Each symbol gets a
+ * dense ID in the order it is first seen. The strings seg works on 
+ * are these IDs stored as one byte codes, and they are turned back 
+ * into symbols on output. A single byte symbol is its own code if it
+ * can be, so the same ASCII input is stored the same way with all 
+ * --symbols. The one byte codes are what limits the table to 
+ * SYMTAB_MAX symbols.
+ *
+ * The utterances of the input also keep their phonemes as arrays of
+ * IDs, see symtab_ids(), and the tables of single phonemes, like the
+ * unigram counts of phonstats, are arrays indexed by ID. Without a 
+ * table, with --symbols=bytes, the ID of a phoneme is its byte.
+ *
+ * The words of the lexicons read with -I and written with -O are 
+ * also in symbols, with the phonemes separated by spaces with 
+ * --symbols=tokens. The stress file has one byte per phoneme with all
+ * --symbols.
+ */
+
+enum symtab_mode {
+    SYM_BYTES = 0,      // a byte is a phoneme, no table
+    SYM_UTF8,
+    SYM_TOKENS
+};
+
+#define SYMTAB_MAX  212     // the number of one byte codes
+#define SYMTAB_NIDS 256     // the IDs are below this with all --symbols
+
+extern int symtab_on;
+
+void symtab_init(enum symtab_mode mode, const char *wsep);
+void symtab_free();
+
+int symtab_id(const char *s, size_t len);
+const char *symtab_sym(uint16_t id);
+size_t symtab_size();
+int symtab_code_id(unsigned char c);
+uint16_t *symtab_ids(const char *s);
+
+char *symtab_encode(const char *line, unsigned short **pos);
+void symtab_fputs_codes(FILE *fp, const char *s, size_t n);
+char *symtab_decode(const char *s);
+const char *symtab_word_sep();
+
+/* symtab_fputsn() - write at most `n' phonemes of `s', decoded if 
+ *                   there is a table
+ */
+static inline void
+symtab_fputsn(FILE *fp, const char *s, size_t n)
+{
+    if (symtab_on) {
+        symtab_fputs_codes(fp, s, n);
+    } else {
+        fprintf(fp, "%.*s", (int) n, s);
+    }
+}
+
+/* symtab_fputs() - write the word `s', decoded if there is a table */
+static inline void
+symtab_fputs(FILE *fp, const char *s)
+{
+    if (symtab_on) {
+        symtab_fputs_codes(fp, s, SIZE_MAX);
+    } else {
+        fputs(s, fp);
+    }
+}
+
+#endif // _SYMTAB_H
@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+# round trip of the binary lexicon, run with 'make check-lexbin'.
+#
+# a lexicon is learned with all of pred, phon and lex and written in
+# both formats, each is read back with -I and used to segment the 
+# same input. the segmentations and the entries of the lexicons 
+# written from the two must be the same. the ';' lines are statistics,
+# the text format does not keep the frequencies of the categories 
+# that are not lexical.
+#
+# damaged copies of the binary lexicon (truncated, and with an item
+# pointing outside the file) must be rejected with an error, not 
+# crash the loader.
+
+NAME=lexbin
+. ${0%/*}/lib.sh
+ARGS="$ARGS -c pred"
+
+corpus 2000 > $T/in.txt
+
+$SEG $ARGS -i $T/in.txt -o /dev/null -O $T/lex.txt || fail "seg failed"
+$SEG $ARGS -i $T/in.txt -o /dev/null -O $T/lex.bin \
+     --outlex-format=binary || fail "seg failed"
+
+$SEG $ARGS -i $T/in.txt -I $T/lex.txt -o $T/t.seg -O $T/t.lex \
+     || fail "cannot load the text lexicon"
+$SEG $ARGS -i $T/in.txt -I $T/lex.bin -o $T/b.seg -O $T/b.lex \
+     || fail "cannot load the binary lexicon"
+cmp -s $T/t.seg $T/b.seg || fail "segmentations differ"
+grep -v '^;' $T/t.lex | sort > $T/t.ent
+grep -v '^;' $T/b.lex | sort > $T/b.ent
+cmp -s $T/t.ent $T/b.ent || fail "lexicon entries differ"
+
+# the damaged lexicons, PFATAL() exits with 255
+size=$(wc -c < $T/lex.bin)
+head -c $((size / 2)) $T/lex.bin > $T/short.bin
+cp $T/lex.bin $T/bad.bin
+printf '\377\377\377\177' | dd of=$T/bad.bin bs=1 seek=$((size - 32)) \
+    conv=notrunc 2> /dev/null
+for f in short bad; do
+    $SEG $ARGS -i $T/in.txt -I $T/$f.bin -o /dev/null 2> $T/$f.err
+    rc=$?
+    [ $rc -eq 255 ] && grep -q "not a valid binary lexicon" $T/$f.err \
+        || fail "$f.bin: exit status $rc"
+done
+
+ok
@@ -0,0 +1,23 @@
+#
+# the part shared by the tests, sourced by them after setting NAME.
+#
+# SEG is the binary under test and CORPUS the corpus the inputs are
+# taken from. T is a scratch directory, removed by fail() and ok().
+# ARGS are the options of the model most tests run, a test adds the
+# options of the feature it exercises. a test that starts a process
+# in the background keeps its pid in `pid', fail() kills it.
+
+SEG=${SEG:-./seg}
+CORPUS=${CORPUS:-data/br-phono.txt}
+T=${TMPDIR:-/tmp}/$NAME-$$
+ARGS="-m combine -c phon -c lex --pred-m=mi --quiet"
+pid=
+
+fail() { echo "$NAME: $*" >&2; [ -n "$pid" ] && kill $pid; rm -rf $T; 
+         exit 1; }
+ok() { rm -rf $T; echo "$NAME: ok"; }
+
+# corpus() - the first `n' lines of `file', CORPUS if not given
+corpus() { head -$1 ${2:-$CORPUS}; }
+
+mkdir -p $T || exit 1
@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# --checkpoint-every and --resume, run with 'make check-resume'.
+#
+# a run writes a checkpoint every 700 utterances, the last one is 
+# after utterance 2800 of 3200. the run resumed from it must print 
+# the same --print-prf scores, the ones of the periods before the 
+# checkpoint included, and write the same segmentation as the run 
+# from the start. the sliding window of --print-prf=-N as well.
+
+NAME=resume
+. ${0%/*}/lib.sh
+ARGS="$ARGS -c pred --print-header"
+
+corpus 3200 > $T/in.txt
+
+for prf in 500 -500; do
+    $SEG $ARGS --print-prf=$prf -i $T/in.txt -o $T/full.seg \
+        --checkpoint-every=700 --checkpoint-file=$T/ckpt > $T/full.prf \
+        || fail "seg --checkpoint-every failed"
+    $SEG $ARGS --print-prf=$prf -i $T/in.txt -o $T/res.seg \
+        --resume=$T/ckpt > $T/res.prf || fail "seg --resume failed"
+    [ $(wc -l < $T/full.prf) -eq 8 ] \
+        || fail "--print-prf=$prf: not a score per 500 utterances"
+    cmp -s $T/full.prf $T/res.prf || fail "--print-prf=$prf: scores differ"
+    cmp -s $T/full.seg $T/res.seg \
+        || fail "--print-prf=$prf: segmentations differ"
+done
+
+ok
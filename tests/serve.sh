@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# seg --serve over a Unix socket, run with 'make check-serve'.
+#
+# a model with the stress cue is trained on the start of the corpus
+# with stress patterns, and the next utterances, each with its stress
+# pattern after a tab, are sent as requests with tests/serve_client, 
+# one by one and in batches. the answers must be the same as the 
+# answers to the same requests read from stdin, one per request, and
+# the report at exit must count all the requests. a request without
+# its stress pattern gets an error answer.
+
+NAME=serve
+CORPUS=${CORPUS:-data/br-phono-modified.txt}
+STRESS=${STRESS:-$CORPUS.stress}
+. ${0%/*}/lib.sh
+CLIENT=${CLIENT:-tests/serve_client}
+ARGS="$ARGS -c stress --stress-file=$T/train.st -o /dev/null"
+
+corpus 1000 > $T/train.txt
+corpus 1000 $STRESS > $T/train.st
+sed -n '1001,1300p' $CORPUS > $T/req.txt
+sed -n '1001,1300p' $STRESS | paste $T/req.txt - > $T/req.tsv
+nreq=$(wc -l < $T/req.txt)
+
+$SEG $ARGS -i $T/train.txt --serve=- < $T/req.tsv > $T/stdin.out \
+    2> /dev/null || fail "seg --serve=- failed"
+[ $(wc -l < $T/stdin.out) -eq $nreq ] || fail "not one answer per request"
+grep -q '^; error' $T/stdin.out && fail "a request was not answered"
+head -1 $T/req.txt | $SEG $ARGS -i $T/train.txt --serve=- 2> /dev/null \
+    | grep -q '^; error: the stress pattern is missing' \
+    || fail "a request without stress was answered"
+
+for batch in 1 16; do
+    pid=
+    $SEG $ARGS -i $T/train.txt --serve=$T/sock --serve-batch=$batch \
+        2> $T/server.err &
+    pid=$!
+    i=0
+    while [ ! -S $T/sock ]; do
+        i=$((i + 1))
+        [ $i -gt 100 ] && fail "the server did not start"
+        sleep 0.1
+    done
+
+    # two connections, the server answers them one after the other
+    head -100 $T/req.tsv | $CLIENT $T/sock > $T/sock.out \
+        || fail "client failed"
+    sed -n '101,$p' $T/req.tsv | $CLIENT $T/sock >> $T/sock.out \
+        || fail "client failed"
+    kill -TERM $pid
+    wait $pid
+    pid=
+
+    cmp -s $T/stdin.out $T/sock.out \
+        || fail "--serve-batch=$batch: the answers differ"
+    grep -q "serve: $nreq requests" $T/server.err \
+        || fail "--serve-batch=$batch: wrong request count"
+done
+
+ok
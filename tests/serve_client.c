@@ -0,0 +1,108 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+/* serve_client.c -- a client of `seg --serve=SOCKET', for tests/serve.sh
+ *
+ * usage: serve_client SOCKET < requests > answers
+ *
+ * Sends its standard input to the Unix socket SOCKET and copies the 
+ * answers to its standard output until the server closes the 
+ * connection. The requests are written by a child process, so a 
+ * server that answers while it reads cannot block on a full socket.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static int
+copy(int from, int to)
+{
+    char buf[8192];
+    ssize_t n;
+
+    while ((n = read(from, buf, sizeof buf)) != 0) {
+        char *p = buf;
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        while (n > 0) {
+            ssize_t k = write(to, p, n);
+
+            if (k < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            p += k;
+            n -= k;
+        }
+    }
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    struct sockaddr_un sa;
+    int fd, status;
+    pid_t pid;
+
+    if (argc != 2 || strlen(argv[1]) >= sizeof (sa.sun_path)) {
+        fprintf(stderr, "usage: serve_client SOCKET < requests\n");
+        return 2;
+    }
+    memset(&sa, 0, sizeof (sa));
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, argv[1]);
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 
+        || connect(fd, (struct sockaddr *) &sa, sizeof (sa)) < 0) {
+        fprintf(stderr, "serve_client: %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    if ((pid = fork()) < 0) {
+        perror("serve_client: fork");
+        return 1;
+    }
+    if (pid == 0) {
+        int rc = copy(STDIN_FILENO, fd);
+
+        shutdown(fd, SHUT_WR);
+        _exit(rc < 0);
+    }
+    if (copy(fd, STDOUT_FILENO) < 0) {
+        perror("serve_client: read");
+        return 1;
+    }
+    if (waitpid(pid, &status, 0) < 0 || status != 0) {
+        fprintf(stderr, "serve_client: writing the requests failed\n");
+        return 1;
+    }
+    close(fd);
+    return 0;
+}
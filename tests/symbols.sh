@@ -0,0 +1,104 @@
+#!/bin/sh
+#
+# --symbols on the output paths, run with 'make check-symbols'.
+#
+# the input is rewritten for --symbols=tokens, a phoneme per token
+# and `|' between the words (`#' is a phoneme of the corpus), and for
+# --symbols=utf8, each phoneme a two byte character, half of them
+# followed by a combining diacritic that is all that tells them from
+# the other half. the segmentation, the lexicon written with -O, the
+# segmentation with that lexicon read back with -I and the phonemes
+# printed with --print-ph must be the ones of the same input as bytes,
+# with the phonemes rewritten the same way.
+
+NAME=symbols
+. ${0%/*}/lib.sh
+
+# tokens() - the words of the lines as tokens, `sep' between the words
+tokens() {
+    awk -v sep="$1" '{
+        out = ""
+        for (i = 1; i <= NF; i++) {
+            w = ""
+            for (j = 1; j <= length($i); j++) {
+                w = w (j > 1 ? " " : "") substr($i, j, 1)
+            }
+            out = out (i > 1 ? " " sep " " : "") w
+        }
+        print out
+    }'
+}
+
+# utf8() - the phonemes of the lines as UTF-8, the printable ASCII
+#          characters c and c + 1 of an even c are U+0100 + (c - 32)/2,
+#          and c + 1 is followed by U+0301. the spaces, `<' and `>' are
+#          kept. with `csv', only the first field is rewritten.
+utf8() {
+    LC_ALL=C awk -v csv="$1" 'BEGIN {
+        for (i = 33; i < 127; i++) ord[sprintf("%c", i)] = i
+        if (csv) FS = OFS = ","
+    }
+    function map(s,    out, j, c, cp) {
+        out = ""
+        for (j = 1; j <= length(s); j++) {
+            c = substr(s, j, 1)
+            if (!(c in ord) || c == "<" || c == ">") {
+                out = out c
+                continue
+            }
+            cp = 256 + int((ord[c] - 32) / 2)
+            out = out sprintf("%c%c", 192 + int(cp / 64), 128 + cp % 64)
+            if (ord[c] % 2) out = out sprintf("%c%c", 204, 129)
+        }
+        return out
+    }
+    {
+        if (csv) $1 = map($1)
+        else $0 = map($0)
+        print
+    }'
+}
+
+corpus 1000 > $T/in.txt
+tokens '|' < $T/in.txt > $T/tok.txt
+utf8 < $T/in.txt > $T/utf.txt
+
+PRINT="-p --pred-m=tp --print-ph --quiet"
+$SEG $ARGS -i $T/in.txt -o $T/b.seg -O $T/b.lex || fail "seg failed"
+$SEG $ARGS -i $T/in.txt -I $T/b.lex -o $T/bi.seg || fail "seg -I failed"
+$SEG $PRINT -i $T/in.txt -o $T/b.csv || fail "seg -p failed"
+grep -v '^;' $T/b.lex | sed 's/ := .*//' > $T/b.words
+
+for sym in tokens utf8; do
+    if [ $sym = tokens ]; then
+        S="--symbols=tokens --word-sep=|"
+        in=$T/tok.txt
+        tokens '|' < $T/b.seg > $T/b.$sym.seg
+        tokens '|' < $T/bi.seg > $T/bi.$sym.seg
+        tokens '' < $T/b.words | sort > $T/b.$sym.ent
+        cp $T/b.csv $T/b.$sym.csv
+    else
+        S="--symbols=utf8"
+        in=$T/utf.txt
+        utf8 < $T/b.seg > $T/b.$sym.seg
+        utf8 < $T/bi.seg > $T/bi.$sym.seg
+        utf8 < $T/b.words | sort > $T/b.$sym.ent
+        utf8 csv < $T/b.csv > $T/b.$sym.csv
+    fi
+
+    $SEG $ARGS $S -i $in -o $T/s.seg -O $T/s.lex || fail "seg $S failed"
+    cmp -s $T/b.$sym.seg $T/s.seg || fail "$S: segmentations differ"
+
+    grep -v '^;' $T/s.lex | sed 's/ := .*//' | sort > $T/s.ent
+    cmp -s $T/b.$sym.ent $T/s.ent || fail "$S: lexicon words differ"
+
+    $SEG $ARGS $S -i $in -I $T/s.lex -o $T/si.seg \
+         || fail "seg $S -I failed"
+    cmp -s $T/bi.$sym.seg $T/si.seg \
+         || fail "$S: segmentations with -I differ"
+
+    $SEG $PRINT $S -i $in -o $T/s.csv || fail "seg -p $S failed"
+    cmp -s $T/b.$sym.csv $T/s.csv || fail "$S: --print-ph differs"
+done
+
+ok
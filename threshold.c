@@ -41,30 +41,21 @@ threshold_init()
 #define normalize(x, y) y
 
 int
-get_votes_treshold(double ***vote_l, double ***vote_r, struct mlist *ml)
+get_votes_treshold(struct mlist *ml)
 {
     int m, i;
-    double **vl = NULL;
     
     assert (init == 1);
-    assert (*vote_r == NULL);
 
-    if (*vote_l == NULL) {
-        vl = malloc(ml->len * sizeof (double *));
-        for (m = 0; m < ml->len; m++) {
-            vl[m] = malloc (ml->slen * sizeof (double));
-        }
-    }
+    mlist_votes(ml, 0);
 
     for (m = 0; m < ml->len; m++) {
         double *mval = ml->mlist[m];
         for (i = 1; i < ml->slen; i++) {
-                vl[m][i] = (normalize(ml->m[m], mval[i]) 
-                            - opt.threshold_arg);
+                MLIST_VOTES(ml, ml->vote_l, i)[m] = 
+                    (normalize(ml->m[m], mval[i]) - opt.threshold_arg);
         }
     }
 
-    *vote_l = vl;
-    *vote_r = NULL;
     return  1;
 }
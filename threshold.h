@@ -26,7 +26,7 @@
 #include "mlist.h"
 void threshold_init();
 
-int get_votes_treshold(double ***vote_l, double ***vote_r, struct mlist *ml);
+int get_votes_treshold(struct mlist *ml);
 
 #endif // _THRESHOLD_H
 
@@ -0,0 +1,192 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <assert.h>
+#include "tpool.h"
+
+struct tpool {
+    int             size;       // number of threads including the caller
+    pthread_t       *threads;
+    pthread_mutex_t lock;
+    pthread_cond_t  work;       // signalled when a new job is posted
+    pthread_cond_t  done;       // signalled when the last worker finishes
+    unsigned long   job;        // job counter, workers wait for a change
+    int             busy;       // number of workers running the job
+    int             quit;
+    tpool_funct_t   fn;
+    void            *arg;
+    int             nitems;
+    int             next;       // next item to process
+};
+
+struct worker_arg {
+    struct tpool    *p;
+    int             tid;
+};
+
+static void
+tpool_work(struct tpool *p, int tid)
+{
+    int item;
+
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        item = p->next++;
+        pthread_mutex_unlock(&p->lock);
+        if (item >= p->nitems) break;
+        p->fn(p->arg, item, tid);
+    }
+}
+
+static void *
+tpool_worker(void *a)
+{
+    struct worker_arg *wa = a;
+    struct tpool *p = wa->p;
+    int tid = wa->tid;
+    unsigned long job = 0;
+
+    free(wa);
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        while (p->job == job && !p->quit) {
+            pthread_cond_wait(&p->work, &p->lock);
+        }
+        if (p->quit) {
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        job = p->job;
+        pthread_mutex_unlock(&p->lock);
+
+        tpool_work(p, tid);
+
+        pthread_mutex_lock(&p->lock);
+        if (--p->busy == 0) {
+            pthread_cond_signal(&p->done);
+        }
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+struct tpool *
+tpool_new(int nthreads)
+{
+    struct tpool *p = malloc(sizeof (*p));
+    int i;
+
+    assert(nthreads > 0);
+    p->size = nthreads;
+    p->threads = malloc(nthreads * sizeof (*p->threads));
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->work, NULL);
+    pthread_cond_init(&p->done, NULL);
+    p->job = 0;
+    p->busy = 0;
+    p->quit = 0;
+    p->nitems = p->next = 0;
+
+    for (i = 1; i < nthreads; i++) {
+        struct worker_arg *wa = malloc(sizeof (*wa));
+        wa->p = p;
+        wa->tid = i;
+        pthread_create(&p->threads[i], NULL, tpool_worker, wa);
+    }
+    return p;
+}
+
+void
+tpool_run(struct tpool *p, int nitems, tpool_funct_t fn, void *arg)
+{
+    if (p->size == 1 || nitems <= 1) {
+        int i;
+        for (i = 0; i < nitems; i++) {
+            fn(arg, i, 0);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&p->lock);
+    p->fn = fn;
+    p->arg = arg;
+    p->nitems = nitems;
+    p->next = 0;
+    p->busy = p->size - 1;
+    p->job++;
+    pthread_cond_broadcast(&p->work);
+    pthread_mutex_unlock(&p->lock);
+
+    tpool_work(p, 0);
+
+    pthread_mutex_lock(&p->lock);
+    while (p->busy > 0) {
+        pthread_cond_wait(&p->done, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+
+int
+tpool_size(struct tpool *p)
+{
+    return p->size;
+}
+
+void
+tpool_free(struct tpool *p)
+{
+    int i;
+
+    pthread_mutex_lock(&p->lock);
+    p->quit = 1;
+    pthread_cond_broadcast(&p->work);
+    pthread_mutex_unlock(&p->lock);
+
+    for (i = 1; i < p->size; i++) {
+        pthread_join(p->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->work);
+    pthread_cond_destroy(&p->done);
+    free(p->threads);
+    free(p);
+}
+
+/* tpool_shared() - return a pool shared by all callers
+ *
+ * the pool is created on the first call, and re-created if a 
+ * different number of threads is requested later.
+ */
+struct tpool *
+tpool_shared(int nthreads)
+{
+    static struct tpool *shared = NULL;
+
+    if (shared && shared->size != nthreads) {
+        tpool_free(shared);
+        shared = NULL;
+    }
+    if (shared == NULL) {
+        shared = tpool_new(nthreads);
+    }
+    return shared;
+}
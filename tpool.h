@@ -0,0 +1,45 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TPOOL_H
+#define _TPOOL_H       1
+
+/*
+ * A minimal pool of worker threads for data parallel loops. 
+ * tpool_run() calls fn(arg, item, tid) for each item in [0, nitems)
+ * and returns after all items are processed. The calling thread
+ * works as the thread with tid 0, the workers have tids 1..size-1.
+ * The items are handed out dynamically, so fn() should not depend on
+ * which thread processes a particular item.
+ */
+
+typedef void (*tpool_funct_t)(void *arg, int item, int tid);
+
+struct tpool;
+
+struct tpool    *tpool_new(int nthreads);
+void            tpool_run(struct tpool *p, int nitems, 
+                          tpool_funct_t fn, void *arg);
+int             tpool_size(struct tpool *p);
+void            tpool_free(struct tpool *p);
+
+struct tpool    *tpool_shared(int nthreads);
+
+#endif /* _TPOOL_H */
@@ -25,6 +25,7 @@
 #include "pred.h"
 #include "mdata.h"
 #include "measures.h"
+#include "cclib_debug.h"
 
 
 int 
@@ -34,43 +35,51 @@ ub_init(struct mdlist *mdl, struct phonstats *ps, enum m_id ub_id, enum m_id ue_
     int ub_votec = 0;
     int lmin = 0, rmin = 0, lmax = 0, rmax = 0; 
     int li, ri;
-
-    lmin = opt.ub_lmin_arg;
-    lmax = opt.ub_lmax_arg;
-    rmin = opt.ub_rmin_arg;
-    rmax = opt.ub_rmax_arg;
-
-    if (opt.ub_ngmax_given) {
-        assert (!opt.ub_lmax_given && !opt.ub_rmax_given);
-        rmax = lmax = opt.ub_ngmax_arg;
+    const struct gengetopt_args_info *o = mdl->opt;
+
+    lmin = o->ub_lmin_arg;
+    lmax = o->ub_lmax_arg;
+    rmin = o->ub_rmin_arg;
+    rmax = o->ub_rmax_arg;
+
+    if ((o->ub_ngmax_given && (o->ub_lmax_given || o->ub_rmax_given))
+        || (o->ub_ngmin_given && (o->ub_lmin_given || o->ub_rmin_given))
+        || (o->ub_nglen_given && (o->ub_lmin_given || o->ub_rmin_given 
+                                  || o->ub_lmax_given || o->ub_rmax_given
+                                  || o->ub_ngmin_given 
+                                  || o->ub_ngmax_given))) {
+        PERROR("conflicting --ub-* n-gram lengths\n");
+        return -1;
+    }
+    if (o->ub_ngmax_given) {
+        rmax = lmax = o->ub_ngmax_arg;
     }
-    if (opt.ub_ngmin_given) {
-        assert (!opt.ub_lmin_given && !opt.ub_rmin_given);
-        rmin = lmin = opt.ub_ngmin_arg;
+    if (o->ub_ngmin_given) {
+        rmin = lmin = o->ub_ngmin_arg;
     }
-    if (opt.ub_nglen_given) {
-        assert (!opt.ub_lmin_given && !opt.ub_rmin_given);
-        assert (!opt.ub_lmax_given && !opt.ub_rmax_given);
-        assert (!opt.ub_ngmin_given && !opt.ub_ngmax_given);
-        rmin = lmin = rmax = lmax = opt.ub_nglen_arg;
+    if (o->ub_nglen_given) {
+        rmin = lmin = rmax = lmax = o->ub_nglen_arg;
     }
     
-    assert(lmax >= lmin && rmax >= rmin);
+    if (lmax < lmin || rmax < rmin) {
+        PERROR("the minimum --ub-* n-gram lengths exceed the maximum\n");
+        return -1;
+    }
 
     if (ub_id == M_SUB) {
         assert (ue_id == M_SUE);
-        if (opt.sub_ngmin_given) lmin = rmin = opt.sub_ngmin_arg;
-        if (opt.sub_ngmax_given) lmax = rmax = opt.sub_ngmax_arg;
+        if (o->sub_ngmin_given) lmin = rmin = o->sub_ngmin_arg;
+        if (o->sub_ngmax_given) lmax = rmax = o->sub_ngmax_arg;
     }
 
-    if (opt.ub_type_arg == ub_type_arg_both) {
+    if (o->ub_type_arg == ub_type_arg_both) {
         ub_votec = 2 + (rmax - rmin + lmax - lmin);
         ub = ue = 1;
     } else {
-        if (opt.ub_type_arg == ub_type_arg_ubegin) {
+        if (o->ub_type_arg == ub_type_arg_ubegin) {
             ub_votec = 1 + (rmax - rmin);
             ub = 1;
-        } else if (opt.ub_type_arg == ub_type_arg_uend) {
+        } else if (o->ub_type_arg == ub_type_arg_uend) {
             ub_votec = 1 + (lmax - lmin);
             ue = 1;
         }
@@ -90,90 +99,139 @@ ub_init(struct mdlist *mdl, struct phonstats *ps, enum m_id ub_id, enum m_id ue_
     return ub_votec;
 }
 
+/* the utterance with the boundary markers and its prefix hashes */
+static __thread struct span_hash ng_sh;
+
+/*
+ * bndry_ng_freq() - frequency of the ngram `ch' + [start, end) if 
+ *                   `before' is set, or [start, end) + `ch' otherwise
+ *
+ * the ngram is copied only when it is not a span of `sh'.
+ */
+static inline size_t
+bndry_ng_freq(struct phonstats *ps, struct span_hash *sh, 
+              int start, int end, char ch, int before)
+{
+    int n = end - start;
+    char ng[n + 1];
+    strhash_t hv = span_hash_get(sh, start, n);
+
+    if (before) {
+        if (start > 0 && sh->s[start - 1] == ch) {
+            return phonstats_freq_span(ps, span_hash_get(sh, start - 1, n + 1),
+                                       sh->s + start - 1, n + 1);
+        }
+        ng[0] = ch;
+        memcpy(ng + 1, sh->s + start, n);
+        hv = str_hash_cat((unsigned char) ch, hv, n);
+    } else {
+        if (sh->s[end] == ch) {
+            return phonstats_freq_span(ps, span_hash_get(sh, start, n + 1),
+                                       sh->s + start, n + 1);
+        }
+        memcpy(ng, sh->s + start, n);
+        ng[n] = ch;
+        hv = str_hash_cat(hv, (unsigned char) ch, 1);
+    }
+    return phonstats_freq_span(ps, hv, ng, n + 1);
+}
+
+static inline size_t
+ng_freq(struct phonstats *ps, struct span_hash *sh, int start, int end)
+{
+    return phonstats_freq_span(ps, span_hash_get(sh, start, end - start),
+                               sh->s + start, end - start);
+}
+
+/* `sh' is m->s with BOW_CH and EOW_CH, so s[i] is sh->s[i + 1] */
 static inline double 
-_calc_ub_single(struct phonstats *ps, struct mdata *m, int pos, int len)
+_calc_ub_single(struct phonstats *ps, struct mdata *m, int pos, int len,
+                struct span_hash *sh)
 {
-    char *ng_r;
-    double ub;
+    int end;
     
     assert(pos <= len);
     assert(m->info->mid == M_PUB || m->info->mid == M_SUB || m->info->mid == M_LPB);
 
     assert (m->len_r > 0);
-    if (pos + m->len_r > len) ng_r = strndup(m->s + pos, len - pos);
-    else                      ng_r = strndup(m->s + pos, m->len_r); 
+    if (pos == len) return 0.5;
 
-    ub = (pos == len) ? 0.5 : cond_p_r(ps, "<", ng_r);
-    
-    free(ng_r);
+    end = (pos + m->len_r > len) ? len : pos + m->len_r;
 
-    return ub;
+    // cond_p_r(ps, "<", ng_r)
+    return (double) bndry_ng_freq(ps, sh, pos + 1, end + 1, BOW_CH, 1) /
+           (double) ng_freq(ps, sh, pos + 1, end + 1);
 }
 
 double 
 calc_ub_single(struct phonstats *ps, struct mdata *m, int pos)
 {
     int len = strlen(m->s);
-    return  _calc_ub_single(ps, m, pos, len);
+
+    span_hash_set(&ng_sh, m->s, len, BOW_CH, EOW_CH);
+    return  _calc_ub_single(ps, m, pos, len, &ng_sh);
 }
 
 double *
-calc_ub_list(struct phonstats *ps, struct mdata *m)
+calc_ub_list(struct phonstats *ps, struct mdata *m, double *out)
 {
     int len = strlen(m->s);
     int j = 0;
-    double *ubl = NULL;
+    double *ubl = out;
 
     assert(ps->max_ng > m->len_r);
 
-    ubl = malloc((len + 1) * sizeof (*ubl));
+    if (ubl == NULL) ubl = malloc((len + 1) * sizeof (*ubl));
 
+    span_hash_set(&ng_sh, m->s, len, BOW_CH, EOW_CH);
     for (j = 0; j <= len; j++) {
-        ubl[j] = _calc_ub_single(ps, m, j, len);
+        ubl[j] = _calc_ub_single(ps, m, j, len, &ng_sh);
     }
     return ubl;
 }
 
 double 
-_calc_ue_single(struct phonstats *ps, struct mdata *m, int pos, int len)
+_calc_ue_single(struct phonstats *ps, struct mdata *m, int pos, int len,
+                struct span_hash *sh)
 {
-    char *ng_l;
-    double ub;
+    int start;
     
     assert(pos <= len);
     assert(m->info->mid == M_PUE || m->info->mid == M_SUE || m->info->mid == M_LPE);
 
     assert (m->len_l > 0);
-    if (pos > m->len_l) ng_l = strndup(m->s + pos - m->len_l, m->len_l);
-    else                ng_l = strndup(m->s , pos); 
+    if (pos == 0) return 0.5;
 
-    ub = (pos == 0) ? 0.5 : cond_p(ps, ng_l, ">");
-    
-    free(ng_l);
+    start = (pos > m->len_l) ? pos - m->len_l : 0;
 
-    return ub;
+    // cond_p(ps, ng_l, ">")
+    return (double) bndry_ng_freq(ps, sh, start + 1, pos + 1, EOW_CH, 0) /
+           (double) ng_freq(ps, sh, start + 1, pos + 1);
 }
 
 double 
 calc_ue_single(struct phonstats *ps, struct mdata *m, int pos)
 {
     int len = strlen(m->s);
-    return  _calc_ue_single(ps, m, pos, len);
+
+    span_hash_set(&ng_sh, m->s, len, BOW_CH, EOW_CH);
+    return  _calc_ue_single(ps, m, pos, len, &ng_sh);
 }
 
 double *
-calc_ue_list(struct phonstats *ps, struct mdata *m)
+calc_ue_list(struct phonstats *ps, struct mdata *m, double *out)
 {
     int len = strlen(m->s);
     int j = 0;
-    double *uel = NULL;
+    double *uel = out;
 
     assert(ps->max_ng > m->len_l);
 
-    uel = malloc((len + 1) * sizeof (*uel));
+    if (uel == NULL) uel = malloc((len + 1) * sizeof (*uel));
 
+    span_hash_set(&ng_sh, m->s, len, BOW_CH, EOW_CH);
     for (j = 0; j <= len; j++) {
-        uel[j] = _calc_ue_single(ps, m, j, len);
+        uel[j] = _calc_ue_single(ps, m, j, len, &ng_sh);
     }
     return uel;
 }
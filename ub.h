@@ -27,9 +27,9 @@
 
 int ub_init(struct mdlist *mdl, struct phonstats *ps, enum m_id ub_id, enum m_id ue_id); 
 double calc_ub_single(struct phonstats *ps, struct mdata *m, int pos);
-double *calc_ub_list(struct phonstats *ps, struct mdata *m);
+double *calc_ub_list(struct phonstats *ps, struct mdata *m, double *out);
 
 double calc_ue_single(struct phonstats *ps, struct mdata *m, int pos);
-double *calc_ue_list(struct phonstats *ps, struct mdata *m);
+double *calc_ue_list(struct phonstats *ps, struct mdata *m, double *out);
 
 #endif // _UB_H
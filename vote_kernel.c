@@ -0,0 +1,418 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include <math.h>
+#include "vote_kernel.h"
+#include "peak.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VK_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * scalar kernels, these are also used for the tails of the rows that
+ * do not fill a vector.
+ */
+
+static inline double
+peak_value(double prev, double curr, double next, double dir, 
+           enum vk_peak pt)
+{
+    double left  = dir * (curr - prev);
+    double right = dir * (curr - next);
+
+    switch (pt) {
+    case VK_PEAK_STRICT:
+        return (SIGN(left) != SIGN(right)) ? 0.0 : left + right;
+    case VK_PEAK_STRICT2:
+        if (SIGN(left) != SIGN(right)) return 0.0;
+        return (curr < 0.0) ? 0.0 : left + right;
+    case VK_PEAK_RELAXED:
+        return left + right;
+    case VK_PEAK_LEFT:
+        return left;
+    case VK_PEAK_RIGHT:
+    default:
+        return right;
+    }
+}
+
+static inline double
+vote_value(double peak, enum vk_vote vt)
+{
+    switch (vt) {
+    case VK_VOTE_BINARY:
+        return (peak > 0.0) ? 1.0 : -1.0;
+    case VK_VOTE_DIFF:
+        return peak;
+    case VK_VOTE_LGDIFF:
+    default:
+        return 2 * LOGISTIC(peak) - 1;
+    }
+}
+
+static void
+peak_range(double *vote, const double *val, int from, int n, double dir,
+           enum vk_peak pt, enum vk_vote vt)
+{
+    int i;
+
+    for (i = from; i < n; i++) {
+        vote[i] = vote_value(peak_value(val[i - 1], val[i], val[i + 1], 
+                                        dir, pt), vt);
+    }
+}
+
+static void
+peak_scalar(double *vote, const double *val, int n, double dir,
+            enum vk_peak pt, enum vk_vote vt)
+{
+    peak_range(vote, val, 1, n, dir, pt, vt);
+}
+
+static void
+wmul_scalar(double *out, const double *w, const double *v, int n)
+{
+    int m;
+
+    for (m = 0; m < n; m++) out[m] = w[m] * v[m];
+}
+
+static int
+npos_scalar(const double *v, int n)
+{
+    int m, count = 0;
+
+    for (m = 0; m < n; m++) count += (v[m] > 0.0);
+    return count;
+}
+
+static inline double
+wupdate_value(double vote, double mvote, double cweight, int nvotes)
+{
+    double diff = (SIGN(mvote) == SIGN(vote)) ? 1.0 : -1.0;
+    double tpcount = (double) (nvotes - 1)  * cweight + diff;
+
+    if (tpcount < 0) tpcount = 0.5; 
+    return tpcount / (double) nvotes;
+}
+
+static void
+wupdate_scalar(double *w, const double *v, double mvote, int nvotes, int n)
+{
+    int m;
+
+    for (m = 0; m < n; m++) w[m] = wupdate_value(v[m], mvote, w[m], nvotes);
+}
+
+static const struct vote_kernel vk_scalar = {
+    .name = "scalar",
+    .peak = peak_scalar,
+    .wmul = wmul_scalar,
+    .npos = npos_scalar,
+    .wupdate = wupdate_scalar,
+};
+
+#ifdef VK_X86
+
+/*
+ * SSE2 kernels, two values at a time
+ */
+
+__attribute__((target("sse2")))
+static void
+peak_sse2(double *vote, const double *val, int n, double dir,
+          enum vk_peak pt, enum vk_vote vt)
+{
+    const __m128d vdir = _mm_set1_pd(dir), zero = _mm_setzero_pd(),
+                  one = _mm_set1_pd(1.0), mone = _mm_set1_pd(-1.0);
+    int i;
+
+    for (i = 1; i + 2 <= n; i += 2) {
+        __m128d curr = _mm_loadu_pd(val + i),
+                left = _mm_mul_pd(vdir, 
+                                  _mm_sub_pd(curr, _mm_loadu_pd(val + i - 1))),
+                right = _mm_mul_pd(vdir, 
+                                  _mm_sub_pd(curr, _mm_loadu_pd(val + i + 1))),
+                peak, neq;
+
+        switch (pt) {
+        case VK_PEAK_STRICT:
+        case VK_PEAK_STRICT2:
+            // SIGN(left) != SIGN(right)
+            neq = _mm_or_pd(_mm_xor_pd(_mm_cmpgt_pd(left, zero), 
+                                       _mm_cmpgt_pd(right, zero)),
+                            _mm_xor_pd(_mm_cmplt_pd(left, zero), 
+                                       _mm_cmplt_pd(right, zero)));
+            if (pt == VK_PEAK_STRICT2) {
+                neq = _mm_or_pd(neq, _mm_cmplt_pd(curr, zero));
+            }
+            peak = _mm_andnot_pd(neq, _mm_add_pd(left, right));
+        break;
+        case VK_PEAK_RELAXED:
+            peak = _mm_add_pd(left, right);
+        break;
+        case VK_PEAK_LEFT:
+            peak = left;
+        break;
+        case VK_PEAK_RIGHT:
+        default:
+            peak = right;
+        break;
+        }
+        if (vt == VK_VOTE_BINARY) {
+            __m128d gt = _mm_cmpgt_pd(peak, zero);
+            peak = _mm_or_pd(_mm_and_pd(gt, one), _mm_andnot_pd(gt, mone));
+        }
+        _mm_storeu_pd(vote + i, peak);
+    }
+    if (vt == VK_VOTE_LGDIFF) {
+        int j;
+        for (j = 1; j < i; j++) vote[j] = vote_value(vote[j], vt);
+    }
+    peak_range(vote, val, i, n, dir, pt, vt);
+}
+
+__attribute__((target("sse2")))
+static void
+wmul_sse2(double *out, const double *w, const double *v, int n)
+{
+    int m;
+
+    for (m = 0; m + 2 <= n; m += 2) {
+        _mm_storeu_pd(out + m, _mm_mul_pd(_mm_loadu_pd(w + m), 
+                                          _mm_loadu_pd(v + m)));
+    }
+    for (; m < n; m++) out[m] = w[m] * v[m];
+}
+
+__attribute__((target("sse2")))
+static int
+npos_sse2(const double *v, int n)
+{
+    const __m128d zero = _mm_setzero_pd();
+    int m, count = 0;
+
+    for (m = 0; m + 2 <= n; m += 2) {
+        count += __builtin_popcount(
+                    _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(v + m), zero)));
+    }
+    for (; m < n; m++) count += (v[m] > 0.0);
+    return count;
+}
+
+__attribute__((target("sse2")))
+static void
+wupdate_sse2(double *w, const double *v, double mvote, int nvotes, int n)
+{
+    const __m128d zero = _mm_setzero_pd(), 
+                  one = _mm_set1_pd(1.0), mone = _mm_set1_pd(-1.0),
+                  half = _mm_set1_pd(0.5),
+                  nm1 = _mm_set1_pd((double) (nvotes - 1)),
+                  nv = _mm_set1_pd((double) nvotes),
+                  mv = _mm_set1_pd(mvote),
+                  mgt = _mm_cmpgt_pd(mv, zero), mlt = _mm_cmplt_pd(mv, zero);
+    int m;
+
+    for (m = 0; m + 2 <= n; m += 2) {
+        __m128d vv = _mm_loadu_pd(v + m),
+                neq = _mm_or_pd(_mm_xor_pd(_mm_cmpgt_pd(vv, zero), mgt),
+                                _mm_xor_pd(_mm_cmplt_pd(vv, zero), mlt)),
+                diff = _mm_or_pd(_mm_and_pd(neq, mone), 
+                                 _mm_andnot_pd(neq, one)),
+                tp = _mm_add_pd(_mm_mul_pd(nm1, _mm_loadu_pd(w + m)), diff),
+                neg = _mm_cmplt_pd(tp, zero);
+
+        tp = _mm_or_pd(_mm_and_pd(neg, half), _mm_andnot_pd(neg, tp));
+        _mm_storeu_pd(w + m, _mm_div_pd(tp, nv));
+    }
+    for (; m < n; m++) w[m] = wupdate_value(v[m], mvote, w[m], nvotes);
+}
+
+static const struct vote_kernel vk_sse2 = {
+    .name = "sse2",
+    .peak = peak_sse2,
+    .wmul = wmul_sse2,
+    .npos = npos_sse2,
+    .wupdate = wupdate_sse2,
+};
+
+/*
+ * AVX2 kernels, four values at a time
+ */
+
+__attribute__((target("avx2")))
+static void
+peak_avx2(double *vote, const double *val, int n, double dir,
+          enum vk_peak pt, enum vk_vote vt)
+{
+    const __m256d vdir = _mm256_set1_pd(dir), zero = _mm256_setzero_pd(),
+                  one = _mm256_set1_pd(1.0), mone = _mm256_set1_pd(-1.0);
+    int i;
+
+    for (i = 1; i + 4 <= n; i += 4) {
+        __m256d curr = _mm256_loadu_pd(val + i),
+                left = _mm256_mul_pd(vdir, 
+                          _mm256_sub_pd(curr, _mm256_loadu_pd(val + i - 1))),
+                right = _mm256_mul_pd(vdir, 
+                          _mm256_sub_pd(curr, _mm256_loadu_pd(val + i + 1))),
+                peak, neq;
+
+        switch (pt) {
+        case VK_PEAK_STRICT:
+        case VK_PEAK_STRICT2:
+            neq = _mm256_or_pd(
+                    _mm256_xor_pd(_mm256_cmp_pd(left, zero, _CMP_GT_OQ),
+                                  _mm256_cmp_pd(right, zero, _CMP_GT_OQ)),
+                    _mm256_xor_pd(_mm256_cmp_pd(left, zero, _CMP_LT_OQ),
+                                  _mm256_cmp_pd(right, zero, _CMP_LT_OQ)));
+            if (pt == VK_PEAK_STRICT2) {
+                neq = _mm256_or_pd(neq, _mm256_cmp_pd(curr, zero, _CMP_LT_OQ));
+            }
+            peak = _mm256_andnot_pd(neq, _mm256_add_pd(left, right));
+        break;
+        case VK_PEAK_RELAXED:
+            peak = _mm256_add_pd(left, right);
+        break;
+        case VK_PEAK_LEFT:
+            peak = left;
+        break;
+        case VK_PEAK_RIGHT:
+        default:
+            peak = right;
+        break;
+        }
+        if (vt == VK_VOTE_BINARY) {
+            peak = _mm256_blendv_pd(mone, one, 
+                                    _mm256_cmp_pd(peak, zero, _CMP_GT_OQ));
+        }
+        _mm256_storeu_pd(vote + i, peak);
+    }
+    if (vt == VK_VOTE_LGDIFF) {
+        int j;
+        for (j = 1; j < i; j++) vote[j] = vote_value(vote[j], vt);
+    }
+    peak_range(vote, val, i, n, dir, pt, vt);
+}
+
+__attribute__((target("avx2")))
+static void
+wmul_avx2(double *out, const double *w, const double *v, int n)
+{
+    int m;
+
+    for (m = 0; m + 4 <= n; m += 4) {
+        _mm256_storeu_pd(out + m, _mm256_mul_pd(_mm256_loadu_pd(w + m), 
+                                                _mm256_loadu_pd(v + m)));
+    }
+    for (; m < n; m++) out[m] = w[m] * v[m];
+}
+
+__attribute__((target("avx2")))
+static int
+npos_avx2(const double *v, int n)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    int m, count = 0;
+
+    for (m = 0; m + 4 <= n; m += 4) {
+        count += __builtin_popcount(_mm256_movemask_pd(
+                    _mm256_cmp_pd(_mm256_loadu_pd(v + m), zero, _CMP_GT_OQ)));
+    }
+    for (; m < n; m++) count += (v[m] > 0.0);
+    return count;
+}
+
+__attribute__((target("avx2")))
+static void
+wupdate_avx2(double *w, const double *v, double mvote, int nvotes, int n)
+{
+    const __m256d zero = _mm256_setzero_pd(), 
+                  one = _mm256_set1_pd(1.0), mone = _mm256_set1_pd(-1.0),
+                  half = _mm256_set1_pd(0.5),
+                  nm1 = _mm256_set1_pd((double) (nvotes - 1)),
+                  nv = _mm256_set1_pd((double) nvotes),
+                  mv = _mm256_set1_pd(mvote),
+                  mgt = _mm256_cmp_pd(mv, zero, _CMP_GT_OQ), 
+                  mlt = _mm256_cmp_pd(mv, zero, _CMP_LT_OQ);
+    int m;
+
+    for (m = 0; m + 4 <= n; m += 4) {
+        __m256d vv = _mm256_loadu_pd(v + m),
+                neq = _mm256_or_pd(
+                        _mm256_xor_pd(_mm256_cmp_pd(vv, zero, _CMP_GT_OQ), mgt),
+                        _mm256_xor_pd(_mm256_cmp_pd(vv, zero, _CMP_LT_OQ), mlt)),
+                diff = _mm256_blendv_pd(one, mone, neq),
+                tp = _mm256_add_pd(_mm256_mul_pd(nm1, _mm256_loadu_pd(w + m)),
+                                   diff);
+
+        tp = _mm256_blendv_pd(tp, half, _mm256_cmp_pd(tp, zero, _CMP_LT_OQ));
+        _mm256_storeu_pd(w + m, _mm256_div_pd(tp, nv));
+    }
+    for (; m < n; m++) w[m] = wupdate_value(v[m], mvote, w[m], nvotes);
+}
+
+static const struct vote_kernel vk_avx2 = {
+    .name = "avx2",
+    .peak = peak_avx2,
+    .wmul = wmul_avx2,
+    .npos = npos_avx2,
+    .wupdate = wupdate_avx2,
+};
+
+#endif // VK_X86
+
+static int
+vk_supported(const struct vote_kernel *k)
+{
+#ifdef VK_X86
+    __builtin_cpu_init();
+    if (k == &vk_avx2) return __builtin_cpu_supports("avx2");
+    if (k == &vk_sse2) return __builtin_cpu_supports("sse2");
+#endif
+    return k == &vk_scalar;
+}
+
+/* vote_kernel_find() - the kernels named `name'
+ *
+ * "auto" selects the fastest kernels the CPU supports. returns NULL if
+ * the kernels are unknown or not supported.
+ */
+const struct vote_kernel *
+vote_kernel_find(const char *name)
+{
+    static const struct vote_kernel *all[] = {
+#ifdef VK_X86
+        &vk_avx2, &vk_sse2,
+#endif
+        &vk_scalar, NULL
+    };
+    int i;
+
+    for (i = 0; all[i] != NULL; i++) {
+        if (!strcmp(name, "auto") || !strcmp(name, all[i]->name)) {
+            if (vk_supported(all[i])) return all[i];
+            if (strcmp(name, "auto")) return NULL;
+        }
+    }
+    return NULL;
+}
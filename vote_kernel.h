@@ -0,0 +1,61 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _VOTE_KERNEL_H
+#define _VOTE_KERNEL_H 1
+
+/*
+ * Kernels for peak detection and vote combination over whole rows of
+ * measure values. Each kernel set does the same arithmetic in the same
+ * order as the scalar code in peak.c and mvote.c, so that all sets give
+ * exactly the same results. There are no FMA versions for this reason.
+ */
+
+enum vk_peak {
+    VK_PEAK_STRICT,
+    VK_PEAK_STRICT2,
+    VK_PEAK_RELAXED,
+    VK_PEAK_LEFT,
+    VK_PEAK_RIGHT,
+};
+
+enum vk_vote {
+    VK_VOTE_BINARY,
+    VK_VOTE_DIFF,
+    VK_VOTE_LGDIFF,
+};
+
+struct vote_kernel {
+    const char  *name;
+    // vote[i] for 0 < i < n, from val[i - 1], val[i] and val[i + 1]
+    void (*peak)(double *vote, const double *val, int n, double dir,
+                 enum vk_peak pt, enum vk_vote vt);
+    // out[m] = w[m] * v[m]
+    void (*wmul)(double *out, const double *w, const double *v, int n);
+    // number of positive v[m]
+    int  (*npos)(const double *v, int n);
+    // w[m] = weight_update(v[m], mvote, w[m]), see mvote.c
+    void (*wupdate)(double *w, const double *v, double mvote, 
+                    int nvotes, int n);
+};
+
+const struct vote_kernel *vote_kernel_find(const char *name);
+
+#endif // _VOTE_KERNEL_H
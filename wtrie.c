@@ -0,0 +1,108 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include "wtrie.h"
+
+struct wtrie *
+wtrie_new()
+{
+    struct wtrie *t = malloc(sizeof (*t));
+
+    t->nalloc = 1024;
+    t->node = malloc(t->nalloc * sizeof (*t->node));
+    t->node[0].child = 0;
+    t->node[0].sibling = 0;
+    t->node[0].ch = '\0';
+    t->node[0].data = NULL;
+    t->n = 1;
+    return t;
+}
+
+void
+wtrie_free(struct wtrie *t)
+{
+    if (t == NULL) 
+        return;
+    free(t->node);
+    free(t);
+}
+
+/* wtrie_child() - return the child of `node' for `ch', or 0 */
+int
+wtrie_child(struct wtrie *t, int node, char ch)
+{
+    int c;
+
+    for (c = t->node[node].child; c != 0; c = t->node[c].sibling) {
+        if (t->node[c].ch == ch) 
+            return c;
+    }
+    return 0;
+}
+
+/* wtrie_add_child() - return the child of `node' for `ch', add it if 
+ *                     it does not exist
+ */
+int
+wtrie_add_child(struct wtrie *t, int node, char ch)
+{
+    int c = wtrie_child(t, node, ch);
+
+    if (c == 0) {
+        if (t->n == t->nalloc) {
+            t->nalloc *= 2;
+            t->node = realloc(t->node, t->nalloc * sizeof (*t->node));
+        }
+        c = t->n++;
+        t->node[c].child = 0;
+        t->node[c].ch = ch;
+        t->node[c].data = NULL;
+        t->node[c].sibling = t->node[node].child;
+        t->node[node].child = c;
+    }
+    return c;
+}
+
+/* wtrie_add() - add the word `w', return the node it ends at */
+int
+wtrie_add(struct wtrie *t, const char *w)
+{
+    int node = 0;
+
+    for (; *w; w++) {
+        node = wtrie_add_child(t, node, *w);
+    }
+    return node;
+}
+
+/* wtrie_find() - return the node the word `w' ends at, or 0 */
+int
+wtrie_find(struct wtrie *t, const char *w)
+{
+    int node = 0;
+
+    for (; *w; w++) {
+        node = wtrie_child(t, node, *w);
+        if (node == 0) 
+            return 0;
+    }
+    return node;
+}
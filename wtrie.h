@@ -0,0 +1,52 @@
+/*  
+    Copyright 2010-2014 Çağrı Çöltekin <c.coltekin@rug.nl>
+
+    This file is part of seg, an application for word segmentation.
+
+    seg is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program as `gpl.txt'. If not, see 
+    <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _WTRIE_H
+#define _WTRIE_H       1
+
+/*
+ * A character trie for looking up all words starting at a position
+ * of an utterance with a single walk. The nodes are kept in a single
+ * array and referred to by their indices, node 0 is the root. 
+ * The children of a node are linked through ->sibling, 0 ends the 
+ * list. ->data is owned by the caller; it is NULL for nodes that do
+ * not end a word.
+ */
+
+struct wtrie_node {
+    int                 child;      // first child, 0 if none
+    int                 sibling;    // next child of the parent, 0 if none
+    char                ch;
+    void                *data;
+};
+
+struct wtrie {
+    struct wtrie_node   *node;
+    int                 n, nalloc;
+};
+
+struct wtrie    *wtrie_new();
+void            wtrie_free(struct wtrie *t);
+int             wtrie_child(struct wtrie *t, int node, char ch);
+int             wtrie_add_child(struct wtrie *t, int node, char ch);
+int             wtrie_add(struct wtrie *t, const char *w);
+int             wtrie_find(struct wtrie *t, const char *w);
+
+#endif /* _WTRIE_H */